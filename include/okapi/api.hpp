@@ -48,22 +48,32 @@
 #include "okapi/api/chassis/model/xDriveModel.hpp"
 #include "okapi/impl/chassis/controller/chassisControllerBuilder.hpp"
 
+#include "okapi/api/control/async/asyncCascadedPidController.hpp"
 #include "okapi/api/control/async/asyncLinearMotionProfileController.hpp"
 #include "okapi/api/control/async/asyncMotionProfileController.hpp"
 #include "okapi/api/control/async/asyncPosIntegratedController.hpp"
 #include "okapi/api/control/async/asyncPosPidController.hpp"
+#include "okapi/api/control/async/asyncPurePursuitController.hpp"
+#include "okapi/api/control/async/asyncRamseteController.hpp"
 #include "okapi/api/control/async/asyncVelIntegratedController.hpp"
 #include "okapi/api/control/async/asyncVelPidController.hpp"
 #include "okapi/api/control/async/asyncWrapper.hpp"
 #include "okapi/api/control/controllerInput.hpp"
 #include "okapi/api/control/controllerOutput.hpp"
+#include "okapi/api/control/iterative/iterativeCascadedPidController.hpp"
 #include "okapi/api/control/iterative/iterativeMotorVelocityController.hpp"
 #include "okapi/api/control/iterative/iterativePosPidController.hpp"
 #include "okapi/api/control/iterative/iterativeVelPidController.hpp"
+#include "okapi/api/control/iterative/pidBank.hpp"
+#include "okapi/api/control/iterative/pidController.hpp"
 #include "okapi/api/control/util/controllerRunner.hpp"
 #include "okapi/api/control/util/flywheelSimulator.hpp"
+#include "okapi/api/control/util/pidGainSchedule.hpp"
 #include "okapi/api/control/util/pidTuner.hpp"
+#include "okapi/api/control/util/sCurveProfile.hpp"
 #include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/control/util/stepTimingStats.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
 #include "okapi/impl/control/async/asyncMotionProfileControllerBuilder.hpp"
 #include "okapi/impl/control/async/asyncPosControllerBuilder.hpp"
 #include "okapi/impl/control/async/asyncVelControllerBuilder.hpp"
@@ -7,11 +7,13 @@
 
 #include "okapi/api/chassis/controller/chassisController.hpp"
 #include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/util/sCurveProfile.hpp"
 #include "okapi/api/util/abstractRate.hpp"
 #include "okapi/api/util/logging.hpp"
 #include "okapi/api/util/timeUtil.hpp"
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <tuple>
 
 namespace okapi {
@@ -187,6 +189,33 @@ class ChassisControllerPID : public ChassisController {
              IterativePosPIDController::Gains>
   getGains() const;
 
+  /**
+   * Makes moves and turns follow motion profiles. Instead of stepping the PID controllers straight
+   * to the final target, which saturates their outputs and overshoots on large movements, the
+   * controllers follow a setpoint which moves along the profile. The profile's velocity is added to
+   * their outputs as feedforward, so the controllers only have to correct the error from the
+   * setpoint. A movement is not settled until its profile is done.
+   *
+   * Movements which were already started are not changed.
+   *
+   * @param istraightLimits The limits of moves in m/s, m/s/s, and m/s/s/s.
+   * @param iturnLimits The limits of turns in deg/s, deg/s/s, and deg/s/s/s. This is how fast the
+   * robot turns, not how fast its wheels turn.
+   * @param ishape The shape of the profiles. Trapezoidal profiles ignore the jerk limits.
+   * @param ivelocityFeedforward How much of the profile's velocity to add to the outputs. `1`
+   * commands the motors at the profile's velocity and `0` disables feedforward.
+   */
+  void setMotionProfile(const PathfinderLimits &istraightLimits,
+                        const PathfinderLimits &iturnLimits,
+                        SCurveProfile::Shape ishape = SCurveProfile::Shape::trapezoid,
+                        double ivelocityFeedforward = 1);
+
+  /**
+   * Makes moves and turns step the PID controllers straight to the final target. This is the
+   * default.
+   */
+  void disableMotionProfile();
+
   /**
    * Starts the internal thread. This method is called by the ChassisControllerBuilder when making a
    * new instance of this class.
@@ -245,6 +274,25 @@ class ChassisControllerPID : public ChassisController {
   std::atomic_bool dtorCalled{false};
   QTime threadSleepTime{10_ms};
 
+  struct MotionProfileSettings {
+    PathfinderLimits straightLimits;
+    PathfinderLimits turnLimits;
+    SCurveProfile::Shape shape;
+    double velocityFeedforward;
+  };
+
+  // The profile the current movement follows
+  struct ProfiledMovement {
+    SCurveProfile profile;
+    double ticksPerUnit; // Encoder ticks per unit of the profile's position
+    double velocityFeedforward;
+  };
+
+  std::optional<MotionProfileSettings> profileSettings{std::nullopt};
+  std::shared_ptr<const ProfiledMovement> profiledMovement{nullptr};
+  CrossplatformMutex profiledMovementMutex;
+  std::atomic_bool profileDone{true};
+
   static void trampoline(void *context);
   void loop();
 
@@ -267,6 +315,25 @@ class ChassisControllerPID : public ChassisController {
    */
   void stopAfterSettled();
 
+  /**
+   * Sets the profile the next movement follows, or clears it if motion profiles are disabled.
+   *
+   * @param idistance The distance of the movement in the units of its limits.
+   * @param iisTurn Whether the movement is a turn.
+   * @param iticksPerUnit Encoder ticks per unit of distance.
+   */
+  void setProfiledMovement(double idistance, bool iisTurn, double iticksPerUnit);
+
+  /**
+   * Follows the profile of the current movement.
+   *
+   * @param imovement The profile of the current movement.
+   * @param itime The time since the movement started.
+   * @return The offset to add to the sensor reading, so the PID controller's error is from the
+   * profile's setpoint instead of the final target, and the feedforward to add to its output.
+   */
+  std::pair<double, double> stepProfile(const ProfiledMovement &imovement, QTime itime);
+
   typedef enum { distance, angle, none } modeType;
   modeType mode{none};
 
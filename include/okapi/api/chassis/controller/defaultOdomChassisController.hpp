@@ -8,8 +8,10 @@
 #include "okapi/api/chassis/controller/chassisControllerIntegrated.hpp"
 #include "okapi/api/chassis/controller/odomChassisController.hpp"
 #include "okapi/api/chassis/model/skidSteerModel.hpp"
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
 #include "okapi/api/odometry/odometry.hpp"
 #include <memory>
+#include <optional>
 
 namespace okapi {
 class DefaultOdomChassisController : public OdomChassisController {
@@ -45,7 +47,27 @@ class DefaultOdomChassisController : public OdomChassisController {
   DefaultOdomChassisController &operator=(DefaultOdomChassisController &&other) = delete;
 
   /**
-   * Drives the robot straight to a point in the odom frame.
+   * How driveToPoint() moves the robot.
+   */
+  enum class PointMotion {
+    turnThenDrive, ///< Turn to face the point, wait to settle, then drive straight to it.
+    curved         ///< Drive and turn at the same time from odometry each tick, like driveToPose().
+  };
+
+  /**
+   * When driveToPose() and curved driveToPoint() motions are done.
+   */
+  struct PoseExitConditions {
+    QLength distance{1_in}; // The robot must be within this distance of the target
+    QAngle angle{3_deg};    // The robot must be within this angle of the heading (poses only)
+    QTime settleTime{0_ms}; // The robot must stay within both for this long
+    QTime timeout{5_s};     // The motion is given up after this long, or never if zero
+  };
+
+  /**
+   * Drives the robot straight to a point in the odom frame. By default, the robot turns to face
+   * the point and then drives to it. Use `setPointMotion(PointMotion::curved)` to drive and turn at
+   * the same time instead.
    *
    * @param ipoint The target point to navigate to.
    * @param ibackwards Whether to drive to the target point backwards.
@@ -56,6 +78,27 @@ class DefaultOdomChassisController : public OdomChassisController {
                     bool ibackwards = false,
                     const QLength &ioffset = 0_mm) override;
 
+  /**
+   * Drives the robot to a pose in the odom frame along a curve. Each tick, the distance and heading
+   * are corrected at the same time from odometry using the "boomerang" controller: the robot
+   * steers towards a carrot point which starts behind the target, along the target heading, and
+   * slides onto the target as the robot gets closer. This does not wait for a turn to settle
+   * before driving, so it is much faster than driveToPoint() followed by turnToAngle().
+   *
+   * The robot stops once the exit conditions set by `setPoseExitConditions()` are met. The
+   * internal ChassisController is stopped first so it does not fight this motion.
+   *
+   * @param ipoint The target point to navigate to.
+   * @param iangle The heading to arrive at.
+   * @param ibackwards Whether to drive to the target pose backwards.
+   * @param ilead How far behind the target the carrot point starts, as a fraction of the distance
+   * to the target. Larger values make wider curves. Must be in the range [0, 1).
+   */
+  void driveToPose(const Point &ipoint,
+                   const QAngle &iangle,
+                   bool ibackwards = false,
+                   double ilead = 0.6) override;
+
   /**
    * Turns the robot to face a point in the odom frame.
    *
@@ -63,6 +106,38 @@ class DefaultOdomChassisController : public OdomChassisController {
    */
   void turnToPoint(const Point &ipoint) override;
 
+  /**
+   * Sets how driveToPoint() moves the robot. The default is `PointMotion::turnThenDrive`.
+   *
+   * @param imotion How driveToPoint() moves the robot.
+   */
+  void setPointMotion(PointMotion imotion);
+
+  /**
+   * @return How driveToPoint() moves the robot.
+   */
+  PointMotion getPointMotion() const;
+
+  /**
+   * Sets the gains used by driveToPose() and curved driveToPoint() motions. The distance error is
+   * in meters and the heading error is in radians. The outputs are the forward and yaw speeds
+   * passed to `ChassisModel::driveVector()`.
+   *
+   * @param idistanceGains The gains of the distance controller.
+   * @param iturnGains The gains of the heading controller.
+   */
+  void setPoseGains(const IterativePosPIDController::Gains &idistanceGains,
+                    const IterativePosPIDController::Gains &iturnGains);
+
+  /**
+   * Sets when driveToPose() and curved driveToPoint() motions are done. With the default settle
+   * time of zero, a motion is done as soon as the robot is close enough to the target. With the
+   * default timeout, a motion which never gets close enough is given up after five seconds.
+   *
+   * @param iexitConditions The exit conditions.
+   */
+  void setPoseExitConditions(const PoseExitConditions &iexitConditions);
+
   /**
    * @return The internal ChassisController.
    */
@@ -171,7 +246,30 @@ class DefaultOdomChassisController : public OdomChassisController {
   protected:
   std::shared_ptr<Logger> logger;
   std::shared_ptr<ChassisController> controller;
+  PointMotion pointMotion{PointMotion::turnThenDrive};
+  IterativePosPIDController::Gains poseDistanceGains{2.5, 0, 0, 0};
+  IterativePosPIDController::Gains poseTurnGains{2, 0, 0, 0};
+  PoseExitConditions poseExitConditions{};
+
+  // Closer than this, the robot stops steering towards the target and only corrects its heading,
+  // because the angle to the target swings wildly as the robot passes it
+  static constexpr double poseCloseDistance = 0.075; // m
 
   void waitForOdomTask();
+
+  /**
+   * Drives to a target in the frame transformation frame, correcting the distance and heading at
+   * the same time.
+   *
+   * @param itarget The target point.
+   * @param iangle The heading to arrive at, or `std::nullopt` to arrive at any heading.
+   * @param ibackwards Whether to drive to the target backwards.
+   * @param ilead How far behind the target the carrot point starts, as a fraction of the distance
+   * to the target.
+   */
+  void driveCurved(const Point &itarget,
+                   const std::optional<QAngle> &iangle,
+                   bool ibackwards,
+                   double ilead);
 };
 } // namespace okapi
@@ -62,6 +62,22 @@ class OdomChassisController : public ChassisController {
   virtual void
   driveToPoint(const Point &ipoint, bool ibackwards = false, const QLength &ioffset = 0_mm) = 0;
 
+  /**
+   * Drives the robot to a pose in the odom frame, correcting its distance and heading at the same
+   * time. Controllers which can't do this do not need to override it; by default, an instance of
+   * `std::runtime_error` is thrown (and an error is logged).
+   *
+   * @param ipoint The target point to navigate to.
+   * @param iangle The heading to arrive at.
+   * @param ibackwards Whether to drive to the target pose backwards.
+   * @param ilead How far behind the target the robot aims at first, as a fraction of the distance
+   * to the target. Larger values make wider curves.
+   */
+  virtual void driveToPose(const Point &ipoint,
+                           const QAngle &iangle,
+                           bool ibackwards = false,
+                           double ilead = 0.6);
+
   /**
    * Turns the robot to face a point in the odom frame.
    *
@@ -0,0 +1,133 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/async/asyncPositionController.hpp"
+#include "okapi/api/control/async/asyncWrapper.hpp"
+#include "okapi/api/control/controllerOutput.hpp"
+#include "okapi/api/control/iterative/iterativeCascadedPidController.hpp"
+#include "okapi/api/control/offsettableControllerInput.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <memory>
+
+namespace okapi {
+class AsyncCascadedPIDController : public AsyncWrapper<double, double>,
+                                   public AsyncPositionController<double, double> {
+  public:
+  /**
+   * An async cascaded position-velocity PID controller. Both loops run in one task, which runs at
+   * the inner loop's sample time. See IterativeCascadedPIDController.
+   *
+   * @param iinput The controller input. Will be turned into an OffsettableControllerInput.
+   * @param ioutput The controller output.
+   * @param itimeUtil The TimeUtil.
+   * @param iouterGains The gains of the outer position loop.
+   * @param iinnerGains The gains of the inner velocity loop.
+   * @param ivelMath The VelMath used by the inner loop for calculating velocity. Its sample time
+   * should be at most iinnerSampleTime.
+   * @param imaxVelocity The maximum velocity target of the inner loop, in the units of the VelMath.
+   * @param iouterSampleTime The sample time of the outer loop.
+   * @param iinnerSampleTime The sample time of the inner loop.
+   * @param iratio Any external gear ratio.
+   * @param ilogger The logger this instance will log to.
+   */
+  AsyncCascadedPIDController(
+    const std::shared_ptr<ControllerInput<double>> &iinput,
+    const std::shared_ptr<ControllerOutput<double>> &ioutput,
+    const TimeUtil &itimeUtil,
+    const IterativePosPIDController::Gains &iouterGains,
+    const IterativeVelPIDController::Gains &iinnerGains,
+    std::unique_ptr<VelMath> ivelMath,
+    double imaxVelocity,
+    QTime iouterSampleTime = 10_ms,
+    QTime iinnerSampleTime = 5_ms,
+    double iratio = 1,
+    const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  /**
+   * An async cascaded position-velocity PID controller. Both loops run in one task, which runs at
+   * the inner loop's sample time. See IterativeCascadedPIDController.
+   *
+   * @param iinput The controller input.
+   * @param ioutput The controller output.
+   * @param itimeUtil The TimeUtil.
+   * @param iouterGains The gains of the outer position loop.
+   * @param iinnerGains The gains of the inner velocity loop.
+   * @param ivelMath The VelMath used by the inner loop for calculating velocity. Its sample time
+   * should be at most iinnerSampleTime.
+   * @param imaxVelocity The maximum velocity target of the inner loop, in the units of the VelMath.
+   * @param iouterSampleTime The sample time of the outer loop.
+   * @param iinnerSampleTime The sample time of the inner loop.
+   * @param iratio Any external gear ratio.
+   * @param ilogger The logger this instance will log to.
+   */
+  AsyncCascadedPIDController(
+    const std::shared_ptr<OffsetableControllerInput> &iinput,
+    const std::shared_ptr<ControllerOutput<double>> &ioutput,
+    const TimeUtil &itimeUtil,
+    const IterativePosPIDController::Gains &iouterGains,
+    const IterativeVelPIDController::Gains &iinnerGains,
+    std::unique_ptr<VelMath> ivelMath,
+    double imaxVelocity,
+    QTime iouterSampleTime = 10_ms,
+    QTime iinnerSampleTime = 5_ms,
+    double iratio = 1,
+    const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Sets the "absolute" zero position of the controller to its current position.
+   */
+  void tarePosition() override;
+
+  /**
+   * Sets the maximum velocity target of the inner loop.
+   *
+   * @param imaxVelocity The maximum velocity, in the units of the VelMath.
+   */
+  void setMaxVelocity(std::int32_t imaxVelocity) override;
+
+  /**
+   * Set the gains of the outer position loop.
+   *
+   * @param igains The new gains.
+   */
+  void setOuterGains(const IterativePosPIDController::Gains &igains);
+
+  /**
+   * @return The gains of the outer position loop.
+   */
+  IterativePosPIDController::Gains getOuterGains() const;
+
+  /**
+   * Set the gains of the inner velocity loop.
+   *
+   * @param igains The new gains.
+   */
+  void setInnerGains(const IterativeVelPIDController::Gains &igains);
+
+  /**
+   * @return The gains of the inner velocity loop.
+   */
+  IterativeVelPIDController::Gains getInnerGains() const;
+
+  protected:
+  /**
+   * Creates the cascaded controller this controller runs.
+   */
+  static std::shared_ptr<IterativeCascadedPIDController>
+  makeController(const TimeUtil &itimeUtil,
+                 const IterativePosPIDController::Gains &iouterGains,
+                 const IterativeVelPIDController::Gains &iinnerGains,
+                 std::unique_ptr<VelMath> ivelMath,
+                 double imaxVelocity,
+                 QTime iouterSampleTime,
+                 QTime iinnerSampleTime,
+                 const std::shared_ptr<Logger> &ilogger);
+
+  std::shared_ptr<OffsetableControllerInput> offsettableInput;
+  std::shared_ptr<IterativeCascadedPIDController> internalController;
+};
+} // namespace okapi
@@ -0,0 +1,362 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/chassis/controller/chassisScales.hpp"
+#include "okapi/api/chassis/model/hDriveModel.hpp"
+#include "okapi/api/chassis/model/xDriveModel.hpp"
+#include "okapi/api/control/async/asyncPositionController.hpp"
+#include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/device/motor/abstractMotor.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <valarray>
+
+namespace okapi {
+class AsyncHolonomicMotionProfileController
+  : public AsyncPositionController<std::string, PathfinderPoint> {
+  public:
+  /**
+   * An Async Controller which generates and follows 2D motion profiles for holonomic chassis. The
+   * translation of the robot is decoupled from its heading, so the robot can strafe and turn while
+   * it follows a path instead of turning to face the direction it is driving in. The path of the
+   * center of the robot is generated through the waypoints and the heading is profiled separately
+   * between the headings of the waypoints.
+   *
+   * The model must be an `XDriveModel` (including a `ThreeEncoderXDriveModel`), which has its four
+   * wheels driven separately, or an `HDriveModel`, which has its side wheels driven like a skid
+   * steer and its middle wheel driven to strafe. The middle wheel of an `HDriveModel` is assumed to
+   * be the same size as the side wheels. The scales are used the same way the chassis controllers
+   * use them, so the wheel diameter of an X drive is its effective diameter. Throws a
+   * `std::invalid_argument` exception if the model is neither or if the gear ratio is zero.
+   *
+   * @param itimeUtil The TimeUtil.
+   * @param ilimits The default limits of the translation of the robot.
+   * @param imodel The chassis model to control.
+   * @param iscales The chassis dimensions.
+   * @param ipair The gearset.
+   * @param ilogger The logger this instance will log to.
+   */
+  AsyncHolonomicMotionProfileController(
+    const TimeUtil &itimeUtil,
+    const PathfinderLimits &ilimits,
+    const std::shared_ptr<ChassisModel> &imodel,
+    const ChassisScales &iscales,
+    const AbstractMotor::GearsetRatioPair &ipair,
+    const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  AsyncHolonomicMotionProfileController(AsyncHolonomicMotionProfileController &&other) = delete;
+
+  AsyncHolonomicMotionProfileController &
+  operator=(AsyncHolonomicMotionProfileController &&other) = delete;
+
+  ~AsyncHolonomicMotionProfileController() override;
+
+  /**
+   * One step of a holonomic path. Positions are relative to the start of the path, with positive x
+   * forward, positive y to the left, and positive theta counterclockwise.
+   */
+  struct HolonomicSegment {
+    double x;     // m
+    double y;     // m
+    double theta; // Heading of the robot in rad
+    double vx;    // m/s
+    double vy;    // m/s
+    double omega; // rad/s
+    double dt;    // Duration of the segment in seconds
+  };
+
+  // Paths are immutable once saved. They are shared so that a path which is being followed stays
+  // alive until it is finished, even if it is removed from the table in the meantime.
+  using PathPtr = std::shared_ptr<const std::vector<HolonomicSegment>>;
+
+  /**
+   * Generates a path which intersects the given waypoints and saves it internally with a key of
+   * pathId. Call `setTarget()` with the same `pathId` to run it. The theta of each waypoint is
+   * the heading the robot should have when it reaches that waypoint, not the direction it is
+   * driving in.
+   *
+   * If the waypoints form a path which is impossible to achieve, an instance of
+   * `std::runtime_error` is thrown (and an error is logged) which describes the waypoints. If there
+   * are no waypoints, no path is generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   */
+  void generatePath(std::initializer_list<PathfinderPoint> iwaypoints, const std::string &ipathId);
+
+  /**
+   * Generates a path which intersects the given waypoints and saves it internally with a key of
+   * pathId. Call `setTarget()` with the same `pathId` to run it. The theta of each waypoint is
+   * the heading the robot should have when it reaches that waypoint, not the direction it is
+   * driving in.
+   *
+   * If the waypoints form a path which is impossible to achieve, an instance of
+   * `std::runtime_error` is thrown (and an error is logged) which describes the waypoints. If there
+   * are no waypoints, no path is generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   * @param ilimits The limits to use for this path only.
+   */
+  void generatePath(std::initializer_list<PathfinderPoint> iwaypoints,
+                    const std::string &ipathId,
+                    const PathfinderLimits &ilimits);
+
+  /**
+   * Removes a path. If the path is being followed, it keeps running until it finishes and its
+   * memory is freed then; otherwise its memory is freed immediately. This function always returns
+   * `true` because the path no longer exists afterwards.
+   *
+   * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
+   * @return `true` if the path no longer exists
+   */
+  bool removePath(const std::string &ipathId);
+
+  /**
+   * Gets the identifiers of all paths saved in this `AsyncHolonomicMotionProfileController`.
+   *
+   * @return The identifiers of all paths
+   */
+  std::vector<std::string> getPaths();
+
+  /**
+   * Executes a path with the given ID. If there is no path matching the ID, the method will
+   * return. Any targets set while a path is being followed will be ignored.
+   *
+   * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
+   */
+  void setTarget(std::string ipathId) override;
+
+  /**
+   * Writes the value of the controller output. This method might be automatically called in another
+   * thread by the controller.
+   *
+   * This just calls `setTarget()`.
+   */
+  void controllerSet(std::string ivalue) override;
+
+  /**
+   * Gets the last set target, or the default target if none was set.
+   *
+   * @return the last target
+   */
+  std::string getTarget() override;
+
+  /**
+   * Gets the last set target, or the default target if none was set.
+   *
+   * @return the last target
+   */
+  virtual std::string getTarget() const;
+
+  /**
+   * This is overridden to return the current path.
+   *
+   * @return The most recent value of the process variable.
+   */
+  std::string getProcessValue() const override;
+
+  /**
+   * Blocks the current task until the controller has settled. This controller is settled when
+   * it has finished following a path. If no path is being followed, it is settled.
+   */
+  void waitUntilSettled() override;
+
+  /**
+   * Generates a new path from the position (typically the current position) to the target and
+   * blocks until the controller has settled. Does not save the path which was generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   */
+  void moveTo(std::initializer_list<PathfinderPoint> iwaypoints);
+
+  /**
+   * Generates a new path from the position (typically the current position) to the target and
+   * blocks until the controller has settled. Does not save the path which was generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ilimits The limits to use for this path only.
+   */
+  void moveTo(std::initializer_list<PathfinderPoint> iwaypoints, const PathfinderLimits &ilimits);
+
+  /**
+   * Returns the displacement from where the robot should be on the path to the end of the path.
+   * Returns zero if there is no path currently being followed.
+   *
+   * @return the last error
+   */
+  PathfinderPoint getError() const override;
+
+  /**
+   * Returns whether the controller has settled at the target. Determining what settling means is
+   * implementation-dependent.
+   *
+   * If the controller is disabled, this method must return `true`.
+   *
+   * @return whether the controller is settled
+   */
+  bool isSettled() override;
+
+  /**
+   * Resets the controller's internal state so it is similar to when it was first initialized, while
+   * keeping any user-configured information. This implementation also stops movement.
+   */
+  void reset() override;
+
+  /**
+   * Changes whether the controller is off or on. Turning the controller on after it was off will
+   * NOT cause the controller to move to its last set target.
+   */
+  void flipDisable() override;
+
+  /**
+   * Sets whether the controller is off or on. Turning the controller on after it was off will
+   * NOT cause the controller to move to its last set target, unless it was reset in that time.
+   *
+   * @param iisDisabled whether the controller is disabled
+   */
+  void flipDisable(bool iisDisabled) override;
+
+  /**
+   * Returns whether the controller is currently disabled.
+   *
+   * @return whether the controller is currently disabled
+   */
+  bool isDisabled() const override;
+
+  /**
+   * This implementation does nothing because the API always requires the starting position to be
+   * specified.
+   */
+  void tarePosition() override;
+
+  /**
+   * This implementation does nothing because the maximum velocity is configured using
+   * PathfinderLimits elsewhere.
+   *
+   * @param imaxVelocity Ignored.
+   */
+  void setMaxVelocity(std::int32_t imaxVelocity) override;
+
+  /**
+   * Sets the generator used to generate the path of the center of the robot. Paths which were
+   * already saved are not regenerated.
+   *
+   * @param igenerator The generator to use, or `nullptr` to use a default `TrajectoryGenerator`.
+   */
+  void setTrajectoryGenerator(const std::shared_ptr<const TrajectoryGenerator> &igenerator);
+
+  /**
+   * Computes the speed of each driven wheel for a chassis velocity. For an `XDriveModel` the
+   * speeds are for the top left, top right, bottom right, and bottom left wheels. For an
+   * `HDriveModel` they are for the left, right, and middle wheels.
+   *
+   * @param iforward The forward velocity of the robot in m/s.
+   * @param ileft The velocity of the robot to its left in m/s.
+   * @param iangular The angular velocity of the robot in rad/s, positive counterclockwise.
+   * @return The speed of each wheel as a fraction of the gearset's max speed.
+   */
+  std::valarray<double> getWheelSpeeds(double iforward, double ileft, double iangular) const;
+
+  /**
+   * Starts the internal thread. This should not be called by normal users. This method is called
+   * by the AsyncControllerFactory when making a new instance of this class.
+   */
+  void startThread();
+
+  /**
+   * Returns the underlying thread handle.
+   *
+   * @return The underlying thread handle.
+   */
+  CrossplatformThread *getThread() const;
+
+  /**
+   * Removes a path without stopping execution. This is the same as `removePath()`, since a running
+   * path is freed once it finishes.
+   *
+   * @param ipathId The path ID that will be removed
+   */
+  void forceRemovePath(const std::string &ipathId);
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  std::map<std::string, PathPtr> paths{};
+  PathfinderLimits limits;
+  std::shared_ptr<ChassisModel> model;
+  std::shared_ptr<XDriveModel> xModel; // Set if the model is an X drive
+  std::shared_ptr<HDriveModel> hModel; // Set if the model is an H drive
+  ChassisScales scales;
+  AbstractMotor::GearsetRatioPair pair;
+  TimeUtil timeUtil;
+  std::shared_ptr<const TrajectoryGenerator> trajectoryGenerator;
+
+  // This must be locked when accessing the paths, the current path, or the running path. It is
+  // never held while a path is being followed.
+  mutable CrossplatformMutex pathsMutex;
+
+  // The path being followed and the segment of it which is being followed
+  PathPtr runningPath{nullptr};
+  const HolonomicSegment *currentSegment{nullptr};
+  std::string currentPath{""};
+  std::atomic_bool isRunning{false};
+  std::atomic_bool disabled{false};
+  std::atomic_bool dtorCalled{false};
+  CrossplatformThread *task{nullptr};
+
+  static void trampoline(void *context);
+  void loop();
+
+  /**
+   * Follow the supplied path. Must follow the disabled lifecycle.
+   */
+  virtual void executeSinglePath(const std::vector<HolonomicSegment> &path,
+                                 std::unique_ptr<AbstractRate> rate);
+
+  /**
+   * Generates the path of the center of the robot, profiles the heading along it, and slows down
+   * the segments where a wheel would have to go faster than its motor can.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier for the path, used in error messages.
+   * @param ilimits The limits of the translation of the robot.
+   * @return The path.
+   */
+  std::vector<HolonomicSegment> generateSegments(const std::vector<PathfinderPoint> &iwaypoints,
+                                                 const std::string &ipathId,
+                                                 const PathfinderLimits &ilimits) const;
+
+  /**
+   * Takes a snapshot of a path. The snapshot stays valid even if the path is removed or replaced.
+   *
+   * @param ipathId The identifier of the path.
+   * @return The path, or `nullptr` if there is no path with that identifier.
+   */
+  PathPtr getPath(const std::string &ipathId) const;
+
+  /**
+   * Writes wheel speeds to the model.
+   *
+   * @param ispeeds The speeds from `getWheelSpeeds()`.
+   */
+  void setWheelSpeeds(const std::valarray<double> &ispeeds);
+
+  /**
+   * Converts linear "chassis" speed to rotational motor speed.
+   *
+   * @param linear "chassis" frame speed
+   * @return motor frame speed
+   */
+  QAngularSpeed convertLinearToRotational(QSpeed linear) const;
+};
+} // namespace okapi
@@ -6,7 +6,11 @@
 #pragma once
 
 #include "okapi/api/control/async/asyncPositionController.hpp"
+#include "okapi/api/control/util/compactTrajectory.hpp"
+#include "okapi/api/control/util/pathGenerationBatch.hpp"
 #include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/control/util/sCurveProfile.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
 #include "okapi/api/device/motor/abstractMotor.hpp"
 #include "okapi/api/units/QAngularSpeed.hpp"
 #include "okapi/api/units/QSpeed.hpp"
@@ -14,6 +18,8 @@
 #include "okapi/api/util/timeUtil.hpp"
 #include <atomic>
 #include <map>
+#include <memory>
+#include <optional>
 
 extern "C" {
 #include "okapi/pathfinder/include/pathfinder.h"
@@ -76,10 +82,35 @@ class AsyncLinearMotionProfileController : public AsyncPositionController<std::s
                     const std::string &ipathId,
                     const PathfinderLimits &ilimits);
 
+  struct PathSpec {
+    std::vector<QLength> waypoints;
+    std::string pathId;
+    std::optional<PathfinderLimits> limits{}; // The default limits are used if this is empty
+  };
+
+  /**
+   * Generates a batch of paths in parallel and saves each one internally with a key of its pathId.
+   * This blocks until every path is done, so it is meant to be called once at startup instead of
+   * calling `generatePath()` for each path. The paths are generated on `iworkers` worker threads,
+   * one of which is the calling thread.
+   *
+   * A path which cannot be generated does not stop the rest of the batch. Instead of an exception
+   * being thrown, its result is marked as failed (and an error is logged). A path with no
+   * waypoints or with a pathId used by an earlier path in the batch also fails. Throws a
+   * `std::invalid_argument` exception if there are no workers.
+   *
+   * @param ispecs The waypoints, pathId, and limits of each path.
+   * @param iworkers The number of worker threads to generate the paths on.
+   * @return The result of each path, including how long it took to generate, in the same order as
+   * the specs.
+   */
+  std::vector<PathGenerationResult> generatePaths(const std::vector<PathSpec> &ispecs,
+                                                  std::size_t iworkers = 4);
+
   /**
-   * Removes a path and frees the memory it used. This function returns `true` if the path was
-   * either deleted or didn't exist in the first place. It returns `false` if the path could not be
-   * removed because it is running.
+   * Removes a path. If the path is being followed, it keeps running until it finishes and its
+   * memory is freed then; otherwise its memory is freed immediately. This function always returns
+   * `true` because the path no longer exists afterwards.
    *
    * @param ipathId A unique identifier for the path, previously passed to generatePath()
    * @return `true` if the path no longer exists
@@ -169,6 +200,33 @@ class AsyncLinearMotionProfileController : public AsyncPositionController<std::s
               const PathfinderLimits &ilimits,
               bool ibackwards = false);
 
+  /**
+   * Re-plans the path being followed so that it ends at a new target without stopping. The new
+   * profile starts from the position, velocity, and acceleration of the running profile at the next
+   * control tick, so the switch happens within one tick. The new profile is jerk-limited, or
+   * trapezoidal if closed-form trapezoidal profiles are being generated. Returns `false` and does
+   * nothing if no path is being followed. If the path ends before the next tick, the new target is
+   * ignored.
+   *
+   * @param itarget The new target, measured the same way as the waypoints of the running path.
+   * @return Whether a path was being followed.
+   */
+  bool retarget(const QLength &itarget);
+
+  /**
+   * Re-plans the path being followed so that it ends at a new target without stopping. The new
+   * profile starts from the position, velocity, and acceleration of the running profile at the next
+   * control tick, so the switch happens within one tick. The new profile is jerk-limited, or
+   * trapezoidal if closed-form trapezoidal profiles are being generated. Returns `false` and does
+   * nothing if no path is being followed. If the path ends before the next tick, the new target is
+   * ignored. Throws a `std::invalid_argument` exception if a limit is not positive.
+   *
+   * @param itarget The new target, measured the same way as the waypoints of the running path.
+   * @param ilimits The limits to use for the rest of the path.
+   * @return Whether a path was being followed.
+   */
+  bool retarget(const QLength &itarget, const PathfinderLimits &ilimits);
+
   /**
    * Returns the last error of the controller. Does not update when disabled. Returns zero if there
    * is no path currently being followed.
@@ -228,6 +286,43 @@ class AsyncLinearMotionProfileController : public AsyncPositionController<std::s
    */
   void setMaxVelocity(std::int32_t imaxVelocity) override;
 
+  /**
+   * Sets how paths are stored in memory once they are generated. Paths are stored as a
+   * `CompactTrajectory`, which only keeps the columns needed to follow the path. Lowering the
+   * precision lets more paths stay in memory at once. Paths which were already saved keep their
+   * storage. The default is `float64`, which is lossless, without the pose columns because a 1D
+   * profile has no pose.
+   *
+   * @param iprecision The precision to store each column with.
+   * @param iretainPose Whether to keep the x, y, and heading columns.
+   */
+  void setTrajectoryStorage(CompactTrajectory::Precision iprecision, bool iretainPose = false);
+
+  /**
+   * Sets the generator used to generate paths. By default, paths are generated with pathfinder.
+   * Paths which were already saved are not regenerated.
+   *
+   * @param igenerator The generator to use, or `nullptr` to use pathfinder.
+   */
+  void setTrajectoryGenerator(const std::shared_ptr<const TrajectoryGenerator> &igenerator);
+
+  /**
+   * Generates paths in closed form as an `SCurveProfile` instead of with pathfinder or a
+   * `TrajectoryGenerator`. A closed-form profile takes microseconds to make, so moves can be
+   * profiled right before they are followed. Only the first and last waypoints are used because
+   * the profile moves in a straight line between them. Paths which were already saved are not
+   * regenerated.
+   *
+   * @param ishape The shape of the profiles.
+   * @param ilazy Whether to evaluate the profile each control tick instead of storing its segments.
+   */
+  void setClosedFormProfile(SCurveProfile::Shape ishape, bool ilazy = false);
+
+  /**
+   * Generates paths with pathfinder or the `TrajectoryGenerator`. This is the default.
+   */
+  void setSplineProfile();
+
   /**
    * Starts the internal thread. This should not be called by normal users. This method is called
    * by the AsyncControllerFactory when making a new instance of this class.
@@ -242,8 +337,8 @@ class AsyncLinearMotionProfileController : public AsyncPositionController<std::s
   CrossplatformThread *getThread() const;
 
   /**
-   * Attempts to remove a path without stopping execution, then if that fails, disables the
-   * controller and removes the path.
+   * Removes a path without stopping execution. This is the same as `removePath()`, since a running
+   * path is freed once it finishes.
    *
    * @param ipathId The path ID that will be removed
    */
@@ -254,21 +349,46 @@ class AsyncLinearMotionProfileController : public AsyncPositionController<std::s
   using SegmentPtr = std::unique_ptr<Segment, void (*)(void *)>;
 
   struct TrajectoryPair {
-    SegmentPtr segment;
+    CompactTrajectory segment;
     int length;
+    double origin;                        // The first waypoint, which position zero is at
+    std::optional<SCurveProfile> profile; // Evaluated each tick instead of the segments if set
   };
 
+  // Paths are immutable once saved. They are shared so that a path which is being followed stays
+  // alive until it is finished, even if it is removed from the table in the meantime.
+  using PathPtr = std::shared_ptr<const TrajectoryPair>;
+
   std::shared_ptr<Logger> logger;
-  std::map<std::string, TrajectoryPair> paths{};
+  std::map<std::string, PathPtr> paths{};
   PathfinderLimits limits;
   std::shared_ptr<ControllerOutput<double>> output;
   QLength diameter;
   AbstractMotor::GearsetRatioPair pair;
   double currentProfilePosition{0};
   TimeUtil timeUtil;
+  CompactTrajectory::Precision storagePrecision{CompactTrajectory::Precision::float64};
+  bool storageRetainsPose{false};
+  std::shared_ptr<const TrajectoryGenerator> trajectoryGenerator{nullptr};
+  std::optional<SCurveProfile::Shape> closedFormShape{std::nullopt};
+  bool closedFormLazy{false};
+
+  // The duration of each tick of a closed-form profile
+  static constexpr double closedFormDt = 0.010;
+
+  struct RetargetRequest {
+    double target; // m, in the same frame as the waypoints
+    PathfinderLimits limits;
+    SCurveProfile::Shape shape;
+  };
+
+  // This must be locked when accessing the paths, the current path, the running path, the pending
+  // retarget request, or the end of the re-planned profile
+  mutable CrossplatformMutex currentPathMutex;
 
-  // This must be locked when accessing the current path
-  CrossplatformMutex currentPathMutex;
+  PathPtr runningPath{nullptr}; // The path loop() is following
+  std::optional<RetargetRequest> pendingRetarget{std::nullopt};
+  std::optional<double> retargetedEnd{std::nullopt}; // Relative to the start of the path
 
   std::string currentPath{""};
   std::atomic_bool isRunning{false};
@@ -303,5 +423,68 @@ class AsyncLinearMotionProfileController : public AsyncPositionController<std::s
    * @return The length of the path.
    */
   int getPathLength(const TrajectoryPair &path);
+
+  /**
+   * Follows a closed-form profile by evaluating it each tick. The profile is re-planned when a
+   * retarget request comes in. Must follow the disabled lifecycle.
+   *
+   * @param iprofile The profile to follow, relative to the start of the path.
+   * @param iorigin The first waypoint of the path.
+   * @param rate The rate to run at.
+   */
+  void executeProfile(const SCurveProfile &iprofile,
+                      double iorigin,
+                      std::unique_ptr<AbstractRate> rate);
+
+  /**
+   * Takes the pending retarget request, if there is one, and plans the rest of the path for it.
+   * `currentPathMutex` must be locked.
+   *
+   * @param istate The state the running profile is in, relative to the start of the path.
+   * @param iorigin The first waypoint of the path.
+   * @return The new profile, relative to the start of the path, if there was a request.
+   */
+  std::optional<SCurveProfile> takeRetarget(const SCurveProfile::State &istate, double iorigin);
+
+  /**
+   * Generates a closed-form profile and saves it.
+   *
+   * @param istart The position to start at.
+   * @param iend The position to end at.
+   * @param ipathId A unique identifier to save the path with.
+   * @param ilimits The limits to use for this path.
+   */
+  void generateClosedFormPath(QLength istart,
+                              QLength iend,
+                              const std::string &ipathId,
+                              const PathfinderLimits &ilimits);
+
+  /**
+   * Generates a path which intersects the given waypoints and saves it. This is thread safe so
+   * that a batch of paths can be generated in parallel.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   * @param ilimits The limits to use for this path.
+   */
+  void internalGeneratePath(const std::vector<QLength> &iwaypoints,
+                            const std::string &ipathId,
+                            const PathfinderLimits &ilimits);
+
+  /**
+   * Saves a path, replacing any path with the same ID.
+   *
+   * @param ipathId A unique identifier to save the path with.
+   * @param ipath The path to save.
+   */
+  void savePath(const std::string &ipathId, TrajectoryPair &&ipath);
+
+  /**
+   * Takes a snapshot of a path. The snapshot stays valid even if the path is removed or replaced.
+   *
+   * @param ipathId The identifier of the path.
+   * @return The path, or `nullptr` if there is no path with that identifier.
+   */
+  PathPtr getPath(const std::string &ipathId) const;
 };
 } // namespace okapi
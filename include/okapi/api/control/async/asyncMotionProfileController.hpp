@@ -8,13 +8,24 @@
 #include "okapi/api/chassis/controller/chassisScales.hpp"
 #include "okapi/api/chassis/model/skidSteerModel.hpp"
 #include "okapi/api/control/async/asyncPositionController.hpp"
+#include "okapi/api/control/util/bakedPath.hpp"
+#include "okapi/api/control/util/compactTrajectory.hpp"
+#include "okapi/api/control/util/pathFeasibilityChecker.hpp"
+#include "okapi/api/control/util/pathGenerationBatch.hpp"
+#include "okapi/api/control/util/pathGenerationHandle.hpp"
 #include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/control/util/tankTrajectoryLimiter.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/odometry/odometry.hpp"
 #include "okapi/api/units/QAngularSpeed.hpp"
 #include "okapi/api/units/QSpeed.hpp"
 #include "okapi/api/util/logging.hpp"
 #include "okapi/api/util/timeUtil.hpp"
 #include <atomic>
+#include <deque>
+#include <list>
 #include <map>
+#include <optional>
 
 extern "C" {
 #include "okapi/pathfinder/include/pathfinder.h"
@@ -77,9 +88,108 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
                     const PathfinderLimits &ilimits);
 
   /**
-   * Removes a path and frees the memory it used. This function returns true if the path was either
-   * deleted or didn't exist in the first place. It returns false if the path could not be removed
-   * because it is running.
+   * Generates one continuous path through a sequence of legs and saves it internally with a key of
+   * pathId. Each leg must start at the waypoint the previous leg ended at. The robot does not stop
+   * at the joints between legs; it only stops at the end of the last leg. This is faster than
+   * following each leg as its own path, which stops at the end of every leg.
+   *
+   * If a leg does not start where the previous leg ended, an instance of `std::invalid_argument`
+   * is thrown (and an error is logged). If the legs form a path which is impossible to achieve, an
+   * instance of `std::runtime_error` is thrown (and an error is logged). If there are no
+   * waypoints, no path is generated.
+   *
+   * @param ilegs The legs of the path, each made of the waypoints to hit on that leg.
+   * @param ipathId A unique identifier to save the path with.
+   */
+  void generatePathChain(std::initializer_list<std::vector<PathfinderPoint>> ilegs,
+                         const std::string &ipathId);
+
+  /**
+   * Generates one continuous path through a sequence of legs and saves it internally with a key of
+   * pathId. Each leg must start at the waypoint the previous leg ended at. The robot does not stop
+   * at the joints between legs; it only stops at the end of the last leg. This is faster than
+   * following each leg as its own path, which stops at the end of every leg.
+   *
+   * If a leg does not start where the previous leg ended, an instance of `std::invalid_argument`
+   * is thrown (and an error is logged). If the legs form a path which is impossible to achieve, an
+   * instance of `std::runtime_error` is thrown (and an error is logged). If there are no
+   * waypoints, no path is generated.
+   *
+   * @param ilegs The legs of the path, each made of the waypoints to hit on that leg.
+   * @param ipathId A unique identifier to save the path with.
+   * @param ilimits The limits to use for this path only.
+   */
+  void generatePathChain(std::initializer_list<std::vector<PathfinderPoint>> ilegs,
+                         const std::string &ipathId,
+                         const PathfinderLimits &ilimits);
+
+  /**
+   * Queues a path which intersects the given waypoints to be generated in the background and saved
+   * internally with a key of pathId. This returns immediately, so a path can be generated while
+   * another path is being followed. `setTarget()` waits for the path to finish generating if it is
+   * not ready yet.
+   *
+   * If the waypoints form a path which is impossible to achieve, the returned handle is marked as
+   * failed (and an error is logged) instead of an exception being thrown. If there are no
+   * waypoints, the returned handle is marked as failed and no path is generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   * @return A handle which tracks the generation of the path.
+   */
+  std::shared_ptr<PathGenerationHandle>
+  generatePathAsync(std::initializer_list<PathfinderPoint> iwaypoints, const std::string &ipathId);
+
+  /**
+   * Queues a path which intersects the given waypoints to be generated in the background and saved
+   * internally with a key of pathId. This returns immediately, so a path can be generated while
+   * another path is being followed. `setTarget()` waits for the path to finish generating if it is
+   * not ready yet.
+   *
+   * If the waypoints form a path which is impossible to achieve, the returned handle is marked as
+   * failed (and an error is logged) instead of an exception being thrown. If there are no
+   * waypoints, the returned handle is marked as failed and no path is generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   * @param ilimits The limits to use for this path only.
+   * @return A handle which tracks the generation of the path.
+   */
+  std::shared_ptr<PathGenerationHandle>
+  generatePathAsync(std::initializer_list<PathfinderPoint> iwaypoints,
+                    const std::string &ipathId,
+                    const PathfinderLimits &ilimits);
+
+  struct PathSpec {
+    std::vector<PathfinderPoint> waypoints;
+    std::string pathId;
+    std::optional<PathfinderLimits> limits{}; // The default limits are used if this is empty
+  };
+
+  /**
+   * Generates a batch of paths in parallel and saves each one internally with a key of its pathId.
+   * This blocks until every path is done, so it is meant to be called once at startup instead of
+   * calling `generatePath()` for each path. The paths are generated on `iworkers` worker threads,
+   * one of which is the calling thread.
+   *
+   * A path which cannot be generated does not stop the rest of the batch. Instead of an exception
+   * being thrown, its result is marked as failed (and an error is logged). A path with no
+   * waypoints or with a pathId used by an earlier path in the batch also fails. Throws a
+   * `std::invalid_argument` exception if there are no workers.
+   *
+   * @param ispecs The waypoints, pathId, and limits of each path.
+   * @param iworkers The number of worker threads to generate the paths on.
+   * @return The result of each path, including how long it took to generate, in the same order as
+   * the specs.
+   */
+  std::vector<PathGenerationResult> generatePaths(const std::vector<PathSpec> &ispecs,
+                                                  std::size_t iworkers = 4);
+
+  /**
+   * Removes a path. If the path is being followed, it keeps running until it finishes and its
+   * memory is freed then; otherwise its memory is freed immediately. This function always returns
+   * true because the path no longer exists afterwards. If the path is queued for generation by
+   * `generatePathAsync()`, the generation is cancelled and its handle fails.
    *
    * @param ipathId A unique identifier for the path, previously passed to `generatePath()`
    * @return True if the path no longer exists
@@ -95,7 +205,8 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
 
   /**
    * Executes a path with the given ID. If there is no path matching the ID, the method will
-   * return. Any targets set while a path is being followed will be ignored.
+   * return. Any targets set while a path is being followed will be ignored. If the path is still
+   * being generated by `generatePathAsync()`, this blocks until it is done.
    *
    * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
    */
@@ -103,7 +214,8 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
 
   /**
    * Executes a path with the given ID. If there is no path matching the ID, the method will
-   * return. Any targets set while a path is being followed will be ignored.
+   * return. Any targets set while a path is being followed will be ignored. If the path is still
+   * being generated by `generatePathAsync()`, this blocks until it is done.
    *
    * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
    * @param ibackwards Whether to follow the profile backwards.
@@ -139,7 +251,8 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
 
   /**
    * Generates a new path from the position (typically the current position) to the target and
-   * blocks until the controller has settled. Does not save the path which was generated.
+   * blocks until the controller has settled. Does not save the path which was generated, unless
+   * the trajectory cache is enabled with `setTrajectoryCacheBudget()`.
    *
    * @param iwaypoints The waypoints to hit on the path.
    * @param ibackwards Whether to follow the profile backwards.
@@ -151,7 +264,8 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
 
   /**
    * Generates a new path from the position (typically the current position) to the target and
-   * blocks until the controller has settled. Does not save the path which was generated.
+   * blocks until the controller has settled. Does not save the path which was generated, unless
+   * the trajectory cache is enabled with `setTrajectoryCacheBudget()`.
    *
    * @param iwaypoints The waypoints to hit on the path.
    * @param ilimits The limits to use for this path only.
@@ -163,6 +277,82 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
               bool ibackwards = false,
               bool imirrored = false);
 
+  struct TrajectoryCacheStats {
+    std::size_t hits;    // Number of moveTo() calls which reused a cached trajectory
+    std::size_t misses;  // Number of moveTo() calls which had to generate a trajectory
+    std::size_t entries; // Number of trajectories currently cached
+    std::size_t bytes;   // Memory currently used by the cached trajectories
+  };
+
+  /**
+   * Sets how paths are stored in memory once they are generated or loaded. Paths are stored as a
+   * `CompactTrajectory`, which only keeps the columns needed to follow the path. Lowering the
+   * precision or dropping the pose (x, y, and heading) columns lets more paths stay in memory at
+   * once. Paths which were already saved keep their storage. The default is `float64` with the
+   * pose columns kept, which is lossless.
+   *
+   * @param iprecision The precision to store each column with.
+   * @param iretainPose Whether to keep the x, y, and heading columns.
+   */
+  void setTrajectoryStorage(CompactTrajectory::Precision iprecision, bool iretainPose = true);
+
+  /**
+   * Sets the generator used to generate paths. By default, paths are generated with pathfinder.
+   * A `TrajectoryGenerator` also respects a centripetal acceleration limit and can use a different
+   * segment duration. Paths which were already saved are not regenerated, but the trajectory cache
+   * used by `moveTo()` is cleared.
+   *
+   * @param igenerator The generator to use, or `nullptr` to use pathfinder.
+   */
+  void setTrajectoryGenerator(const std::shared_ptr<const TrajectoryGenerator> &igenerator);
+
+  /**
+   * Follows paths closed loop. The chassis is driven with voltage using a kS/kV/kA feedforward
+   * computed from each wheel's profiled velocity and acceleration, plus a correction proportional
+   * to each wheel's position error measured with the chassis model's sensors. If odometry is given,
+   * the heading error measured by the odometry is corrected as well. The odometry must be stepped
+   * by something else, such as an `OdomChassisController`. Takes effect on the next path.
+   *
+   * @param igains The follower gains.
+   * @param iodometry The odometry to measure heading with, or `nullptr` to only use the sensors.
+   */
+  void setFollowerGains(const ProfileFollowerGains &igains,
+                        const std::shared_ptr<Odometry> &iodometry = nullptr);
+
+  /**
+   * Follows paths open loop by commanding each wheel's profiled velocity. This is the default.
+   * Takes effect on the next path.
+   */
+  void setOpenLoopFollower();
+
+  /**
+   * Sets the memory budget of the trajectory cache used by `moveTo()`. Trajectories are cached by
+   * the content of their waypoints, limits, and the chassis scales, so calling `moveTo()` again
+   * with the same arguments reuses the trajectory instead of generating it again. The least
+   * recently used trajectories are evicted once the cache uses more memory than the budget. A
+   * budget of zero disables the cache, which is the default.
+   *
+   * Cached trajectories are saved as paths with IDs starting with `__moveTo`.
+   *
+   * @param ibytes The maximum memory the cached trajectories can use, in bytes.
+   */
+  void setTrajectoryCacheBudget(std::size_t ibytes);
+
+  /**
+   * @return The memory budget of the trajectory cache, in bytes.
+   */
+  std::size_t getTrajectoryCacheBudget() const;
+
+  /**
+   * @return The hit and miss counters and the current size of the trajectory cache.
+   */
+  TrajectoryCacheStats getTrajectoryCacheStats() const;
+
+  /**
+   * Removes every trajectory from the trajectory cache and resets its counters.
+   */
+  void clearTrajectoryCache();
+
   /**
    * Returns the last error of the controller. Does not update when disabled. This implementation
    * always returns zero since the robot is assumed to perfectly follow the path. Subclasses can
@@ -224,7 +414,7 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
   void setMaxVelocity(std::int32_t imaxVelocity) override;
 
   /**
-   * Starts the internal thread. This should not be called by normal users. This method is called
+   * Starts the internal threads. This should not be called by normal users. This method is called
    * by the `AsyncMotionProfileControllerBuilder` when making a new instance of this class.
    */
   void startThread();
@@ -234,6 +424,11 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
    */
   CrossplatformThread *getThread() const;
 
+  /**
+   * @return The underlying thread handle of the path generation task.
+   */
+  CrossplatformThread *getGenerationThread() const;
+
   /**
    * Saves a generated path to files. Paths are stored as `<ipathId>.<left/right>.csv`. An SD card
    * must be inserted into the brain and the directory must exist. `idirectory` can be prefixed with
@@ -254,8 +449,48 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
   void loadPath(const std::string &idirectory, const std::string &ipathId);
 
   /**
-   * Attempts to remove a path without stopping execution. If that fails, disables the controller
-   * and removes the path.
+   * Saves generated paths to a single binary trajectory file. The file holds a versioned header,
+   * an index of the paths, and a checksummed block of segments for each path, so it loads much
+   * faster than the CSV files written by `storePath()`. The segments are stored in the native
+   * byte order of the brain. An SD card must be inserted into the brain and the directory must
+   * exist. `idirectory` can be prefixed with `/usd/`, but it this is not required.
+   *
+   * @param idirectory The directory to store the trajectory file in
+   * @param ifileName The name of the trajectory file
+   * @param ipathIds The path IDs of the generated paths to store
+   */
+  void storePathsBinary(const std::string &idirectory,
+                        const std::string &ifileName,
+                        const std::vector<std::string> &ipathIds);
+
+  /**
+   * Loads every path in a binary trajectory file written by `storePathsBinary()`. Each path is
+   * loaded under the path ID it was stored with. If the file is corrupt, no paths are loaded.
+   * `/usd/` is automatically prepended to `idirectory` if it is not specified.
+   *
+   * @param idirectory The directory that the trajectory file is stored in
+   * @param ifileName The name of the trajectory file
+   */
+  void loadPathsBinary(const std::string &idirectory, const std::string &ifileName);
+
+  /**
+   * Registers a path which was generated ahead of time by the `bakeTrajectories` tool and compiled
+   * into the program. The path is saved internally with a key of its pathId, just like a path from
+   * `generatePath()`, but nothing is generated and the baked data is followed in place instead of
+   * being copied. The trajectory storage settings do not apply to baked paths.
+   *
+   * The motor commands of a baked path depend on the chassis it was baked for. If the wheel
+   * diameter, wheel track, or gearset in the manifest do not match this controller, an instance of
+   * `std::invalid_argument` is thrown (and an error is logged) and the path is not registered.
+   *
+   * @param ipath The baked path. It must outlive this controller, which is the case for the paths
+   * in a header generated by the tool.
+   */
+  void registerBakedPath(const BakedPath &ipath);
+
+  /**
+   * Removes a path without stopping execution. This is the same as `removePath()`, since a running
+   * path is freed once it finishes.
    *
    * @param ipathId The path ID that will be removed
    */
@@ -265,22 +500,69 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
   using TrajectoryPtr = std::unique_ptr<TrajectoryCandidate, void (*)(TrajectoryCandidate *)>;
   using SegmentPtr = std::unique_ptr<Segment, void (*)(void *)>;
 
+  // Baked paths are compiled with the same commands, so they can be followed without copying them
+  using MotorCommand = BakedMotorCommand;
+
   struct TrajectoryPair {
-    SegmentPtr left;
-    SegmentPtr right;
+    CompactTrajectory left;
+    CompactTrajectory right;
     int length;
+    std::vector<MotorCommand> commands;
+    const MotorCommand *bakedCommands{nullptr}; // Followed instead of commands if set
+  };
+
+  // Paths are immutable once saved. They are shared so that a path which is being followed stays
+  // alive until it is finished, even if it is removed from the table in the meantime.
+  using PathPtr = std::shared_ptr<const TrajectoryPair>;
+
+  struct GenerationRequest {
+    std::vector<PathfinderPoint> waypoints;
+    PathfinderLimits limits;
+    std::shared_ptr<PathGenerationHandle> handle;
+  };
+
+  static constexpr char trajectoryFileMagic[4] = {'O', 'K', 'T', 'F'};
+  static constexpr std::uint32_t trajectoryFileVersion = 1;
+  static constexpr std::size_t trajectoryFilePathIdSize = 64;
+
+  struct TrajectoryFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t segmentSize;
+    std::uint32_t pathCount;
+  };
+
+  struct TrajectoryFileIndexEntry {
+    char pathId[trajectoryFilePathIdSize]; // Null terminated
+    std::int32_t length;
+    std::uint32_t reserved;
+    std::uint64_t offset; // Offset of the left segments from the start of the file
+    std::uint64_t leftChecksum;
+    std::uint64_t rightChecksum;
+  };
+
+  struct TrajectoryCacheEntry {
+    std::vector<double> key;
+    std::string pathId;
+    std::size_t bytes;
   };
 
   std::shared_ptr<Logger> logger;
-  std::map<std::string, TrajectoryPair> paths{};
+  std::map<std::string, PathPtr> paths{};
   PathfinderLimits limits;
   std::shared_ptr<ChassisModel> model;
   ChassisScales scales;
   AbstractMotor::GearsetRatioPair pair;
   TimeUtil timeUtil;
+  CompactTrajectory::Precision storagePrecision{CompactTrajectory::Precision::float64};
+  bool storageRetainsPose{true};
+
+  // This must be locked when accessing the paths, the current path, or the follower. It is never
+  // held while a path is being followed.
+  mutable CrossplatformMutex pathsMutex;
 
-  // This must be locked when accessing the current path
-  CrossplatformMutex currentPathMutex;
+  std::optional<ProfileFollowerGains> followerGains{std::nullopt};
+  std::shared_ptr<Odometry> followerOdometry{nullptr};
 
   std::string currentPath{""};
   std::atomic_bool isRunning{false};
@@ -290,14 +572,147 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
   std::atomic_bool dtorCalled{false};
   CrossplatformThread *task{nullptr};
 
+  // This must be locked when accessing the generation queue, the request being generated, or the
+  // pending paths
+  CrossplatformMutex generationMutex;
+
+  std::deque<GenerationRequest> generationQueue{};
+  std::shared_ptr<PathGenerationHandle> currentGeneration{nullptr};
+  std::shared_ptr<const TrajectoryGenerator> trajectoryGenerator{nullptr};
+  std::map<std::string, std::shared_ptr<PathGenerationHandle>> pendingPaths{};
+  CrossplatformThread *generationTask{nullptr};
+  std::atomic_bool generationStopped{false};
+
+  // The most recently used trajectory is at the front
+  std::list<TrajectoryCacheEntry> trajectoryCache{};
+  std::size_t trajectoryCacheBudget{0};
+  std::size_t trajectoryCacheBytes{0};
+  std::atomic_size_t trajectoryCacheHits{0};
+  std::atomic_size_t trajectoryCacheMisses{0};
+
   static void trampoline(void *context);
   void loop();
 
+  static void generationTrampoline(void *context);
+  void generationLoop();
+
+  /**
+   * Generates the left and right trajectories for a path. Does not save the path. Throws a
+   * `std::runtime_error` if the path is impossible.
+   *
+   * @param iwaypoints The waypoints to hit on the path. Must not be empty.
+   * @param ipathId The identifier of the path, used for logging.
+   * @param ilimits The limits to use for this path.
+   * @return The generated trajectories.
+   */
+  TrajectoryPair generateTrajectory(const std::vector<PathfinderPoint> &iwaypoints,
+                                    const std::string &ipathId,
+                                    const PathfinderLimits &ilimits);
+
+  /**
+   * Re-times the left and right trajectories of a path so neither wheel goes faster than the
+   * gearset allows or accelerates harder than the max acceleration, then compacts them.
+   *
+   * @param ileft The left segments.
+   * @param iright The right segments.
+   * @param ilength The number of segments on each side.
+   * @param ilimits The limits the path was generated with.
+   * @return The compacted path.
+   */
+  TrajectoryPair limitWheels(const Segment *ileft,
+                             const Segment *iright,
+                             int ilength,
+                             const PathfinderLimits &ilimits) const;
+
+  /**
+   * Compacts the left and right trajectories of a path using the configured storage.
+   *
+   * @param ileft The left segments.
+   * @param iright The right segments.
+   * @param ilength The number of segments on each side.
+   * @return The compacted path.
+   */
+  TrajectoryPair makeTrajectoryPair(const Segment *ileft, const Segment *iright, int ilength) const;
+
+  /**
+   * Lowers a path into the motor commands which are sent while following it. The commands are
+   * converted to motor speeds using the chassis scales and gearset, so following the path needs no
+   * unit math.
+   *
+   * @param ileft The left segments.
+   * @param iright The right segments.
+   * @param ilength The number of segments on each side.
+   * @return The motor commands.
+   */
+  std::vector<MotorCommand>
+  compileMotorCommands(const Segment *ileft, const Segment *iright, int ilength) const;
+
+  /**
+   * Saves a path, replacing any old path with the same identifier.
+   *
+   * @param ipathId The identifier to save the path with.
+   * @param ipath The path to save.
+   */
+  void savePath(const std::string &ipathId, TrajectoryPair &&ipath);
+
+  /**
+   * Makes the key a trajectory is cached with. The key holds everything the trajectory is
+   * generated from.
+   *
+   * @param iwaypoints The waypoints of the trajectory.
+   * @param ilimits The limits of the trajectory.
+   * @return The cache key.
+   */
+  std::vector<double> makeTrajectoryCacheKey(std::initializer_list<PathfinderPoint> iwaypoints,
+                                             const PathfinderLimits &ilimits) const;
+
+  /**
+   * Hashes a cache key.
+   *
+   * @param ikey The cache key.
+   * @return The hash of the key.
+   */
+  static std::uint64_t hashTrajectoryCacheKey(const std::vector<double> &ikey);
+
+  /**
+   * Finds the path which holds the cached trajectory for a key and marks it as the most recently
+   * used trajectory.
+   *
+   * @param ikey The cache key.
+   * @return The ID of the path, or an empty string if the trajectory is not cached.
+   */
+  std::string findCachedTrajectory(const std::vector<double> &ikey);
+
+  /**
+   * Removes the least recently used trajectories until the cache fits in its budget.
+   */
+  void evictCachedTrajectories();
+
+  /**
+   * Blocks until the path is done generating if it was queued by `generatePathAsync()`.
+   *
+   * @param ipathId The identifier of the path.
+   */
+  void waitForPendingPath(const std::string &ipathId);
+
   /**
    * Follow the supplied path. Must follow the disabled lifecycle.
    */
   virtual void executeSinglePath(const TrajectoryPair &path, std::unique_ptr<AbstractRate> rate);
 
+  /**
+   * Follow the supplied path closed loop. Must follow the disabled lifecycle.
+   *
+   * @param path The path to follow.
+   * @param rate The rate to follow the path with.
+   * @param igains The follower gains.
+   * @param iodometry The odometry to measure heading with, or `nullptr` to only use the sensors.
+   */
+  void executeClosedLoopPath(const TrajectoryPair &path,
+                             std::unique_ptr<AbstractRate> rate,
+                             const ProfileFollowerGains &igains,
+                             const std::shared_ptr<Odometry> &iodometry);
+
   /**
    * Converts linear chassis speed to rotational motor speed.
    *
@@ -321,13 +736,24 @@ class AsyncMotionProfileController : public AsyncPositionController<std::string,
 
   void internalStorePath(FILE *leftPathFile, FILE *rightPathFile, const std::string &ipathId);
   void internalLoadPath(FILE *leftPathFile, FILE *rightPathFile, const std::string &ipathId);
+  void internalStorePathsBinary(FILE *pathFile, const std::vector<std::string> &ipathIds);
+  void internalLoadPathsBinary(FILE *pathFile);
+
+  /**
+   * Hashes bytes with 64-bit FNV-1a.
+   *
+   * @param idata The bytes to hash.
+   * @param isize The number of bytes.
+   * @return The hash of the bytes.
+   */
+  static std::uint64_t fnv1a(const void *idata, std::size_t isize);
 
   /**
-   * Reads the length of the path in a thread-safe manner.
+   * Takes a snapshot of a path. The snapshot stays valid even if the path is removed or replaced.
    *
-   * @param path The path to read from.
-   * @return The length of the path.
+   * @param ipathId The identifier of the path.
+   * @return The path, or `nullptr` if there is no path with that identifier.
    */
-  int getPathLength(const TrajectoryPair &path);
+  PathPtr getPath(const std::string &ipathId) const;
 };
 } // namespace okapi
@@ -93,6 +93,23 @@ class AsyncPosPIDController : public AsyncWrapper<double, double>,
    */
   IterativePosPIDController::Gains getGains() const;
 
+  /**
+   * Sets the velocity and acceleration of the target, which drive the feedforward terms. See
+   * IterativePosPIDController::setTargetVelocity(). Call this after setTarget().
+   *
+   * @param ivelocity the target's velocity in units of the sensor per second
+   * @param iacceleration the target's acceleration in units of the sensor per second squared
+   */
+  void setTargetVelocity(double ivelocity, double iacceleration = 0);
+
+  /**
+   * Sets a gain schedule, which replaces the gains on every step. Pass nullptr to stop using a
+   * gain schedule.
+   *
+   * @param igainSchedule The gain schedule.
+   */
+  void setGainSchedule(std::shared_ptr<PIDGainSchedule> igainSchedule);
+
   protected:
   std::shared_ptr<OffsetableControllerInput> offsettableInput;
   std::shared_ptr<IterativePosPIDController> internalController;
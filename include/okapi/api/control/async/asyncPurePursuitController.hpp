@@ -0,0 +1,426 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/chassis/controller/chassisScales.hpp"
+#include "okapi/api/chassis/model/chassisModel.hpp"
+#include "okapi/api/control/async/asyncPositionController.hpp"
+#include "okapi/api/control/util/pathSpatialIndex.hpp"
+#include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/device/motor/abstractMotor.hpp"
+#include "okapi/api/odometry/odometry.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <atomic>
+#include <map>
+
+namespace okapi {
+class AsyncPurePursuitController : public AsyncPositionController<std::string, PathfinderPoint> {
+  public:
+  /**
+   * An Async Controller which follows paths with pure pursuit. Each step, the robot finds the
+   * point on the path closest to it and a lookahead point further along the path, then drives
+   * along the arc which reaches the lookahead point. The lookahead distance grows with the speed of
+   * the robot, so it cuts fewer corners when it is slow and oscillates less when it is fast. Unlike
+   * `DefaultOdomChassisController::driveToPoint()`, which turns in place and then drives straight,
+   * the robot moves continuously along curves.
+   *
+   * The robot's pose is read from the odometry, which must be stepped by something else, such as
+   * an `OdomChassisController`. Paths are followed relative to the robot's pose when they start.
+   * Throws a `std::invalid_argument` exception if the gear ratio is zero, if there is no odometry,
+   * or if the lookahead distances are not positive or are out of order.
+   *
+   * @param itimeUtil The TimeUtil.
+   * @param ilimits The default limits. The max acceleration also limits the centripetal
+   * acceleration in turns.
+   * @param imodel The chassis model to control.
+   * @param iscales The chassis dimensions.
+   * @param ipair The gearset.
+   * @param iodometry The odometry to read the robot's pose from.
+   * @param iminLookahead The lookahead distance when the robot is slow.
+   * @param imaxLookahead The lookahead distance when the robot is fast.
+   * @param ilookaheadTime How far ahead to look at the robot's speed. The lookahead distance is
+   * this times the speed, bounded by the min and max lookahead distances.
+   * @param ilogger The logger this instance will log to.
+   */
+  AsyncPurePursuitController(const TimeUtil &itimeUtil,
+                             const PathfinderLimits &ilimits,
+                             const std::shared_ptr<ChassisModel> &imodel,
+                             const ChassisScales &iscales,
+                             const AbstractMotor::GearsetRatioPair &ipair,
+                             const std::shared_ptr<Odometry> &iodometry,
+                             QLength iminLookahead = 6_in,
+                             QLength imaxLookahead = 18_in,
+                             QTime ilookaheadTime = 0.4_s,
+                             const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  AsyncPurePursuitController(AsyncPurePursuitController &&other) = delete;
+
+  AsyncPurePursuitController &operator=(AsyncPurePursuitController &&other) = delete;
+
+  ~AsyncPurePursuitController() override;
+
+  /**
+   * One point of a path. Positions are relative to the start of the path, with positive x forward,
+   * positive y to the left, and positive heading counterclockwise.
+   */
+  struct PathPoint {
+    double x;         // m
+    double y;         // m
+    double heading;   // rad
+    double curvature; // 1/m, positive when turning counterclockwise
+    double velocity;  // The target velocity at this point in m/s
+  };
+
+  struct Pose {
+    double x;     // X coordinate in meters
+    double y;     // Y coordinate in meters, positive to the left
+    double theta; // Heading in radians, positive counterclockwise
+  };
+
+  /**
+   * Generates a dense path which intersects the given waypoints and saves it internally with a key
+   * of pathId. Call `setTarget()` with the same `pathId` to run it. The target velocity at each
+   * point is as fast as the robot can go there and still slow down in time for the turns after it
+   * and the end of the path.
+   *
+   * If the waypoints form a path which is impossible to achieve, an instance of
+   * `std::runtime_error` is thrown (and an error is logged) which describes the waypoints. If there
+   * are no waypoints, no path is generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   */
+  void generatePath(std::initializer_list<PathfinderPoint> iwaypoints, const std::string &ipathId);
+
+  /**
+   * Generates a dense path which intersects the given waypoints and saves it internally with a key
+   * of pathId. Call `setTarget()` with the same `pathId` to run it. The target velocity at each
+   * point is as fast as the robot can go there and still slow down in time for the turns after it
+   * and the end of the path.
+   *
+   * If the waypoints form a path which is impossible to achieve, an instance of
+   * `std::runtime_error` is thrown (and an error is logged) which describes the waypoints. If there
+   * are no waypoints, no path is generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier to save the path with.
+   * @param ilimits The limits to use for this path only.
+   */
+  void generatePath(std::initializer_list<PathfinderPoint> iwaypoints,
+                    const std::string &ipathId,
+                    const PathfinderLimits &ilimits);
+
+  /**
+   * Removes a path and frees the memory it used. This function returns `true` if the path was
+   * either deleted or didn't exist in the first place. It returns `false` if the path could not be
+   * removed because it is running.
+   *
+   * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
+   * @return `true` if the path no longer exists
+   */
+  bool removePath(const std::string &ipathId);
+
+  /**
+   * Gets the identifiers of all paths saved in this `AsyncPurePursuitController`.
+   *
+   * @return The identifiers of all paths
+   */
+  std::vector<std::string> getPaths();
+
+  /**
+   * Gets the points of a path.
+   *
+   * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
+   * @return The points of the path, or an empty vector if there is no path with that identifier.
+   */
+  std::vector<PathPoint> getPathPoints(const std::string &ipathId) const;
+
+  /**
+   * Executes a path with the given ID. If there is no path matching the ID, the method will
+   * return. Any targets set while a path is being followed will be ignored.
+   *
+   * @param ipathId A unique identifier for the path, previously passed to `generatePath()`.
+   */
+  void setTarget(std::string ipathId) override;
+
+  /**
+   * Writes the value of the controller output. This method might be automatically called in another
+   * thread by the controller.
+   *
+   * This just calls `setTarget()`.
+   */
+  void controllerSet(std::string ivalue) override;
+
+  /**
+   * Gets the last set target, or the default target if none was set.
+   *
+   * @return the last target
+   */
+  std::string getTarget() override;
+
+  /**
+   * Gets the last set target, or the default target if none was set.
+   *
+   * @return the last target
+   */
+  virtual std::string getTarget() const;
+
+  /**
+   * This is overridden to return the current path.
+   *
+   * @return The most recent value of the process variable.
+   */
+  std::string getProcessValue() const override;
+
+  /**
+   * Blocks the current task until the controller has settled. This controller is settled when
+   * it has reached the end of the path. If no path is being followed, it is settled.
+   */
+  void waitUntilSettled() override;
+
+  /**
+   * Generates a new path from the position (typically the current position) to the target and
+   * blocks until the controller has settled. Does not save the path which was generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   */
+  void moveTo(std::initializer_list<PathfinderPoint> iwaypoints);
+
+  /**
+   * Generates a new path from the position (typically the current position) to the target and
+   * blocks until the controller has settled. Does not save the path which was generated.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ilimits The limits to use for this path only.
+   */
+  void moveTo(std::initializer_list<PathfinderPoint> iwaypoints, const PathfinderLimits &ilimits);
+
+  /**
+   * Returns the displacement from the robot to the end of the path, in the frame of the path.
+   * Returns zero if there is no path currently being followed.
+   *
+   * @return the last error
+   */
+  PathfinderPoint getError() const override;
+
+  /**
+   * Returns whether the controller has settled at the target. Determining what settling means is
+   * implementation-dependent.
+   *
+   * If the controller is disabled, this method must return `true`.
+   *
+   * @return whether the controller is settled
+   */
+  bool isSettled() override;
+
+  /**
+   * Resets the controller's internal state so it is similar to when it was first initialized, while
+   * keeping any user-configured information. This implementation also stops movement.
+   */
+  void reset() override;
+
+  /**
+   * Changes whether the controller is off or on. Turning the controller on after it was off will
+   * NOT cause the controller to move to its last set target.
+   */
+  void flipDisable() override;
+
+  /**
+   * Sets whether the controller is off or on. Turning the controller on after it was off will
+   * NOT cause the controller to move to its last set target, unless it was reset in that time.
+   *
+   * @param iisDisabled whether the controller is disabled
+   */
+  void flipDisable(bool iisDisabled) override;
+
+  /**
+   * Returns whether the controller is currently disabled.
+   *
+   * @return whether the controller is currently disabled
+   */
+  bool isDisabled() const override;
+
+  /**
+   * This implementation does nothing because the API always requires the starting position to be
+   * specified.
+   */
+  void tarePosition() override;
+
+  /**
+   * This implementation does nothing because the maximum velocity is configured using
+   * PathfinderLimits elsewhere.
+   *
+   * @param imaxVelocity Ignored.
+   */
+  void setMaxVelocity(std::int32_t imaxVelocity) override;
+
+  /**
+   * Sets the generator used to generate the shape of paths. Paths which were already saved are not
+   * regenerated.
+   *
+   * @param igenerator The generator to use, or `nullptr` to use a default `TrajectoryGenerator`.
+   */
+  void setTrajectoryGenerator(const std::shared_ptr<const TrajectoryGenerator> &igenerator);
+
+  /**
+   * Sets how long the robot may go without moving further along the path before the path is given
+   * up on, such as when the robot is blocked. A warning is logged when this happens. The default
+   * is one second.
+   *
+   * @param itimeout The stall timeout.
+   */
+  void setStallTimeout(QTime itimeout);
+
+  /**
+   * @return The stall timeout.
+   */
+  QTime getStallTimeout() const;
+
+  /**
+   * Computes the lookahead distance for a speed.
+   *
+   * @param ivelocity The speed of the robot in m/s.
+   * @return The lookahead distance in meters.
+   */
+  double getLookahead(double ivelocity) const;
+
+  /**
+   * Computes the curvature of the arc from the robot to a point which the robot is tangent to.
+   *
+   * @param ipose The robot's pose.
+   * @param ix The x coordinate of the point.
+   * @param iy The y coordinate of the point.
+   * @return The curvature in 1/m, positive when turning counterclockwise.
+   */
+  static double arcCurvature(const Pose &ipose, double ix, double iy);
+
+  /**
+   * Starts the internal thread. This should not be called by normal users. This method is called
+   * by the AsyncControllerFactory when making a new instance of this class.
+   */
+  void startThread();
+
+  /**
+   * Returns the underlying thread handle.
+   *
+   * @return The underlying thread handle.
+   */
+  CrossplatformThread *getThread() const;
+
+  /**
+   * Attempts to remove a path without stopping execution, then if that fails, disables the
+   * controller and removes the path.
+   *
+   * @param ipathId The path ID that will be removed
+   */
+  void forceRemovePath(const std::string &ipathId);
+
+  protected:
+  struct Path {
+    std::vector<PathPoint> points;
+    PathSpatialIndex index;
+    double maxAccel; // The max acceleration the robot speeds up with, in m/s/s
+  };
+
+  // Paths are immutable once saved. They are shared so that a path which is being followed stays
+  // alive until it is finished.
+  using PathPtr = std::shared_ptr<const Path>;
+
+  // The distance between the points of a path, in meters
+  static constexpr double pointSpacing = 0.01;
+
+  // The period the path is followed at, in seconds
+  static constexpr double period = 0.01;
+
+  // How far along the path after the last closest point the next closest point is searched for,
+  // in max lookahead distances. This keeps the robot from skipping ahead where a path crosses
+  // itself.
+  static constexpr double searchWindow = 3;
+
+  std::shared_ptr<Logger> logger;
+  std::map<std::string, PathPtr> paths{};
+  PathfinderLimits limits;
+  std::shared_ptr<ChassisModel> model;
+  ChassisScales scales;
+  AbstractMotor::GearsetRatioPair pair;
+  TimeUtil timeUtil;
+  std::shared_ptr<Odometry> odometry;
+  double minLookahead;
+  double maxLookahead;
+  double lookaheadTime;
+  std::shared_ptr<const TrajectoryGenerator> trajectoryGenerator;
+
+  // This must be locked when accessing the paths, the current path, the error, or the stall timeout
+  mutable CrossplatformMutex currentPathMutex;
+
+  PathfinderPoint error{0_m, 0_m, 0_deg};
+  QTime stallTimeout{1_s};
+  std::string currentPath{""};
+  std::atomic_bool isRunning{false};
+  std::atomic_bool disabled{false};
+  std::atomic_bool dtorCalled{false};
+  CrossplatformThread *task{nullptr};
+
+  static void trampoline(void *context);
+  void loop();
+
+  /**
+   * Follow the supplied path. Must follow the disabled lifecycle.
+   */
+  virtual void executeSinglePath(const Path &path, std::unique_ptr<AbstractRate> rate);
+
+  /**
+   * Generates the points of a path.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ipathId A unique identifier for the path, used in error messages.
+   * @param ilimits The limits of the path.
+   * @return The points of the path.
+   */
+  std::vector<PathPoint> generatePoints(const std::vector<PathfinderPoint> &iwaypoints,
+                                        const std::string &ipathId,
+                                        const PathfinderLimits &ilimits) const;
+
+  /**
+   * Finds the lookahead point, which is where a circle around the robot leaves the path. The
+   * search starts from the previous lookahead point so that it never moves backwards.
+   *
+   * @param ipoints The points of the path.
+   * @param ipose The robot's pose.
+   * @param iclosest The index of the point closest to the robot.
+   * @param ilookahead The radius of the circle.
+   * @param ioprogress The position of the previous lookahead point along the path, as an index
+   * plus a fraction of the way to the next point. Set to the new lookahead point.
+   * @return The x and y coordinates of the lookahead point.
+   */
+  static std::pair<double, double> findLookahead(const std::vector<PathPoint> &ipoints,
+                                                 const Pose &ipose,
+                                                 std::size_t iclosest,
+                                                 double ilookahead,
+                                                 double &ioprogress);
+
+  /**
+   * Reads the robot's pose from the odometry in the frame paths are generated in. Odometry uses
+   * positive y to the right and clockwise heading, while paths use positive y to the left and
+   * counterclockwise heading.
+   *
+   * @return The robot's pose.
+   */
+  Pose getOdometryPose() const;
+
+  /**
+   * Converts linear "chassis" speed to rotational motor speed.
+   *
+   * @param linear "chassis" frame speed
+   * @return motor frame speed
+   */
+  QAngularSpeed convertLinearToRotational(QSpeed linear) const;
+};
+} // namespace okapi
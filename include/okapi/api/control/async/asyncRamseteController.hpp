@@ -0,0 +1,91 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/async/asyncMotionProfileController.hpp"
+#include "okapi/api/odometry/odometry.hpp"
+
+namespace okapi {
+class AsyncRamseteController : public AsyncMotionProfileController {
+  public:
+  /**
+   * An Async Controller which generates 2D motion profiles and follows them using a RAMSETE
+   * nonlinear feedback law. The robot's pose is read from the odometry and compared against the
+   * pose along the path, so that lateral and heading error are corrected as well as error along
+   * the path. The odometry must be stepped by something else, such as an `OdomChassisController`.
+   * Paths are followed relative to the robot's pose when they start. Paths must be stored with
+   * their pose (see `setTrajectoryStorage()`). Throws a `std::invalid_argument` exception if the
+   * gear ratio is zero or if `ib` or `izeta` are out of range.
+   *
+   * @param itimeUtil The TimeUtil.
+   * @param ilimits The default limits.
+   * @param imodel The chassis model to control.
+   * @param iscales The chassis dimensions.
+   * @param ipair The gearset.
+   * @param iodometry The odometry to read the robot's pose from.
+   * @param ib How aggressively to correct error, in rad^2/m^2. Must be greater than zero.
+   * @param izeta How damped the correction is. Must be in the range (0, 1).
+   * @param ilogger The logger this instance will log to.
+   */
+  AsyncRamseteController(const TimeUtil &itimeUtil,
+                         const PathfinderLimits &ilimits,
+                         const std::shared_ptr<ChassisModel> &imodel,
+                         const ChassisScales &iscales,
+                         const AbstractMotor::GearsetRatioPair &ipair,
+                         const std::shared_ptr<Odometry> &iodometry,
+                         double ib = 2.0,
+                         double izeta = 0.7,
+                         const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  AsyncRamseteController(AsyncRamseteController &&other) = delete;
+
+  AsyncRamseteController &operator=(AsyncRamseteController &&other) = delete;
+
+  ~AsyncRamseteController() override;
+
+  struct Pose {
+    double x;     // X coordinate in meters
+    double y;     // Y coordinate in meters, positive to the left
+    double theta; // Heading in radians, positive counterclockwise
+  };
+
+  struct ChassisSpeeds {
+    double linear;  // Linear velocity in m/s
+    double angular; // Angular velocity in rad/s, positive counterclockwise
+  };
+
+  /**
+   * Computes the RAMSETE control law.
+   *
+   * @param ipose The robot's pose.
+   * @param idesiredPose The pose along the path.
+   * @param idesiredSpeeds The chassis speeds along the path.
+   * @return The chassis speeds which drive the robot back onto the path.
+   */
+  ChassisSpeeds calculate(const Pose &ipose,
+                          const Pose &idesiredPose,
+                          const ChassisSpeeds &idesiredSpeeds) const;
+
+  protected:
+  std::shared_ptr<Odometry> odometry;
+  double b;
+  double zeta;
+
+  /**
+   * Follow the supplied path using the RAMSETE law. Must follow the disabled lifecycle.
+   */
+  void executeSinglePath(const TrajectoryPair &path, std::unique_ptr<AbstractRate> rate) override;
+
+  /**
+   * Reads the robot's pose from the odometry in the frame paths are generated in. Odometry uses
+   * positive y to the right and clockwise heading, while paths use positive y to the left and
+   * counterclockwise heading.
+   *
+   * @return The robot's pose.
+   */
+  Pose getOdometryPose() const;
+};
+} // namespace okapi
@@ -0,0 +1,214 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/iterative/iterativePositionController.hpp"
+#include "okapi/api/control/iterative/iterativeVelPidController.hpp"
+#include "okapi/api/util/logging.hpp"
+#include <memory>
+
+namespace okapi {
+/**
+ * A position controller made of two loops. The output of the outer position loop is the velocity
+ * target of the inner velocity loop, which is set in the same step as the outer loop runs. Both
+ * loops read the same position measurement; the inner loop calculates velocity from it with its
+ * VelMath.
+ *
+ * The inner loop may run faster than the outer loop. This controller should be stepped at the
+ * inner loop's sample time. Each loop steps on the first step at least its own sample time minus
+ * half of the inner loop's sample time after its last step, so the loops stay in phase even if the
+ * steps are slightly early or late. To do this, both loops are switched to measured-dt stepping
+ * (see IterativePosPIDController::setUseMeasuredDt()).
+ */
+class IterativeCascadedPIDController : public IterativePositionController<double, double> {
+  public:
+  /**
+   * A cascaded position-velocity controller. The sample time of the outer controller must be at
+   * least the sample time of the inner controller.
+   *
+   * @param iouterController The position controller. Its output in the range [-1, 1] is scaled to
+   * the inner controller's velocity target in the range [-imaxVelocity, imaxVelocity].
+   * @param iinnerController The velocity controller, which calculates this controller's output.
+   * @param imaxVelocity The maximum velocity target of the inner controller, in the units of the
+   * inner controller's VelMath.
+   * @param ilogger The logger this instance will log to.
+   */
+  IterativeCascadedPIDController(
+    const std::shared_ptr<IterativePosPIDController> &iouterController,
+    const std::shared_ptr<IterativeVelPIDController> &iinnerController,
+    double imaxVelocity,
+    std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Do one iteration of the controller. Steps the outer controller if it is due and then the inner
+   * controller. Returns the output of the inner controller.
+   *
+   * @param ireading new position measurement
+   * @return controller output
+   */
+  double step(double ireading) override;
+
+  /**
+   * Sets the target position for the controller.
+   *
+   * @param itarget new target position
+   */
+  void setTarget(double itarget) override;
+
+  /**
+   * Writes the value of the controller output. This method might be automatically called in another
+   * thread by the controller. The range of input values is expected to be [-1, 1].
+   *
+   * @param ivalue the controller's output in the range [-1, 1]
+   */
+  void controllerSet(double ivalue) override;
+
+  /**
+   * Gets the last set target, or the default target if none was set.
+   *
+   * @return the last target
+   */
+  double getTarget() override;
+
+  /**
+   * @return The most recent position measurement.
+   */
+  double getProcessValue() const override;
+
+  /**
+   * Returns the last calculated output of the controller, which is the output of the inner
+   * controller.
+   */
+  double getOutput() const override;
+
+  /**
+   * Get the upper output bound.
+   *
+   * @return  the upper output bound
+   */
+  double getMaxOutput() override;
+
+  /**
+   * Get the lower output bound.
+   *
+   * @return the lower output bound
+   */
+  double getMinOutput() override;
+
+  /**
+   * Returns the last position error of the controller. Does not update when disabled.
+   */
+  double getError() const override;
+
+  /**
+   * Returns whether the outer controller has settled at the target position.
+   *
+   * If the controller is disabled, this method must return true.
+   *
+   * @return whether the controller is settled
+   */
+  bool isSettled() override;
+
+  /**
+   * Sets the sample time of the inner controller, which is the time between steps of this
+   * controller. The sample time of the outer controller is changed to keep the same oversampling.
+   *
+   * @param isampleTime time between loops
+   */
+  void setSampleTime(QTime isampleTime) override;
+
+  /**
+   * Set controller output bounds. Default bounds are [-1, 1].
+   *
+   * @param imax max output
+   * @param imin min output
+   */
+  void setOutputLimits(double imax, double imin) override;
+
+  /**
+   * Sets the (soft) limits for the target range that controllerSet() scales into. The target
+   * computed by controllerSet() is scaled into the range [-itargetMin, itargetMax].
+   *
+   * @param itargetMax The new max target for controllerSet().
+   * @param itargetMin The new min target for controllerSet().
+   */
+  void setControllerSetTargetLimits(double itargetMax, double itargetMin) override;
+
+  /**
+   * Resets the internal state of both controllers so it is similar to when they were first
+   * initialized, while keeping any user-configured information.
+   */
+  void reset() override;
+
+  /**
+   * Changes whether the controller is off or on. Turning the controller on after it was off will
+   * cause the controller to move to its last set target, unless it was reset in that time.
+   */
+  void flipDisable() override;
+
+  /**
+   * Sets whether the controller is off or on. Turning the controller on after it was off will
+   * cause the controller to move to its last set target, unless it was reset in that time.
+   *
+   * @param iisDisabled whether the controller is disabled
+   */
+  void flipDisable(bool iisDisabled) override;
+
+  /**
+   * Returns whether the controller is currently disabled.
+   *
+   * @return whether the controller is currently disabled
+   */
+  bool isDisabled() const override;
+
+  /**
+   * Get the sample time of the inner controller, which is the time between steps of this
+   * controller.
+   *
+   * @return sample time
+   */
+  QTime getSampleTime() const override;
+
+  /**
+   * Sets the maximum velocity target of the inner controller.
+   *
+   * @param imaxVelocity The maximum velocity, in the units of the inner controller's VelMath.
+   */
+  void setMaxVelocity(double imaxVelocity);
+
+  /**
+   * @return The maximum velocity target of the inner controller.
+   */
+  double getMaxVelocity() const;
+
+  /**
+   * @return The number of inner controller steps per outer controller step.
+   */
+  double getOversampling() const;
+
+  /**
+   * @return The outer position controller.
+   */
+  std::shared_ptr<IterativePosPIDController> getOuterController() const;
+
+  /**
+   * @return The inner velocity controller.
+   */
+  std::shared_ptr<IterativeVelPIDController> getInnerController() const;
+
+  protected:
+  /**
+   * Lets each controller step on the step of this controller which is closest to its sample time.
+   */
+  void alignControllers();
+
+  std::shared_ptr<Logger> logger;
+  std::shared_ptr<IterativePosPIDController> outerController;
+  std::shared_ptr<IterativeVelPIDController> innerController;
+  double maxVelocity{0};
+};
+} // namespace okapi
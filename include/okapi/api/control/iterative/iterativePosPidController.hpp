@@ -9,6 +9,7 @@
 
 #include "okapi/api/control/iterative/iterativePositionController.hpp"
 #include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/control/util/stepTimingStats.hpp"
 #include "okapi/api/filter/filter.hpp"
 #include "okapi/api/filter/passthroughFilter.hpp"
 #include "okapi/api/util/logging.hpp"
@@ -17,6 +18,8 @@
 #include <memory>
 
 namespace okapi {
+class PIDGainSchedule;
+
 class IterativePosPIDController : public IterativePositionController<double, double> {
   public:
   struct Gains {
@@ -24,6 +27,9 @@ class IterativePosPIDController : public IterativePositionController<double, dou
     double kI{0};
     double kD{0};
     double kBias{0};
+    double kS{0}; // Output in the direction of the target's velocity, if it is moving
+    double kV{0}; // Output per unit/s of target velocity
+    double kA{0}; // Output per unit/s/s of target acceleration
 
     bool operator==(const Gains &rhs) const;
     bool operator!=(const Gains &rhs) const;
@@ -72,12 +78,23 @@ class IterativePosPIDController : public IterativePositionController<double, dou
   double step(double inewReading) override;
 
   /**
-   * Sets the target for the controller.
+   * Sets the target for the controller. This clears the target velocity and acceleration.
    *
    * @param itarget new target position
    */
   void setTarget(double itarget) override;
 
+  /**
+   * Sets the velocity and acceleration of the target, which drive the kV and kA feedforward terms
+   * and the direction of the kS term. Call this after setTarget() when following a trajectory. The
+   * kS term is not applied while the target velocity is zero.
+   *
+   * @param ivelocity the target's velocity in units of the process variable per second
+   * @param iacceleration the target's acceleration in units of the process variable per second
+   * squared
+   */
+  virtual void setTargetVelocity(double ivelocity, double iacceleration = 0);
+
   /**
    * Writes the value of the controller output. This method might be automatically called in another
    * thread by the controller. The range of input values is expected to be [-1, 1].
@@ -237,11 +254,73 @@ class IterativePosPIDController : public IterativePositionController<double, dou
    */
   Gains getGains() const;
 
+  /**
+   * Sets a gain schedule, which replaces the gains on every step. Pass nullptr to stop using a
+   * gain schedule, which keeps the gains from the last step.
+   *
+   * @param igainSchedule The gain schedule.
+   */
+  virtual void setGainSchedule(std::shared_ptr<PIDGainSchedule> igainSchedule);
+
+  /**
+   * @return The gain schedule, or nullptr if there is none.
+   */
+  std::shared_ptr<PIDGainSchedule> getGainSchedule() const;
+
+  /**
+   * Sets whether the integral and derivative terms use the measured time between steps instead of
+   * the sample time. When enabled, a step runs once the sample time minus the jitter tolerance has
+   * passed since the last step, so a loop which runs slightly faster than the sample time still
+   * steps every time. Disabled by default.
+   *
+   * @param iuseMeasuredDt whether to use the measured time between steps
+   */
+  virtual void setUseMeasuredDt(bool iuseMeasuredDt);
+
+  /**
+   * @return Whether the integral and derivative terms use the measured time between steps.
+   */
+  bool isUsingMeasuredDt() const;
+
+  /**
+   * Sets how far from the sample time a step may run before it counts as late, or, when using the
+   * measured time between steps, how early a step may run. Defaults to 1 ms.
+   *
+   * @param ijitterTolerance the jitter tolerance, which must be in the range [0, sampleTime)
+   */
+  virtual void setJitterTolerance(QTime ijitterTolerance);
+
+  /**
+   * @return The jitter tolerance.
+   */
+  QTime getJitterTolerance() const;
+
+  /**
+   * @return Statistics on the timing of this controller's steps.
+   */
+  StepTimingStats getStepTimingStats() const;
+
+  /**
+   * Clears the statistics on the timing of this controller's steps.
+   */
+  void resetStepTimingStats();
+
   protected:
+  /**
+   * Returns whether enough time has passed to run a step.
+   *
+   * @param istepDt the time since the last step
+   * @return whether to run a step
+   */
+  bool shouldStep(QTime istepDt) const;
+
   std::shared_ptr<Logger> logger;
-  double kP, kI, kD, kBias;
+  double kP, kI, kD, kBias, kS, kV, kA;
   QTime sampleTime{10_ms};
   double target{0};
+  double targetVelocity{0};
+  double targetAcceleration{0};
+  std::shared_ptr<PIDGainSchedule> gainSchedule;
   double lastReading{0};
   double error{0};
   double lastError{0};
@@ -270,6 +349,13 @@ class IterativePosPIDController : public IterativePositionController<double, dou
 
   bool controllerIsDisabled{false};
 
+  // Whether to scale the integral and derivative by the measured time between steps
+  bool useMeasuredDt{false};
+  QTime jitterTolerance{1_ms};
+  // Whether loopDtTimer's mark holds the time of the last step
+  bool stepMarkPlaced{false};
+  StepTimingStats stepTimingStats;
+
   std::unique_ptr<AbstractTimer> loopDtTimer;
   std::unique_ptr<SettledUtil> settledUtil;
 };
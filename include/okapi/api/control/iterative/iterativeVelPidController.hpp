@@ -7,6 +7,7 @@
 
 #include "okapi/api/control/iterative/iterativeVelocityController.hpp"
 #include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/control/util/stepTimingStats.hpp"
 #include "okapi/api/filter/passthroughFilter.hpp"
 #include "okapi/api/filter/velMath.hpp"
 #include "okapi/api/util/logging.hpp"
@@ -220,6 +221,44 @@ class IterativeVelPIDController : public IterativeVelocityController<double, dou
    */
   Gains getGains() const;
 
+  /**
+   * Sets whether the change in output of each step is scaled by the measured time between steps
+   * instead of the sample time. When enabled, a step runs once the sample time minus the jitter
+   * tolerance has passed since the last step, so a loop which runs slightly faster than the sample
+   * time still steps every time. Disabled by default.
+   *
+   * @param iuseMeasuredDt whether to use the measured time between steps
+   */
+  virtual void setUseMeasuredDt(bool iuseMeasuredDt);
+
+  /**
+   * @return Whether the change in output is scaled by the measured time between steps.
+   */
+  bool isUsingMeasuredDt() const;
+
+  /**
+   * Sets how far from the sample time a step may run before it counts as late, or, when using the
+   * measured time between steps, how early a step may run. Defaults to 1 ms.
+   *
+   * @param ijitterTolerance the jitter tolerance, which must be in the range [0, sampleTime)
+   */
+  virtual void setJitterTolerance(QTime ijitterTolerance);
+
+  /**
+   * @return The jitter tolerance.
+   */
+  QTime getJitterTolerance() const;
+
+  /**
+   * @return Statistics on the timing of this controller's steps.
+   */
+  StepTimingStats getStepTimingStats() const;
+
+  /**
+   * Clears the statistics on the timing of this controller's steps.
+   */
+  void resetStepTimingStats();
+
   /**
    * Sets the number of encoder ticks per revolution. Default is 1800.
    *
@@ -233,6 +272,14 @@ class IterativeVelPIDController : public IterativeVelocityController<double, dou
   virtual QAngularSpeed getVel() const;
 
   protected:
+  /**
+   * Returns whether enough time has passed to run a step.
+   *
+   * @param istepDt the time since the last step
+   * @return whether to run a step
+   */
+  bool shouldStep(QTime istepDt) const;
+
   std::shared_ptr<Logger> logger;
   double kP, kD, kF, kSF;
   QTime sampleTime{10_ms};
@@ -246,6 +293,10 @@ class IterativeVelPIDController : public IterativeVelocityController<double, dou
   double controllerSetTargetMax{1};
   double controllerSetTargetMin{-1};
   bool controllerIsDisabled{false};
+  bool useMeasuredDt{false};
+  QTime jitterTolerance{1_ms};
+  bool stepMarkPlaced{false};
+  StepTimingStats stepTimingStats;
 
   std::unique_ptr<VelMath> velMath;
   std::unique_ptr<Filter> derivativeFilter;
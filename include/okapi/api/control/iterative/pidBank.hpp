@@ -0,0 +1,253 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/abstractTimer.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace okapi {
+/**
+ * A bank of position PID controllers which are stepped together. The gains and state of every
+ * controller are stored in contiguous arrays, so one call to step() updates every controller in a
+ * single pass over those arrays using one timestamp.
+ *
+ * Each controller behaves like an IterativePosPIDController with a PassthroughFilter on its
+ * derivative term. All controllers share one sample time, and settling is checked against the
+ * timestamp of the last step instead of the time isSettled() is called. Feedforward gains (kS, kV,
+ * and kA) and gain schedules are not supported; those gains are ignored.
+ *
+ * Controllers are addressed by their index in the gains given to the constructor. Indices are not
+ * bounds checked.
+ */
+class PIDBank {
+  public:
+  /**
+   * A bank of position PID controllers.
+   *
+   * @param igains the gains of each controller
+   * @param itimeUtil see TimeUtil docs
+   * @param ilogger The logger this instance will log to.
+   */
+  PIDBank(const std::vector<IterativePosPIDController::Gains> &igains,
+          const TimeUtil &itimeUtil,
+          std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger());
+
+  /**
+   * Do one iteration of every controller. The readings are given in the same order as the
+   * controllers. Disabled controllers output 0.
+   *
+   * @param ireadings the new measurement of each controller
+   * @return the output of each controller
+   */
+  const std::vector<double> &step(const std::vector<double> &ireadings);
+
+  /**
+   * @return The number of controllers in this bank.
+   */
+  std::size_t size() const;
+
+  /**
+   * Sets the target for a controller.
+   *
+   * @param iindex the controller index
+   * @param itarget new target position
+   */
+  void setTarget(std::size_t iindex, double itarget);
+
+  /**
+   * Gets the last set target of a controller, or the default target if none was set.
+   *
+   * @param iindex the controller index
+   * @return the last target
+   */
+  double getTarget(std::size_t iindex) const;
+
+  /**
+   * @param iindex the controller index
+   * @return The most recent value of the process variable of a controller.
+   */
+  double getProcessValue(std::size_t iindex) const;
+
+  /**
+   * Returns the last calculated output of a controller, or 0 if it is disabled.
+   *
+   * @param iindex the controller index
+   * @return the last output
+   */
+  double getOutput(std::size_t iindex) const;
+
+  /**
+   * Returns the last error of a controller.
+   *
+   * @param iindex the controller index
+   * @return the last error
+   */
+  double getError(std::size_t iindex) const;
+
+  /**
+   * Returns whether a controller settled during the last step. A disabled controller is always
+   * settled.
+   *
+   * @param iindex the controller index
+   * @return whether the controller is settled
+   */
+  bool isSettled(std::size_t iindex) const;
+
+  /**
+   * @return Whether every controller is settled.
+   */
+  bool isSettled() const;
+
+  /**
+   * Sets the conditions a controller uses to determine whether it has settled. See SettledUtil
+   * for their meaning.
+   *
+   * @param iindex the controller index
+   * @param iatTargetError The minimum error to be considered settled.
+   * @param iatTargetDerivative The minimum error derivative to be considered settled.
+   * @param iatTargetTime The minimum time within atTargetError to be considered settled.
+   */
+  void setSettleConditions(std::size_t iindex,
+                           double iatTargetError = 50,
+                           double iatTargetDerivative = 5,
+                           QTime iatTargetTime = 250_ms);
+
+  /**
+   * Set time between loops for every controller.
+   *
+   * @param isampleTime time between loops
+   */
+  void setSampleTime(QTime isampleTime);
+
+  /**
+   * @return The sample time of every controller.
+   */
+  QTime getSampleTime() const;
+
+  /**
+   * Set a controller's output bounds. Default bounds are [-1, 1].
+   *
+   * @param iindex the controller index
+   * @param imax max output
+   * @param imin min output
+   */
+  void setOutputLimits(std::size_t iindex, double imax, double imin);
+
+  /**
+   * Set a controller's integrator bounds. Default bounds are [-1, 1].
+   *
+   * @param iindex the controller index
+   * @param imax max integrator value
+   * @param imin min integrator value
+   */
+  void setIntegralLimits(std::size_t iindex, double imax, double imin);
+
+  /**
+   * Set a controller's error sum bounds. Default bounds are [0,
+   * std::numeric_limits<double>::max()]. See IterativePosPIDController::setErrorSumLimits().
+   *
+   * @param iindex the controller index
+   * @param imax max error value that will be summed
+   * @param imin min error value that will be summed
+   */
+  void setErrorSumLimits(std::size_t iindex, double imax, double imin);
+
+  /**
+   * Set whether a controller's integrator should be reset when error is 0 or changes sign.
+   *
+   * @param iindex the controller index
+   * @param iresetOnZero true to reset
+   */
+  void setIntegratorReset(std::size_t iindex, bool iresetOnZero);
+
+  /**
+   * Set a controller's gains.
+   *
+   * @param iindex the controller index
+   * @param igains The new gains.
+   */
+  void setGains(std::size_t iindex, const IterativePosPIDController::Gains &igains);
+
+  /**
+   * Gets a controller's current gains.
+   *
+   * @param iindex the controller index
+   * @return The current gains.
+   */
+  IterativePosPIDController::Gains getGains(std::size_t iindex) const;
+
+  /**
+   * Resets a controller's internal state so it is similar to when it was first initialized, while
+   * keeping any user-configured information.
+   *
+   * @param iindex the controller index
+   */
+  void reset(std::size_t iindex);
+
+  /**
+   * Sets whether a controller is off or on. Turning the controller on after it was off will cause
+   * the controller to move to its last set target, unless it was reset in that time.
+   *
+   * @param iindex the controller index
+   * @param iisDisabled whether the controller is disabled
+   */
+  void flipDisable(std::size_t iindex, bool iisDisabled);
+
+  /**
+   * Returns whether a controller is currently disabled.
+   *
+   * @param iindex the controller index
+   * @return whether the controller is currently disabled
+   */
+  bool isDisabled(std::size_t iindex) const;
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  QTime sampleTime{10_ms};
+  std::unique_ptr<AbstractTimer> loopDtTimer;
+
+  // Gains
+  std::vector<double> kP;
+  std::vector<double> kI;
+  std::vector<double> kD;
+  std::vector<double> kBias;
+
+  // State
+  std::vector<double> target;
+  std::vector<double> lastReading;
+  std::vector<double> error;
+  std::vector<double> lastError;
+  std::vector<double> integral;
+  std::vector<double> output;
+
+  // Limits
+  std::vector<double> integralMax;
+  std::vector<double> integralMin;
+  std::vector<double> errorSumMin;
+  std::vector<double> errorSumMax;
+  std::vector<double> outputMax;
+  std::vector<double> outputMin;
+  std::vector<std::uint8_t> shouldResetOnCross;
+  std::vector<std::uint8_t> controllerIsDisabled;
+
+  // Settling, with times in ms. atTargetSince is NaN while a controller is not at its target.
+  std::vector<double> atTargetError;
+  std::vector<double> atTargetDerivative;
+  std::vector<double> atTargetTime;
+  std::vector<double> atTargetSince;
+  std::vector<double> settledLastError;
+  std::vector<std::uint8_t> settled;
+
+  // The outputs returned by step(), which are 0 for disabled controllers
+  std::vector<double> stepOutput;
+};
+} // namespace okapi
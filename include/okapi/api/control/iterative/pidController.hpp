@@ -0,0 +1,456 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/iterative/iterativePositionController.hpp"
+#include "okapi/api/control/util/settledUtil.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/abstractTimer.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace okapi {
+/**
+ * The optional features of a PIDController.
+ */
+struct PIDFeature {
+  /**
+   * Only sum error within the bounds set with PIDController::setErrorSumLimits(). Without this
+   * feature, every error is summed.
+   */
+  struct ErrorSumLimits {};
+
+  /**
+   * Reset the integral when the error changes sign.
+   */
+  struct ResetOnCross {};
+
+  /**
+   * A derivative filter which returns the derivative unchanged, like PassthroughFilter.
+   */
+  struct UnfilteredDerivative {
+    template <typename T> T filter(const T ireading) {
+      return ireading;
+    }
+  };
+};
+
+/**
+ * A position PID controller whose features are chosen at compile time. With every feature and
+ * the same derivative filter, it computes the same outputs as IterativePosPIDController. Features
+ * which are not used cost nothing, and because nothing is virtual, step() can be inlined into the
+ * calling loop. Feedforward gains (kS, kV, and kA) are ignored.
+ *
+ * This controller does not track time; every call to step() is one sample, so it should be called
+ * once per sample time. Use IterativePIDWrapper to use it as an IterativePositionController.
+ *
+ * @tparam T The numeric type, which must be constructible from double and support the arithmetic
+ * and comparison operators. ErrorSumLimits also needs std::numeric_limits<T>.
+ * @tparam DerivativeFilter A type with a filter(T) method, which is called directly. Any of the
+ * filters in okapi/api/filter can be used with double.
+ * @tparam Features Any of the types in PIDFeature.
+ */
+template <typename T = double,
+          typename DerivativeFilter = PIDFeature::UnfilteredDerivative,
+          typename... Features>
+class PIDController {
+  public:
+  using value_type = T;
+
+  static constexpr bool hasErrorSumLimits =
+    (std::is_same_v<Features, PIDFeature::ErrorSumLimits> || ...);
+  static constexpr bool hasResetOnCross =
+    (std::is_same_v<Features, PIDFeature::ResetOnCross> || ...);
+
+  /**
+   * Position PID controller.
+   *
+   * @param igains the controller gains
+   * @param isampleTime the time between calls to step(), which scales kI and kD
+   * @param iderivativeFilter a filter for filtering the derivative term
+   */
+  explicit PIDController(const IterativePosPIDController::Gains &igains,
+                         const QTime isampleTime = 10_ms,
+                         DerivativeFilter iderivativeFilter = DerivativeFilter())
+    : sampleTime(isampleTime), derivativeFilter(std::move(iderivativeFilter)) {
+    if (igains.kI != 0) {
+      setIntegralLimits(T(1 / igains.kI), T(-1 / igains.kI));
+    }
+    setGains(igains);
+  }
+
+  /**
+   * Do one iteration of the controller. Returns the reading in the range [-1, 1] unless the
+   * bounds have been changed with setOutputLimits().
+   *
+   * @param inewReading new measurement
+   * @return controller output
+   */
+  T step(const T inewReading) {
+    const T readingDiff = inewReading - lastReading;
+    lastReading = inewReading;
+    const T error = target - lastReading;
+
+    if constexpr (hasErrorSumLimits) {
+      const T absError = error < T(0) ? -error : error;
+      if ((absError < target - errorSumMin && absError > target - errorSumMax) ||
+          (absError > target + errorSumMin && absError < target + errorSumMax)) {
+        integral = integral + kI * error;
+      }
+    } else {
+      integral = integral + kI * error;
+    }
+
+    if constexpr (hasResetOnCross) {
+      if (isNegative(error) != isNegative(lastError)) {
+        integral = T(0);
+      }
+    }
+
+    integral = std::clamp(integral, integralMin, integralMax);
+
+    // Derivative over measurement to eliminate derivative kick on setpoint change
+    const T derivative = derivativeFilter.filter(readingDiff);
+
+    output = std::clamp(kP * error + integral - kD * derivative + kBias, outputMin, outputMax);
+    lastError = error;
+
+    return output;
+  }
+
+  /**
+   * Sets the target for the controller.
+   *
+   * @param itarget new target position
+   */
+  void setTarget(const T itarget) {
+    target = itarget;
+  }
+
+  /**
+   * @return the last set target
+   */
+  T getTarget() const {
+    return target;
+  }
+
+  /**
+   * @return The most recent value of the process variable.
+   */
+  T getProcessValue() const {
+    return lastReading;
+  }
+
+  /**
+   * @return The last calculated output of the controller.
+   */
+  T getOutput() const {
+    return output;
+  }
+
+  /**
+   * @return The difference between the target and the most recent value of the process variable.
+   */
+  T getError() const {
+    return target - lastReading;
+  }
+
+  /**
+   * Set controller output bounds. Default bounds are [-1, 1].
+   *
+   * @param imax max output
+   * @param imin min output
+   */
+  void setOutputLimits(T imax, T imin) {
+    // Always use larger value as max
+    if (imin > imax) {
+      std::swap(imax, imin);
+    }
+
+    outputMax = imax;
+    outputMin = imin;
+    output = std::clamp(output, outputMin, outputMax);
+  }
+
+  /**
+   * @return The upper output bound.
+   */
+  T getMaxOutput() const {
+    return outputMax;
+  }
+
+  /**
+   * @return The lower output bound.
+   */
+  T getMinOutput() const {
+    return outputMin;
+  }
+
+  /**
+   * Set integrator bounds. Default bounds are [-1, 1].
+   *
+   * @param imax max integrator value
+   * @param imin min integrator value
+   */
+  void setIntegralLimits(T imax, T imin) {
+    // Always use larger value as max
+    if (imin > imax) {
+      std::swap(imax, imin);
+    }
+
+    integralMax = imax;
+    integralMin = imin;
+    integral = std::clamp(integral, integralMin, integralMax);
+  }
+
+  /**
+   * Set the error sum bounds. See IterativePosPIDController::setErrorSumLimits(). Only available
+   * with PIDFeature::ErrorSumLimits.
+   *
+   * @param imax max error value that will be summed
+   * @param imin min error value that will be summed
+   */
+  void setErrorSumLimits(const T imax, const T imin) {
+    static_assert(hasErrorSumLimits, "PIDController: ErrorSumLimits is not enabled.");
+    errorSumMax = imax;
+    errorSumMin = imin;
+  }
+
+  /**
+   * Set controller gains.
+   *
+   * @param igains The new gains.
+   */
+  void setGains(const IterativePosPIDController::Gains &igains) {
+    const double sampleTimeSec = sampleTime.convert(second);
+    kP = T(igains.kP);
+    kI = T(igains.kI * sampleTimeSec);
+    kD = T(igains.kD / sampleTimeSec);
+    kBias = T(igains.kBias);
+  }
+
+  /**
+   * @return The current gains.
+   */
+  IterativePosPIDController::Gains getGains() const {
+    const double sampleTimeSec = sampleTime.convert(second);
+    return {static_cast<double>(kP),
+            static_cast<double>(kI) / sampleTimeSec,
+            static_cast<double>(kD) * sampleTimeSec,
+            static_cast<double>(kBias)};
+  }
+
+  /**
+   * Set the time between calls to step(), keeping the same gains.
+   *
+   * @param isampleTime time between loops
+   */
+  void setSampleTime(const QTime isampleTime) {
+    if (isampleTime > 0_ms) {
+      const auto gains = getGains();
+      sampleTime = isampleTime;
+      setGains(gains);
+    }
+  }
+
+  /**
+   * @return The time between calls to step().
+   */
+  QTime getSampleTime() const {
+    return sampleTime;
+  }
+
+  /**
+   * Resets the controller's internal state so it is similar to when it was first initialized,
+   * while keeping any user-configured information.
+   */
+  void reset() {
+    lastError = T(0);
+    lastReading = T(0);
+    integral = T(0);
+    output = T(0);
+  }
+
+  protected:
+  /**
+   * Checks the sign bit of floating point values, so -0 is negative like with std::copysign.
+   */
+  static bool isNegative(const T ivalue) {
+    if constexpr (std::is_floating_point_v<T>) {
+      return std::signbit(ivalue);
+    } else {
+      return ivalue < T(0);
+    }
+  }
+
+  QTime sampleTime;
+  DerivativeFilter derivativeFilter;
+  T kP{0}, kI{0}, kD{0}, kBias{0};
+  T target{0};
+  T lastReading{0};
+  T lastError{0};
+  T integral{0};
+  T integralMax{1};
+  T integralMin{-1};
+  T errorSumMin{0};
+  T errorSumMax{std::numeric_limits<T>::max()};
+  T output{0};
+  T outputMax{1};
+  T outputMin{-1};
+};
+
+/**
+ * Wraps a PIDController as an IterativePositionController, which adds the sample time, settling,
+ * disabling, and controllerSet() behavior of IterativePosPIDController.
+ *
+ * @tparam Controller The PIDController type.
+ */
+template <typename Controller>
+class IterativePIDWrapper : public IterativePositionController<double, double> {
+  public:
+  using value_type = typename Controller::value_type;
+
+  /**
+   * Wraps a PIDController.
+   *
+   * @param icontroller the controller
+   * @param itimeUtil see TimeUtil docs
+   * @param ilogger The logger this instance will log to.
+   */
+  IterativePIDWrapper(Controller icontroller,
+                      const TimeUtil &itimeUtil,
+                      std::shared_ptr<Logger> ilogger = Logger::getDefaultLogger())
+    : logger(std::move(ilogger)),
+      controller(std::move(icontroller)),
+      loopDtTimer(itimeUtil.getTimer()),
+      settledUtil(itimeUtil.getSettledUtil()) {
+  }
+
+  double step(const double inewReading) override {
+    if (controllerIsDisabled) {
+      return 0;
+    }
+
+    loopDtTimer->placeHardMark();
+
+    if (loopDtTimer->getDtFromHardMark() >= controller.getSampleTime()) {
+      controller.step(value_type(inewReading));
+      error = static_cast<double>(controller.getError());
+      loopDtTimer->clearHardMark(); // Important that we only clear if dt >= sampleTime
+
+      settledUtil->isSettled(error);
+    }
+
+    return static_cast<double>(controller.getOutput());
+  }
+
+  void setTarget(const double itarget) override {
+    LOG_INFO("IterativePIDWrapper: Set target to " + std::to_string(itarget));
+    controller.setTarget(value_type(itarget));
+  }
+
+  void controllerSet(const double ivalue) override {
+    controller.setTarget(
+      value_type(remapRange(ivalue, -1, 1, controllerSetTargetMin, controllerSetTargetMax)));
+  }
+
+  double getTarget() override {
+    return static_cast<double>(controller.getTarget());
+  }
+
+  double getProcessValue() const override {
+    return static_cast<double>(controller.getProcessValue());
+  }
+
+  double getOutput() const override {
+    return isDisabled() ? 0 : static_cast<double>(controller.getOutput());
+  }
+
+  double getMaxOutput() override {
+    return static_cast<double>(controller.getMaxOutput());
+  }
+
+  double getMinOutput() override {
+    return static_cast<double>(controller.getMinOutput());
+  }
+
+  double getError() const override {
+    return static_cast<double>(controller.getError());
+  }
+
+  bool isSettled() override {
+    return isDisabled() ? true : settledUtil->isSettled(error);
+  }
+
+  void setSampleTime(const QTime isampleTime) override {
+    controller.setSampleTime(isampleTime);
+  }
+
+  QTime getSampleTime() const override {
+    return controller.getSampleTime();
+  }
+
+  void setOutputLimits(const double imax, const double imin) override {
+    controller.setOutputLimits(value_type(imax), value_type(imin));
+  }
+
+  void setControllerSetTargetLimits(double itargetMax, double itargetMin) override {
+    // Always use larger value as max
+    if (itargetMin > itargetMax) {
+      std::swap(itargetMax, itargetMin);
+    }
+
+    controllerSetTargetMax = itargetMax;
+    controllerSetTargetMin = itargetMin;
+  }
+
+  void reset() override {
+    LOG_INFO_S("IterativePIDWrapper: Reset");
+    error = 0;
+    controller.reset();
+    settledUtil->reset();
+  }
+
+  void flipDisable() override {
+    flipDisable(!controllerIsDisabled);
+  }
+
+  void flipDisable(const bool iisDisabled) override {
+    LOG_INFO("IterativePIDWrapper: flipDisable " + std::to_string(iisDisabled));
+    controllerIsDisabled = iisDisabled;
+  }
+
+  bool isDisabled() const override {
+    return controllerIsDisabled;
+  }
+
+  /**
+   * @return The wrapped controller, for features which are not part of the
+   * IterativePositionController interface.
+   */
+  Controller &getController() {
+    return controller;
+  }
+
+  protected:
+  std::shared_ptr<Logger> logger;
+  Controller controller;
+  std::unique_ptr<AbstractTimer> loopDtTimer;
+  std::unique_ptr<SettledUtil> settledUtil;
+  double error{0};
+  double controllerSetTargetMax{1};
+  double controllerSetTargetMin{-1};
+  bool controllerIsDisabled{false};
+};
+} // namespace okapi
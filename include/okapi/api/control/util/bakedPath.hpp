@@ -0,0 +1,42 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace okapi {
+/**
+ * The types in this file describe paths which were generated ahead of time by the
+ * `bakeTrajectories` tool and compiled into the program as constant data. They only hold pointers
+ * to that data, so they can be constructed in a `constexpr` context.
+ */
+struct BakedMotorCommand {
+  float left;  // Left side speed as a fraction of the gearset's max speed
+  float right; // Right side speed as a fraction of the gearset's max speed
+  float dt;    // Duration of the segment in seconds
+};
+
+struct BakedTrajectorySide {
+  const float *position; // m
+  const float *velocity; // m/s
+  const float *x;        // m
+  const float *y;        // m
+  const float *heading;  // rad
+};
+
+struct BakedPath {
+  const char *pathId;
+  std::int32_t length;
+  double dt;            // Duration of every segment in seconds
+  double wheelDiameter; // m, of the chassis the path was baked for
+  double wheelTrack;    // m, of the chassis the path was baked for
+  double gearsetRpm;    // Max speed of the gearset the commands were baked for
+  double gearRatio;     // Ratio of the gearset the commands were baked for
+  BakedTrajectorySide left;
+  BakedTrajectorySide right;
+  const BakedMotorCommand *commands;
+};
+} // namespace okapi
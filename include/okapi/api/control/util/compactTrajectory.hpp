@@ -0,0 +1,156 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/bakedPath.hpp"
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include "okapi/pathfinder/include/pathfinder.h"
+}
+
+namespace okapi {
+class CompactTrajectory {
+  public:
+  enum class Precision {
+    float64, ///< Store each value as a double. Lossless.
+    float32, ///< Store each value as a float.
+    fixed16  ///< Store each value as a 16-bit integer scaled by the largest value in its column.
+  };
+
+  CompactTrajectory() = default;
+
+  /**
+   * A trajectory stored as a structure of arrays. Only the columns needed to follow the trajectory
+   * (velocity and position) and, optionally, the pose columns (x, y, and heading) are kept. The
+   * segment duration is stored once if it is the same for every segment. Acceleration and jerk are
+   * only stored at `float64` so that precision stays lossless; otherwise they are recovered by
+   * differentiating the velocity when a full `Segment` is requested.
+   *
+   * @param isegments The segments to compact.
+   * @param ilength The number of segments.
+   * @param iprecision The precision to store each column with.
+   * @param iretainPose Whether to keep the x, y, and heading columns.
+   */
+  CompactTrajectory(const Segment *isegments,
+                    int ilength,
+                    Precision iprecision = Precision::float32,
+                    bool iretainPose = true);
+
+  /**
+   * A trajectory which reads its columns from one side of a baked path instead of copying them, so
+   * it does not allocate. The columns are stored as floats with the pose kept. The baked data must
+   * outlive the trajectory, which is the case for data compiled into the program.
+   *
+   * @param iside The columns of the side.
+   * @param ilength The number of segments.
+   * @param idt The duration of every segment.
+   */
+  CompactTrajectory(const BakedTrajectorySide &iside, int ilength, double idt);
+
+  /**
+   * @return The number of segments.
+   */
+  int getLength() const;
+
+  /**
+   * @return The precision the columns are stored with.
+   */
+  Precision getPrecision() const;
+
+  /**
+   * @return Whether the x, y, and heading columns were kept.
+   */
+  bool hasPose() const;
+
+  /**
+   * @return Whether every segment has the same duration.
+   */
+  bool hasConstantDt() const;
+
+  /**
+   * @param i The index of the segment.
+   * @return The duration of the segment in seconds.
+   */
+  double getDt(int i) const;
+
+  /**
+   * @param i The index of the segment.
+   * @return The velocity of the segment in m/s.
+   */
+  double getVelocity(int i) const;
+
+  /**
+   * @param i The index of the segment.
+   * @return The position of the segment in meters.
+   */
+  double getPosition(int i) const;
+
+  /**
+   * Recovers a full segment. The x, y, and heading are zero if the pose columns were not kept.
+   *
+   * @param i The index of the segment.
+   * @return The segment.
+   */
+  Segment getSegment(int i) const;
+
+  /**
+   * Recovers every segment. This is intended for debugging and for serialization.
+   *
+   * @return The segments.
+   */
+  std::vector<Segment> getSegments() const;
+
+  /**
+   * @return The number of bytes used by the stored columns. Baked columns are not counted.
+   */
+  std::size_t getMemoryUsage() const;
+
+  protected:
+  class Column {
+    public:
+    Column() = default;
+
+    /**
+     * @param ivalues The values to store.
+     * @param iprecision The precision to store the values with.
+     */
+    Column(const std::vector<double> &ivalues, Precision iprecision);
+
+    /**
+     * @param iview The floats to read the values from. They are not copied.
+     */
+    explicit Column(const float *iview);
+
+    double operator[](int i) const;
+
+    std::size_t getMemoryUsage() const;
+
+    protected:
+    Precision precision{Precision::float64};
+    double scale{1};
+    std::vector<double> doubles{};
+    std::vector<float> floats{};
+    std::vector<std::int16_t> fixed{};
+    const float *view{nullptr}; // Read instead of floats if set
+  };
+
+  int length{0};
+  Precision precision{Precision::float64};
+  bool pose{false};
+  bool constantDt{true};
+  double dt{0};
+  Column dts{};
+  Column velocities{};
+  Column positions{};
+  Column xs{};
+  Column ys{};
+  Column headings{};
+  Column accelerations{}; // Only stored at float64
+  Column jerks{};         // Only stored at float64
+};
+} // namespace okapi
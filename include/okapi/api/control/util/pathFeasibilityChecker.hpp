@@ -0,0 +1,96 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include <string>
+#include <vector>
+
+namespace okapi {
+class PathFeasibilityChecker {
+  public:
+  enum class Problem {
+    tooFewWaypoints,        ///< A path needs at least two waypoints.
+    invalidLimits,          ///< A limit is not positive.
+    waypointsTooClose,      ///< Two waypoints in a row are in the same place.
+    headingDiscontinuity,   ///< A waypoint faces away from the waypoint next to it.
+    curvatureTooHigh,       ///< The inner wheel would have to stop or drive backwards.
+    centripetalAccelTooHigh ///< Turning at the max velocity takes more than the max acceleration.
+  };
+
+  enum class Severity {
+    warning, ///< The path can be generated but might not be followed well.
+    error    ///< The path can't be generated.
+  };
+
+  struct Diagnostic {
+    Problem problem;
+    Severity severity;
+    std::size_t waypoint; // The index of the waypoint the problem is at or starts at
+    double value;         // The measured value, in SI units
+    double limit;         // The bound the value broke, in SI units
+  };
+
+  /**
+   * Checks whether a path can be generated with pathfinder before fitting it. The checks are
+   * closed-form and allocate nothing unless there is a problem, so many candidate paths can be
+   * checked quickly. Each span between two waypoints is checked the way pathfinder fits it, as a
+   * cubic Hermite spline whose ends are tangent to the headings of the waypoints.
+   *
+   * @param iwheelTrack The distance between the left and right wheels. A path is warned about if
+   * its inner wheel would have to drive backwards, which pathfinder's tank modifier can't do. Zero
+   * disables that check.
+   */
+  explicit PathFeasibilityChecker(QLength iwheelTrack = 0_m);
+
+  /**
+   * Checks a path.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ilimits The limits of the trajectory.
+   * @return Every problem with the path, in the order of the waypoints. Empty if there are none.
+   */
+  std::vector<Diagnostic> check(const std::vector<PathfinderPoint> &iwaypoints,
+                                const PathfinderLimits &ilimits) const;
+
+  /**
+   * @param idiagnostics The diagnostics from `check()`.
+   * @return Whether none of the diagnostics are errors.
+   */
+  static bool isFeasible(const std::vector<Diagnostic> &idiagnostics);
+
+  /**
+   * @param idiagnostic A diagnostic from `check()`.
+   * @return A description of the problem.
+   */
+  static std::string describe(const Diagnostic &idiagnostic);
+
+  /**
+   * @return The distance between the left and right wheels.
+   */
+  QLength getWheelTrack() const;
+
+  protected:
+  double wheelTrack;
+
+  // Waypoints closer than this are in the same place, in meters
+  static constexpr double minSpacing = 1e-3;
+
+  // The number of points each span's curvature is sampled at
+  static constexpr int curvatureSamples = 16;
+
+  /**
+   * Computes the maximum curvature of a span the way pathfinder fits it.
+   *
+   * @param ilength The distance between the waypoints.
+   * @param istartSlope The tangent of the start heading relative to the chord.
+   * @param iendSlope The tangent of the end heading relative to the chord.
+   * @return The maximum curvature in 1/m.
+   */
+  static double maxCurvature(double ilength, double istartSlope, double iendSlope);
+};
+} // namespace okapi
@@ -0,0 +1,76 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/coreProsAPI.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include "okapi/api/util/logging.hpp"
+#include "okapi/api/util/timeUtil.hpp"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace okapi {
+struct PathGenerationResult {
+  std::string pathId;
+  bool succeeded;
+  QTime duration;    // Time spent generating the path
+  std::string error; // Empty if the path was generated
+};
+
+class PathGenerationBatch {
+  public:
+  /**
+   * Generates a batch of paths on a pool of worker threads. Each worker takes the next path which
+   * has not been started yet until every path is done, so a few long paths do not hold up the
+   * rest. The thread which calls `run()` is one of the workers.
+   *
+   * @param ipathIds The identifiers of the paths, in the order they should be started.
+   * @param igenerate Generates and saves the path at an index into `ipathIds`. Throws an exception
+   * which describes why the path could not be generated. This is called from several threads at
+   * once, so it must be thread safe.
+   * @param itimeUtil The TimeUtil used to time each path and to wait for the workers.
+   * @param ilogger The logger this instance will log to.
+   */
+  PathGenerationBatch(std::vector<std::string> ipathIds,
+                      std::function<void(std::size_t)> igenerate,
+                      const TimeUtil &itimeUtil,
+                      const std::shared_ptr<Logger> &ilogger = Logger::getDefaultLogger());
+
+  PathGenerationBatch(const PathGenerationBatch &) = delete;
+
+  PathGenerationBatch &operator=(const PathGenerationBatch &) = delete;
+
+  /**
+   * Generates every path and blocks until they are all done. A path whose identifier was already
+   * used by an earlier path in the batch fails without being generated. Throws a
+   * `std::invalid_argument` exception if there are no workers.
+   *
+   * @param iworkers The number of workers, including the calling thread. No more workers are
+   * started than there are paths.
+   * @return The result of each path, in the same order as the identifiers.
+   */
+  std::vector<PathGenerationResult> run(std::size_t iworkers);
+
+  protected:
+  std::vector<std::string> pathIds;
+  std::function<void(std::size_t)> generate;
+  TimeUtil timeUtil;
+  std::shared_ptr<Logger> logger;
+  std::vector<PathGenerationResult> results{};
+  std::vector<bool> skipped{};
+  std::atomic<std::size_t> nextPath{0};
+  std::atomic<std::size_t> finishedWorkers{0};
+
+  /**
+   * Generates paths until there are none left to start.
+   */
+  void work();
+
+  static void trampoline(void *context);
+};
+} // namespace okapi
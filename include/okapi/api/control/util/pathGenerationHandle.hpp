@@ -0,0 +1,74 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/util/timeUtil.hpp"
+#include <atomic>
+#include <string>
+
+namespace okapi {
+class PathGenerationHandle {
+  public:
+  enum class Status {
+    pending, ///< The path is queued or is being generated.
+    done,    ///< The path was generated and saved.
+    failed   ///< The path could not be generated. See `getError()`.
+  };
+
+  /**
+   * A handle to a path that is being generated in the background. The generator marks the handle
+   * as done or failed once it finishes with the path.
+   *
+   * @param ipathId The identifier the path will be saved with.
+   */
+  explicit PathGenerationHandle(std::string ipathId);
+
+  /**
+   * @return The identifier the path will be saved with.
+   */
+  const std::string &getPathId() const;
+
+  /**
+   * @return The current status of the generation.
+   */
+  Status getStatus() const;
+
+  /**
+   * @return Whether the generator is finished with the path, either because it was generated or
+   * because it failed.
+   */
+  bool isReady() const;
+
+  /**
+   * @return The reason the generation failed, or an empty string if it did not fail.
+   */
+  std::string getError() const;
+
+  /**
+   * Blocks the current task until the generator is finished with the path.
+   *
+   * @param itimeUtil The TimeUtil used to get a rate to wait with.
+   */
+  void waitUntilReady(const TimeUtil &itimeUtil) const;
+
+  /**
+   * Marks the path as generated. This should only be called by the generator.
+   */
+  void markDone();
+
+  /**
+   * Marks the path as failed. This should only be called by the generator.
+   *
+   * @param ierror The reason the generation failed.
+   */
+  void markFailed(const std::string &ierror);
+
+  protected:
+  std::string pathId;
+  std::string error{""};
+  std::atomic<Status> status{Status::pending};
+};
+} // namespace okapi
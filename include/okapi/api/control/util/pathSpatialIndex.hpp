@@ -0,0 +1,80 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace okapi {
+class PathSpatialIndex {
+  public:
+  /**
+   * A k-d tree over the points of a path, which finds the point closest to a position in
+   * O(log n) time on average instead of checking every point. The search can be restricted to a
+   * window of indices along the path, so a follower never jumps to an earlier or much later part of
+   * a path which crosses itself.
+   *
+   * @param ipoints The x and y coordinates of each point, in the order they are along the path.
+   */
+  explicit PathSpatialIndex(const std::vector<std::pair<double, double>> &ipoints);
+
+  /**
+   * Finds the point closest to a position. Points which are equally close are broken by the lower
+   * index.
+   *
+   * @param ix The x coordinate of the position.
+   * @param iy The y coordinate of the position.
+   * @param ifirst The index of the first point to consider.
+   * @param ilast The index of the last point to consider.
+   * @return The index of the closest point, or `size()` if no point is in [ifirst, ilast].
+   */
+  std::size_t nearest(double ix,
+                      double iy,
+                      std::size_t ifirst = 0,
+                      std::size_t ilast = std::numeric_limits<std::size_t>::max()) const;
+
+  /**
+   * @return The number of points in the index.
+   */
+  std::size_t size() const;
+
+  protected:
+  struct Node {
+    double x;
+    double y;
+    std::size_t index;    // The index of the point along the path
+    std::size_t minIndex; // The smallest index in the subtree this node is the root of
+    std::size_t maxIndex; // The largest index in the subtree this node is the root of
+  };
+
+  // The tree is stored implicitly: the root of the nodes in [begin, end) is at their middle, and
+  // each level splits on x and y in turn
+  std::vector<Node> nodes{};
+
+  /**
+   * Builds the subtree of the nodes in [ibegin, iend).
+   *
+   * @return The smallest and largest indices in the subtree.
+   */
+  std::pair<std::size_t, std::size_t> build(std::size_t ibegin, std::size_t iend, bool isplitX);
+
+  struct Query {
+    double x;
+    double y;
+    std::size_t first;
+    std::size_t last;
+    std::size_t best;
+    double bestDistance; // Squared
+  };
+
+  /**
+   * Searches the subtree of the nodes in [ibegin, iend) for a point closer than the best so far.
+   */
+  void search(std::size_t ibegin, std::size_t iend, bool isplitX, Query &ioquery) const;
+};
+} // namespace okapi
@@ -20,4 +20,16 @@ struct PathfinderLimits {
   double maxAccel; // Maximum robot acceleration in m/s/s
   double maxJerk;  // Maximum robot jerk in m/s/s/s
 };
+
+/**
+ * Gains for following a motion profile closed loop. Outputs are in the chassis model's voltage
+ * range of [-1, 1].
+ */
+struct ProfileFollowerGains {
+  double kS;     // Output added in the direction of motion to overcome static friction
+  double kV;     // Output per m/s of wheel velocity
+  double kA;     // Output per m/s/s of wheel acceleration
+  double kP;     // Output per meter of wheel position error
+  double kTheta; // Output per radian of heading error, only used with odometry
+};
 } // namespace okapi
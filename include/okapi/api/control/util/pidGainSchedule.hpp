@@ -0,0 +1,97 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace okapi {
+/**
+ * A table of IterativePosPIDController gains which are linearly interpolated between its points.
+ * The table is indexed by the controller's error, its target, or an external value such as the
+ * height of a lift. Inputs outside of the table use the gains of the closest point.
+ */
+class PIDGainSchedule {
+  public:
+  enum class Source {
+    error,   // The absolute value of the controller's error
+    target,  // The controller's target
+    external // The value returned by a function
+  };
+
+  /**
+   * A table of gains indexed by the controller's error or target.
+   *
+   * @param isource What the table is indexed by. Must not be Source::external.
+   * @param ipoints The gains at each input value. There must be at least one point and the inputs
+   * must be unique.
+   */
+  PIDGainSchedule(Source isource,
+                  std::vector<std::pair<double, IterativePosPIDController::Gains>> ipoints);
+
+  /**
+   * A table of gains indexed by an external value.
+   *
+   * @param iexternal A function which returns the table's input. It is called on every step of
+   * the controller, from the controller's thread.
+   * @param ipoints The gains at each input value. There must be at least one point and the inputs
+   * must be unique.
+   */
+  PIDGainSchedule(std::function<double()> iexternal,
+                  std::vector<std::pair<double, IterativePosPIDController::Gains>> ipoints);
+
+  /**
+   * Gets the gains for a controller's current error and target.
+   *
+   * @param ierror the controller's error
+   * @param itarget the controller's target
+   * @return the interpolated gains
+   */
+  IterativePosPIDController::Gains getGains(double ierror, double itarget) const;
+
+  /**
+   * Interpolates the gains at an input value.
+   *
+   * @param iinput the table's input
+   * @return the interpolated gains
+   */
+  IterativePosPIDController::Gains interpolate(double iinput) const;
+
+  /**
+   * @return What the table is indexed by.
+   */
+  Source getSource() const;
+
+  /**
+   * @return The table's points, sorted by their inputs.
+   */
+  const std::vector<std::pair<double, IterativePosPIDController::Gains>> &getPoints() const;
+
+  protected:
+  Source source;
+  std::function<double()> external;
+  std::vector<std::pair<double, IterativePosPIDController::Gains>> points;
+
+  /**
+   * Sorts the points and checks that there is at least one and their inputs are unique.
+   */
+  void sortPoints();
+
+  /**
+   * Linearly interpolates between two sets of gains.
+   *
+   * @param ia the gains when it is 0
+   * @param ib the gains when it is 1
+   * @param it the interpolation parameter in the range [0, 1]
+   * @return the interpolated gains
+   */
+  static IterativePosPIDController::Gains lerp(const IterativePosPIDController::Gains &ia,
+                                               const IterativePosPIDController::Gains &ib,
+                                               double it);
+};
+} // namespace okapi
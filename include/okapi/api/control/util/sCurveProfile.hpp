@@ -0,0 +1,149 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include <vector>
+
+extern "C" {
+#include "okapi/pathfinder/include/pathfinder.h"
+}
+
+namespace okapi {
+class SCurveProfile {
+  public:
+  enum class Shape {
+    sCurve,   ///< Jerk-limited, with up to seven phases of constant jerk.
+    trapezoid ///< Acceleration-limited, with up to three phases. The jerk limit is ignored.
+  };
+
+  struct State {
+    double position;     // m
+    double velocity;     // m/s
+    double acceleration; // m/s/s
+    double jerk;         // m/s/s/s
+  };
+
+  /**
+   * A 1D motion profile which moves a distance from rest to rest. The profile is computed in closed
+   * form, so making one takes microseconds and it can be evaluated at any time without storing its
+   * segments. Throws a `std::invalid_argument` exception if the distance is not finite or if a
+   * limit the shape uses is not positive.
+   *
+   * @param idistance The distance to move in meters. Negative distances move backwards.
+   * @param ilimits The limits of the profile.
+   * @param ishape The shape of the profile.
+   */
+  SCurveProfile(double idistance, const PathfinderLimits &ilimits, Shape ishape = Shape::sCurve);
+
+  /**
+   * A 1D motion profile which moves from any state to rest at a target. This is used to re-plan a
+   * profile while it is being followed, starting from the state it is in at that moment. The cruise
+   * velocity is found by bisection over closed-form phases. If the start is moving too fast to stop
+   * at the target, the profile overshoots and comes back. Throws a `std::invalid_argument`
+   * exception if the start or the target is not finite or if a limit the shape uses is not
+   * positive.
+   *
+   * @param istart The state to start from. The jerk is ignored, and so is the acceleration for a
+   * trapezoidal profile.
+   * @param itarget The position to end at in meters.
+   * @param ilimits The limits of the profile.
+   * @param ishape The shape of the profile.
+   */
+  SCurveProfile(const State &istart,
+                double itarget,
+                const PathfinderLimits &ilimits,
+                Shape ishape = Shape::sCurve);
+
+  /**
+   * Evaluates the profile. Times before the start give the start state and times after the end
+   * give the end state.
+   *
+   * @param itime The time since the start of the profile in seconds.
+   * @return The state of the profile at that time.
+   */
+  State getState(double itime) const;
+
+  /**
+   * @return The duration of the profile in seconds.
+   */
+  double getDuration() const;
+
+  /**
+   * @return The position the profile ends at in meters.
+   */
+  double getDistance() const;
+
+  /**
+   * @return The shape of the profile.
+   */
+  Shape getShape() const;
+
+  /**
+   * Samples the profile into segments like a pathfinder trajectory. The first segment is one `idt`
+   * after the start and the last segment is at the end of the profile.
+   *
+   * @param idt The duration of each segment.
+   * @return The segments.
+   */
+  std::vector<Segment> getSegments(QTime idt = 10_ms) const;
+
+  protected:
+  struct Phase {
+    double startTime;
+    double duration;
+    State start; // The jerk is constant for the whole phase
+  };
+
+  PathfinderLimits limits;
+  Shape shape;
+  std::vector<Phase> phases{};
+  State start{0, 0, 0, 0};
+  State end{0, 0, 0, 0};
+  double duration{0};
+
+  /**
+   * Throws if the limits the shape uses are not positive.
+   */
+  void validateLimits() const;
+
+  /**
+   * Appends a phase of constant jerk starting from the end of the profile.
+   *
+   * @param iduration The duration of the phase. Phases which are not longer than zero are skipped.
+   * @param ijerk The jerk during the phase.
+   */
+  void appendPhase(double iduration, double ijerk);
+
+  /**
+   * Appends the quickest change from the end of the profile to a velocity with zero acceleration.
+   *
+   * @param ivelocity The velocity to end at.
+   */
+  void appendVelocityChange(double ivelocity);
+
+  /**
+   * @param ivelocity The velocity to cruise at.
+   * @return The position the profile would stop at if it changed to the velocity and then
+   * immediately stopped.
+   */
+  double getStopPosition(double ivelocity) const;
+
+  /**
+   * @param ivelocity The velocity to change to from rest.
+   * @return The time it takes to change to the velocity from rest.
+   */
+  double getRampTime(double ivelocity) const;
+
+  /**
+   * @param istart The state at the start of a phase.
+   * @param itime The time since the start of the phase.
+   * @return The state at that time.
+   */
+  static State integrate(const State &istart, double itime);
+};
+} // namespace okapi
@@ -0,0 +1,38 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/units/QTime.hpp"
+#include <cstdint>
+
+namespace okapi {
+/**
+ * Statistics on the timing of an iterative controller's steps. The times cover the intervals
+ * between consecutive steps, which are not measured across a reset or while disabled.
+ */
+struct StepTimingStats {
+  std::uint32_t steps{0};     // Calls to step() which ran the controller
+  std::uint32_t skipped{0};   // Calls to step() which returned early because it was too soon
+  std::uint32_t intervals{0}; // Measured times between steps
+  std::uint32_t late{0};      // Steps later than the sample time plus the jitter tolerance
+  QTime minDt{0_ms};          // Shortest time between steps
+  QTime maxDt{0_ms};          // Longest time between steps
+  QTime totalDt{0_ms};        // Sum of the times between steps
+
+  /**
+   * Records the time between a step and the one before it.
+   *
+   * @param idt the time since the last step
+   * @param ilateDt steps which take longer than this are late
+   */
+  void recordInterval(QTime idt, QTime ilateDt);
+
+  /**
+   * @return The mean time between steps, or 0 if no intervals have been measured.
+   */
+  QTime getMeanDt() const;
+};
+} // namespace okapi
@@ -0,0 +1,101 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/device/motor/abstractMotor.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "okapi/pathfinder/include/pathfinder.h"
+}
+
+namespace okapi {
+class TankTrajectoryLimiter {
+  public:
+  /**
+   * Re-times the left and right trajectories of a skid steer path so that neither wheel drives
+   * faster than its max velocity or accelerates harder than its max acceleration. Generators only
+   * limit the center of the robot, so on a tight curve the outer wheel can be asked for more than
+   * its motors can give. The path keeps its shape and is only slowed down where a wheel would break
+   * a limit, so it stays at full speed on straights instead of lowering the max velocity
+   * everywhere. Throws a `std::invalid_argument` exception if a limit is not positive.
+   *
+   * @param imaxWheelVelocity The max velocity of each wheel in m/s.
+   * @param imaxWheelAccel The max acceleration of each wheel in m/s/s.
+   */
+  TankTrajectoryLimiter(double imaxWheelVelocity, double imaxWheelAccel);
+
+  /**
+   * Computes the max velocity of a wheel from the gearset its motors are in.
+   *
+   * @param iwheelDiameter The diameter of the wheel.
+   * @param ipair The gearset of the motors and the gear ratio from the motors to the wheel.
+   * @return The max velocity of the wheel in m/s.
+   */
+  static double computeMaxWheelVelocity(QLength iwheelDiameter,
+                                        const AbstractMotor::GearsetRatioPair &ipair);
+
+  /**
+   * Re-times a path. The velocity of each segment is scaled down until both wheels respect the
+   * limits, and the slower path is sampled again with the duration of the first segment. The
+   * segments are copied unchanged if no limit is broken.
+   *
+   * @param ileft The segments of the left wheel.
+   * @param iright The segments of the right wheel, at the same times as the left wheel.
+   * @param ilength The number of segments in each side.
+   * @return The re-timed left and right segments.
+   */
+  std::pair<std::vector<Segment>, std::vector<Segment>>
+  limit(const Segment *ileft, const Segment *iright, int ilength) const;
+
+  /**
+   * @return The max velocity of each wheel in m/s.
+   */
+  double getMaxWheelVelocity() const;
+
+  /**
+   * @return The max acceleration of each wheel in m/s/s.
+   */
+  double getMaxWheelAccel() const;
+
+  protected:
+  // Segments which would only be slowed down by less than this are left alone
+  static constexpr double tolerance = 1e-3;
+
+  double maxWheelVelocity;
+  double maxWheelAccel;
+
+  /**
+   * Computes how much each segment has to be slowed down. The velocity of each wheel is capped,
+   * then passes forwards and backwards cap how quickly each wheel can speed up from the segment
+   * before it and slow down to the segment after it.
+   *
+   * @param ileft The segments of the left wheel.
+   * @param iright The segments of the right wheel.
+   * @param ilength The number of segments in each side.
+   * @return The factor in (0, 1] to scale the velocity of each segment by.
+   */
+  std::vector<double> computeScales(const Segment *ileft, const Segment *iright, int ilength) const;
+
+  /**
+   * Samples one side of a re-timed path.
+   *
+   * @param iside The segments of the side.
+   * @param ilength The number of segments in the side.
+   * @param iscales The factor each segment's velocity is scaled by.
+   * @param itimes The time at the end of each re-timed segment.
+   * @param idt The duration of each output segment.
+   * @return The output segments.
+   */
+  static std::vector<Segment> resample(const Segment *iside,
+                                       int ilength,
+                                       const std::vector<double> &iscales,
+                                       const std::vector<double> &itimes,
+                                       double idt);
+};
+} // namespace okapi
@@ -0,0 +1,143 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/device/motor/abstractMotor.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "okapi/pathfinder/include/pathfinder.h"
+}
+
+namespace okapi {
+class TrajectoryBaker {
+  public:
+  enum class Generator {
+    pathfinder, ///< The generator `AsyncMotionProfileController` uses by default.
+    native      ///< A `TrajectoryGenerator` with its default settings.
+  };
+
+  struct PathSpec {
+    std::string pathId;
+    std::vector<PathfinderPoint> waypoints;
+    PathfinderLimits limits;
+  };
+
+  struct Manifest {
+    QLength wheelDiameter;
+    QLength wheelTrack;
+    AbstractMotor::GearsetRatioPair pair;
+    Generator generator;
+    std::vector<PathSpec> paths;
+  };
+
+  /**
+   * Generates paths on the host ahead of time and writes them as a C++ header of constant data,
+   * which is compiled into the program and registered with
+   * `AsyncMotionProfileController::registerBakedPath()`. The paths are generated the same way
+   * `AsyncMotionProfileController` generates them.
+   *
+   * @param imanifest The chassis and the paths to bake.
+   */
+  explicit TrajectoryBaker(Manifest imanifest);
+
+  /**
+   * Parses a path manifest. Each line holds one directive, and `#` starts a comment:
+   *
+   * - `chassis <wheel diameter> <wheel track>`
+   * - `gearset <red|green|blue> [<ratio>]`
+   * - `generator <pathfinder|native>`
+   * - `limits <max vel> <max accel> <max jerk>`, used by the paths which follow it
+   * - `path <id> [<max vel> <max accel> <max jerk>]`, which starts a path
+   * - `point <x> <y> <theta>`, which adds a waypoint to the current path
+   *
+   * Lengths may end in `m`, `cm`, `mm`, `in`, or `ft` and default to meters. Angles may end in
+   * `deg` or `rad` and default to degrees. Limits are in meters and seconds. Throws a
+   * `std::invalid_argument` exception which names the line if the manifest is malformed.
+   *
+   * @param imanifest The manifest to parse.
+   * @return The parsed manifest.
+   */
+  static Manifest parseManifest(std::istream &imanifest);
+
+  /**
+   * Generates every path and writes them as a header. The header defines a `paths` array of
+   * `BakedPath` and its segment data, all `inline constexpr`, in the given namespace. Throws a
+   * `std::runtime_error` exception if a path cannot be generated.
+   *
+   * @param iout The stream to write the header to.
+   * @param inamespace The namespace to put the data in.
+   */
+  void writeHeader(std::ostream &iout, const std::string &inamespace) const;
+
+  /**
+   * Generates the two sides of a path.
+   *
+   * @param ipath The path to generate.
+   * @return The left and right segments.
+   */
+  std::pair<std::vector<Segment>, std::vector<Segment>> generate(const PathSpec &ipath) const;
+
+  protected:
+  Manifest manifest;
+
+  static std::invalid_argument manifestError(int iline, const std::string &imessage);
+
+  /**
+   * Re-times the two sides of a path to respect the wheel limits the same way
+   * `AsyncMotionProfileController` does.
+   *
+   * @param isides The left and right segments.
+   * @param ilimits The limits the path was generated with.
+   * @return The re-timed left and right segments.
+   */
+  std::pair<std::vector<Segment>, std::vector<Segment>>
+  limitWheels(const std::pair<std::vector<Segment>, std::vector<Segment>> &isides,
+              const PathfinderLimits &ilimits) const;
+
+  /**
+   * Parses a number which may be followed by a unit.
+   *
+   * @param itoken The token to parse.
+   * @param ounit Set to whatever follows the number.
+   * @param iline The line the token is on.
+   * @return The number.
+   */
+  static double parseNumber(const std::string &itoken, std::string &ounit, int iline);
+
+  static QLength parseLength(const std::string &itoken, int iline);
+
+  static QAngle parseAngle(const std::string &itoken, int iline);
+
+  static double parsePlainNumber(const std::string &itoken, int iline);
+
+  static PathfinderLimits
+  parseLimits(const std::vector<std::string> &itokens, std::size_t ifirst, int iline);
+
+  /**
+   * Writes one column of a side as an array of floats.
+   */
+  static void writeColumn(std::ostream &iout,
+                          const std::string &iname,
+                          const std::vector<Segment> &isegments,
+                          double Segment::*ifield);
+
+  /**
+   * @return A float literal which holds the value exactly once it is rounded to a float.
+   */
+  static std::string formatFloat(double ivalue);
+
+  /**
+   * @return The value escaped to be put in a string literal.
+   */
+  static std::string escape(const std::string &ivalue);
+};
+} // namespace okapi
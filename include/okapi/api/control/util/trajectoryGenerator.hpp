@@ -0,0 +1,208 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+
+#include "okapi/api/control/util/pathfinderUtil.hpp"
+#include "okapi/api/units/QLength.hpp"
+#include "okapi/api/units/QTime.hpp"
+#include <array>
+#include <limits>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "okapi/pathfinder/include/pathfinder.h"
+}
+
+namespace okapi {
+class TrajectoryGenerator {
+  public:
+  /**
+   * Generates trajectories through waypoints without pathfinder. The path is fit with quintic
+   * Hermite splines and its arc length is computed with Gaussian quadrature. The path is then
+   * time-parameterized so that the velocity, acceleration, and jerk limits and the centripetal
+   * acceleration limit are all respected. The trajectories use pathfinder's `Segment` so they can
+   * be used anywhere pathfinder's trajectories are. Throws a `std::invalid_argument` exception if
+   * `idt` or `imaxCentripetalAccel` are not positive.
+   *
+   * @param idt The duration of each segment.
+   * @param imaxCentripetalAccel The maximum centripetal acceleration in m/s/s. The robot slows down
+   * in turns to stay under this. The default is no limit.
+   */
+  explicit TrajectoryGenerator(
+    QTime idt = 10_ms,
+    double imaxCentripetalAccel = std::numeric_limits<double>::infinity());
+
+  /**
+   * Generates the trajectory of the center of the robot. Throws a `std::invalid_argument` exception
+   * if there are fewer than two waypoints, if two waypoints in a row are in the same place, if any
+   * limit is not positive, or if no trajectory through the waypoints could be found which respects
+   * the velocity and acceleration limits.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ilimits The limits of the trajectory.
+   * @return The trajectory.
+   */
+  std::vector<Segment> generate(const std::vector<PathfinderPoint> &iwaypoints,
+                                const PathfinderLimits &ilimits) const;
+
+  /**
+   * Generates the trajectories of the left and right wheels of a skid steer robot. The wheel
+   * velocities are computed exactly from the curvature of the path. Throws like `generate()`.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ilimits The limits of the trajectory of the center of the robot.
+   * @param iwheelTrack The distance between the left and right wheels.
+   * @return The left and right trajectories.
+   */
+  std::pair<std::vector<Segment>, std::vector<Segment>>
+  generateTank(const std::vector<PathfinderPoint> &iwaypoints,
+               const PathfinderLimits &ilimits,
+               QLength iwheelTrack) const;
+
+  /**
+   * @return The duration of each segment.
+   */
+  QTime getDt() const;
+
+  /**
+   * @return The maximum centripetal acceleration in m/s/s.
+   */
+  double getMaxCentripetalAccel() const;
+
+  protected:
+  /**
+   * A quintic Hermite spline between two waypoints, parameterized by t in [0, 1]. The second
+   * derivative is zero at both ends so that splines join with zero curvature.
+   */
+  class QuinticSpline {
+    public:
+    /**
+     * @param istart The waypoint to start at.
+     * @param iend The waypoint to end at.
+     */
+    QuinticSpline(const PathfinderPoint &istart, const PathfinderPoint &iend);
+
+    /**
+     * @return The arc length of the spline in meters.
+     */
+    double getLength() const;
+
+    /**
+     * Finds the parameter at an arc length along the spline by inverting the arc length with
+     * Newton's method.
+     *
+     * @param idistance The arc length in meters.
+     * @return The parameter in [0, 1].
+     */
+    double getParameter(double idistance) const;
+
+    /**
+     * @param it The parameter.
+     * @return The x and y position in meters.
+     */
+    std::pair<double, double> getPosition(double it) const;
+
+    /**
+     * @param it The parameter.
+     * @return The heading in radians, counterclockwise from the x axis.
+     */
+    double getHeading(double it) const;
+
+    /**
+     * @param it The parameter.
+     * @return The signed curvature in 1/m, positive when turning counterclockwise.
+     */
+    double getCurvature(double it) const;
+
+    protected:
+    // The arc length is integrated over this many equal intervals of t
+    static constexpr int quadratureIntervals = 8;
+
+    std::array<double, 6> x{}; // Coefficients of t^0 through t^5
+    std::array<double, 6> y{}; // Coefficients of t^0 through t^5
+    std::array<double, quadratureIntervals + 1> intervalDistances{};
+
+    static double evaluate(const std::array<double, 6> &icoeffs, double it);
+    static double derivative(const std::array<double, 6> &icoeffs, double it);
+    static double secondDerivative(const std::array<double, 6> &icoeffs, double it);
+
+    /**
+     * @param it The parameter.
+     * @return The rate of change of arc length with respect to t.
+     */
+    double getSpeed(double it) const;
+
+    /**
+     * Integrates the speed with five-point Gauss-Legendre quadrature.
+     *
+     * @param it0 The parameter to integrate from.
+     * @param it1 The parameter to integrate to.
+     * @return The arc length between the parameters.
+     */
+    double integrate(double it0, double it1) const;
+  };
+
+  /**
+   * A sequence of splines which is indexed by arc length.
+   */
+  class SplinePath {
+    public:
+    explicit SplinePath(const std::vector<PathfinderPoint> &iwaypoints);
+
+    /**
+     * @return The arc length of the path in meters.
+     */
+    double getLength() const;
+
+    /**
+     * @param idistance The arc length along the path in meters.
+     * @return The spline the distance lies on and the parameter on that spline.
+     */
+    std::pair<const QuinticSpline *, double> locate(double idistance) const;
+
+    protected:
+    std::vector<QuinticSpline> splines{};
+    std::vector<double> startDistances{};
+    double length{0};
+  };
+
+  // The spacing between the points the velocity limits are computed at, in meters
+  static constexpr double gridSpacing = 0.01;
+
+  // The most times the time parameterization is refined to respect the limits
+  static constexpr int maxRefinements = 10;
+
+  double dt;
+  double maxCentripetalAccel;
+
+  /**
+   * Time-parameterizes a path. The velocity limit at each grid point is lowered until the
+   * filtered velocity respects it. Throws a `std::invalid_argument` exception if the final
+   * trajectory does not respect the velocity and acceleration limits.
+   *
+   * @param ipath The path.
+   * @param ilimits The limits of the trajectory.
+   * @param ocurvatures The curvature at each segment.
+   * @return The trajectory.
+   */
+  std::vector<Segment> parameterize(const SplinePath &ipath,
+                                    const PathfinderLimits &ilimits,
+                                    std::vector<double> &ocurvatures) const;
+
+  /**
+   * Validates the inputs and generates the trajectory of the center of the robot.
+   *
+   * @param iwaypoints The waypoints to hit on the path.
+   * @param ilimits The limits of the trajectory.
+   * @param ocurvatures The curvature at each segment.
+   * @return The trajectory.
+   */
+  std::vector<Segment> generateCenter(const std::vector<PathfinderPoint> &iwaypoints,
+                                      const PathfinderLimits &ilimits,
+                                      std::vector<double> &ocurvatures) const;
+};
+} // namespace okapi
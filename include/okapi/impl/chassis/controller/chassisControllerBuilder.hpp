@@ -11,6 +11,7 @@
 #include "okapi/api/chassis/model/hDriveModel.hpp"
 #include "okapi/api/chassis/model/skidSteerModel.hpp"
 #include "okapi/api/chassis/model/xDriveModel.hpp"
+#include "okapi/api/control/util/pidGainSchedule.hpp"
 #include "okapi/api/util/logging.hpp"
 #include "okapi/api/util/mathUtil.hpp"
 #include "okapi/impl/device/motor/motor.hpp"
@@ -254,6 +255,31 @@ class ChassisControllerBuilder {
                                       const IterativePosPIDController::Gains &iturnGains,
                                       const IterativePosPIDController::Gains &iangleGains);
 
+  /**
+   * Sets gain schedules for the PID controllers, causing the builder to generate a
+   * ChassisControllerPID. Uses the turn controller's schedule for the angle controller. Each
+   * controller starts with the gains of its schedule's first point.
+   *
+   * @param idistanceSchedule The distance controller's gain schedule.
+   * @param iturnSchedule The turn controller's gain schedule.
+   * @return An ongoing builder.
+   */
+  ChassisControllerBuilder &withGains(const PIDGainSchedule &idistanceSchedule,
+                                      const PIDGainSchedule &iturnSchedule);
+
+  /**
+   * Sets gain schedules for the PID controllers, causing the builder to generate a
+   * ChassisControllerPID. Each controller starts with the gains of its schedule's first point.
+   *
+   * @param idistanceSchedule The distance controller's gain schedule.
+   * @param iturnSchedule The turn controller's gain schedule.
+   * @param iangleSchedule The angle controller's gain schedule.
+   * @return An ongoing builder.
+   */
+  ChassisControllerBuilder &withGains(const PIDGainSchedule &idistanceSchedule,
+                                      const PIDGainSchedule &iturnSchedule,
+                                      const PIDGainSchedule &iangleSchedule);
+
   /**
    * Sets the odometry information, causing the builder to generate an Odometry variant.
    *
@@ -311,6 +337,22 @@ class ChassisControllerBuilder {
     std::unique_ptr<Filter> iturnFilter = std::make_unique<PassthroughFilter>(),
     std::unique_ptr<Filter> iangleFilter = std::make_unique<PassthroughFilter>());
 
+  /**
+   * Makes moves and turns follow motion profiles. This only applies to a ChassisControllerPID,
+   * which is built when gains are given. See `ChassisControllerPID::setMotionProfile()`.
+   *
+   * @param istraightLimits The limits of moves in m/s, m/s/s, and m/s/s/s.
+   * @param iturnLimits The limits of turns in deg/s, deg/s/s, and deg/s/s/s.
+   * @param ishape The shape of the profiles.
+   * @param ivelocityFeedforward How much of the profile's velocity to add to the outputs.
+   * @return An ongoing builder.
+   */
+  ChassisControllerBuilder &
+  withMotionProfile(const PathfinderLimits &istraightLimits,
+                    const PathfinderLimits &iturnLimits,
+                    SCurveProfile::Shape ishape = SCurveProfile::Shape::trapezoid,
+                    double ivelocityFeedforward = 1);
+
   /**
    * Sets the chassis dimensions.
    *
@@ -470,6 +512,14 @@ class ChassisControllerBuilder {
   std::unique_ptr<Filter> angleFilter = std::make_unique<PassthroughFilter>();
   IterativePosPIDController::Gains turnGains;
   std::unique_ptr<Filter> turnFilter = std::make_unique<PassthroughFilter>();
+  std::shared_ptr<PIDGainSchedule> distanceSchedule;
+  std::shared_ptr<PIDGainSchedule> angleSchedule;
+  std::shared_ptr<PIDGainSchedule> turnSchedule;
+  bool hasMotionProfile{false};
+  PathfinderLimits straightProfileLimits;
+  PathfinderLimits turnProfileLimits;
+  SCurveProfile::Shape profileShape{SCurveProfile::Shape::trapezoid};
+  double profileVelocityFeedforward{1};
   TimeUtilFactory chassisControllerTimeUtilFactory = TimeUtilFactory();
   TimeUtilFactory closedLoopControllerTimeUtilFactory = TimeUtilFactory();
   TimeUtilFactory odometryTimeUtilFactory = TimeUtilFactory();
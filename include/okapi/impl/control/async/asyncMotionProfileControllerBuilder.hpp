@@ -6,8 +6,12 @@
 #pragma once
 
 #include "okapi/api/chassis/controller/chassisController.hpp"
+#include "okapi/api/chassis/controller/odomChassisController.hpp"
+#include "okapi/api/control/async/asyncHolonomicMotionProfileController.hpp"
 #include "okapi/api/control/async/asyncLinearMotionProfileController.hpp"
 #include "okapi/api/control/async/asyncMotionProfileController.hpp"
+#include "okapi/api/control/async/asyncPurePursuitController.hpp"
+#include "okapi/api/control/async/asyncRamseteController.hpp"
 #include "okapi/api/util/logging.hpp"
 #include "okapi/impl/device/motor/motor.hpp"
 #include "okapi/impl/device/motor/motorGroup.hpp"
@@ -99,6 +103,60 @@ class AsyncMotionProfileControllerBuilder {
    */
   AsyncMotionProfileControllerBuilder &withLimits(const PathfinderLimits &ilimits);
 
+  /**
+   * Follows paths closed loop. See `AsyncMotionProfileController::setFollowerGains()`. Only used by
+   * `buildMotionProfileController()`.
+   *
+   * @param igains The follower gains.
+   * @param iodometry The odometry to measure heading with, or `nullptr` to only use the sensors.
+   * @return An ongoing builder.
+   */
+  AsyncMotionProfileControllerBuilder &
+  withFollowerGains(const ProfileFollowerGains &igains,
+                    const std::shared_ptr<Odometry> &iodometry = nullptr);
+
+  /**
+   * Sets the odometry the robot's pose is read from. This must be used with
+   * buildRamseteController() and buildPurePursuitController().
+   *
+   * @param icontroller The odometry chassis controller whose odometry to use.
+   * @return An ongoing builder.
+   */
+  AsyncMotionProfileControllerBuilder &
+  withOdometry(const std::shared_ptr<OdomChassisController> &icontroller);
+
+  /**
+   * Sets the odometry the robot's pose is read from. This must be used with
+   * buildRamseteController() and buildPurePursuitController().
+   *
+   * @param iodometry The odometry.
+   * @return An ongoing builder.
+   */
+  AsyncMotionProfileControllerBuilder &withOdometry(const std::shared_ptr<Odometry> &iodometry);
+
+  /**
+   * Sets the gains of the RAMSETE law used by buildRamseteController(). The defaults are
+   * `b = 2` and `zeta = 0.7`.
+   *
+   * @param ib How aggressively to correct error, in rad^2/m^2. Must be greater than zero.
+   * @param izeta How damped the correction is. Must be in the range (0, 1).
+   * @return An ongoing builder.
+   */
+  AsyncMotionProfileControllerBuilder &withRamseteGains(double ib, double izeta);
+
+  /**
+   * Sets the lookahead used by buildPurePursuitController(). The lookahead distance is the robot's
+   * speed times the lookahead time, bounded by the min and max lookahead distances. The defaults
+   * are `6_in`, `18_in`, and `0.4_s`.
+   *
+   * @param iminLookahead The lookahead distance when the robot is slow.
+   * @param imaxLookahead The lookahead distance when the robot is fast.
+   * @param ilookaheadTime How far ahead to look at the robot's speed.
+   * @return An ongoing builder.
+   */
+  AsyncMotionProfileControllerBuilder &
+  withPurePursuitLookahead(QLength iminLookahead, QLength imaxLookahead, QTime ilookaheadTime);
+
   /**
    * Sets the TimeUtilFactory used when building the controller. The default is the static
    * TimeUtilFactory.
@@ -155,12 +213,49 @@ class AsyncMotionProfileControllerBuilder {
    */
   std::shared_ptr<AsyncMotionProfileController> buildMotionProfileController();
 
+  /**
+   * Builds the AsyncRamseteController. The output must be a chassis and the odometry must be set.
+   * For example:
+   *   `.withOutput(odomChassis).withOdometry(odomChassis).buildRamseteController()`
+   *
+   * @return A fully built AsyncRamseteController.
+   */
+  std::shared_ptr<AsyncRamseteController> buildRamseteController();
+
+  /**
+   * Builds the AsyncPurePursuitController. The output must be a chassis and the odometry must be
+   * set. For example:
+   *   `.withOutput(odomChassis).withOdometry(odomChassis).buildPurePursuitController()`
+   *
+   * @return A fully built AsyncPurePursuitController.
+   */
+  std::shared_ptr<AsyncPurePursuitController> buildPurePursuitController();
+
+  /**
+   * Builds the AsyncHolonomicMotionProfileController. The output must be a chassis with an
+   * `XDriveModel` or an `HDriveModel`. For example:
+   *   `.withOutput(xDriveChassis).buildHolonomicMotionProfileController()`
+   *
+   * @return A fully built AsyncHolonomicMotionProfileController.
+   */
+  std::shared_ptr<AsyncHolonomicMotionProfileController> buildHolonomicMotionProfileController();
+
   private:
   std::shared_ptr<Logger> logger;
 
   bool hasLimits{false};
   PathfinderLimits limits;
 
+  std::shared_ptr<Odometry> odometry{nullptr};
+  double ramseteB{2.0};
+  double ramseteZeta{0.7};
+  QLength minLookahead{6_in};
+  QLength maxLookahead{18_in};
+  QTime lookaheadTime{0.4_s};
+
+  std::optional<ProfileFollowerGains> followerGains{std::nullopt};
+  std::shared_ptr<Odometry> followerOdometry{nullptr};
+
   bool hasOutput{false};
   std::shared_ptr<ControllerOutput<double>> output;
   QLength diameter;
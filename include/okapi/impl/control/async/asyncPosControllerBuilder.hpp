@@ -8,6 +8,7 @@
 #include "okapi/api/control/async/asyncPosIntegratedController.hpp"
 #include "okapi/api/control/async/asyncPosPidController.hpp"
 #include "okapi/api/control/async/asyncPositionController.hpp"
+#include "okapi/api/control/util/pidGainSchedule.hpp"
 #include "okapi/api/util/logging.hpp"
 #include "okapi/impl/device/motor/motor.hpp"
 #include "okapi/impl/device/motor/motorGroup.hpp"
@@ -84,6 +85,15 @@ class AsyncPosControllerBuilder {
    */
   AsyncPosControllerBuilder &withGains(const IterativePosPIDController::Gains &igains);
 
+  /**
+   * Sets a gain schedule for the controller, causing the builder to generate an
+   * AsyncPosPIDController. The controller starts with the gains of the schedule's first point.
+   *
+   * @param igainSchedule The gain schedule.
+   * @return An ongoing builder.
+   */
+  AsyncPosControllerBuilder &withGains(const PIDGainSchedule &igainSchedule);
+
   /**
    * Sets the derivative filter which filters the derivative term before it is scaled by kD. The
    * filter is ignored when using integrated control. The default derivative filter is a
@@ -171,6 +181,7 @@ class AsyncPosControllerBuilder {
 
   bool hasGains{false}; // Whether gains were passed, no gains means integrated control
   IterativePosPIDController::Gains gains;
+  std::shared_ptr<PIDGainSchedule> gainSchedule;
   std::unique_ptr<Filter> derivativeFilter = std::make_unique<PassthroughFilter>();
 
   bool gearsetSetByUser{false}; // Used so motor's don't overwrite a gearset set manually
@@ -6,6 +6,7 @@
 #include "okapi/api/chassis/controller/chassisControllerPid.hpp"
 #include "okapi/api/util/mathUtil.hpp"
 #include <cmath>
+#include <mutex>
 #include <utility>
 
 namespace okapi {
@@ -49,6 +50,8 @@ void ChassisControllerPID::loop() {
   double distanceElapsed = 0, angleChange = 0;
   modeType pastMode = none;
   auto rate = timeUtil.getRate();
+  auto profileTimer = timeUtil.getTimer();
+  std::shared_ptr<const ProfiledMovement> movement;
 
   while (!dtorCalled.load(std::memory_order_acquire) && !task->notifyTake(0)) {
     /**
@@ -60,22 +63,37 @@ void ChassisControllerPID::loop() {
     } else {
       if (mode != pastMode || newMovement.load(std::memory_order_acquire)) {
         encStartVals = chassisModel->getSensorVals();
+
+        {
+          std::scoped_lock lock(profiledMovementMutex);
+          movement = profiledMovement;
+        }
+        profileTimer->placeMark();
+
         newMovement.store(false, std::memory_order_release);
       }
 
+      double offset = 0;
+      double feedforward = 0;
+      if (movement) {
+        std::tie(offset, feedforward) = stepProfile(*movement, profileTimer->getDtFromMark());
+      }
+
       switch (mode) {
       case distance:
         encVals = chassisModel->getSensorVals() - encStartVals;
         distanceElapsed = static_cast<double>((encVals[0] + encVals[1])) / 2.0;
         angleChange = static_cast<double>(encVals[0] - encVals[1]);
 
-        distancePid->step(distanceElapsed);
+        distancePid->step(distanceElapsed + offset);
         anglePid->step(angleChange);
 
         if (velocityMode) {
-          chassisModel->driveVector(distancePid->getOutput(), anglePid->getOutput());
+          chassisModel->driveVector(distancePid->getOutput() + feedforward,
+                                    anglePid->getOutput());
         } else {
-          chassisModel->driveVectorVoltage(distancePid->getOutput(), anglePid->getOutput());
+          chassisModel->driveVectorVoltage(distancePid->getOutput() + feedforward,
+                                           anglePid->getOutput());
         }
 
         break;
@@ -84,12 +102,12 @@ void ChassisControllerPID::loop() {
         encVals = chassisModel->getSensorVals() - encStartVals;
         angleChange = (encVals[0] - encVals[1]) / 2.0;
 
-        turnPid->step(angleChange);
+        turnPid->step(angleChange + offset);
 
         if (velocityMode) {
-          chassisModel->driveVector(0, turnPid->getOutput());
+          chassisModel->driveVector(0, turnPid->getOutput() + feedforward);
         } else {
-          chassisModel->driveVectorVoltage(0, turnPid->getOutput());
+          chassisModel->driveVectorVoltage(0, turnPid->getOutput() + feedforward);
         }
 
         break;
@@ -109,6 +127,47 @@ void ChassisControllerPID::loop() {
   LOG_INFO_S("Stopped ChassisControllerPID task.");
 }
 
+std::pair<double, double> ChassisControllerPID::stepProfile(const ProfiledMovement &imovement,
+                                                           const QTime itime) {
+  const double time = itime.convert(second);
+  const auto state = imovement.profile.getState(time);
+
+  if (time >= imovement.profile.getDuration()) {
+    profileDone.store(true, std::memory_order_release);
+  }
+
+  // The PID controller's target stays at the end of the movement, so shift the reading by how far
+  // the setpoint is from the end. Its error is then the error from the setpoint.
+  const double offset = (imovement.profile.getDistance() - state.position) * imovement.ticksPerUnit;
+
+  // The outputs are a fraction of the max velocity in velocity mode, or of the max voltage, which
+  // the gearset's max velocity is close to, in voltage mode
+  const double motorRpm = state.velocity * imovement.ticksPerUnit / scales.tpr * 60;
+  const double maxRpm =
+    velocityMode ? chassisModel->getMaxVelocity()
+                 : static_cast<double>(toUnderlyingType(gearsetRatioPair.internalGearset));
+
+  return {offset, imovement.velocityFeedforward * motorRpm / maxRpm};
+}
+
+void ChassisControllerPID::setProfiledMovement(const double idistance,
+                                               const bool iisTurn,
+                                               const double iticksPerUnit) {
+  std::shared_ptr<const ProfiledMovement> movement;
+  if (profileSettings) {
+    movement = std::make_shared<const ProfiledMovement>(ProfiledMovement{
+      SCurveProfile(idistance,
+                    iisTurn ? profileSettings->turnLimits : profileSettings->straightLimits,
+                    profileSettings->shape),
+      iticksPerUnit,
+      profileSettings->velocityFeedforward});
+  }
+
+  std::scoped_lock lock(profiledMovementMutex);
+  profiledMovement = std::move(movement);
+  profileDone.store(profiledMovement == nullptr, std::memory_order_release);
+}
+
 void ChassisControllerPID::trampoline(void *context) {
   if (context) {
     static_cast<ChassisControllerPID *>(context)->loop();
@@ -130,6 +189,8 @@ void ChassisControllerPID::moveDistanceAsync(const QLength itarget) {
 
   LOG_INFO("ChassisControllerPID: moving " + std::to_string(newTarget) + " motor ticks");
 
+  setProfiledMovement(itarget.convert(meter), false, scales.straight * gearsetRatioPair.ratio);
+
   distancePid->setTarget(newTarget);
   anglePid->setTarget(0);
 
@@ -168,6 +229,10 @@ void ChassisControllerPID::turnAngleAsync(const QAngle idegTarget) {
 
   LOG_INFO("ChassisControllerPID: turning " + std::to_string(newTarget) + " motor ticks");
 
+  setProfiledMovement(idegTarget.convert(degree),
+                      true,
+                      scales.turn * gearsetRatioPair.ratio * boolToSign(normalTurns));
+
   turnPid->setTarget(newTarget);
 
   doneLooping.store(false, std::memory_order_release);
@@ -196,10 +261,11 @@ void ChassisControllerPID::setTurnsMirrored(const bool ishouldMirror) {
 bool ChassisControllerPID::isSettled() {
   switch (mode) {
   case distance:
-    return distancePid->isSettled() && anglePid->isSettled();
+    return profileDone.load(std::memory_order_acquire) && distancePid->isSettled() &&
+           anglePid->isSettled();
 
   case angle:
-    return turnPid->isSettled();
+    return profileDone.load(std::memory_order_acquire) && turnPid->isSettled();
 
   default:
     return true;
@@ -248,7 +314,8 @@ bool ChassisControllerPID::waitForDistanceSettled() {
   LOG_INFO_S("ChassisControllerPID: Waiting to settle in distance mode");
 
   auto rate = timeUtil.getRate();
-  while (!(distancePid->isSettled() && anglePid->isSettled())) {
+  while (!(profileDone.load(std::memory_order_acquire) && distancePid->isSettled() &&
+           anglePid->isSettled())) {
     if (mode == angle) {
       // False will cause the loop to re-enter the switch
       LOG_WARN_S("ChassisControllerPID: Mode changed to angle while waiting in distance!");
@@ -266,7 +333,7 @@ bool ChassisControllerPID::waitForAngleSettled() {
   LOG_INFO_S("ChassisControllerPID: Waiting to settle in angle mode");
 
   auto rate = timeUtil.getRate();
-  while (!turnPid->isSettled()) {
+  while (!(profileDone.load(std::memory_order_acquire) && turnPid->isSettled())) {
     if (mode == distance) {
       // False will cause the loop to re-enter the switch
       LOG_WARN_S("ChassisControllerPID: Mode changed to distance while waiting in angle!");
@@ -314,6 +381,22 @@ ChassisControllerPID::getGains() const {
   return std::make_tuple(distancePid->getGains(), turnPid->getGains(), anglePid->getGains());
 }
 
+void ChassisControllerPID::setMotionProfile(const PathfinderLimits &istraightLimits,
+                                            const PathfinderLimits &iturnLimits,
+                                            const SCurveProfile::Shape ishape,
+                                            const double ivelocityFeedforward) {
+  // Check the limits now instead of when the next movement starts
+  SCurveProfile(0, istraightLimits, ishape);
+  SCurveProfile(0, iturnLimits, ishape);
+
+  profileSettings =
+    MotionProfileSettings{istraightLimits, iturnLimits, ishape, ivelocityFeedforward};
+}
+
+void ChassisControllerPID::disableMotionProfile() {
+  profileSettings = std::nullopt;
+}
+
 void ChassisControllerPID::startThread() {
   if (!task) {
     task = new CrossplatformThread(trampoline, this, "ChassisControllerPID");
@@ -5,6 +5,7 @@
  */
 #include "okapi/api/chassis/controller/defaultOdomChassisController.hpp"
 #include "okapi/api/odometry/odomMath.hpp"
+#include "okapi/api/util/mathUtil.hpp"
 #include <cmath>
 
 namespace okapi {
@@ -39,6 +40,28 @@ void DefaultOdomChassisController::driveToPoint(const Point &ipoint,
                                                 const QLength &ioffset) {
   waitForOdomTask();
 
+  if (pointMotion == PointMotion::curved) {
+    const auto state = odom->getState(StateMode::FRAME_TRANSFORMATION);
+    const Point point = ipoint.inFT(defaultStateMode);
+    const auto length = OdomMath::computeDistanceToPoint(point, state);
+
+    if ((length - ioffset).abs() <= moveThreshold) {
+      return;
+    }
+
+    // Stop short of the point along the line from the robot to the point
+    const double fraction =
+      length.convert(meter) > 0 ? ioffset.convert(meter) / length.convert(meter) : 0;
+    const Point target{point.x - (point.x - state.x) * fraction,
+                       point.y - (point.y - state.y) * fraction};
+
+    LOG_INFO("DefaultOdomChassisController: Driving along a curve to {" +
+             std::to_string(target.x.convert(meter)) + ", " +
+             std::to_string(target.y.convert(meter)) + "} meters");
+    driveCurved(target, std::nullopt, ibackwards, 0);
+    return;
+  }
+
   auto [length, angle] = OdomMath::computeDistanceAndAngleToPoint(
     ipoint.inFT(defaultStateMode), odom->getState(StateMode::FRAME_TRANSFORMATION));
 
@@ -66,6 +89,105 @@ void DefaultOdomChassisController::driveToPoint(const Point &ipoint,
   }
 }
 
+void DefaultOdomChassisController::driveToPose(const Point &ipoint,
+                                               const QAngle &iangle,
+                                               const bool ibackwards,
+                                               const double ilead) {
+  if (ilead < 0 || ilead >= 1) {
+    std::string msg("DefaultOdomChassisController: The lead must be in the range [0, 1).");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  waitForOdomTask();
+
+  const Point target = ipoint.inFT(defaultStateMode);
+
+  LOG_INFO("DefaultOdomChassisController: Driving to pose {" +
+           std::to_string(target.x.convert(meter)) + ", " +
+           std::to_string(target.y.convert(meter)) + "} meters, " +
+           std::to_string(iangle.convert(degree)) + " degrees");
+  driveCurved(target, iangle, ibackwards, ilead);
+}
+
+void DefaultOdomChassisController::driveCurved(const Point &itarget,
+                                               const std::optional<QAngle> &iangle,
+                                               const bool ibackwards,
+                                               const double ilead) {
+  // Stop the internal controller so it doesn't fight us for the model
+  controller->stop();
+  auto chassisModel = controller->getModel();
+
+  IterativePosPIDController distancePid(poseDistanceGains, timeUtil);
+  IterativePosPIDController turnPid(poseTurnGains, timeUtil);
+  distancePid.setTarget(0);
+  turnPid.setTarget(0);
+
+  auto rate = timeUtil.getRate();
+  auto timer = timeUtil.getTimer();
+  timer->placeHardMark();
+  bool wasWithin = false;
+
+  const double targetX = itarget.x.convert(meter);
+  const double targetY = itarget.y.convert(meter);
+  const double direction = ibackwards ? -1 : 1;
+  const double flip = ibackwards ? pi : 0;
+
+  auto constrain = [](const double iradians) { return std::remainder(iradians, 2 * pi); };
+
+  while (true) {
+    const auto state = odom->getState(StateMode::FRAME_TRANSFORMATION);
+    const double x = state.x.convert(meter);
+    const double y = state.y.convert(meter);
+    const double theta = state.theta.convert(radian);
+
+    const double distance = std::hypot(targetX - x, targetY - y);
+    const double headingError = iangle ? constrain(iangle->convert(radian) - theta) : 0;
+
+    const bool within =
+      distance < poseExitConditions.distance.convert(meter) &&
+      (!iangle || std::abs(headingError) < poseExitConditions.angle.convert(radian));
+    if (within && !wasWithin) {
+      timer->placeMark();
+    }
+    wasWithin = within;
+
+    if (within && timer->getDtFromMark() >= poseExitConditions.settleTime) {
+      break;
+    }
+
+    if (poseExitConditions.timeout > 0_ms &&
+        timer->getDtFromHardMark() >= poseExitConditions.timeout) {
+      LOG_WARN("DefaultOdomChassisController: Timed out " + std::to_string(distance) +
+               " meters from the target.");
+      break;
+    }
+
+    // The carrot starts behind the target along the target heading and slides onto the target as
+    // the robot gets closer, which bends the path so the robot arrives at the target heading
+    double carrotX = targetX;
+    double carrotY = targetY;
+    if (iangle) {
+      carrotX -= direction * ilead * distance * std::cos(iangle->convert(radian));
+      carrotY -= direction * ilead * distance * std::sin(iangle->convert(radian));
+    }
+
+    const double targetAngle = constrain(std::atan2(targetY - y, targetX - x) - theta + flip);
+    const double carrotAngle = constrain(std::atan2(carrotY - y, carrotX - x) - theta + flip);
+
+    // Only the part of the distance along the robot's heading is driven, so the robot slows down
+    // when it is facing away from the target instead of orbiting it
+    const double linearError = direction * distance * std::cos(targetAngle);
+    const double angularError = distance < poseCloseDistance ? headingError : carrotAngle;
+
+    chassisModel->driveVector(distancePid.step(-linearError), turnPid.step(-angularError));
+
+    rate->delayUntil(10_ms);
+  }
+
+  chassisModel->stop();
+}
+
 void DefaultOdomChassisController::turnToPoint(const Point &ipoint) {
   waitForOdomTask();
 
@@ -98,6 +220,26 @@ void DefaultOdomChassisController::turnToAngle(const QAngle &iangle) {
   }
 }
 
+void DefaultOdomChassisController::setPointMotion(const PointMotion imotion) {
+  pointMotion = imotion;
+}
+
+DefaultOdomChassisController::PointMotion DefaultOdomChassisController::getPointMotion() const {
+  return pointMotion;
+}
+
+void DefaultOdomChassisController::setPoseGains(
+  const IterativePosPIDController::Gains &idistanceGains,
+  const IterativePosPIDController::Gains &iturnGains) {
+  poseDistanceGains = idistanceGains;
+  poseTurnGains = iturnGains;
+}
+
+void DefaultOdomChassisController::setPoseExitConditions(
+  const PoseExitConditions &iexitConditions) {
+  poseExitConditions = iexitConditions;
+}
+
 void DefaultOdomChassisController::moveDistance(QLength itarget) {
   controller->moveDistance(itarget);
 }
@@ -4,6 +4,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "okapi/api/chassis/controller/odomChassisController.hpp"
+#include <stdexcept>
 
 namespace okapi {
 OdomChassisController::OdomChassisController(TimeUtil itimeUtil,
@@ -25,6 +26,15 @@ OdomChassisController::~OdomChassisController() {
   delete odomTask;
 }
 
+void OdomChassisController::driveToPose(const Point &,
+                                        const QAngle &,
+                                        const bool,
+                                        const double) {
+  std::string msg("OdomChassisController: driveToPose() is not supported by this controller.");
+  LOG_ERROR(msg);
+  throw std::runtime_error(msg);
+}
+
 OdomState OdomChassisController::getState() const {
   return odom->getState(defaultStateMode);
 }
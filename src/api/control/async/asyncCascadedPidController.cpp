@@ -0,0 +1,105 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncCascadedPidController.hpp"
+
+namespace okapi {
+AsyncCascadedPIDController::AsyncCascadedPIDController(
+  const std::shared_ptr<ControllerInput<double>> &iinput,
+  const std::shared_ptr<ControllerOutput<double>> &ioutput,
+  const TimeUtil &itimeUtil,
+  const IterativePosPIDController::Gains &iouterGains,
+  const IterativeVelPIDController::Gains &iinnerGains,
+  std::unique_ptr<VelMath> ivelMath,
+  const double imaxVelocity,
+  const QTime iouterSampleTime,
+  const QTime iinnerSampleTime,
+  const double iratio,
+  const std::shared_ptr<Logger> &ilogger)
+  : AsyncCascadedPIDController(std::make_shared<OffsetableControllerInput>(iinput),
+                               ioutput,
+                               itimeUtil,
+                               iouterGains,
+                               iinnerGains,
+                               std::move(ivelMath),
+                               imaxVelocity,
+                               iouterSampleTime,
+                               iinnerSampleTime,
+                               iratio,
+                               ilogger) {
+}
+
+AsyncCascadedPIDController::AsyncCascadedPIDController(
+  const std::shared_ptr<OffsetableControllerInput> &iinput,
+  const std::shared_ptr<ControllerOutput<double>> &ioutput,
+  const TimeUtil &itimeUtil,
+  const IterativePosPIDController::Gains &iouterGains,
+  const IterativeVelPIDController::Gains &iinnerGains,
+  std::unique_ptr<VelMath> ivelMath,
+  const double imaxVelocity,
+  const QTime iouterSampleTime,
+  const QTime iinnerSampleTime,
+  const double iratio,
+  const std::shared_ptr<Logger> &ilogger)
+  : AsyncWrapper<double, double>(iinput,
+                                 ioutput,
+                                 makeController(itimeUtil,
+                                                iouterGains,
+                                                iinnerGains,
+                                                std::move(ivelMath),
+                                                imaxVelocity,
+                                                iouterSampleTime,
+                                                iinnerSampleTime,
+                                                ilogger),
+                                 itimeUtil.getRateSupplier(),
+                                 iratio,
+                                 ilogger),
+    offsettableInput(iinput),
+    internalController(std::static_pointer_cast<IterativeCascadedPIDController>(controller)) {
+}
+
+void AsyncCascadedPIDController::tarePosition() {
+  offsettableInput->tarePosition();
+}
+
+void AsyncCascadedPIDController::setMaxVelocity(const std::int32_t imaxVelocity) {
+  internalController->setMaxVelocity(imaxVelocity);
+}
+
+void AsyncCascadedPIDController::setOuterGains(const IterativePosPIDController::Gains &igains) {
+  internalController->getOuterController()->setGains(igains);
+}
+
+IterativePosPIDController::Gains AsyncCascadedPIDController::getOuterGains() const {
+  return internalController->getOuterController()->getGains();
+}
+
+void AsyncCascadedPIDController::setInnerGains(const IterativeVelPIDController::Gains &igains) {
+  internalController->getInnerController()->setGains(igains);
+}
+
+IterativeVelPIDController::Gains AsyncCascadedPIDController::getInnerGains() const {
+  return internalController->getInnerController()->getGains();
+}
+
+std::shared_ptr<IterativeCascadedPIDController>
+AsyncCascadedPIDController::makeController(const TimeUtil &itimeUtil,
+                                           const IterativePosPIDController::Gains &iouterGains,
+                                           const IterativeVelPIDController::Gains &iinnerGains,
+                                           std::unique_ptr<VelMath> ivelMath,
+                                           const double imaxVelocity,
+                                           const QTime iouterSampleTime,
+                                           const QTime iinnerSampleTime,
+                                           const std::shared_ptr<Logger> &ilogger) {
+  auto outer = std::make_shared<IterativePosPIDController>(iouterGains, itimeUtil);
+  outer->setSampleTime(iouterSampleTime);
+
+  auto inner =
+    std::make_shared<IterativeVelPIDController>(iinnerGains, std::move(ivelMath), itimeUtil);
+  inner->setSampleTime(iinnerSampleTime);
+
+  return std::make_shared<IterativeCascadedPIDController>(outer, inner, imaxVelocity, ilogger);
+}
+} // namespace okapi
@@ -0,0 +1,486 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncHolonomicMotionProfileController.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace okapi {
+AsyncHolonomicMotionProfileController::AsyncHolonomicMotionProfileController(
+  const TimeUtil &itimeUtil,
+  const PathfinderLimits &ilimits,
+  const std::shared_ptr<ChassisModel> &imodel,
+  const ChassisScales &iscales,
+  const AbstractMotor::GearsetRatioPair &ipair,
+  const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    limits(ilimits),
+    model(imodel),
+    xModel(std::dynamic_pointer_cast<XDriveModel>(imodel)),
+    hModel(std::dynamic_pointer_cast<HDriveModel>(imodel)),
+    scales(iscales),
+    pair(ipair),
+    timeUtil(itimeUtil),
+    trajectoryGenerator(std::make_shared<TrajectoryGenerator>()) {
+  if (ipair.ratio == 0) {
+    std::string msg(
+      "AsyncHolonomicMotionProfileController: The gear ratio cannot be zero! Check if you are "
+      "using integer division.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  if (!xModel && !hModel) {
+    std::string msg("AsyncHolonomicMotionProfileController: The model must be an XDriveModel or "
+                    "an HDriveModel.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+}
+
+AsyncHolonomicMotionProfileController::~AsyncHolonomicMotionProfileController() {
+  // Stop following the path so the task can be joined before the paths are freed
+  dtorCalled.store(true, std::memory_order_release);
+  disabled.store(true, std::memory_order_release);
+  delete task;
+  task = nullptr;
+}
+
+void AsyncHolonomicMotionProfileController::generatePath(
+  std::initializer_list<PathfinderPoint> iwaypoints,
+  const std::string &ipathId) {
+  generatePath(iwaypoints, ipathId, limits);
+}
+
+void AsyncHolonomicMotionProfileController::generatePath(
+  std::initializer_list<PathfinderPoint> iwaypoints,
+  const std::string &ipathId,
+  const PathfinderLimits &ilimits) {
+  if (iwaypoints.size() == 0) {
+    // No point in generating a path
+    LOG_WARN_S("AsyncHolonomicMotionProfileController: Not generating a path because no "
+               "waypoints were given.");
+    return;
+  }
+
+  auto path = std::make_shared<const std::vector<HolonomicSegment>>(
+    generateSegments(iwaypoints, ipathId, ilimits));
+  const auto length = path->size();
+
+  {
+    // Anything following the old path holds its own reference to it, so it can be replaced here
+    std::scoped_lock lock(pathsMutex);
+    paths.insert_or_assign(ipathId, std::move(path));
+  }
+
+  LOG_INFO("AsyncHolonomicMotionProfileController: Completely done generating path " + ipathId);
+  LOG_DEBUG("AsyncHolonomicMotionProfileController: Path length: " + std::to_string(length));
+}
+
+std::vector<AsyncHolonomicMotionProfileController::HolonomicSegment>
+AsyncHolonomicMotionProfileController::generateSegments(
+  const std::vector<PathfinderPoint> &iwaypoints,
+  const std::string &ipathId,
+  const PathfinderLimits &ilimits) const {
+  const std::size_t count = iwaypoints.size();
+
+  // The thetas of the waypoints are headings of the robot, so the path of the center of the robot
+  // is generated with the direction of travel through each waypoint instead
+  std::vector<PathfinderPoint> travel;
+  travel.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto &before = iwaypoints[i == 0 ? 0 : i - 1];
+    const auto &after = iwaypoints[std::min(i + 1, count - 1)];
+    const double dx = (after.x - before.x).convert(meter);
+    const double dy = (after.y - before.y).convert(meter);
+    travel.push_back(
+      PathfinderPoint{iwaypoints[i].x, iwaypoints[i].y, std::atan2(dy, dx) * radian});
+  }
+
+  LOG_INFO_S("AsyncHolonomicMotionProfileController: Generating path with TrajectoryGenerator");
+
+  std::vector<Segment> center;
+  try {
+    center = trajectoryGenerator->generate(travel, ilimits);
+  } catch (const std::invalid_argument &e) {
+    std::string message = "AsyncHolonomicMotionProfileController: The path (id " + ipathId +
+                          ") is impossible: " + e.what();
+
+    LOG_ERROR(message);
+    throw std::runtime_error(message);
+  }
+
+  const std::size_t length = center.size();
+
+  // The path passes within one step of each waypoint, so each waypoint is at the first local
+  // minimum of the distance to it which is that close
+  double maxStep = 0;
+  for (std::size_t i = 1; i < length; ++i) {
+    maxStep = std::max(
+      maxStep, std::hypot(center[i].x - center[i - 1].x, center[i].y - center[i - 1].y));
+  }
+
+  std::vector<std::size_t> waypointIndices{0};
+  for (std::size_t k = 1; k + 1 < count; ++k) {
+    const double x = iwaypoints[k].x.convert(meter);
+    const double y = iwaypoints[k].y.convert(meter);
+    auto distance = [&](const std::size_t i) {
+      return std::hypot(center[i].x - x, center[i].y - y);
+    };
+
+    std::size_t i = waypointIndices.back();
+    while (i + 1 < length && distance(i) > maxStep) {
+      ++i;
+    }
+
+    while (i + 1 < length && distance(i + 1) < distance(i)) {
+      ++i;
+    }
+
+    waypointIndices.push_back(i);
+  }
+  waypointIndices.push_back(length - 1);
+
+  std::vector<HolonomicSegment> path;
+  path.reserve(length);
+
+  std::size_t span = 0;
+  for (std::size_t i = 0; i < length; ++i) {
+    while (span + 2 < waypointIndices.size() && i > waypointIndices[span + 1]) {
+      ++span;
+    }
+
+    const auto &start = center[waypointIndices[span]];
+    const auto &end = center[waypointIndices[span + 1]];
+    const double startTheta = iwaypoints[span].theta.convert(radian);
+    const double turn =
+      std::remainder(iwaypoints[span + 1].theta.convert(radian) - startTheta, 2 * pi);
+    const double spanLength = end.position - start.position;
+
+    // The heading follows a cosine blend between the waypoints so the robot starts and stops
+    // turning smoothly. The span has no length if two waypoints matched the same segment.
+    double theta = startTheta + turn;
+    double omega = 0;
+    if (spanLength > 0) {
+      const double u = std::clamp((center[i].position - start.position) / spanLength, 0.0, 1.0);
+      theta = startTheta + turn * (1 - std::cos(pi * u)) / 2;
+      omega = turn * pi / 2 * std::sin(pi * u) * center[i].velocity / spanLength;
+    }
+
+    HolonomicSegment segment{center[i].x,
+                             center[i].y,
+                             theta,
+                             center[i].velocity * std::cos(center[i].heading),
+                             center[i].velocity * std::sin(center[i].heading),
+                             omega,
+                             center[i].dt};
+
+    // Slow down the segment if a wheel can't keep up. Stretching the segment by the same amount
+    // keeps the robot on the path.
+    const double forward = std::cos(theta) * segment.vx + std::sin(theta) * segment.vy;
+    const double left = -std::sin(theta) * segment.vx + std::cos(theta) * segment.vy;
+    const double peak = std::abs(getWheelSpeeds(forward, left, omega)).max();
+    if (peak > 1) {
+      segment.vx /= peak;
+      segment.vy /= peak;
+      segment.omega /= peak;
+      segment.dt *= peak;
+    }
+
+    path.push_back(segment);
+  }
+
+  return path;
+}
+
+bool AsyncHolonomicMotionProfileController::removePath(const std::string &ipathId) {
+  std::scoped_lock lock(pathsMutex);
+
+  // A running path is pinned by loop(), so it is only freed once it finishes
+  paths.erase(ipathId);
+
+  /*
+   * A return value of true provides no feedback about whether the
+   * path was actually removed but instead tells us that the path
+   * does not exist at this moment
+   */
+  return true;
+}
+
+std::vector<std::string> AsyncHolonomicMotionProfileController::getPaths() {
+  std::scoped_lock lock(pathsMutex);
+
+  std::vector<std::string> keys;
+  for (const auto &path : paths) {
+    keys.push_back(path.first);
+  }
+
+  return keys;
+}
+
+void AsyncHolonomicMotionProfileController::setTarget(std::string ipathId) {
+  LOG_INFO("AsyncHolonomicMotionProfileController: Set target to: " + ipathId);
+
+  {
+    std::scoped_lock lock(pathsMutex);
+    currentPath = ipathId;
+  }
+
+  isRunning.store(true, std::memory_order_release);
+}
+
+void AsyncHolonomicMotionProfileController::controllerSet(const std::string ivalue) {
+  setTarget(ivalue);
+}
+
+std::string AsyncHolonomicMotionProfileController::getTarget() {
+  std::scoped_lock lock(pathsMutex);
+  return currentPath;
+}
+
+std::string AsyncHolonomicMotionProfileController::getTarget() const {
+  std::scoped_lock lock(pathsMutex);
+  return currentPath;
+}
+
+std::string AsyncHolonomicMotionProfileController::getProcessValue() const {
+  std::scoped_lock lock(pathsMutex);
+  return currentPath;
+}
+
+void AsyncHolonomicMotionProfileController::loop() {
+  LOG_INFO_S("Started AsyncHolonomicMotionProfileController task.");
+
+  auto rate = timeUtil.getRate();
+
+  while (!dtorCalled.load(std::memory_order_acquire) && !task->notifyTake(0)) {
+    if (isRunning.load(std::memory_order_acquire) && !isDisabled()) {
+      const std::string target = getTarget();
+      LOG_INFO("AsyncHolonomicMotionProfileController: Running with path: " + target);
+
+      // Pin the path for the whole run so it can't be freed while it is being followed
+      const auto path = getPath(target);
+      if (!path) {
+        LOG_WARN("AsyncHolonomicMotionProfileController: Target was set to non-existent path "
+                 "with name: " +
+                 target);
+      } else {
+        LOG_DEBUG("AsyncHolonomicMotionProfileController: Path length is " +
+                  std::to_string(path->size()));
+
+        {
+          std::scoped_lock lock(pathsMutex);
+          runningPath = path;
+        }
+
+        executeSinglePath(*path, timeUtil.getRate());
+
+        {
+          std::scoped_lock lock(pathsMutex);
+          runningPath = nullptr;
+          currentSegment = nullptr;
+        }
+
+        // Stop after the path because:
+        // 1. We only support an exit velocity of zero
+        // 2. Because of (1), we should make sure the system is stopped
+        model->stop();
+
+        LOG_INFO_S("AsyncHolonomicMotionProfileController: Done moving");
+      }
+
+      isRunning.store(false, std::memory_order_release);
+    }
+
+    rate->delayUntil(10_ms);
+  }
+
+  LOG_INFO_S("Stopped AsyncHolonomicMotionProfileController task.");
+}
+
+void AsyncHolonomicMotionProfileController::executeSinglePath(
+  const std::vector<HolonomicSegment> &path,
+  std::unique_ptr<AbstractRate> rate) {
+  for (std::size_t i = 0; i < path.size() && !isDisabled(); ++i) {
+    const auto &segment = path[i];
+
+    {
+      std::scoped_lock lock(pathsMutex);
+      currentSegment = &segment;
+    }
+
+    // Rotate the velocity of the path into the frame of the robot
+    const double cosTheta = std::cos(segment.theta);
+    const double sinTheta = std::sin(segment.theta);
+    const double forward = cosTheta * segment.vx + sinTheta * segment.vy;
+    const double left = -sinTheta * segment.vx + cosTheta * segment.vy;
+    setWheelSpeeds(getWheelSpeeds(forward, left, segment.omega));
+
+    rate->delayUntil(segment.dt * second);
+  }
+}
+
+std::valarray<double> AsyncHolonomicMotionProfileController::getWheelSpeeds(
+  const double iforward,
+  const double ileft,
+  const double iangular) const {
+  const double gearset = toUnderlyingType(pair.internalGearset);
+  auto toMotor = [&](const double ilinear) {
+    return convertLinearToRotational(ilinear * mps).convert(rpm) / gearset;
+  };
+
+  // The sides move in opposite directions to turn the robot
+  const double turn = iangular * scales.wheelTrack.convert(meter) / 2;
+
+  if (xModel) {
+    return {toMotor(iforward - ileft - turn),
+            toMotor(iforward + ileft + turn),
+            toMotor(iforward - ileft + turn),
+            toMotor(iforward + ileft - turn)};
+  }
+
+  return {toMotor(iforward - turn), toMotor(iforward + turn), toMotor(-ileft)};
+}
+
+void AsyncHolonomicMotionProfileController::setWheelSpeeds(const std::valarray<double> &ispeeds) {
+  if (xModel) {
+    const double maxVelocity = xModel->getMaxVelocity();
+    auto write = [&](const std::shared_ptr<AbstractMotor> &imotor, const double ispeed) {
+      imotor->moveVelocity(static_cast<std::int16_t>(std::clamp(ispeed, -1.0, 1.0) * maxVelocity));
+    };
+
+    write(xModel->getTopLeftMotor(), ispeeds[0]);
+    write(xModel->getTopRightMotor(), ispeeds[1]);
+    write(xModel->getBottomRightMotor(), ispeeds[2]);
+    write(xModel->getBottomLeftMotor(), ispeeds[3]);
+  } else {
+    hModel->left(ispeeds[0]);
+    hModel->right(ispeeds[1]);
+    hModel->middle(ispeeds[2]);
+  }
+}
+
+QAngularSpeed
+AsyncHolonomicMotionProfileController::convertLinearToRotational(QSpeed linear) const {
+  return (linear * (360_deg / (scales.wheelDiameter * 1_pi))) * pair.ratio;
+}
+
+void AsyncHolonomicMotionProfileController::trampoline(void *context) {
+  if (context) {
+    static_cast<AsyncHolonomicMotionProfileController *>(context)->loop();
+  }
+}
+
+void AsyncHolonomicMotionProfileController::waitUntilSettled() {
+  LOG_INFO_S("AsyncHolonomicMotionProfileController: Waiting to settle");
+
+  auto rate = timeUtil.getRate();
+  while (!isSettled()) {
+    rate->delayUntil(10_ms);
+  }
+
+  LOG_INFO_S("AsyncHolonomicMotionProfileController: Done waiting to settle");
+}
+
+void AsyncHolonomicMotionProfileController::moveTo(
+  std::initializer_list<PathfinderPoint> iwaypoints) {
+  moveTo(iwaypoints, limits);
+}
+
+void AsyncHolonomicMotionProfileController::moveTo(
+  std::initializer_list<PathfinderPoint> iwaypoints,
+  const PathfinderLimits &ilimits) {
+  static int moveToCount = 0;
+  std::string name = "__moveTo" + std::to_string(moveToCount++);
+  generatePath(iwaypoints, name, ilimits);
+  setTarget(name);
+  waitUntilSettled();
+  if (!removePath(name)) {
+    // Failed to remove path (Warn and move on)
+    LOG_WARN_S("AsyncHolonomicMotionProfileController: Couldn't remove path after moveTo");
+  }
+}
+
+PathfinderPoint AsyncHolonomicMotionProfileController::getError() const {
+  std::scoped_lock lock(pathsMutex);
+
+  if (!runningPath || currentSegment == nullptr) {
+    return PathfinderPoint{0_m, 0_m, 0_deg};
+  }
+
+  // The last segment in the path is the target
+  const auto &end = runningPath->back();
+  return PathfinderPoint{(end.x - currentSegment->x) * meter,
+                         (end.y - currentSegment->y) * meter,
+                         (end.theta - currentSegment->theta) * radian};
+}
+
+bool AsyncHolonomicMotionProfileController::isSettled() {
+  return isDisabled() || !isRunning.load(std::memory_order_acquire);
+}
+
+void AsyncHolonomicMotionProfileController::reset() {
+  // Interrupt executeSinglePath() by disabling the controller
+  flipDisable(true);
+
+  LOG_INFO_S("AsyncHolonomicMotionProfileController: Waiting to reset");
+
+  auto rate = timeUtil.getRate();
+  while (isRunning.load(std::memory_order_acquire)) {
+    rate->delayUntil(1_ms);
+  }
+
+  flipDisable(false);
+}
+
+void AsyncHolonomicMotionProfileController::flipDisable() {
+  flipDisable(!disabled.load(std::memory_order_acquire));
+}
+
+void AsyncHolonomicMotionProfileController::flipDisable(const bool iisDisabled) {
+  LOG_INFO("AsyncHolonomicMotionProfileController: flipDisable " + std::to_string(iisDisabled));
+  disabled.store(iisDisabled, std::memory_order_release);
+  // loop() will stop the model when executeSinglePath() is done
+  // the default implementation of executeSinglePath() breaks when disabled
+}
+
+bool AsyncHolonomicMotionProfileController::isDisabled() const {
+  return disabled.load(std::memory_order_acquire);
+}
+
+void AsyncHolonomicMotionProfileController::setTrajectoryGenerator(
+  const std::shared_ptr<const TrajectoryGenerator> &igenerator) {
+  trajectoryGenerator = igenerator ? igenerator : std::make_shared<TrajectoryGenerator>();
+}
+
+void AsyncHolonomicMotionProfileController::startThread() {
+  if (!task) {
+    task = new CrossplatformThread(trampoline, this, "AsyncHolonomicMotionProfileController");
+  }
+}
+
+CrossplatformThread *AsyncHolonomicMotionProfileController::getThread() const {
+  return task;
+}
+
+void AsyncHolonomicMotionProfileController::tarePosition() {
+}
+
+void AsyncHolonomicMotionProfileController::setMaxVelocity(std::int32_t) {
+}
+
+void AsyncHolonomicMotionProfileController::forceRemovePath(const std::string &ipathId) {
+  removePath(ipathId);
+}
+
+AsyncHolonomicMotionProfileController::PathPtr
+AsyncHolonomicMotionProfileController::getPath(const std::string &ipathId) const {
+  std::scoped_lock lock(pathsMutex);
+  auto path = paths.find(ipathId);
+  return path == paths.end() ? nullptr : path->second;
+}
+} // namespace okapi
@@ -5,6 +5,8 @@
  */
 #include "okapi/api/control/async/asyncLinearMotionProfileController.hpp"
 #include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
 #include <mutex>
 #include <numeric>
 
@@ -32,13 +34,12 @@ AsyncLinearMotionProfileController::AsyncLinearMotionProfileController(
 }
 
 AsyncLinearMotionProfileController::~AsyncLinearMotionProfileController() {
+  // Stop following the path so the task can be joined. The task may need currentPathMutex to
+  // finish, so it must not be held here.
   dtorCalled.store(true, std::memory_order_release);
-
-  // Free paths before deleting the task
-  std::scoped_lock lock(currentPathMutex);
-  paths.clear();
-
+  disabled.store(true, std::memory_order_release);
   delete task;
+  task = nullptr;
 }
 
 void AsyncLinearMotionProfileController::generatePath(std::initializer_list<QLength> iwaypoints,
@@ -49,13 +50,87 @@ void AsyncLinearMotionProfileController::generatePath(std::initializer_list<QLen
 void AsyncLinearMotionProfileController::generatePath(std::initializer_list<QLength> iwaypoints,
                                                       const std::string &ipathId,
                                                       const PathfinderLimits &ilimits) {
-  if (iwaypoints.size() == 0) {
+  internalGeneratePath(iwaypoints, ipathId, ilimits);
+}
+
+std::vector<PathGenerationResult>
+AsyncLinearMotionProfileController::generatePaths(const std::vector<PathSpec> &ispecs,
+                                                  const std::size_t iworkers) {
+  std::vector<std::string> pathIds;
+  pathIds.reserve(ispecs.size());
+  for (const auto &spec : ispecs) {
+    pathIds.push_back(spec.pathId);
+  }
+
+  PathGenerationBatch batch(
+    std::move(pathIds),
+    [&](const std::size_t i) {
+      const auto &spec = ispecs[i];
+      if (spec.waypoints.empty()) {
+        std::string msg("AsyncLinearMotionProfileController: Not generating path " + spec.pathId +
+                        " because no waypoints were given.");
+        LOG_WARN(msg);
+        throw std::invalid_argument(msg);
+      }
+
+      internalGeneratePath(spec.waypoints, spec.pathId, spec.limits.value_or(limits));
+    },
+    timeUtil,
+    logger);
+
+  return batch.run(iworkers);
+}
+
+void AsyncLinearMotionProfileController::internalGeneratePath(
+  const std::vector<QLength> &iwaypoints,
+  const std::string &ipathId,
+  const PathfinderLimits &ilimits) {
+  if (iwaypoints.empty()) {
     // No point in generating a path
     LOG_WARN_S("AsyncLinearMotionProfileController: Not generating a path because no "
                "waypoints were given.");
     return;
   }
 
+  if (closedFormShape) {
+    generateClosedFormPath(iwaypoints.front(), iwaypoints.back(), ipathId, ilimits);
+    return;
+  }
+
+  if (trajectoryGenerator) {
+    std::vector<PathfinderPoint> points;
+    points.reserve(iwaypoints.size());
+    for (auto &point : iwaypoints) {
+      points.push_back(PathfinderPoint{point, 0_m, 0_deg});
+    }
+
+    LOG_INFO_S("AsyncLinearMotionProfileController: Generating path with TrajectoryGenerator");
+
+    std::vector<Segment> trajectory;
+    try {
+      trajectory = trajectoryGenerator->generate(points, ilimits);
+    } catch (const std::invalid_argument &e) {
+      std::string message = "AsyncLinearMotionProfileController: The path (id " + ipathId +
+                            ") is impossible: " + e.what();
+
+      LOG_ERROR(message);
+      throw std::runtime_error(message);
+    }
+
+    const int length = static_cast<int>(trajectory.size());
+
+    savePath(ipathId,
+             TrajectoryPair{
+               CompactTrajectory(trajectory.data(), length, storagePrecision, storageRetainsPose),
+               length,
+               iwaypoints.front().convert(meter),
+               std::nullopt});
+
+    LOG_INFO("AsyncLinearMotionProfileController: Completely done generating path " + ipathId);
+    LOG_DEBUG("AsyncLinearMotionProfileController: Path length: " + std::to_string(length));
+    return;
+  }
+
   std::vector<Waypoint> points;
   points.reserve(iwaypoints.size());
   for (auto &point : iwaypoints) {
@@ -110,15 +185,64 @@ void AsyncLinearMotionProfileController::generatePath(std::initializer_list<QLen
 
   pathfinder_generate(candidate.get(), trajectory.get());
 
-  // Free the old path before overwriting it
-  forceRemovePath(ipathId);
-
-  paths.emplace(ipathId, TrajectoryPair{std::move(trajectory), length});
+  savePath(ipathId,
+           TrajectoryPair{
+             CompactTrajectory(trajectory.get(), length, storagePrecision, storageRetainsPose),
+             length,
+             iwaypoints.front().convert(meter),
+             std::nullopt});
 
   LOG_INFO("AsyncLinearMotionProfileController: Completely done generating path " + ipathId);
   LOG_DEBUG("AsyncLinearMotionProfileController: Path length: " + std::to_string(length));
 }
 
+void AsyncLinearMotionProfileController::generateClosedFormPath(const QLength istart,
+                                                                const QLength iend,
+                                                                const std::string &ipathId,
+                                                                const PathfinderLimits &ilimits) {
+  LOG_INFO_S("AsyncLinearMotionProfileController: Generating closed-form profile");
+
+  std::optional<SCurveProfile> profile;
+  try {
+    profile.emplace((iend - istart).convert(meter), ilimits, *closedFormShape);
+  } catch (const std::invalid_argument &e) {
+    std::string message = "AsyncLinearMotionProfileController: The path (id " + ipathId +
+                          ") is impossible: " + e.what();
+
+    LOG_ERROR(message);
+    throw std::runtime_error(message);
+  }
+
+  const double duration = profile->getDuration();
+
+  if (closedFormLazy) {
+    savePath(ipathId,
+             TrajectoryPair{CompactTrajectory(), 0, istart.convert(meter), std::move(profile)});
+  } else {
+    const auto trajectory = profile->getSegments(closedFormDt * second);
+    const int length = static_cast<int>(trajectory.size());
+    savePath(ipathId,
+             TrajectoryPair{
+               CompactTrajectory(trajectory.data(), length, storagePrecision, storageRetainsPose),
+               length,
+               istart.convert(meter),
+               std::nullopt});
+  }
+
+  LOG_INFO("AsyncLinearMotionProfileController: Completely done generating path " + ipathId);
+  LOG_DEBUG("AsyncLinearMotionProfileController: Profile duration: " +
+            std::to_string(duration));
+}
+
+void AsyncLinearMotionProfileController::savePath(const std::string &ipathId,
+                                                  TrajectoryPair &&ipath) {
+  auto path = std::make_shared<const TrajectoryPair>(std::move(ipath));
+
+  // Anything following the old path holds its own reference to it, so it can be replaced here
+  std::scoped_lock lock(currentPathMutex);
+  paths.insert_or_assign(ipathId, std::move(path));
+}
+
 std::string
 AsyncLinearMotionProfileController::getPathErrorMessage(const std::vector<Waypoint> &points,
                                                         const std::string &ipathId,
@@ -137,18 +261,10 @@ AsyncLinearMotionProfileController::getPathErrorMessage(const std::vector<Waypoi
 }
 
 bool AsyncLinearMotionProfileController::removePath(const std::string &ipathId) {
-  if (!isDisabled() && isRunning.load(std::memory_order_acquire) && getTarget() == ipathId) {
-    LOG_WARN("AsyncLinearMotionProfileController: Attempted to remove currently running path " +
-             ipathId);
-    return false;
-  }
-
   std::scoped_lock lock(currentPathMutex);
 
-  auto oldPath = paths.find(ipathId);
-  if (oldPath != paths.end()) {
-    paths.erase(ipathId);
-  }
+  // A running path is pinned by loop(), so it is only freed once it finishes
+  paths.erase(ipathId);
 
   /*
    * A return value of true provides no feedback about whether the
@@ -159,6 +275,8 @@ bool AsyncLinearMotionProfileController::removePath(const std::string &ipathId)
 }
 
 std::vector<std::string> AsyncLinearMotionProfileController::getPaths() {
+  std::scoped_lock lock(currentPathMutex);
+
   std::vector<std::string> keys;
 
   for (const auto &path : paths) {
@@ -176,7 +294,14 @@ void AsyncLinearMotionProfileController::setTarget(std::string ipathId, const bo
   LOG_INFO("AsyncLinearMotionProfileController: Set target to: " + ipathId + " (ibackwards" +
            std::to_string(ibackwards) + ")");
 
-  currentPath = ipathId;
+  {
+    // A retarget request which came in after the last path ended is too late for the new one
+    std::scoped_lock lock(currentPathMutex);
+    pendingRetarget.reset();
+    retargetedEnd.reset();
+    currentPath = ipathId;
+  }
+
   direction.store(boolToSign(!ibackwards), std::memory_order_release);
   isRunning.store(true, std::memory_order_release);
 }
@@ -186,14 +311,17 @@ void AsyncLinearMotionProfileController::controllerSet(const std::string ivalue)
 }
 
 std::string AsyncLinearMotionProfileController::getTarget() {
+  std::scoped_lock lock(currentPathMutex);
   return currentPath;
 }
 
 std::string AsyncLinearMotionProfileController::getTarget() const {
+  std::scoped_lock lock(currentPathMutex);
   return currentPath;
 }
 
 std::string AsyncLinearMotionProfileController::getProcessValue() const {
+  std::scoped_lock lock(currentPathMutex);
   return currentPath;
 }
 
@@ -204,19 +332,30 @@ void AsyncLinearMotionProfileController::loop() {
 
   while (!dtorCalled.load(std::memory_order_acquire) && !task->notifyTake(0)) {
     if (isRunning.load(std::memory_order_acquire) && !isDisabled()) {
-      LOG_INFO("AsyncLinearMotionProfileController: Running with path: " + currentPath);
+      const std::string target = getTarget();
+      LOG_INFO("AsyncLinearMotionProfileController: Running with path: " + target);
 
-      auto path = paths.find(currentPath);
-
-      if (path == paths.end()) {
+      // Pin the path for the whole run so it can't be freed while it is being followed
+      const auto path = getPath(target);
+      if (!path) {
         LOG_WARN(
           "AsyncLinearMotionProfileController: Target was set to non-existent path with name: " +
-          currentPath);
+          target);
       } else {
         LOG_DEBUG("AsyncLinearMotionProfileController: Path length is " +
-                  std::to_string(path->second.length));
+                  std::to_string(path->length));
+
+        {
+          std::scoped_lock lock(currentPathMutex);
+          runningPath = path;
+        }
 
-        executeSinglePath(path->second, timeUtil.getRate());
+        executeSinglePath(*path, timeUtil.getRate());
+
+        {
+          std::scoped_lock lock(currentPathMutex);
+          runningPath = nullptr;
+        }
 
         // Set 0 after the path because:
         // 1. We only support an exit velocity of zero
@@ -237,28 +376,94 @@ void AsyncLinearMotionProfileController::loop() {
 
 void AsyncLinearMotionProfileController::executeSinglePath(const TrajectoryPair &path,
                                                            std::unique_ptr<AbstractRate> rate) {
+  if (path.profile) {
+    executeProfile(*path.profile, path.origin, std::move(rate));
+    return;
+  }
+
   const auto reversed = direction.load(std::memory_order_acquire);
 
   const int pathLength = getPathLength(path);
   for (int i = 0; i < pathLength && !isDisabled(); ++i) {
-    // This mutex is used to combat an edge case of an edge case
-    // if a running path is asked to be removed at the moment this loop is executing
-    std::scoped_lock lock(currentPathMutex);
+    // Lock to take any retarget request and to publish the position for getError()
+    std::unique_lock lock(currentPathMutex);
+
+    // Re-plan from the segment which was followed last tick
+    const auto last = i > 0 ? path.segment.getSegment(i - 1) : Segment{};
+    if (auto profile =
+          takeRetarget({last.position, last.velocity, last.acceleration, 0}, path.origin)) {
+      lock.unlock();
+      executeProfile(*profile, path.origin, std::move(rate));
+      return;
+    }
 
-    const auto segDT = path.segment.get()[i].dt * second;
-    currentProfilePosition = path.segment.get()[i].position;
+    const auto segDT = path.segment.getDt(i) * second;
+    currentProfilePosition = path.segment.getPosition(i);
 
-    const auto motorRPM =
-      convertLinearToRotational(path.segment.get()[i].velocity * mps).convert(rpm);
+    const auto motorRPM = convertLinearToRotational(path.segment.getVelocity(i) * mps).convert(rpm);
     output->controllerSet(motorRPM / toUnderlyingType(pair.internalGearset) * reversed);
 
     // Unlock before the delay to be nice to other tasks
-    currentPathMutex.unlock();
+    lock.unlock();
 
     rate->delayUntil(segDT);
   }
 }
 
+void AsyncLinearMotionProfileController::executeProfile(const SCurveProfile &iprofile,
+                                                        const double iorigin,
+                                                        std::unique_ptr<AbstractRate> rate) {
+  const auto reversed = direction.load(std::memory_order_acquire);
+
+  SCurveProfile profile(iprofile);
+  auto state = profile.getState(0);
+  for (int i = 1; !isDisabled(); ++i) {
+    std::unique_lock lock(currentPathMutex);
+
+    // Re-plan from the state which was followed last tick so the velocity does not jump
+    if (auto replanned = takeRetarget(state, iorigin)) {
+      profile = *replanned;
+      i = 1;
+    }
+
+    const double time = std::min(i * closedFormDt, profile.getDuration());
+    state = profile.getState(time);
+    currentProfilePosition = state.position;
+
+    const auto motorRPM = convertLinearToRotational(state.velocity * mps).convert(rpm);
+    output->controllerSet(motorRPM / toUnderlyingType(pair.internalGearset) * reversed);
+
+    // Unlock before the delay to be nice to other tasks
+    lock.unlock();
+
+    rate->delayUntil(closedFormDt * second);
+
+    if (time >= profile.getDuration()) {
+      break;
+    }
+  }
+}
+
+std::optional<SCurveProfile>
+AsyncLinearMotionProfileController::takeRetarget(const SCurveProfile::State &istate,
+                                                 const double iorigin) {
+  if (!pendingRetarget) {
+    return std::nullopt;
+  }
+
+  const auto request = *pendingRetarget;
+  pendingRetarget.reset();
+
+  SCurveProfile profile(istate, request.target - iorigin, request.limits, request.shape);
+  retargetedEnd = profile.getDistance();
+
+  LOG_INFO("AsyncLinearMotionProfileController: Re-planned to " + std::to_string(request.target) +
+           " m from " + std::to_string(istate.position + iorigin) + " m at " +
+           std::to_string(istate.velocity) + " m/s");
+
+  return profile;
+}
+
 int AsyncLinearMotionProfileController::getPathLength(const TrajectoryPair &path) {
   std::scoped_lock lock(currentPathMutex);
   return path.length;
@@ -306,13 +511,57 @@ void AsyncLinearMotionProfileController::moveTo(const QLength &iposition,
   }
 }
 
+bool AsyncLinearMotionProfileController::retarget(const QLength &itarget) {
+  return retarget(itarget, limits);
+}
+
+bool AsyncLinearMotionProfileController::retarget(const QLength &itarget,
+                                                  const PathfinderLimits &ilimits) {
+  const auto shape = closedFormShape.value_or(SCurveProfile::Shape::sCurve);
+  if (!(ilimits.maxVel > 0) || !(ilimits.maxAccel > 0) ||
+      (shape == SCurveProfile::Shape::sCurve && !(ilimits.maxJerk > 0))) {
+    std::string msg("AsyncLinearMotionProfileController: The retarget limits must be positive.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  if (isSettled()) {
+    LOG_WARN_S(
+      "AsyncLinearMotionProfileController: Not retargeting because no path is being followed");
+    return false;
+  }
+
+  LOG_INFO("AsyncLinearMotionProfileController: Retargeting to " +
+           std::to_string(itarget.convert(meter)) + " m");
+
+  std::scoped_lock lock(currentPathMutex);
+  pendingRetarget = RetargetRequest{itarget.convert(meter), ilimits, shape};
+  return true;
+}
+
 double AsyncLinearMotionProfileController::getError() const {
-  if (const auto path = paths.find(getTarget()); path == paths.end()) {
-    return 0;
-  } else {
-    // The last position in the path is the target position
-    return path->second.segment.get()[path->second.length - 1].position - currentProfilePosition;
+  std::scoped_lock lock(currentPathMutex);
+
+  // The path being followed may have been removed or replaced since it started
+  PathPtr path = runningPath;
+  if (!path) {
+    const auto saved = paths.find(currentPath);
+    if (saved == paths.end()) {
+      return 0;
+    }
+    path = saved->second;
+  }
+
+  if (retargetedEnd) {
+    return *retargetedEnd - currentProfilePosition;
   }
+
+  if (path->profile) {
+    return path->profile->getDistance() - currentProfilePosition;
+  }
+
+  // The last position in the path is the target position
+  return path->segment.getPosition(path->length - 1) - currentProfilePosition;
 }
 
 bool AsyncLinearMotionProfileController::isSettled() {
@@ -348,6 +597,28 @@ bool AsyncLinearMotionProfileController::isDisabled() const {
   return disabled.load(std::memory_order_acquire);
 }
 
+void AsyncLinearMotionProfileController::setTrajectoryStorage(
+  const CompactTrajectory::Precision iprecision,
+  const bool iretainPose) {
+  storagePrecision = iprecision;
+  storageRetainsPose = iretainPose;
+}
+
+void AsyncLinearMotionProfileController::setTrajectoryGenerator(
+  const std::shared_ptr<const TrajectoryGenerator> &igenerator) {
+  trajectoryGenerator = igenerator;
+}
+
+void AsyncLinearMotionProfileController::setClosedFormProfile(const SCurveProfile::Shape ishape,
+                                                              const bool ilazy) {
+  closedFormShape = ishape;
+  closedFormLazy = ilazy;
+}
+
+void AsyncLinearMotionProfileController::setSplineProfile() {
+  closedFormShape = std::nullopt;
+}
+
 void AsyncLinearMotionProfileController::startThread() {
   if (!task) {
     task = new CrossplatformThread(trampoline, this, "AsyncLinearMotionProfileController");
@@ -365,11 +636,14 @@ void AsyncLinearMotionProfileController::setMaxVelocity(std::int32_t) {
 }
 
 void AsyncLinearMotionProfileController::forceRemovePath(const std::string &ipathId) {
-  if (!removePath(ipathId)) {
-    LOG_WARN("AsyncLinearMotionProfileController: Disabling controller to remove path " + ipathId);
-    flipDisable(true);
-    removePath(ipathId);
-  }
+  removePath(ipathId);
+}
+
+AsyncLinearMotionProfileController::PathPtr
+AsyncLinearMotionProfileController::getPath(const std::string &ipathId) const {
+  std::scoped_lock lock(currentPathMutex);
+  auto path = paths.find(ipathId);
+  return path == paths.end() ? nullptr : path->second;
 }
 
 } // namespace okapi
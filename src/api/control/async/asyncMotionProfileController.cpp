@@ -6,9 +6,12 @@
 #include "okapi/api/control/async/asyncMotionProfileController.hpp"
 #include "okapi/api/util/mathUtil.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <mutex>
 #include <numeric>
+#include <optional>
 
 namespace okapi {
 AsyncMotionProfileController::AsyncMotionProfileController(
@@ -35,9 +38,29 @@ AsyncMotionProfileController::AsyncMotionProfileController(
 AsyncMotionProfileController::~AsyncMotionProfileController() {
   dtorCalled.store(true, std::memory_order_release);
 
-  // Free paths before deleting the task
-  std::scoped_lock lock(currentPathMutex);
-  paths.clear();
+  // Let the generation task stop on its own instead of deleting it while it could be holding a lock
+  if (generationTask) {
+    auto rate = timeUtil.getRate();
+    while (!generationStopped.load(std::memory_order_acquire)) {
+      rate->delayUntil(1_ms);
+    }
+  }
+  delete generationTask;
+
+  {
+    const std::string msg("AsyncMotionProfileController: The controller was destroyed.");
+    std::scoped_lock lock(generationMutex);
+    if (currentGeneration) {
+      currentGeneration->markFailed(msg);
+      currentGeneration = nullptr;
+    }
+
+    for (auto &request : generationQueue) {
+      request.handle->markFailed(msg);
+    }
+    generationQueue.clear();
+    pendingPaths.clear();
+  }
 
   delete task;
 }
@@ -57,6 +80,172 @@ void AsyncMotionProfileController::generatePath(std::initializer_list<Pathfinder
     return;
   }
 
+  auto path = generateTrajectory(iwaypoints, ipathId, ilimits);
+  const int length = path.length;
+  savePath(ipathId, std::move(path));
+
+  LOG_INFO("AsyncMotionProfileController: Completely done generating path " + ipathId);
+  LOG_DEBUG("AsyncMotionProfileController: Path length: " + std::to_string(length));
+}
+
+void AsyncMotionProfileController::generatePathChain(
+  std::initializer_list<std::vector<PathfinderPoint>> ilegs,
+  const std::string &ipathId) {
+  generatePathChain(ilegs, ipathId, limits);
+}
+
+void AsyncMotionProfileController::generatePathChain(
+  std::initializer_list<std::vector<PathfinderPoint>> ilegs,
+  const std::string &ipathId,
+  const PathfinderLimits &ilimits) {
+  // The legs are joined into one list of waypoints so the profile carries its velocity through
+  // the joints instead of stopping at them
+  std::vector<PathfinderPoint> waypoints;
+  for (const auto &leg : ilegs) {
+    if (leg.empty()) {
+      continue;
+    }
+
+    auto legStart = leg.begin();
+    if (!waypoints.empty()) {
+      const auto &joint = waypoints.back();
+
+      // Headings which differ by whole turns, such as 0 and 360 degrees, are the same heading
+      const double headingDiff =
+        std::remainder((joint.theta - legStart->theta).convert(radian), 2 * 1_pi);
+      if ((joint.x - legStart->x).abs() > 1e-6_m || (joint.y - legStart->y).abs() > 1e-6_m ||
+          std::abs(headingDiff) > 1e-6) {
+        std::string msg("AsyncMotionProfileController: A leg of path " + ipathId +
+                        " does not start where the previous leg ended.");
+        LOG_ERROR(msg);
+        throw std::invalid_argument(msg);
+      }
+
+      // Skip the joint so the path does not have two waypoints in the same place
+      ++legStart;
+    }
+
+    waypoints.insert(waypoints.end(), legStart, leg.end());
+  }
+
+  if (waypoints.empty()) {
+    // No point in generating a path
+    LOG_WARN_S(
+      "AsyncMotionProfileController: Not generating a path because no waypoints were given.");
+    return;
+  }
+
+  auto path = generateTrajectory(waypoints, ipathId, ilimits);
+  const int length = path.length;
+  savePath(ipathId, std::move(path));
+
+  LOG_INFO("AsyncMotionProfileController: Completely done generating path chain " + ipathId);
+  LOG_DEBUG("AsyncMotionProfileController: Path length: " + std::to_string(length));
+}
+
+std::shared_ptr<PathGenerationHandle>
+AsyncMotionProfileController::generatePathAsync(std::initializer_list<PathfinderPoint> iwaypoints,
+                                                const std::string &ipathId) {
+  return generatePathAsync(iwaypoints, ipathId, limits);
+}
+
+std::shared_ptr<PathGenerationHandle>
+AsyncMotionProfileController::generatePathAsync(std::initializer_list<PathfinderPoint> iwaypoints,
+                                                const std::string &ipathId,
+                                                const PathfinderLimits &ilimits) {
+  auto handle = std::make_shared<PathGenerationHandle>(ipathId);
+
+  if (iwaypoints.size() == 0) {
+    // No point in generating a path
+    std::string msg(
+      "AsyncMotionProfileController: Not generating a path because no waypoints were given.");
+    LOG_WARN(msg);
+    handle->markFailed(msg);
+    return handle;
+  }
+
+  LOG_INFO("AsyncMotionProfileController: Queueing path " + ipathId + " for generation");
+
+  std::scoped_lock lock(generationMutex);
+  generationQueue.push_back(GenerationRequest{iwaypoints, ilimits, handle});
+  pendingPaths[ipathId] = handle;
+
+  return handle;
+}
+
+std::vector<PathGenerationResult>
+AsyncMotionProfileController::generatePaths(const std::vector<PathSpec> &ispecs,
+                                            const std::size_t iworkers) {
+  std::vector<std::string> pathIds;
+  pathIds.reserve(ispecs.size());
+  for (const auto &spec : ispecs) {
+    pathIds.push_back(spec.pathId);
+  }
+
+  PathGenerationBatch batch(
+    std::move(pathIds),
+    [&](const std::size_t i) {
+      const auto &spec = ispecs[i];
+      if (spec.waypoints.empty()) {
+        std::string msg("AsyncMotionProfileController: Not generating path " + spec.pathId +
+                        " because no waypoints were given.");
+        LOG_WARN(msg);
+        throw std::invalid_argument(msg);
+      }
+
+      savePath(spec.pathId,
+               generateTrajectory(spec.waypoints, spec.pathId, spec.limits.value_or(limits)));
+      LOG_INFO("AsyncMotionProfileController: Completely done generating path " + spec.pathId);
+    },
+    timeUtil,
+    logger);
+
+  return batch.run(iworkers);
+}
+
+AsyncMotionProfileController::TrajectoryPair
+AsyncMotionProfileController::generateTrajectory(const std::vector<PathfinderPoint> &iwaypoints,
+                                                 const std::string &ipathId,
+                                                 const PathfinderLimits &ilimits) {
+  std::shared_ptr<const TrajectoryGenerator> generator;
+  {
+    std::scoped_lock lock(generationMutex);
+    generator = trajectoryGenerator;
+  }
+
+  if (generator) {
+    LOG_INFO_S("AsyncMotionProfileController: Generating path with TrajectoryGenerator");
+
+    std::pair<std::vector<Segment>, std::vector<Segment>> sides;
+    try {
+      sides = generator->generateTank(iwaypoints, ilimits, scales.wheelTrack);
+    } catch (const std::invalid_argument &e) {
+      std::string message = "AsyncMotionProfileController: The path (id " + ipathId +
+                            ") is impossible: " + e.what();
+
+      LOG_ERROR(message);
+      throw std::runtime_error(message);
+    }
+
+    return limitWheels(
+      sides.first.data(), sides.second.data(), static_cast<int>(sides.first.size()), ilimits);
+  }
+
+  // Find impossible paths before pathfinder fits and allocates them
+  const auto diagnostics = PathFeasibilityChecker(scales.wheelTrack).check(iwaypoints, ilimits);
+  for (const auto &diagnostic : diagnostics) {
+    if (diagnostic.severity == PathFeasibilityChecker::Severity::error) {
+      std::string message = "AsyncMotionProfileController: The path (id " + ipathId +
+                            ") is impossible: " + PathFeasibilityChecker::describe(diagnostic);
+
+      LOG_ERROR(message);
+      throw std::runtime_error(message);
+    }
+
+    LOG_WARN("AsyncMotionProfileController: The path (id " + ipathId +
+             ") might not be followed well: " + PathFeasibilityChecker::describe(diagnostic));
+  }
+
   std::vector<Waypoint> points;
   points.reserve(iwaypoints.size());
   for (auto &point : iwaypoints) {
@@ -131,14 +320,129 @@ void AsyncMotionProfileController::generatePath(std::initializer_list<Pathfinder
                          rightTrajectory.get(),
                          scales.wheelTrack.convert(meter));
 
-  // Free the old path before overwriting it
-  forceRemovePath(ipathId);
+  return limitWheels(leftTrajectory.get(), rightTrajectory.get(), length, ilimits);
+}
 
-  paths.emplace(ipathId,
-                TrajectoryPair{std::move(leftTrajectory), std::move(rightTrajectory), length});
+AsyncMotionProfileController::TrajectoryPair
+AsyncMotionProfileController::limitWheels(const Segment *ileft,
+                                          const Segment *iright,
+                                          const int ilength,
+                                          const PathfinderLimits &ilimits) const {
+  // The generators only limit the center of the robot, so slow down wherever the outer wheel
+  // would need more than the motors can give
+  const TankTrajectoryLimiter limiter(
+    TankTrajectoryLimiter::computeMaxWheelVelocity(scales.wheelDiameter, pair), ilimits.maxAccel);
+  const auto [left, right] = limiter.limit(ileft, iright, ilength);
+  return makeTrajectoryPair(left.data(), right.data(), static_cast<int>(left.size()));
+}
 
-  LOG_INFO("AsyncMotionProfileController: Completely done generating path " + ipathId);
-  LOG_DEBUG("AsyncMotionProfileController: Path length: " + std::to_string(length));
+AsyncMotionProfileController::TrajectoryPair AsyncMotionProfileController::makeTrajectoryPair(
+  const Segment *ileft,
+  const Segment *iright,
+  const int ilength) const {
+  return TrajectoryPair{CompactTrajectory(ileft, ilength, storagePrecision, storageRetainsPose),
+                        CompactTrajectory(iright, ilength, storagePrecision, storageRetainsPose),
+                        ilength,
+                        compileMotorCommands(ileft, iright, ilength)};
+}
+
+std::vector<AsyncMotionProfileController::MotorCommand>
+AsyncMotionProfileController::compileMotorCommands(const Segment *ileft,
+                                                   const Segment *iright,
+                                                   const int ilength) const {
+  const double gearset = toUnderlyingType(pair.internalGearset);
+
+  std::vector<MotorCommand> commands;
+  commands.reserve(ilength);
+
+  for (int i = 0; i < ilength; ++i) {
+    const auto leftRPM = convertLinearToRotational(ileft[i].velocity * mps).convert(rpm);
+    const auto rightRPM = convertLinearToRotational(iright[i].velocity * mps).convert(rpm);
+    commands.push_back(MotorCommand{static_cast<float>(leftRPM / gearset),
+                                     static_cast<float>(rightRPM / gearset),
+                                     static_cast<float>(ileft[i].dt)});
+  }
+
+  return commands;
+}
+
+void AsyncMotionProfileController::savePath(const std::string &ipathId, TrajectoryPair &&ipath) {
+  // Anything following the old path holds its own reference, so the old path is freed once it
+  // finishes
+  std::scoped_lock lock(pathsMutex);
+  paths.insert_or_assign(ipathId, std::make_shared<const TrajectoryPair>(std::move(ipath)));
+}
+
+void AsyncMotionProfileController::generationLoop() {
+  LOG_INFO_S("Started AsyncMotionProfileController generation task.");
+
+  auto rate = timeUtil.getRate();
+
+  while (!dtorCalled.load(std::memory_order_acquire) && !generationTask->notifyTake(0)) {
+    std::optional<GenerationRequest> request;
+
+    {
+      std::scoped_lock lock(generationMutex);
+      if (!generationQueue.empty()) {
+        request.emplace(std::move(generationQueue.front()));
+        generationQueue.pop_front();
+        currentGeneration = request->handle;
+      }
+    }
+
+    if (request) {
+      const auto &pathId = request->handle->getPathId();
+
+      try {
+        auto path = generateTrajectory(request->waypoints, pathId, request->limits);
+        if (dtorCalled.load(std::memory_order_acquire)) {
+          // The destructor fails the request being generated along with the queued ones
+          break;
+        }
+
+        savePath(pathId, std::move(path));
+        LOG_INFO("AsyncMotionProfileController: Completely done generating path " + pathId);
+        request->handle->markDone();
+      } catch (const std::exception &e) {
+        // generateTrajectory() already logged the error
+        request->handle->markFailed(e.what());
+      }
+
+      std::scoped_lock lock(generationMutex);
+      currentGeneration = nullptr;
+      if (auto pending = pendingPaths.find(pathId);
+          pending != pendingPaths.end() && pending->second == request->handle) {
+        pendingPaths.erase(pending);
+      }
+    } else {
+      rate->delayUntil(10_ms);
+    }
+  }
+
+  LOG_INFO_S("Stopped AsyncMotionProfileController generation task.");
+  generationStopped.store(true, std::memory_order_release);
+}
+
+void AsyncMotionProfileController::generationTrampoline(void *context) {
+  if (context) {
+    static_cast<AsyncMotionProfileController *>(context)->generationLoop();
+  }
+}
+
+void AsyncMotionProfileController::waitForPendingPath(const std::string &ipathId) {
+  std::shared_ptr<PathGenerationHandle> handle;
+
+  {
+    std::scoped_lock lock(generationMutex);
+    if (auto pending = pendingPaths.find(ipathId); pending != pendingPaths.end()) {
+      handle = pending->second;
+    }
+  }
+
+  if (handle && !handle->isReady()) {
+    LOG_INFO("AsyncMotionProfileController: Waiting for path " + ipathId + " to be generated");
+    handle->waitUntilReady(timeUtil);
+  }
 }
 
 std::string AsyncMotionProfileController::getPathErrorMessage(const std::vector<Waypoint> &points,
@@ -158,26 +462,38 @@ std::string AsyncMotionProfileController::getPathErrorMessage(const std::vector<
 }
 
 bool AsyncMotionProfileController::removePath(const std::string &ipathId) {
-  if (!isDisabled() && isRunning.load(std::memory_order_acquire) && getTarget() == ipathId) {
-    LOG_WARN("AsyncMotionProfileController: Attempted to remove currently running path " + ipathId);
-    return false;
+  {
+    // Cancel any queued generation so the generation task doesn't save the path again later
+    std::scoped_lock lock(generationMutex);
+    for (auto request = generationQueue.begin(); request != generationQueue.end();) {
+      if (request->handle->getPathId() == ipathId) {
+        if (auto pending = pendingPaths.find(ipathId);
+            pending != pendingPaths.end() && pending->second == request->handle) {
+          pendingPaths.erase(pending);
+        }
+
+        request->handle->markFailed("AsyncMotionProfileController: The path " + ipathId +
+                                    " was removed before it was generated.");
+        request = generationQueue.erase(request);
+      } else {
+        ++request;
+      }
+    }
   }
 
-  std::scoped_lock lock(currentPathMutex);
+  std::scoped_lock lock(pathsMutex);
 
-  auto oldPath = paths.find(ipathId);
-  if (oldPath != paths.end()) {
-    paths.erase(ipathId);
-  }
+  // Anything following the path holds its own reference, so the path is freed once it finishes
+  paths.erase(ipathId);
 
-  // A return value of true provides no feedback about whether the path was actually removed but
-  // instead tells us that the path does not exist at this moment
+  // The path no longer exists whether or not it existed before
   return true;
 }
 
 std::vector<std::string> AsyncMotionProfileController::getPaths() {
   std::vector<std::string> keys;
 
+  std::scoped_lock lock(pathsMutex);
   for (const auto &path : paths) {
     keys.push_back(path.first);
   }
@@ -195,7 +511,13 @@ void AsyncMotionProfileController::setTarget(std::string ipathId,
   LOG_INFO("AsyncMotionProfileController: Set target to: " + ipathId + " (ibackwards=" +
            std::to_string(ibackwards) + ", imirrored=" + std::to_string(imirrored) + ")");
 
-  currentPath = ipathId;
+  waitForPendingPath(ipathId);
+
+  {
+    std::scoped_lock lock(pathsMutex);
+    currentPath = ipathId;
+  }
+
   direction.store(boolToSign(!ibackwards), std::memory_order_release);
   mirrored.store(imirrored, std::memory_order_release);
   isRunning.store(true, std::memory_order_release);
@@ -206,10 +528,12 @@ void AsyncMotionProfileController::controllerSet(std::string ivalue) {
 }
 
 std::string AsyncMotionProfileController::getTarget() {
+  std::scoped_lock lock(pathsMutex);
   return currentPath;
 }
 
 std::string AsyncMotionProfileController::getProcessValue() const {
+  std::scoped_lock lock(pathsMutex);
   return currentPath;
 }
 
@@ -220,20 +544,21 @@ void AsyncMotionProfileController::loop() {
 
   while (!dtorCalled.load(std::memory_order_acquire) && !task->notifyTake(0)) {
     if (isRunning.load(std::memory_order_acquire) && !isDisabled()) {
-      LOG_INFO("AsyncMotionProfileController: Running with path: " + currentPath);
+      const std::string target = getTarget();
+      LOG_INFO("AsyncMotionProfileController: Running with path: " + target);
 
-      auto path = paths.find(currentPath);
-      if (path == paths.end()) {
+      // Pin the path for the whole run so it can't be freed while it is being followed
+      const auto path = getPath(target);
+      if (!path) {
         LOG_WARN("AsyncMotionProfileController: Target was set to non-existent path with name: " +
-                 currentPath);
+                 target);
       } else {
-        LOG_DEBUG("AsyncMotionProfileController: Path length is " +
-                  std::to_string(path->second.length));
+        LOG_DEBUG("AsyncMotionProfileController: Path length is " + std::to_string(path->length));
 
-        executeSinglePath(path->second, timeUtil.getRate());
+        executeSinglePath(*path, timeUtil.getRate());
 
         // Stop the chassis after the path because:
-        // 1. We only support an exit velocity of zero
+        // 1. Paths, including path chains, always end with a velocity of zero
         // 2. Because of (1), we should make sure the system is stopped
         model->stop();
 
@@ -251,22 +576,27 @@ void AsyncMotionProfileController::loop() {
 
 void AsyncMotionProfileController::executeSinglePath(const TrajectoryPair &path,
                                                      std::unique_ptr<AbstractRate> rate) {
-  const int reversed = direction.load(std::memory_order_acquire);
+  const float reversed = direction.load(std::memory_order_acquire);
   const bool followMirrored = mirrored.load(std::memory_order_acquire);
-  const int pathLength = getPathLength(path);
 
-  for (int i = 0; i < pathLength && !isDisabled(); ++i) {
-    // This mutex is used to combat an edge case of an edge case
-    // if a running path is asked to be removed at the moment this loop is executing
-    std::scoped_lock lock(currentPathMutex);
+  std::optional<ProfileFollowerGains> gains;
+  std::shared_ptr<Odometry> odometry;
+  {
+    std::scoped_lock lock(pathsMutex);
+    gains = followerGains;
+    odometry = followerOdometry;
+  }
 
-    const auto segDT = path.left.get()[i].dt * second;
-    const auto leftRPM = convertLinearToRotational(path.left.get()[i].velocity * mps).convert(rpm);
-    const auto rightRPM =
-      convertLinearToRotational(path.right.get()[i].velocity * mps).convert(rpm);
+  if (gains) {
+    executeClosedLoopPath(path, std::move(rate), *gains, odometry);
+    return;
+  }
 
-    const double rightSpeed = rightRPM / toUnderlyingType(pair.internalGearset) * reversed;
-    const double leftSpeed = leftRPM / toUnderlyingType(pair.internalGearset) * reversed;
+  const MotorCommand *commands = path.bakedCommands ? path.bakedCommands : path.commands.data();
+  for (int i = 0; i < path.length && !isDisabled(); ++i) {
+    const auto command = commands + i;
+    const float leftSpeed = command->left * reversed;
+    const float rightSpeed = command->right * reversed;
     if (followMirrored) {
       model->left(rightSpeed);
       model->right(leftSpeed);
@@ -275,16 +605,79 @@ void AsyncMotionProfileController::executeSinglePath(const TrajectoryPair &path,
       model->right(rightSpeed);
     }
 
-    // Unlock before the delay to be nice to other tasks
-    currentPathMutex.unlock();
+    rate->delayUntil(command->dt * second);
+  }
+}
+
+void AsyncMotionProfileController::executeClosedLoopPath(
+  const TrajectoryPair &path,
+  std::unique_ptr<AbstractRate> rate,
+  const ProfileFollowerGains &igains,
+  const std::shared_ptr<Odometry> &iodometry) {
+  const int reversed = direction.load(std::memory_order_acquire);
+  const bool followMirrored = mirrored.load(std::memory_order_acquire);
+  const double wheelTrack = scales.wheelTrack.convert(meter);
+
+  const auto startSensorVals = model->getSensorVals();
+  const double startTheta = iodometry ? iodometry->getState().theta.convert(radian) : 0;
+
+  // The profiled state of each side of the chassis, after mirroring and reversing
+  struct Side {
+    const CompactTrajectory &trajectory;
+    double lastVelocity;
+
+    std::pair<double, double> feedforward(const int i, const int ireversed, const double idt) {
+      const double velocity = trajectory.getVelocity(i) * ireversed;
+      const double acceleration = (velocity - lastVelocity) / idt;
+      lastVelocity = velocity;
+      return {velocity, acceleration};
+    }
+  };
+
+  Side leftSide{followMirrored ? path.right : path.left, 0};
+  Side rightSide{followMirrored ? path.left : path.right, 0};
+
+  auto output = [&](const double ivelocity, const double iacceleration, const double ierror) {
+    const double staticFriction = ivelocity > 0 ? igains.kS : (ivelocity < 0 ? -igains.kS : 0);
+    return staticFriction + igains.kV * ivelocity + igains.kA * iacceleration + igains.kP * ierror;
+  };
+
+  for (int i = 0; i < path.length && !isDisabled(); ++i) {
+    const double segDT = path.left.getDt(i);
+    const auto [leftVelocity, leftAcceleration] = leftSide.feedforward(i, reversed, segDT);
+    const auto [rightVelocity, rightAcceleration] = rightSide.feedforward(i, reversed, segDT);
+
+    // Where each side should be at the start of this segment
+    const double leftTarget = i > 0 ? leftSide.trajectory.getPosition(i - 1) * reversed : 0;
+    const double rightTarget = i > 0 ? rightSide.trajectory.getPosition(i - 1) * reversed : 0;
+
+    const auto sensorVals = model->getSensorVals();
+    const double leftError = leftTarget - (sensorVals[0] - startSensorVals[0]) / scales.straight;
+    const double rightError = rightTarget - (sensorVals[1] - startSensorVals[1]) / scales.straight;
+
+    double leftOutput = output(leftVelocity, leftAcceleration, leftError);
+    double rightOutput = output(rightVelocity, rightAcceleration, rightError);
+
+    if (iodometry) {
+      // The heading the wheel positions imply, using the same convention as the odometry
+      const double targetTheta = (leftTarget - rightTarget) / wheelTrack;
+      const double theta = iodometry->getState().theta.convert(radian) - startTheta;
+      const double thetaError = targetTheta - theta;
+      leftOutput += igains.kTheta * thetaError;
+      rightOutput -= igains.kTheta * thetaError;
+    }
+
+    model->tank(leftOutput, rightOutput);
 
-    rate->delayUntil(segDT);
+    rate->delayUntil(segDT * second);
   }
 }
 
-int AsyncMotionProfileController::getPathLength(const TrajectoryPair &path) {
-  std::scoped_lock lock(currentPathMutex);
-  return path.length;
+AsyncMotionProfileController::PathPtr
+AsyncMotionProfileController::getPath(const std::string &ipathId) const {
+  std::scoped_lock lock(pathsMutex);
+  auto path = paths.find(ipathId);
+  return path == paths.end() ? nullptr : path->second;
 }
 
 QAngularSpeed AsyncMotionProfileController::convertLinearToRotational(QSpeed linear) const {
@@ -318,12 +711,181 @@ void AsyncMotionProfileController::moveTo(std::initializer_list<PathfinderPoint>
                                           const PathfinderLimits &ilimits,
                                           const bool ibackwards,
                                           const bool imirrored) {
-  static int moveToCount = 0;
-  std::string name = "__moveTo" + std::to_string(moveToCount++);
-  generatePath(iwaypoints, name, ilimits);
+  if (trajectoryCacheBudget == 0) {
+    static int moveToCount = 0;
+    std::string name = "__moveTo" + std::to_string(moveToCount++);
+    generatePath(iwaypoints, name, ilimits);
+    setTarget(name, ibackwards, imirrored);
+    waitUntilSettled();
+    forceRemovePath(name);
+    return;
+  }
+
+  const auto key = makeTrajectoryCacheKey(iwaypoints, ilimits);
+  std::string name = findCachedTrajectory(key);
+
+  if (name.empty()) {
+    trajectoryCacheMisses.fetch_add(1, std::memory_order_relaxed);
+
+    name = "__moveTo" + std::to_string(hashTrajectoryCacheKey(key));
+    generatePath(iwaypoints, name, ilimits);
+
+    if (const auto path = getPath(name)) {
+      // A hash collision could leave an older entry pointing at the path we just overwrote
+      trajectoryCache.remove_if([&](const TrajectoryCacheEntry &entry) {
+        if (entry.pathId == name) {
+          trajectoryCacheBytes -= entry.bytes;
+          return true;
+        }
+        return false;
+      });
+
+      const std::size_t bytes = path->left.getMemoryUsage() + path->right.getMemoryUsage() +
+                                path->commands.size() * sizeof(MotorCommand);
+      trajectoryCache.push_front(TrajectoryCacheEntry{key, name, bytes});
+      trajectoryCacheBytes += bytes;
+    }
+  } else {
+    trajectoryCacheHits.fetch_add(1, std::memory_order_relaxed);
+    LOG_DEBUG("AsyncMotionProfileController: Reusing cached trajectory " + name);
+  }
+
   setTarget(name, ibackwards, imirrored);
   waitUntilSettled();
-  forceRemovePath(name);
+
+  // Evict after settling so we never try to remove the path we are following
+  evictCachedTrajectories();
+}
+
+void AsyncMotionProfileController::setTrajectoryStorage(
+  const CompactTrajectory::Precision iprecision,
+  const bool iretainPose) {
+  storagePrecision = iprecision;
+  storageRetainsPose = iretainPose;
+}
+
+void AsyncMotionProfileController::setTrajectoryGenerator(
+  const std::shared_ptr<const TrajectoryGenerator> &igenerator) {
+  {
+    std::scoped_lock lock(generationMutex);
+    trajectoryGenerator = igenerator;
+  }
+
+  // The cached trajectories were made by the old generator
+  clearTrajectoryCache();
+}
+
+void AsyncMotionProfileController::setFollowerGains(const ProfileFollowerGains &igains,
+                                                    const std::shared_ptr<Odometry> &iodometry) {
+  std::scoped_lock lock(pathsMutex);
+  followerGains = igains;
+  followerOdometry = iodometry;
+}
+
+void AsyncMotionProfileController::setOpenLoopFollower() {
+  std::scoped_lock lock(pathsMutex);
+  followerGains = std::nullopt;
+  followerOdometry = nullptr;
+}
+
+void AsyncMotionProfileController::setTrajectoryCacheBudget(const std::size_t ibytes) {
+  trajectoryCacheBudget = ibytes;
+  evictCachedTrajectories();
+}
+
+std::size_t AsyncMotionProfileController::getTrajectoryCacheBudget() const {
+  return trajectoryCacheBudget;
+}
+
+AsyncMotionProfileController::TrajectoryCacheStats
+AsyncMotionProfileController::getTrajectoryCacheStats() const {
+  return TrajectoryCacheStats{trajectoryCacheHits.load(std::memory_order_relaxed),
+                              trajectoryCacheMisses.load(std::memory_order_relaxed),
+                              trajectoryCache.size(),
+                              trajectoryCacheBytes};
+}
+
+void AsyncMotionProfileController::clearTrajectoryCache() {
+  for (const auto &entry : trajectoryCache) {
+    forceRemovePath(entry.pathId);
+  }
+
+  trajectoryCache.clear();
+  trajectoryCacheBytes = 0;
+  trajectoryCacheHits.store(0, std::memory_order_relaxed);
+  trajectoryCacheMisses.store(0, std::memory_order_relaxed);
+}
+
+std::vector<double> AsyncMotionProfileController::makeTrajectoryCacheKey(
+  std::initializer_list<PathfinderPoint> iwaypoints,
+  const PathfinderLimits &ilimits) const {
+  std::vector<double> key;
+  key.reserve(iwaypoints.size() * 3 + 7);
+
+  for (auto &point : iwaypoints) {
+    key.push_back(point.x.convert(meter));
+    key.push_back(point.y.convert(meter));
+    key.push_back(point.theta.convert(radian));
+  }
+
+  key.push_back(ilimits.maxVel);
+  key.push_back(ilimits.maxAccel);
+  key.push_back(ilimits.maxJerk);
+  key.push_back(scales.wheelDiameter.convert(meter));
+  key.push_back(scales.wheelTrack.convert(meter));
+  key.push_back(toUnderlyingType(pair.internalGearset));
+  key.push_back(pair.ratio);
+
+  return key;
+}
+
+std::uint64_t
+AsyncMotionProfileController::hashTrajectoryCacheKey(const std::vector<double> &ikey) {
+  return fnv1a(ikey.data(), ikey.size() * sizeof(double));
+}
+
+std::uint64_t AsyncMotionProfileController::fnv1a(const void *idata, const std::size_t isize) {
+  std::uint64_t hash = 14695981039346656037ULL;
+
+  const auto *bytes = static_cast<const unsigned char *>(idata);
+  for (std::size_t i = 0; i < isize; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+std::string AsyncMotionProfileController::findCachedTrajectory(const std::vector<double> &ikey) {
+  for (auto entry = trajectoryCache.begin(); entry != trajectoryCache.end(); ++entry) {
+    if (entry->key != ikey) {
+      continue;
+    }
+
+    if (!getPath(entry->pathId)) {
+      // The path was removed by the user, so the entry is stale
+      trajectoryCacheBytes -= entry->bytes;
+      trajectoryCache.erase(entry);
+      return "";
+    }
+
+    // Move the entry to the front because it is now the most recently used
+    trajectoryCache.splice(trajectoryCache.begin(), trajectoryCache, entry);
+    return trajectoryCache.front().pathId;
+  }
+
+  return "";
+}
+
+void AsyncMotionProfileController::evictCachedTrajectories() {
+  while (trajectoryCacheBytes > trajectoryCacheBudget && !trajectoryCache.empty()) {
+    const auto &entry = trajectoryCache.back();
+    LOG_DEBUG("AsyncMotionProfileController: Evicting cached trajectory " + entry.pathId);
+
+    forceRemovePath(entry.pathId);
+    trajectoryCacheBytes -= entry.bytes;
+    trajectoryCache.pop_back();
+  }
 }
 
 PathfinderPoint AsyncMotionProfileController::getError() const {
@@ -373,12 +935,21 @@ void AsyncMotionProfileController::startThread() {
   if (!task) {
     task = new CrossplatformThread(trampoline, this, "AsyncMotionProfileController");
   }
+
+  if (!generationTask) {
+    generationTask =
+      new CrossplatformThread(generationTrampoline, this, "AsyncMotionProfileController Generator");
+  }
 }
 
 CrossplatformThread *AsyncMotionProfileController::getThread() const {
   return task;
 }
 
+CrossplatformThread *AsyncMotionProfileController::getGenerationThread() const {
+  return generationTask;
+}
+
 void AsyncMotionProfileController::storePath(const std::string &idirectory,
                                              const std::string &ipathId) {
   std::string leftFilePath = makeFilePath(idirectory, ipathId + ".left.csv");
@@ -436,19 +1007,21 @@ void AsyncMotionProfileController::loadPath(const std::string &idirectory,
 void AsyncMotionProfileController::internalStorePath(FILE *leftPathFile,
                                                      FILE *rightPathFile,
                                                      const std::string &ipathId) {
-  auto pathData = this->paths.find(ipathId);
+  const auto pathData = getPath(ipathId);
 
   // Make sure path exists
-  if (pathData == paths.end()) {
+  if (!pathData) {
     LOG_WARN("AsyncMotionProfileController: Controller was asked to serialize non-existent path " +
              ipathId);
     // Do nothing- can't serialize nonexistent path
   } else {
-    int len = pathData->second.length;
+    int len = pathData->length;
+    auto leftSegments = pathData->left.getSegments();
+    auto rightSegments = pathData->right.getSegments();
 
     // Serialize paths
-    pathfinder_serialize_csv(leftPathFile, pathData->second.left.get(), len);
-    pathfinder_serialize_csv(rightPathFile, pathData->second.right.get(), len);
+    pathfinder_serialize_csv(leftPathFile, leftSegments.data(), len);
+    pathfinder_serialize_csv(rightPathFile, rightSegments.data(), len);
   }
 }
 
@@ -473,9 +1046,185 @@ void AsyncMotionProfileController::internalLoadPath(FILE *leftPathFile,
   pathfinder_deserialize_csv(rightPathFile, rightTrajectory.get());
 
   // Remove the old path if it exists
-  forceRemovePath(ipathId);
-  paths.emplace(ipathId,
-                TrajectoryPair{std::move(leftTrajectory), std::move(rightTrajectory), count});
+  savePath(ipathId, makeTrajectoryPair(leftTrajectory.get(), rightTrajectory.get(), count));
+}
+
+void AsyncMotionProfileController::storePathsBinary(const std::string &idirectory,
+                                                    const std::string &ifileName,
+                                                    const std::vector<std::string> &ipathIds) {
+  std::string filePath = makeFilePath(idirectory, ifileName);
+  FILE *pathFile = fopen(filePath.c_str(), "wb");
+
+  // Make sure we can open the file successfully
+  if (pathFile == NULL) {
+    LOG_WARN("AsyncMotionProfileController: Couldn't open file " + filePath + " for writing");
+    return;
+  }
+
+  internalStorePathsBinary(pathFile, ipathIds);
+
+  fclose(pathFile);
+}
+
+void AsyncMotionProfileController::loadPathsBinary(const std::string &idirectory,
+                                                   const std::string &ifileName) {
+  std::string filePath = makeFilePath(idirectory, ifileName);
+  FILE *pathFile = fopen(filePath.c_str(), "rb");
+
+  // Make sure we can open the file successfully
+  if (pathFile == NULL) {
+    LOG_WARN("AsyncMotionProfileController: Couldn't open file " + filePath + " for reading");
+    return;
+  }
+
+  internalLoadPathsBinary(pathFile);
+
+  fclose(pathFile);
+}
+
+void AsyncMotionProfileController::internalStorePathsBinary(
+  FILE *pathFile,
+  const std::vector<std::string> &ipathIds) {
+  std::vector<TrajectoryFileIndexEntry> index;
+  std::vector<std::pair<std::vector<Segment>, std::vector<Segment>>> pathData;
+  index.reserve(ipathIds.size());
+  pathData.reserve(ipathIds.size());
+
+  std::uint64_t offset =
+    sizeof(TrajectoryFileHeader) + ipathIds.size() * sizeof(TrajectoryFileIndexEntry);
+
+  for (const auto &pathId : ipathIds) {
+    const auto path = getPath(pathId);
+
+    // Make sure path exists
+    if (!path) {
+      LOG_WARN(
+        "AsyncMotionProfileController: Controller was asked to serialize non-existent path " +
+        pathId);
+      continue;
+    }
+
+    if (pathId.size() >= trajectoryFilePathIdSize) {
+      LOG_WARN("AsyncMotionProfileController: Not serializing path " + pathId +
+               " because its ID is longer than " + std::to_string(trajectoryFilePathIdSize - 1) +
+               " characters");
+      continue;
+    }
+
+    const std::size_t blockSize = sizeof(Segment) * path->length;
+
+    TrajectoryFileIndexEntry entry{};
+    pathId.copy(entry.pathId, pathId.size());
+    entry.length = path->length;
+    entry.offset = offset;
+    auto leftSegments = path->left.getSegments();
+    auto rightSegments = path->right.getSegments();
+    entry.leftChecksum = fnv1a(leftSegments.data(), blockSize);
+    entry.rightChecksum = fnv1a(rightSegments.data(), blockSize);
+
+    index.push_back(entry);
+    pathData.emplace_back(std::move(leftSegments), std::move(rightSegments));
+    offset += 2 * blockSize;
+  }
+
+  // The index was sized for every requested path, so fix up the offsets if any were skipped
+  const std::uint64_t skippedBytes =
+    (ipathIds.size() - index.size()) * sizeof(TrajectoryFileIndexEntry);
+  for (auto &entry : index) {
+    entry.offset -= skippedBytes;
+  }
+
+  TrajectoryFileHeader header{};
+  std::copy(std::begin(trajectoryFileMagic), std::end(trajectoryFileMagic), header.magic);
+  header.version = trajectoryFileVersion;
+  header.segmentSize = sizeof(Segment);
+  header.pathCount = static_cast<std::uint32_t>(index.size());
+
+  fwrite(&header, sizeof(header), 1, pathFile);
+  fwrite(index.data(), sizeof(TrajectoryFileIndexEntry), index.size(), pathFile);
+
+  for (std::size_t i = 0; i < index.size(); ++i) {
+    fwrite(pathData[i].first.data(), sizeof(Segment), index[i].length, pathFile);
+    fwrite(pathData[i].second.data(), sizeof(Segment), index[i].length, pathFile);
+  }
+}
+
+void AsyncMotionProfileController::internalLoadPathsBinary(FILE *pathFile) {
+  // Read the entire file in one go so loading does not depend on the speed of many small reads
+  fseek(pathFile, 0, SEEK_END);
+  const long fileSize = ftell(pathFile);
+  rewind(pathFile);
+
+  if (fileSize < static_cast<long>(sizeof(TrajectoryFileHeader))) {
+    LOG_ERROR_S("AsyncMotionProfileController: Trajectory file is too small to hold a header.");
+    return;
+  }
+
+  std::vector<unsigned char> buffer(static_cast<std::size_t>(fileSize));
+  if (fread(buffer.data(), 1, buffer.size(), pathFile) != buffer.size()) {
+    LOG_ERROR_S("AsyncMotionProfileController: Couldn't read the trajectory file.");
+    return;
+  }
+
+  TrajectoryFileHeader header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+
+  if (!std::equal(
+        std::begin(trajectoryFileMagic), std::end(trajectoryFileMagic), std::begin(header.magic))) {
+    LOG_ERROR_S("AsyncMotionProfileController: The file is not a trajectory file.");
+    return;
+  }
+
+  if (header.version != trajectoryFileVersion || header.segmentSize != sizeof(Segment)) {
+    LOG_ERROR("AsyncMotionProfileController: Unsupported trajectory file version " +
+              std::to_string(header.version) + " with segment size " +
+              std::to_string(header.segmentSize));
+    return;
+  }
+
+  // Every bound is checked by division or subtraction so a crafted size or offset can't overflow
+  if (header.pathCount >
+      (buffer.size() - sizeof(TrajectoryFileHeader)) / sizeof(TrajectoryFileIndexEntry)) {
+    LOG_ERROR_S("AsyncMotionProfileController: Trajectory file index is truncated.");
+    return;
+  }
+
+  std::vector<TrajectoryFileIndexEntry> index(header.pathCount);
+  std::memcpy(index.data(),
+              buffer.data() + sizeof(TrajectoryFileHeader),
+              header.pathCount * sizeof(TrajectoryFileIndexEntry));
+
+  // Validate every path before loading any of them so a corrupt file loads nothing
+  for (const auto &entry : index) {
+    if (entry.length < 0 || entry.pathId[trajectoryFilePathIdSize - 1] != '\0' ||
+        entry.offset > buffer.size() ||
+        static_cast<std::size_t>(entry.length) >
+          (buffer.size() - entry.offset) / (2 * sizeof(Segment))) {
+      LOG_ERROR_S("AsyncMotionProfileController: Trajectory file index entry is invalid.");
+      return;
+    }
+
+    const std::size_t blockSize = sizeof(Segment) * static_cast<std::size_t>(entry.length);
+
+    if (fnv1a(buffer.data() + entry.offset, blockSize) != entry.leftChecksum ||
+        fnv1a(buffer.data() + entry.offset + blockSize, blockSize) != entry.rightChecksum) {
+      LOG_ERROR("AsyncMotionProfileController: Checksum mismatch for path " +
+                std::string(entry.pathId));
+      return;
+    }
+  }
+
+  for (const auto &entry : index) {
+    const std::size_t blockSize = sizeof(Segment) * entry.length;
+
+    std::vector<Segment> leftSegments(entry.length);
+    std::vector<Segment> rightSegments(entry.length);
+    std::memcpy(leftSegments.data(), buffer.data() + entry.offset, blockSize);
+    std::memcpy(rightSegments.data(), buffer.data() + entry.offset + blockSize, blockSize);
+
+    savePath(entry.pathId,
+             makeTrajectoryPair(leftSegments.data(), rightSegments.data(), entry.length));
+  }
 }
 
 std::string AsyncMotionProfileController::makeFilePath(const std::string &directory,
@@ -515,11 +1264,34 @@ std::string AsyncMotionProfileController::makeFilePath(const std::string &direct
   return path;
 }
 
-void AsyncMotionProfileController::forceRemovePath(const std::string &ipathId) {
-  if (!removePath(ipathId)) {
-    LOG_WARN("AsyncMotionProfileController: Disabling controller to remove path " + ipathId);
-    flipDisable(true);
-    removePath(ipathId);
+void AsyncMotionProfileController::registerBakedPath(const BakedPath &ipath) {
+  const std::string pathId(ipath.pathId);
+
+  auto matches = [](const double ibaked, const double iexpected) {
+    return std::abs(ibaked - iexpected) <= 1e-6 * std::max(1.0, std::abs(iexpected));
+  };
+
+  if (!matches(ipath.wheelDiameter, scales.wheelDiameter.convert(meter)) ||
+      !matches(ipath.wheelTrack, scales.wheelTrack.convert(meter)) ||
+      !matches(ipath.gearsetRpm, toUnderlyingType(pair.internalGearset)) ||
+      !matches(ipath.gearRatio, pair.ratio)) {
+    std::string msg("AsyncMotionProfileController: The baked path " + pathId +
+                    " was baked for a different chassis or gearset.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
   }
+
+  savePath(pathId,
+           TrajectoryPair{CompactTrajectory(ipath.left, ipath.length, ipath.dt),
+                          CompactTrajectory(ipath.right, ipath.length, ipath.dt),
+                          ipath.length,
+                          {},
+                          ipath.commands});
+
+  LOG_INFO("AsyncMotionProfileController: Registered baked path " + pathId);
+}
+
+void AsyncMotionProfileController::forceRemovePath(const std::string &ipathId) {
+  removePath(ipathId);
 }
 } // namespace okapi
@@ -70,4 +70,12 @@ void AsyncPosPIDController::setGains(const IterativePosPIDController::Gains &iga
 IterativePosPIDController::Gains AsyncPosPIDController::getGains() const {
   return internalController->getGains();
 }
+
+void AsyncPosPIDController::setTargetVelocity(const double ivelocity, const double iacceleration) {
+  internalController->setTargetVelocity(ivelocity * ratio, iacceleration * ratio);
+}
+
+void AsyncPosPIDController::setGainSchedule(std::shared_ptr<PIDGainSchedule> igainSchedule) {
+  internalController->setGainSchedule(std::move(igainSchedule));
+}
 } // namespace okapi
@@ -0,0 +1,578 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncPurePursuitController.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace okapi {
+AsyncPurePursuitController::AsyncPurePursuitController(const TimeUtil &itimeUtil,
+                                                       const PathfinderLimits &ilimits,
+                                                       const std::shared_ptr<ChassisModel> &imodel,
+                                                       const ChassisScales &iscales,
+                                                       const AbstractMotor::GearsetRatioPair &ipair,
+                                                       const std::shared_ptr<Odometry> &iodometry,
+                                                       const QLength iminLookahead,
+                                                       const QLength imaxLookahead,
+                                                       const QTime ilookaheadTime,
+                                                       const std::shared_ptr<Logger> &ilogger)
+  : logger(ilogger),
+    limits(ilimits),
+    model(imodel),
+    scales(iscales),
+    pair(ipair),
+    timeUtil(itimeUtil),
+    odometry(iodometry),
+    minLookahead(iminLookahead.convert(meter)),
+    maxLookahead(imaxLookahead.convert(meter)),
+    lookaheadTime(ilookaheadTime.convert(second)),
+    trajectoryGenerator(std::make_shared<TrajectoryGenerator>()) {
+  if (ipair.ratio == 0) {
+    std::string msg("AsyncPurePursuitController: The gear ratio cannot be zero! Check if you are "
+                    "using integer division.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  if (!odometry) {
+    std::string msg("AsyncPurePursuitController: The odometry cannot be null.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  if (!(minLookahead > 0) || maxLookahead < minLookahead || lookaheadTime < 0) {
+    std::string msg("AsyncPurePursuitController: The lookahead distances must be positive, the "
+                    "max must be at least the min, and the lookahead time cannot be negative.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+}
+
+AsyncPurePursuitController::~AsyncPurePursuitController() {
+  // Stop following the path so the task can be joined before our members are destroyed
+  dtorCalled.store(true, std::memory_order_release);
+  disabled.store(true, std::memory_order_release);
+  delete task;
+  task = nullptr;
+}
+
+void AsyncPurePursuitController::generatePath(std::initializer_list<PathfinderPoint> iwaypoints,
+                                              const std::string &ipathId) {
+  generatePath(iwaypoints, ipathId, limits);
+}
+
+void AsyncPurePursuitController::generatePath(std::initializer_list<PathfinderPoint> iwaypoints,
+                                              const std::string &ipathId,
+                                              const PathfinderLimits &ilimits) {
+  if (iwaypoints.size() == 0) {
+    // No point in generating a path
+    LOG_WARN_S(
+      "AsyncPurePursuitController: Not generating a path because no waypoints were given.");
+    return;
+  }
+
+  auto points = generatePoints(iwaypoints, ipathId, ilimits);
+
+  std::vector<std::pair<double, double>> positions;
+  positions.reserve(points.size());
+  for (const auto &point : points) {
+    positions.emplace_back(point.x, point.y);
+  }
+
+  const auto length = points.size();
+  auto path = std::make_shared<const Path>(
+    Path{std::move(points), PathSpatialIndex(positions), ilimits.maxAccel});
+
+  // Free the old path before overwriting it
+  forceRemovePath(ipathId);
+
+  {
+    std::scoped_lock lock(currentPathMutex);
+    paths.insert_or_assign(ipathId, std::move(path));
+  }
+
+  LOG_INFO("AsyncPurePursuitController: Completely done generating path " + ipathId);
+  LOG_DEBUG("AsyncPurePursuitController: Path length: " + std::to_string(length));
+}
+
+std::vector<AsyncPurePursuitController::PathPoint>
+AsyncPurePursuitController::generatePoints(const std::vector<PathfinderPoint> &iwaypoints,
+                                           const std::string &ipathId,
+                                           const PathfinderLimits &ilimits) const {
+  std::shared_ptr<const TrajectoryGenerator> generator;
+  {
+    std::scoped_lock lock(currentPathMutex);
+    generator = trajectoryGenerator;
+  }
+
+  LOG_INFO_S("AsyncPurePursuitController: Generating path with TrajectoryGenerator");
+
+  std::vector<Segment> center;
+  try {
+    center = generator->generate(iwaypoints, ilimits);
+  } catch (const std::invalid_argument &e) {
+    std::string message =
+      "AsyncPurePursuitController: The path (id " + ipathId + ") is impossible: " + e.what();
+
+    LOG_ERROR(message);
+    throw std::runtime_error(message);
+  }
+
+  // The segments are spaced by time, so they bunch up where the robot is slow. Sample the path
+  // again at an even spacing so that the lookahead search and the target velocities don't depend
+  // on the profile.
+  PathPoint last{iwaypoints.front().x.convert(meter),
+                 iwaypoints.front().y.convert(meter),
+                 iwaypoints.front().theta.convert(radian),
+                 0,
+                 0};
+  std::vector<PathPoint> points{last};
+
+  double travelled = 0;
+  double nextDistance = pointSpacing;
+  for (const auto &segment : center) {
+    const double step = std::hypot(segment.x - last.x, segment.y - last.y);
+    const double turn = std::remainder(segment.heading - last.heading, 2 * pi);
+
+    while (step > 0 && travelled + step >= nextDistance) {
+      const double fraction = (nextDistance - travelled) / step;
+      points.push_back(PathPoint{last.x + (segment.x - last.x) * fraction,
+                                 last.y + (segment.y - last.y) * fraction,
+                                 last.heading + turn * fraction,
+                                 0,
+                                 0});
+      nextDistance += pointSpacing;
+    }
+
+    travelled += step;
+    last = PathPoint{segment.x, segment.y, last.heading + turn, 0, 0};
+  }
+
+  if (std::hypot(points.back().x - last.x, points.back().y - last.y) > 1e-6) {
+    points.push_back(last);
+  }
+
+  const std::size_t count = points.size();
+  auto distance = [&](const std::size_t i, const std::size_t j) {
+    return std::hypot(points[j].x - points[i].x, points[j].y - points[i].y);
+  };
+
+  // The headings were unwrapped while sampling, so the curvature is the change in heading over the
+  // distance between the neighbors of each point
+  for (std::size_t i = 1; i + 1 < count; ++i) {
+    points[i].curvature =
+      (points[i + 1].heading - points[i - 1].heading) / distance(i - 1, i + 1);
+  }
+
+  if (count > 2) {
+    points.front().curvature = points[1].curvature;
+    points.back().curvature = points[count - 2].curvature;
+  }
+
+  // Go as fast as the centripetal acceleration allows, then slow down in time for each turn and
+  // for the end of the path, where the robot stops
+  for (auto &point : points) {
+    const double turnVelocity = std::abs(point.curvature) > 0
+                                  ? std::sqrt(ilimits.maxAccel / std::abs(point.curvature))
+                                  : ilimits.maxVel;
+    point.velocity = std::min(ilimits.maxVel, turnVelocity);
+  }
+
+  points.back().velocity = 0;
+  for (std::size_t i = count - 1; i > 0; --i) {
+    points[i - 1].velocity =
+      std::min(points[i - 1].velocity,
+               std::sqrt(points[i].velocity * points[i].velocity +
+                         2 * ilimits.maxAccel * distance(i - 1, i)));
+  }
+
+  return points;
+}
+
+bool AsyncPurePursuitController::removePath(const std::string &ipathId) {
+  if (!isDisabled() && isRunning.load(std::memory_order_acquire) && getTarget() == ipathId) {
+    LOG_WARN("AsyncPurePursuitController: Attempted to remove currently running path " + ipathId);
+    return false;
+  }
+
+  std::scoped_lock lock(currentPathMutex);
+
+  auto oldPath = paths.find(ipathId);
+  if (oldPath != paths.end()) {
+    paths.erase(oldPath);
+  }
+
+  /*
+   * A return value of true provides no feedback about whether the
+   * path was actually removed but instead tells us that the path
+   * does not exist at this moment
+   */
+  return true;
+}
+
+std::vector<std::string> AsyncPurePursuitController::getPaths() {
+  std::scoped_lock lock(currentPathMutex);
+
+  std::vector<std::string> keys;
+  for (const auto &path : paths) {
+    keys.push_back(path.first);
+  }
+
+  return keys;
+}
+
+std::vector<AsyncPurePursuitController::PathPoint>
+AsyncPurePursuitController::getPathPoints(const std::string &ipathId) const {
+  std::scoped_lock lock(currentPathMutex);
+
+  auto path = paths.find(ipathId);
+  return path == paths.end() ? std::vector<PathPoint>{} : path->second->points;
+}
+
+void AsyncPurePursuitController::setTarget(std::string ipathId) {
+  LOG_INFO("AsyncPurePursuitController: Set target to: " + ipathId);
+
+  {
+    std::scoped_lock lock(currentPathMutex);
+    currentPath = ipathId;
+  }
+
+  isRunning.store(true, std::memory_order_release);
+}
+
+void AsyncPurePursuitController::controllerSet(const std::string ivalue) {
+  setTarget(ivalue);
+}
+
+std::string AsyncPurePursuitController::getTarget() {
+  std::scoped_lock lock(currentPathMutex);
+  return currentPath;
+}
+
+std::string AsyncPurePursuitController::getTarget() const {
+  std::scoped_lock lock(currentPathMutex);
+  return currentPath;
+}
+
+std::string AsyncPurePursuitController::getProcessValue() const {
+  std::scoped_lock lock(currentPathMutex);
+  return currentPath;
+}
+
+void AsyncPurePursuitController::loop() {
+  LOG_INFO_S("Started AsyncPurePursuitController task.");
+
+  auto rate = timeUtil.getRate();
+
+  while (!dtorCalled.load(std::memory_order_acquire) && !task->notifyTake(0)) {
+    if (isRunning.load(std::memory_order_acquire) && !isDisabled()) {
+      PathPtr path;
+      std::string target;
+      {
+        std::scoped_lock lock(currentPathMutex);
+        target = currentPath;
+        auto it = paths.find(currentPath);
+        if (it != paths.end()) {
+          path = it->second;
+        }
+      }
+
+      LOG_INFO("AsyncPurePursuitController: Running with path: " + target);
+
+      if (path == nullptr) {
+        LOG_WARN("AsyncPurePursuitController: Target was set to non-existent path with name: " +
+                 target);
+      } else {
+        LOG_DEBUG("AsyncPurePursuitController: Path length is " +
+                  std::to_string(path->points.size()));
+
+        executeSinglePath(*path, timeUtil.getRate());
+
+        // Stop after the path because:
+        // 1. We only support an exit velocity of zero
+        // 2. Because of (1), we should make sure the system is stopped
+        model->stop();
+
+        LOG_INFO_S("AsyncPurePursuitController: Done moving");
+      }
+
+      isRunning.store(false, std::memory_order_release);
+    }
+
+    rate->delayUntil(10_ms);
+  }
+
+  LOG_INFO_S("Stopped AsyncPurePursuitController task.");
+}
+
+void AsyncPurePursuitController::executeSinglePath(const Path &path,
+                                                   std::unique_ptr<AbstractRate> rate) {
+  const auto &points = path.points;
+  const double wheelTrack = scales.wheelTrack.convert(meter);
+  const double gearset = toUnderlyingType(pair.internalGearset);
+  auto toMotor = [&](const double ilinear) {
+    return convertLinearToRotational(ilinear * mps).convert(rpm) / gearset;
+  };
+
+  // Paths are followed relative to where the robot is when they start
+  const Pose start = getOdometryPose();
+  const PathPoint &pathStart = points.front();
+  const PathPoint &end = points.back();
+
+  std::size_t closest = 0;
+  double progress = 0;
+  double velocity = 0;
+
+  const auto window =
+    static_cast<std::size_t>(std::ceil(searchWindow * maxLookahead / pointSpacing));
+
+  QTime timeout;
+  {
+    std::scoped_lock lock(currentPathMutex);
+    timeout = stallTimeout;
+  }
+
+  // Give up on the path if the robot stops moving along it, so waitUntilSettled() can't hang
+  auto stallTimer = timeUtil.getTimer();
+  stallTimer->placeMark();
+
+  while (!isDisabled()) {
+    // Move the robot's displacement since the start of the path into the frame of the path
+    const Pose robot = getOdometryPose();
+    const double dx = robot.x - start.x;
+    const double dy = robot.y - start.y;
+    const double localX = std::cos(start.theta) * dx + std::sin(start.theta) * dy;
+    const double localY = -std::sin(start.theta) * dx + std::cos(start.theta) * dy;
+
+    const Pose pose{
+      pathStart.x + std::cos(pathStart.heading) * localX - std::sin(pathStart.heading) * localY,
+      pathStart.y + std::sin(pathStart.heading) * localX + std::cos(pathStart.heading) * localY,
+      pathStart.heading + robot.theta - start.theta};
+
+    // The robot only moves forwards along the path, so points behind the last closest point are
+    // never closer. Points far ahead of it may be closer where the path crosses itself, but the
+    // robot can't have reached them yet.
+    const std::size_t lastClosest = closest;
+    closest = path.index.nearest(pose.x, pose.y, closest, closest + window);
+
+    {
+      std::scoped_lock lock(currentPathMutex);
+      error = PathfinderPoint{(end.x - pose.x) * meter,
+                              (end.y - pose.y) * meter,
+                              std::remainder(end.heading - pose.theta, 2 * pi) * radian};
+    }
+
+    if (closest + 1 >= points.size()) {
+      break;
+    }
+
+    if (closest > lastClosest) {
+      stallTimer->placeMark();
+    } else if (stallTimer->getDtFromMark() >= timeout) {
+      LOG_WARN("AsyncPurePursuitController: Giving up on the path because the robot has not moved "
+               "along it for " +
+               std::to_string(timeout.convert(millisecond)) + " ms");
+      break;
+    }
+
+    // Speed up no faster than the max acceleration, but slow down right away for the turns and
+    // the end of the path
+    velocity = std::min(points[closest].velocity, velocity + path.maxAccel * period);
+
+    const auto [x, y] = findLookahead(points, pose, closest, getLookahead(velocity), progress);
+    const double curvature = arcCurvature(pose, x, y);
+
+    // driveVector() adds the yaw to the left side, and turning counterclockwise slows it down
+    model->driveVector(toMotor(velocity), -toMotor(velocity * curvature * wheelTrack / 2));
+
+    rate->delayUntil(period * second);
+  }
+
+  std::scoped_lock lock(currentPathMutex);
+  error = PathfinderPoint{0_m, 0_m, 0_deg};
+}
+
+std::pair<double, double>
+AsyncPurePursuitController::findLookahead(const std::vector<PathPoint> &ipoints,
+                                          const Pose &ipose,
+                                          const std::size_t iclosest,
+                                          const double ilookahead,
+                                          double &ioprogress) {
+  const std::size_t last = ipoints.size() - 1;
+
+  // The lookahead point is the first place after the closest point where the path leaves the
+  // circle, which is the far intersection of the circle with a segment of the path
+  for (std::size_t i = std::max(iclosest, static_cast<std::size_t>(ioprogress)); i < last; ++i) {
+    const double dx = ipoints[i + 1].x - ipoints[i].x;
+    const double dy = ipoints[i + 1].y - ipoints[i].y;
+    const double fx = ipoints[i].x - ipose.x;
+    const double fy = ipoints[i].y - ipose.y;
+
+    const double a = dx * dx + dy * dy;
+    const double b = 2 * (fx * dx + fy * dy);
+    const double c = fx * fx + fy * fy - ilookahead * ilookahead;
+    const double discriminant = b * b - 4 * a * c;
+    if (a <= 0 || discriminant < 0) {
+      continue;
+    }
+
+    const double t = (-b + std::sqrt(discriminant)) / (2 * a);
+    if (t >= 0 && t <= 1 && i + t >= ioprogress) {
+      ioprogress = i + t;
+      return {ipoints[i].x + dx * t, ipoints[i].y + dy * t};
+    }
+  }
+
+  // The end of the path is inside the circle
+  const auto &end = ipoints[last];
+  if (std::hypot(end.x - ipose.x, end.y - ipose.y) <= ilookahead) {
+    ioprogress = static_cast<double>(last);
+    return {end.x, end.y};
+  }
+
+  // The robot is further than the lookahead distance from the path, so drive back to it
+  ioprogress = std::max(ioprogress, static_cast<double>(iclosest));
+  const auto &target = ipoints[static_cast<std::size_t>(ioprogress)];
+  return {target.x, target.y};
+}
+
+double AsyncPurePursuitController::getLookahead(const double ivelocity) const {
+  return std::clamp(std::abs(ivelocity) * lookaheadTime, minLookahead, maxLookahead);
+}
+
+double
+AsyncPurePursuitController::arcCurvature(const Pose &ipose, const double ix, const double iy) {
+  // Rotate the point into the robot's frame. The arc is tangent to the robot, so its curvature only
+  // depends on how far the point is to the side.
+  const double dx = ix - ipose.x;
+  const double dy = iy - ipose.y;
+  const double side = -std::sin(ipose.theta) * dx + std::cos(ipose.theta) * dy;
+  const double distanceSquared = dx * dx + dy * dy;
+  return distanceSquared > 0 ? 2 * side / distanceSquared : 0;
+}
+
+AsyncPurePursuitController::Pose AsyncPurePursuitController::getOdometryPose() const {
+  const auto state = odometry->getState(StateMode::FRAME_TRANSFORMATION);
+  return Pose{state.x.convert(meter), -state.y.convert(meter), -state.theta.convert(radian)};
+}
+
+QAngularSpeed AsyncPurePursuitController::convertLinearToRotational(QSpeed linear) const {
+  return (linear * (360_deg / (scales.wheelDiameter * 1_pi))) * pair.ratio;
+}
+
+void AsyncPurePursuitController::trampoline(void *context) {
+  if (context) {
+    static_cast<AsyncPurePursuitController *>(context)->loop();
+  }
+}
+
+void AsyncPurePursuitController::waitUntilSettled() {
+  LOG_INFO_S("AsyncPurePursuitController: Waiting to settle");
+
+  auto rate = timeUtil.getRate();
+  while (!isSettled()) {
+    rate->delayUntil(10_ms);
+  }
+
+  LOG_INFO_S("AsyncPurePursuitController: Done waiting to settle");
+}
+
+void AsyncPurePursuitController::moveTo(std::initializer_list<PathfinderPoint> iwaypoints) {
+  moveTo(iwaypoints, limits);
+}
+
+void AsyncPurePursuitController::moveTo(std::initializer_list<PathfinderPoint> iwaypoints,
+                                        const PathfinderLimits &ilimits) {
+  static int moveToCount = 0;
+  std::string name = "__moveTo" + std::to_string(moveToCount++);
+  generatePath(iwaypoints, name, ilimits);
+  setTarget(name);
+  waitUntilSettled();
+  if (!removePath(name)) {
+    // Failed to remove path (Warn and move on)
+    LOG_WARN_S("AsyncPurePursuitController: Couldn't remove path after moveTo");
+  }
+}
+
+PathfinderPoint AsyncPurePursuitController::getError() const {
+  std::scoped_lock lock(currentPathMutex);
+  return error;
+}
+
+bool AsyncPurePursuitController::isSettled() {
+  return isDisabled() || !isRunning.load(std::memory_order_acquire);
+}
+
+void AsyncPurePursuitController::reset() {
+  // Interrupt executeSinglePath() by disabling the controller
+  flipDisable(true);
+
+  LOG_INFO_S("AsyncPurePursuitController: Waiting to reset");
+
+  auto rate = timeUtil.getRate();
+  while (isRunning.load(std::memory_order_acquire)) {
+    rate->delayUntil(1_ms);
+  }
+
+  flipDisable(false);
+}
+
+void AsyncPurePursuitController::flipDisable() {
+  flipDisable(!disabled.load(std::memory_order_acquire));
+}
+
+void AsyncPurePursuitController::flipDisable(const bool iisDisabled) {
+  LOG_INFO("AsyncPurePursuitController: flipDisable " + std::to_string(iisDisabled));
+  disabled.store(iisDisabled, std::memory_order_release);
+  // loop() will stop the model when executeSinglePath() is done
+  // the default implementation of executeSinglePath() breaks when disabled
+}
+
+bool AsyncPurePursuitController::isDisabled() const {
+  return disabled.load(std::memory_order_acquire);
+}
+
+void AsyncPurePursuitController::setTrajectoryGenerator(
+  const std::shared_ptr<const TrajectoryGenerator> &igenerator) {
+  std::scoped_lock lock(currentPathMutex);
+  trajectoryGenerator = igenerator ? igenerator : std::make_shared<TrajectoryGenerator>();
+}
+
+void AsyncPurePursuitController::setStallTimeout(const QTime itimeout) {
+  std::scoped_lock lock(currentPathMutex);
+  stallTimeout = itimeout;
+}
+
+QTime AsyncPurePursuitController::getStallTimeout() const {
+  std::scoped_lock lock(currentPathMutex);
+  return stallTimeout;
+}
+
+void AsyncPurePursuitController::startThread() {
+  if (!task) {
+    task = new CrossplatformThread(trampoline, this, "AsyncPurePursuitController");
+  }
+}
+
+CrossplatformThread *AsyncPurePursuitController::getThread() const {
+  return task;
+}
+
+void AsyncPurePursuitController::tarePosition() {
+}
+
+void AsyncPurePursuitController::setMaxVelocity(std::int32_t) {
+}
+
+void AsyncPurePursuitController::forceRemovePath(const std::string &ipathId) {
+  if (!removePath(ipathId)) {
+    LOG_WARN("AsyncPurePursuitController: Disabling controller to remove path " + ipathId);
+    flipDisable(true);
+    removePath(ipathId);
+  }
+}
+} // namespace okapi
@@ -0,0 +1,135 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncRamseteController.hpp"
+#include <cmath>
+
+namespace okapi {
+AsyncRamseteController::AsyncRamseteController(const TimeUtil &itimeUtil,
+                                               const PathfinderLimits &ilimits,
+                                               const std::shared_ptr<ChassisModel> &imodel,
+                                               const ChassisScales &iscales,
+                                               const AbstractMotor::GearsetRatioPair &ipair,
+                                               const std::shared_ptr<Odometry> &iodometry,
+                                               const double ib,
+                                               const double izeta,
+                                               const std::shared_ptr<Logger> &ilogger)
+  : AsyncMotionProfileController(itimeUtil, ilimits, imodel, iscales, ipair, ilogger),
+    odometry(iodometry),
+    b(ib),
+    zeta(izeta) {
+  if (ib <= 0) {
+    std::string msg("AsyncRamseteController: b must be greater than zero.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  if (izeta <= 0 || izeta >= 1) {
+    std::string msg("AsyncRamseteController: zeta must be in the range (0, 1).");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+}
+
+AsyncRamseteController::~AsyncRamseteController() {
+  // Stop the task before our members are destroyed because it calls our executeSinglePath()
+  dtorCalled.store(true, std::memory_order_release);
+  disabled.store(true, std::memory_order_release);
+  delete task;
+  task = nullptr;
+}
+
+AsyncRamseteController::ChassisSpeeds
+AsyncRamseteController::calculate(const Pose &ipose,
+                                  const Pose &idesiredPose,
+                                  const ChassisSpeeds &idesiredSpeeds) const {
+  // Rotate the error into the robot's frame
+  const double dx = idesiredPose.x - ipose.x;
+  const double dy = idesiredPose.y - ipose.y;
+  const double errorX = std::cos(ipose.theta) * dx + std::sin(ipose.theta) * dy;
+  const double errorY = -std::sin(ipose.theta) * dx + std::cos(ipose.theta) * dy;
+  const double errorTheta = std::remainder(idesiredPose.theta - ipose.theta, 2 * 1_pi);
+
+  const double k = 2 * zeta *
+                   std::sqrt(idesiredSpeeds.angular * idesiredSpeeds.angular +
+                             b * idesiredSpeeds.linear * idesiredSpeeds.linear);
+
+  // sin(x) / x goes to 1 as x goes to 0
+  const double sinc = std::abs(errorTheta) < 1e-9 ? 1 : std::sin(errorTheta) / errorTheta;
+
+  return ChassisSpeeds{idesiredSpeeds.linear * std::cos(errorTheta) + k * errorX,
+                       idesiredSpeeds.angular + k * errorTheta +
+                         b * idesiredSpeeds.linear * sinc * errorY};
+}
+
+void AsyncRamseteController::executeSinglePath(const TrajectoryPair &path,
+                                               std::unique_ptr<AbstractRate> rate) {
+  const int reversed = direction.load(std::memory_order_acquire);
+  const bool followMirrored = mirrored.load(std::memory_order_acquire);
+  const double wheelTrack = scales.wheelTrack.convert(meter);
+  const double gearset = toUnderlyingType(pair.internalGearset);
+
+  if (!path.left.hasPose()) {
+    LOG_ERROR_S("AsyncRamseteController: The path was stored without its pose and can't be "
+                "followed. See setTrajectoryStorage().");
+    return;
+  }
+
+  // Reversing and mirroring are reflections, so the robot's pose is reflected into the frame of
+  // the path and the output is reflected back out of it
+  const double xSign = reversed;
+  const double ySign = followMirrored ? -1 : 1;
+  const double thetaSign = xSign * ySign;
+
+  // Paths are followed relative to where the robot is when they start
+  const Pose start = getOdometryPose();
+  Pose pathStart{};
+
+  for (int i = 0; i < path.length && !isDisabled(); ++i) {
+    const auto left = path.left.getSegment(i);
+    const auto right = path.right.getSegment(i);
+
+    // The center of the chassis is between the wheels
+    const Pose desiredPose{(left.x + right.x) / 2, (left.y + right.y) / 2, left.heading};
+    if (i == 0) {
+      pathStart = desiredPose;
+    }
+
+    const ChassisSpeeds desiredSpeeds{(left.velocity + right.velocity) / 2,
+                                      (right.velocity - left.velocity) / wheelTrack};
+
+    // Move the robot's displacement since the start of the path into the frame of the path
+    const Pose robot = getOdometryPose();
+    const double dx = robot.x - start.x;
+    const double dy = robot.y - start.y;
+    const double localX = (std::cos(start.theta) * dx + std::sin(start.theta) * dy) * xSign;
+    const double localY = (-std::sin(start.theta) * dx + std::cos(start.theta) * dy) * ySign;
+    const double localTheta = (robot.theta - start.theta) * thetaSign;
+
+    const Pose pose{
+      pathStart.x + std::cos(pathStart.theta) * localX - std::sin(pathStart.theta) * localY,
+      pathStart.y + std::sin(pathStart.theta) * localX + std::cos(pathStart.theta) * localY,
+      pathStart.theta + localTheta};
+
+    const auto speeds = calculate(pose, desiredPose, desiredSpeeds);
+    const double linear = speeds.linear * xSign;
+    const double angular = speeds.angular * thetaSign;
+
+    const double leftSpeed =
+      convertLinearToRotational((linear - angular * wheelTrack / 2) * mps).convert(rpm) / gearset;
+    const double rightSpeed =
+      convertLinearToRotational((linear + angular * wheelTrack / 2) * mps).convert(rpm) / gearset;
+    model->left(leftSpeed);
+    model->right(rightSpeed);
+
+    rate->delayUntil(left.dt * second);
+  }
+}
+
+AsyncRamseteController::Pose AsyncRamseteController::getOdometryPose() const {
+  const auto state = odometry->getState(StateMode::FRAME_TRANSFORMATION);
+  return Pose{state.x.convert(meter), -state.y.convert(meter), -state.theta.convert(radian)};
+}
+} // namespace okapi
@@ -0,0 +1,152 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/iterative/iterativeCascadedPidController.hpp"
+#include <stdexcept>
+
+namespace okapi {
+IterativeCascadedPIDController::IterativeCascadedPIDController(
+  const std::shared_ptr<IterativePosPIDController> &iouterController,
+  const std::shared_ptr<IterativeVelPIDController> &iinnerController,
+  const double imaxVelocity,
+  std::shared_ptr<Logger> ilogger)
+  : logger(std::move(ilogger)),
+    outerController(iouterController),
+    innerController(iinnerController) {
+  if (outerController->getSampleTime() < innerController->getSampleTime()) {
+    std::string msg = "IterativeCascadedPIDController: The outer controller's sample time must be "
+                      "at least the inner controller's sample time.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  setMaxVelocity(imaxVelocity);
+  alignControllers();
+}
+
+double IterativeCascadedPIDController::step(const double ireading) {
+  // The outer controller keeps its last output between its steps, so the inner controller follows
+  // the latest velocity target on every step
+  innerController->controllerSet(outerController->step(ireading));
+  return innerController->step(ireading);
+}
+
+void IterativeCascadedPIDController::setTarget(const double itarget) {
+  LOG_INFO("IterativeCascadedPIDController: Set target to " + std::to_string(itarget));
+  outerController->setTarget(itarget);
+}
+
+void IterativeCascadedPIDController::controllerSet(const double ivalue) {
+  outerController->controllerSet(ivalue);
+}
+
+double IterativeCascadedPIDController::getTarget() {
+  return outerController->getTarget();
+}
+
+double IterativeCascadedPIDController::getProcessValue() const {
+  return outerController->getProcessValue();
+}
+
+double IterativeCascadedPIDController::getOutput() const {
+  return innerController->getOutput();
+}
+
+double IterativeCascadedPIDController::getMaxOutput() {
+  return innerController->getMaxOutput();
+}
+
+double IterativeCascadedPIDController::getMinOutput() {
+  return innerController->getMinOutput();
+}
+
+double IterativeCascadedPIDController::getError() const {
+  return outerController->getError();
+}
+
+bool IterativeCascadedPIDController::isSettled() {
+  return outerController->isSettled();
+}
+
+void IterativeCascadedPIDController::setSampleTime(const QTime isampleTime) {
+  if (isampleTime > 0_ms) {
+    const double oversampling = getOversampling();
+    innerController->setSampleTime(isampleTime);
+    outerController->setSampleTime(isampleTime * oversampling);
+    alignControllers();
+  }
+}
+
+void IterativeCascadedPIDController::setOutputLimits(const double imax, const double imin) {
+  innerController->setOutputLimits(imax, imin);
+}
+
+void IterativeCascadedPIDController::setControllerSetTargetLimits(const double itargetMax,
+                                                                  const double itargetMin) {
+  outerController->setControllerSetTargetLimits(itargetMax, itargetMin);
+}
+
+void IterativeCascadedPIDController::reset() {
+  LOG_INFO_S("IterativeCascadedPIDController: Reset");
+  outerController->reset();
+  innerController->reset();
+}
+
+void IterativeCascadedPIDController::flipDisable() {
+  flipDisable(!isDisabled());
+}
+
+void IterativeCascadedPIDController::flipDisable(const bool iisDisabled) {
+  LOG_INFO("IterativeCascadedPIDController: flipDisable " + std::to_string(iisDisabled));
+  outerController->flipDisable(iisDisabled);
+  innerController->flipDisable(iisDisabled);
+}
+
+bool IterativeCascadedPIDController::isDisabled() const {
+  return outerController->isDisabled();
+}
+
+QTime IterativeCascadedPIDController::getSampleTime() const {
+  return innerController->getSampleTime();
+}
+
+void IterativeCascadedPIDController::setMaxVelocity(const double imaxVelocity) {
+  if (imaxVelocity <= 0) {
+    std::string msg = "IterativeCascadedPIDController: The max velocity must be greater than zero.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  maxVelocity = imaxVelocity;
+  innerController->setControllerSetTargetLimits(maxVelocity, -maxVelocity);
+}
+
+double IterativeCascadedPIDController::getMaxVelocity() const {
+  return maxVelocity;
+}
+
+double IterativeCascadedPIDController::getOversampling() const {
+  return outerController->getSampleTime().convert(millisecond) /
+         innerController->getSampleTime().convert(millisecond);
+}
+
+std::shared_ptr<IterativePosPIDController>
+IterativeCascadedPIDController::getOuterController() const {
+  return outerController;
+}
+
+std::shared_ptr<IterativeVelPIDController>
+IterativeCascadedPIDController::getInnerController() const {
+  return innerController;
+}
+
+void IterativeCascadedPIDController::alignControllers() {
+  const QTime jitterTolerance = innerController->getSampleTime() / 2;
+  outerController->setUseMeasuredDt(true);
+  outerController->setJitterTolerance(jitterTolerance);
+  innerController->setUseMeasuredDt(true);
+  innerController->setJitterTolerance(jitterTolerance);
+}
+} // namespace okapi
@@ -6,9 +6,11 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/util/pidGainSchedule.hpp"
 #include "okapi/api/util/mathUtil.hpp"
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace okapi {
 IterativePosPIDController::IterativePosPIDController(const double ikP,
@@ -42,6 +44,14 @@ IterativePosPIDController::IterativePosPIDController(const Gains &igains,
 void IterativePosPIDController::setTarget(const double itarget) {
   LOG_INFO("IterativePosPIDController: Set target to " + std::to_string(itarget));
   target = itarget;
+  targetVelocity = 0;
+  targetAcceleration = 0;
+}
+
+void IterativePosPIDController::setTargetVelocity(const double ivelocity,
+                                                  const double iacceleration) {
+  targetVelocity = ivelocity;
+  targetAcceleration = iacceleration;
 }
 
 void IterativePosPIDController::controllerSet(const double ivalue) {
@@ -121,16 +131,28 @@ double IterativePosPIDController::step(const double inewReading) {
   } else {
     loopDtTimer->placeHardMark();
 
-    if (loopDtTimer->getDtFromHardMark() >= sampleTime) {
+    // The mark is placed on every step, so this is the time since the last step
+    const QTime stepDt = loopDtTimer->getDtFromMark();
+
+    if (shouldStep(stepDt)) {
+      // Scale the integral and derivative to the time since the last step if it is known
+      const double dtRatio = useMeasuredDt && stepMarkPlaced
+                               ? stepDt.convert(millisecond) / sampleTime.convert(millisecond)
+                               : 1;
+
       // lastReading must only be updated here so its updates are time-gated by sampleTime
       const double readingDiff = inewReading - lastReading;
       lastReading = inewReading;
 
       error = getError();
 
+      if (gainSchedule) {
+        setGains(gainSchedule->getGains(error, target));
+      }
+
       if ((std::abs(error) < target - errorSumMin && std::abs(error) > target - errorSumMax) ||
           (std::abs(error) > target + errorSumMin && std::abs(error) < target + errorSumMax)) {
-        integral += kI * error; // Eliminate integral kick while realtime tuning
+        integral += kI * error * dtRatio; // Eliminate integral kick while realtime tuning
       }
 
       if (shouldResetOnCross && std::copysign(1.0, error) != std::copysign(1.0, lastError)) {
@@ -140,14 +162,29 @@ double IterativePosPIDController::step(const double inewReading) {
       integral = std::clamp(integral, integralMin, integralMax);
 
       // Derivative over measurement to eliminate derivative kick on setpoint change
-      derivative = derivativeFilter->filter(readingDiff);
+      derivative = derivativeFilter->filter(readingDiff / dtRatio);
+
+      // Static friction is overcome in the direction the target is moving. There is no kS term
+      // while the target is still, where it would flip sign with the error near the target.
+      const double feedforward = kS * ((targetVelocity > 0) - (targetVelocity < 0)) +
+                                 kV * targetVelocity + kA * targetAcceleration;
 
-      output = std::clamp(kP * error + integral - kD * derivative + kBias, outputMin, outputMax);
+      output = std::clamp(
+        kP * error + integral - kD * derivative + kBias + feedforward, outputMin, outputMax);
 
       lastError = error;
       loopDtTimer->clearHardMark(); // Important that we only clear if dt >= sampleTime
 
+      if (stepMarkPlaced) {
+        stepTimingStats.recordInterval(stepDt, sampleTime + jitterTolerance);
+      }
+      stepTimingStats.steps++;
+      loopDtTimer->placeMark();
+      stepMarkPlaced = true;
+
       settledUtil->isSettled(error);
+    } else {
+      stepTimingStats.skipped++;
     }
   }
 
@@ -162,6 +199,7 @@ void IterativePosPIDController::reset() {
   lastReading = 0;
   integral = 0;
   output = 0;
+  stepMarkPlaced = false;
   settledUtil->reset();
 }
 
@@ -176,6 +214,11 @@ void IterativePosPIDController::flipDisable() {
 void IterativePosPIDController::flipDisable(const bool iisDisabled) {
   LOG_INFO("IterativePosPIDController: flipDisable " + std::to_string(iisDisabled));
   controllerIsDisabled = iisDisabled;
+
+  if (controllerIsDisabled) {
+    // Don't measure the time between steps across the time spent disabled
+    stepMarkPlaced = false;
+  }
 }
 
 bool IterativePosPIDController::isDisabled() const {
@@ -211,15 +254,67 @@ void IterativePosPIDController::setGains(const Gains &igains) {
   kI = igains.kI * sampleTimeSec;
   kD = igains.kD / sampleTimeSec;
   kBias = igains.kBias;
+  kS = igains.kS;
+  kV = igains.kV;
+  kA = igains.kA;
 }
 
 IterativePosPIDController::Gains IterativePosPIDController::getGains() const {
-  return {kP, kI / sampleTime.convert(second), kD * sampleTime.convert(second), kBias};
+  return {kP, kI / sampleTime.convert(second), kD * sampleTime.convert(second), kBias, kS, kV, kA};
+}
+
+void IterativePosPIDController::setGainSchedule(std::shared_ptr<PIDGainSchedule> igainSchedule) {
+  gainSchedule = std::move(igainSchedule);
+}
+
+std::shared_ptr<PIDGainSchedule> IterativePosPIDController::getGainSchedule() const {
+  return gainSchedule;
+}
+
+bool IterativePosPIDController::shouldStep(const QTime istepDt) const {
+  if (useMeasuredDt) {
+    return !stepMarkPlaced || (istepDt > 0_ms && istepDt >= sampleTime - jitterTolerance);
+  }
+
+  return loopDtTimer->getDtFromHardMark() >= sampleTime;
+}
+
+void IterativePosPIDController::setUseMeasuredDt(const bool iuseMeasuredDt) {
+  useMeasuredDt = iuseMeasuredDt;
+}
+
+bool IterativePosPIDController::isUsingMeasuredDt() const {
+  return useMeasuredDt;
+}
+
+void IterativePosPIDController::setJitterTolerance(const QTime ijitterTolerance) {
+  if (ijitterTolerance < 0_ms || ijitterTolerance >= sampleTime) {
+    std::string msg = "IterativePosPIDController: The jitter tolerance (" +
+                      std::to_string(ijitterTolerance.convert(millisecond)) +
+                      " ms) must be at least 0 ms and less than the sample time.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  jitterTolerance = ijitterTolerance;
+}
+
+QTime IterativePosPIDController::getJitterTolerance() const {
+  return jitterTolerance;
+}
+
+StepTimingStats IterativePosPIDController::getStepTimingStats() const {
+  return stepTimingStats;
+}
+
+void IterativePosPIDController::resetStepTimingStats() {
+  stepTimingStats = StepTimingStats();
 }
 
 bool IterativePosPIDController::Gains::operator==(
   const IterativePosPIDController::Gains &rhs) const {
-  return kP == rhs.kP && kI == rhs.kI && kD == rhs.kD && kBias == rhs.kBias;
+  return kP == rhs.kP && kI == rhs.kI && kD == rhs.kD && kBias == rhs.kBias && kS == rhs.kS &&
+         kV == rhs.kV && kA == rhs.kA;
 }
 
 bool IterativePosPIDController::Gains::operator!=(
@@ -7,6 +7,7 @@
 #include "okapi/api/util/mathUtil.hpp"
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace okapi {
 IterativeVelPIDController::IterativeVelPIDController(const double ikP,
@@ -80,19 +81,36 @@ double IterativeVelPIDController::step(const double inewReading) {
   if (!controllerIsDisabled) {
     loopDtTimer->placeHardMark();
 
-    if (loopDtTimer->getDtFromHardMark() >= sampleTime) {
+    // The mark is placed on every step, so this is the time since the last step
+    const QTime stepDt = loopDtTimer->getDtFromMark();
+
+    if (shouldStep(stepDt)) {
+      // Scale the change in output to the time since the last step if it is known
+      const double dtRatio = useMeasuredDt && stepMarkPlaced
+                               ? stepDt.convert(millisecond) / sampleTime.convert(millisecond)
+                               : 1;
+
       stepVel(inewReading);
       error = getError();
 
       // Derivative over measurement to eliminate derivative kick on setpoint change
       derivative = derivativeFilter->filter(velMath->getAccel().getValue());
 
-      outputSum += kP * error - kD * derivative;
+      outputSum += (kP * error - kD * derivative) * dtRatio;
       outputSum = std::clamp(outputSum, outputMin, outputMax);
 
       loopDtTimer->clearHardMark(); // Important that we only clear if dt >= sampleTime
 
+      if (stepMarkPlaced) {
+        stepTimingStats.recordInterval(stepDt, sampleTime + jitterTolerance);
+      }
+      stepTimingStats.steps++;
+      loopDtTimer->placeMark();
+      stepMarkPlaced = true;
+
       settledUtil->isSettled(error);
+    } else {
+      stepTimingStats.skipped++;
     }
 
     output =
@@ -150,6 +168,7 @@ void IterativeVelPIDController::reset() {
   error = 0;
   outputSum = 0;
   output = 0;
+  stepMarkPlaced = false;
   settledUtil->reset();
 }
 
@@ -160,6 +179,11 @@ void IterativeVelPIDController::flipDisable() {
 void IterativeVelPIDController::flipDisable(const bool iisDisabled) {
   LOG_INFO("IterativeVelPIDController: flipDisable " + std::to_string(iisDisabled));
   controllerIsDisabled = iisDisabled;
+
+  if (controllerIsDisabled) {
+    // Don't measure the time between steps across the time spent disabled
+    stepMarkPlaced = false;
+  }
 }
 
 bool IterativeVelPIDController::isDisabled() const {
@@ -177,6 +201,46 @@ IterativeVelPIDController::Gains IterativeVelPIDController::getGains() const {
   return {kP, kD * sampleTime.convert(second), kF, kSF};
 }
 
+bool IterativeVelPIDController::shouldStep(const QTime istepDt) const {
+  if (useMeasuredDt) {
+    return !stepMarkPlaced || (istepDt > 0_ms && istepDt >= sampleTime - jitterTolerance);
+  }
+
+  return loopDtTimer->getDtFromHardMark() >= sampleTime;
+}
+
+void IterativeVelPIDController::setUseMeasuredDt(const bool iuseMeasuredDt) {
+  useMeasuredDt = iuseMeasuredDt;
+}
+
+bool IterativeVelPIDController::isUsingMeasuredDt() const {
+  return useMeasuredDt;
+}
+
+void IterativeVelPIDController::setJitterTolerance(const QTime ijitterTolerance) {
+  if (ijitterTolerance < 0_ms || ijitterTolerance >= sampleTime) {
+    std::string msg = "IterativeVelPIDController: The jitter tolerance (" +
+                      std::to_string(ijitterTolerance.convert(millisecond)) +
+                      " ms) must be at least 0 ms and less than the sample time.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  jitterTolerance = ijitterTolerance;
+}
+
+QTime IterativeVelPIDController::getJitterTolerance() const {
+  return jitterTolerance;
+}
+
+StepTimingStats IterativeVelPIDController::getStepTimingStats() const {
+  return stepTimingStats;
+}
+
+void IterativeVelPIDController::resetStepTimingStats() {
+  stepTimingStats = StepTimingStats();
+}
+
 void IterativeVelPIDController::setTicksPerRev(const double tpr) {
   velMath->setTicksPerRev(tpr);
 }
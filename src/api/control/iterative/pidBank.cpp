@@ -0,0 +1,253 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/iterative/pidBank.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace okapi {
+PIDBank::PIDBank(const std::vector<IterativePosPIDController::Gains> &igains,
+                 const TimeUtil &itimeUtil,
+                 std::shared_ptr<Logger> ilogger)
+  : logger(std::move(ilogger)),
+    loopDtTimer(itimeUtil.getTimer()),
+    kP(igains.size(), 0),
+    kI(igains.size(), 0),
+    kD(igains.size(), 0),
+    kBias(igains.size(), 0),
+    target(igains.size(), 0),
+    lastReading(igains.size(), 0),
+    error(igains.size(), 0),
+    lastError(igains.size(), 0),
+    integral(igains.size(), 0),
+    output(igains.size(), 0),
+    integralMax(igains.size(), 1),
+    integralMin(igains.size(), -1),
+    errorSumMin(igains.size(), 0),
+    errorSumMax(igains.size(), std::numeric_limits<double>::max()),
+    outputMax(igains.size(), 1),
+    outputMin(igains.size(), -1),
+    shouldResetOnCross(igains.size(), true),
+    controllerIsDisabled(igains.size(), false),
+    atTargetError(igains.size(), 50),
+    atTargetDerivative(igains.size(), 5),
+    atTargetTime(igains.size(), 250),
+    atTargetSince(igains.size(), std::numeric_limits<double>::quiet_NaN()),
+    settledLastError(igains.size(), 0),
+    settled(igains.size(), false),
+    stepOutput(igains.size(), 0) {
+  for (std::size_t i = 0; i < igains.size(); ++i) {
+    if (igains[i].kI != 0) {
+      setIntegralLimits(i, 1 / igains[i].kI, -1 / igains[i].kI);
+    }
+    setGains(i, igains[i]);
+  }
+}
+
+const std::vector<double> &PIDBank::step(const std::vector<double> &ireadings) {
+  if (ireadings.size() != size()) {
+    std::string msg = "PIDBank: Got " + std::to_string(ireadings.size()) + " readings for " +
+                      std::to_string(size()) + " controllers.";
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  loopDtTimer->placeHardMark();
+
+  if (loopDtTimer->getDtFromHardMark() >= sampleTime) {
+    const double now = loopDtTimer->millis().convert(millisecond);
+    const std::size_t count = size();
+
+    // Every controller is computed and then only written back if it is enabled, so this loop has
+    // no branches
+    for (std::size_t i = 0; i < count; ++i) {
+      const bool enabled = !controllerIsDisabled[i];
+      const double reading = enabled ? ireadings[i] : lastReading[i];
+
+      // Same as IterativePosPIDController::step() with a PassthroughFilter on the derivative
+      const double readingDiff = reading - lastReading[i];
+      const double newError = target[i] - reading;
+      const double absError = std::abs(newError);
+
+      const bool inErrorSumLimits =
+        (absError < target[i] - errorSumMin[i] && absError > target[i] - errorSumMax[i]) ||
+        (absError > target[i] + errorSumMin[i] && absError < target[i] + errorSumMax[i]);
+      double newIntegral = inErrorSumLimits ? integral[i] + kI[i] * newError : integral[i];
+
+      const bool crossed =
+        shouldResetOnCross[i] && std::signbit(newError) != std::signbit(lastError[i]);
+      newIntegral = std::clamp(crossed ? 0.0 : newIntegral, integralMin[i], integralMax[i]);
+
+      const double newOutput =
+        std::clamp(kP[i] * newError + newIntegral - kD[i] * readingDiff + kBias[i],
+                   outputMin[i],
+                   outputMax[i]);
+
+      // Same as SettledUtil::isSettled(), which does not update its last error when it settles
+      // immediately
+      const bool atTarget = absError <= atTargetError[i] &&
+                            std::abs(newError - settledLastError[i]) <= atTargetDerivative[i];
+      const bool settledNow = atTarget && atTargetTime[i] == 0;
+      const double markedSince = std::isnan(atTargetSince[i]) ? now : atTargetSince[i];
+      const double since = settledNow ? atTargetSince[i]
+                                      : atTarget ? markedSince
+                                                 : std::numeric_limits<double>::quiet_NaN();
+      const bool newSettled = settledNow || now - since > atTargetTime[i];
+
+      lastReading[i] = reading;
+      error[i] = enabled ? newError : error[i];
+      lastError[i] = enabled ? newError : lastError[i];
+      integral[i] = enabled ? newIntegral : integral[i];
+      output[i] = enabled ? newOutput : output[i];
+      atTargetSince[i] = enabled ? since : atTargetSince[i];
+      settledLastError[i] = enabled && !settledNow ? newError : settledLastError[i];
+      settled[i] = enabled ? newSettled : settled[i];
+      stepOutput[i] = enabled ? newOutput : 0;
+    }
+
+    loopDtTimer->clearHardMark(); // Important that we only clear if dt >= sampleTime
+  } else {
+    for (std::size_t i = 0; i < stepOutput.size(); ++i) {
+      stepOutput[i] = controllerIsDisabled[i] ? 0 : output[i];
+    }
+  }
+
+  return stepOutput;
+}
+
+std::size_t PIDBank::size() const {
+  return kP.size();
+}
+
+void PIDBank::setTarget(const std::size_t iindex, const double itarget) {
+  target[iindex] = itarget;
+}
+
+double PIDBank::getTarget(const std::size_t iindex) const {
+  return target[iindex];
+}
+
+double PIDBank::getProcessValue(const std::size_t iindex) const {
+  return lastReading[iindex];
+}
+
+double PIDBank::getOutput(const std::size_t iindex) const {
+  return isDisabled(iindex) ? 0 : output[iindex];
+}
+
+double PIDBank::getError(const std::size_t iindex) const {
+  return target[iindex] - lastReading[iindex];
+}
+
+bool PIDBank::isSettled(const std::size_t iindex) const {
+  return isDisabled(iindex) ? true : settled[iindex];
+}
+
+bool PIDBank::isSettled() const {
+  for (std::size_t i = 0; i < size(); ++i) {
+    if (!isSettled(i)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void PIDBank::setSettleConditions(const std::size_t iindex,
+                                  const double iatTargetError,
+                                  const double iatTargetDerivative,
+                                  const QTime iatTargetTime) {
+  atTargetError[iindex] = iatTargetError;
+  atTargetDerivative[iindex] = iatTargetDerivative;
+  atTargetTime[iindex] = iatTargetTime.convert(millisecond);
+}
+
+void PIDBank::setSampleTime(const QTime isampleTime) {
+  if (isampleTime > 0_ms) {
+    const double ratio = isampleTime.convert(millisecond) / sampleTime.convert(millisecond);
+    for (std::size_t i = 0; i < size(); ++i) {
+      kI[i] *= ratio;
+      kD[i] /= ratio;
+    }
+    sampleTime = isampleTime;
+  }
+}
+
+QTime PIDBank::getSampleTime() const {
+  return sampleTime;
+}
+
+void PIDBank::setOutputLimits(const std::size_t iindex, double imax, double imin) {
+  // Always use larger value as max
+  if (imin > imax) {
+    std::swap(imax, imin);
+  }
+
+  outputMax[iindex] = imax;
+  outputMin[iindex] = imin;
+
+  output[iindex] = std::clamp(output[iindex], imin, imax);
+}
+
+void PIDBank::setIntegralLimits(const std::size_t iindex, double imax, double imin) {
+  // Always use larger value as max
+  if (imin > imax) {
+    std::swap(imax, imin);
+  }
+
+  integralMax[iindex] = imax;
+  integralMin[iindex] = imin;
+
+  integral[iindex] = std::clamp(integral[iindex], imin, imax);
+}
+
+void PIDBank::setErrorSumLimits(const std::size_t iindex, const double imax, const double imin) {
+  errorSumMax[iindex] = imax;
+  errorSumMin[iindex] = imin;
+}
+
+void PIDBank::setIntegratorReset(const std::size_t iindex, const bool iresetOnZero) {
+  shouldResetOnCross[iindex] = iresetOnZero;
+}
+
+void PIDBank::setGains(const std::size_t iindex, const IterativePosPIDController::Gains &igains) {
+  const double sampleTimeSec = sampleTime.convert(second);
+  kP[iindex] = igains.kP;
+  kI[iindex] = igains.kI * sampleTimeSec;
+  kD[iindex] = igains.kD / sampleTimeSec;
+  kBias[iindex] = igains.kBias;
+}
+
+IterativePosPIDController::Gains PIDBank::getGains(const std::size_t iindex) const {
+  return {kP[iindex],
+          kI[iindex] / sampleTime.convert(second),
+          kD[iindex] * sampleTime.convert(second),
+          kBias[iindex]};
+}
+
+void PIDBank::reset(const std::size_t iindex) {
+  LOG_INFO("PIDBank: Reset controller " + std::to_string(iindex));
+
+  error[iindex] = 0;
+  lastError[iindex] = 0;
+  lastReading[iindex] = 0;
+  integral[iindex] = 0;
+  output[iindex] = 0;
+  atTargetSince[iindex] = std::numeric_limits<double>::quiet_NaN();
+  settledLastError[iindex] = 0;
+  settled[iindex] = false;
+}
+
+void PIDBank::flipDisable(const std::size_t iindex, const bool iisDisabled) {
+  LOG_INFO("PIDBank: flipDisable " + std::to_string(iindex) + " " + std::to_string(iisDisabled));
+  controllerIsDisabled[iindex] = iisDisabled;
+}
+
+bool PIDBank::isDisabled(const std::size_t iindex) const {
+  return controllerIsDisabled[iindex];
+}
+} // namespace okapi
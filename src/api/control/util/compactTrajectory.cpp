@@ -0,0 +1,187 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/compactTrajectory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace okapi {
+CompactTrajectory::CompactTrajectory(const Segment *isegments,
+                                     const int ilength,
+                                     const Precision iprecision,
+                                     const bool iretainPose)
+  : length(std::max(ilength, 0)), precision(iprecision), pose(iretainPose) {
+  auto column = [&](double Segment::*field) {
+    std::vector<double> values(length);
+    for (int i = 0; i < length; ++i) {
+      values[i] = isegments[i].*field;
+    }
+    return Column(values, precision);
+  };
+
+  if (length > 0) {
+    dt = isegments[0].dt;
+    constantDt = std::all_of(
+      isegments, isegments + length, [&](const Segment &segment) { return segment.dt == dt; });
+  }
+
+  if (!constantDt) {
+    dts = column(&Segment::dt);
+  }
+
+  velocities = column(&Segment::velocity);
+  positions = column(&Segment::position);
+
+  if (pose) {
+    xs = column(&Segment::x);
+    ys = column(&Segment::y);
+    headings = column(&Segment::heading);
+  }
+
+  if (precision == Precision::float64) {
+    accelerations = column(&Segment::acceleration);
+    jerks = column(&Segment::jerk);
+  }
+}
+
+CompactTrajectory::CompactTrajectory(const BakedTrajectorySide &iside,
+                                     const int ilength,
+                                     const double idt)
+  : length(std::max(ilength, 0)),
+    precision(Precision::float32),
+    pose(true),
+    dt(idt),
+    velocities(iside.velocity),
+    positions(iside.position),
+    xs(iside.x),
+    ys(iside.y),
+    headings(iside.heading) {
+}
+
+int CompactTrajectory::getLength() const {
+  return length;
+}
+
+CompactTrajectory::Precision CompactTrajectory::getPrecision() const {
+  return precision;
+}
+
+bool CompactTrajectory::hasPose() const {
+  return pose;
+}
+
+bool CompactTrajectory::hasConstantDt() const {
+  return constantDt;
+}
+
+double CompactTrajectory::getDt(const int i) const {
+  return constantDt ? dt : dts[i];
+}
+
+double CompactTrajectory::getVelocity(const int i) const {
+  return velocities[i];
+}
+
+double CompactTrajectory::getPosition(const int i) const {
+  return positions[i];
+}
+
+Segment CompactTrajectory::getSegment(const int i) const {
+  Segment segment{};
+  segment.dt = getDt(i);
+  segment.velocity = getVelocity(i);
+  segment.position = getPosition(i);
+
+  if (pose) {
+    segment.x = xs[i];
+    segment.y = ys[i];
+    segment.heading = headings[i];
+  }
+
+  if (precision == Precision::float64) {
+    segment.acceleration = accelerations[i];
+    segment.jerk = jerks[i];
+    return segment;
+  }
+
+  // Differentiate the same way pathfinder does, starting from rest
+  const double lastVelocity = i > 0 ? getVelocity(i - 1) : 0;
+  segment.acceleration = (segment.velocity - lastVelocity) / segment.dt;
+
+  const double lastAcceleration =
+    i > 0 ? (lastVelocity - (i > 1 ? getVelocity(i - 2) : 0)) / getDt(i - 1) : 0;
+  segment.jerk = (segment.acceleration - lastAcceleration) / segment.dt;
+
+  return segment;
+}
+
+std::vector<Segment> CompactTrajectory::getSegments() const {
+  std::vector<Segment> segments;
+  segments.reserve(length);
+
+  for (int i = 0; i < length; ++i) {
+    segments.push_back(getSegment(i));
+  }
+
+  return segments;
+}
+
+std::size_t CompactTrajectory::getMemoryUsage() const {
+  return dts.getMemoryUsage() + velocities.getMemoryUsage() + positions.getMemoryUsage() +
+         xs.getMemoryUsage() + ys.getMemoryUsage() + headings.getMemoryUsage() +
+         accelerations.getMemoryUsage() + jerks.getMemoryUsage();
+}
+
+CompactTrajectory::Column::Column(const std::vector<double> &ivalues, const Precision iprecision)
+  : precision(iprecision) {
+  switch (precision) {
+  case Precision::float64:
+    doubles = ivalues;
+    break;
+
+  case Precision::float32:
+    floats.assign(ivalues.begin(), ivalues.end());
+    break;
+
+  case Precision::fixed16: {
+    double maxMagnitude = 0;
+    for (const double value : ivalues) {
+      maxMagnitude = std::max(maxMagnitude, std::abs(value));
+    }
+
+    constexpr double fixedMax = std::numeric_limits<std::int16_t>::max();
+    scale = maxMagnitude > 0 ? maxMagnitude / fixedMax : 1;
+
+    fixed.reserve(ivalues.size());
+    for (const double value : ivalues) {
+      fixed.push_back(static_cast<std::int16_t>(std::lround(value / scale)));
+    }
+    break;
+  }
+  }
+}
+
+CompactTrajectory::Column::Column(const float *iview) : precision(Precision::float32), view(iview) {
+}
+
+double CompactTrajectory::Column::operator[](const int i) const {
+  switch (precision) {
+  case Precision::float32:
+    return view ? view[i] : floats[i];
+
+  case Precision::fixed16:
+    return fixed[i] * scale;
+
+  default:
+    return doubles[i];
+  }
+}
+
+std::size_t CompactTrajectory::Column::getMemoryUsage() const {
+  return doubles.size() * sizeof(double) + floats.size() * sizeof(float) +
+         fixed.size() * sizeof(std::int16_t);
+}
+} // namespace okapi
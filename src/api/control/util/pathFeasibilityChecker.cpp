@@ -0,0 +1,157 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pathFeasibilityChecker.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace okapi {
+PathFeasibilityChecker::PathFeasibilityChecker(const QLength iwheelTrack)
+  : wheelTrack(iwheelTrack.convert(meter)) {
+}
+
+std::vector<PathFeasibilityChecker::Diagnostic>
+PathFeasibilityChecker::check(const std::vector<PathfinderPoint> &iwaypoints,
+                              const PathfinderLimits &ilimits) const {
+  std::vector<Diagnostic> diagnostics;
+
+  if (iwaypoints.size() < 2) {
+    diagnostics.push_back(Diagnostic{Problem::tooFewWaypoints,
+                                     Severity::error,
+                                     0,
+                                     static_cast<double>(iwaypoints.size()),
+                                     2});
+  }
+
+  bool validLimits = true;
+  for (const double limit : {ilimits.maxVel, ilimits.maxAccel, ilimits.maxJerk}) {
+    if (!(limit > 0) || !std::isfinite(limit)) {
+      diagnostics.push_back(Diagnostic{Problem::invalidLimits, Severity::error, 0, limit, 0});
+      validLimits = false;
+    }
+  }
+
+  // The inner wheel stops when the radius of the turn is half the wheel track
+  const double maxCurvatureForTrack = wheelTrack > 0 ? 2 / wheelTrack : 0;
+  const double maxCurvatureForAccel = validLimits
+                                        ? ilimits.maxAccel / (ilimits.maxVel * ilimits.maxVel)
+                                        : std::numeric_limits<double>::infinity();
+
+  for (std::size_t i = 0; i + 1 < iwaypoints.size(); ++i) {
+    const double x0 = iwaypoints[i].x.convert(meter);
+    const double y0 = iwaypoints[i].y.convert(meter);
+    const double dx = iwaypoints[i + 1].x.convert(meter) - x0;
+    const double dy = iwaypoints[i + 1].y.convert(meter) - y0;
+    const double length = std::hypot(dx, dy);
+
+    if (length < minSpacing) {
+      diagnostics.push_back(
+        Diagnostic{Problem::waypointsTooClose, Severity::error, i, length, minSpacing});
+      continue;
+    }
+
+    // Pathfinder fits the span as a function of the distance along the chord, so each end must
+    // face less than 90 degrees away from the chord
+    const double chord = std::atan2(dy, dx);
+    const double startAngle = std::remainder(iwaypoints[i].theta.convert(radian) - chord, 2 * pi);
+    const double endAngle = std::remainder(iwaypoints[i + 1].theta.convert(radian) - chord, 2 * pi);
+
+    bool discontinuous = false;
+    for (const auto &[waypoint, angle] : {std::pair{i, startAngle}, std::pair{i + 1, endAngle}}) {
+      if (std::abs(angle) >= pi / 2) {
+        diagnostics.push_back(Diagnostic{
+          Problem::headingDiscontinuity, Severity::error, waypoint, std::abs(angle), pi / 2});
+        discontinuous = true;
+      }
+    }
+
+    if (discontinuous) {
+      continue;
+    }
+
+    const double curvature = maxCurvature(length, std::tan(startAngle), std::tan(endAngle));
+
+    if (maxCurvatureForTrack > 0 && curvature > maxCurvatureForTrack) {
+      diagnostics.push_back(Diagnostic{
+        Problem::curvatureTooHigh, Severity::warning, i, curvature, maxCurvatureForTrack});
+    } else if (curvature > maxCurvatureForAccel) {
+      diagnostics.push_back(Diagnostic{Problem::centripetalAccelTooHigh,
+                                       Severity::warning,
+                                       i,
+                                       ilimits.maxVel * ilimits.maxVel * curvature,
+                                       ilimits.maxAccel});
+    }
+  }
+
+  return diagnostics;
+}
+
+double PathFeasibilityChecker::maxCurvature(const double ilength,
+                                            const double istartSlope,
+                                            const double iendSlope) {
+  // These are the coefficients pf_fit_hermite_cubic() computes for y = c x^3 + d x^2 + e x
+  const double c = (istartSlope + iendSlope) / (ilength * ilength);
+  const double d = -(2 * istartSlope + iendSlope) / ilength;
+  const double e = istartSlope;
+
+  double out = 0;
+  for (int i = 0; i <= curvatureSamples; ++i) {
+    const double x = ilength * i / curvatureSamples;
+    const double slope = 3 * c * x * x + 2 * d * x + e;
+    const double second = 6 * c * x + 2 * d;
+    out = std::max(out, std::abs(second) / std::pow(1 + slope * slope, 1.5));
+  }
+
+  return out;
+}
+
+bool PathFeasibilityChecker::isFeasible(const std::vector<Diagnostic> &idiagnostics) {
+  return std::none_of(idiagnostics.begin(), idiagnostics.end(), [](const Diagnostic &diagnostic) {
+    return diagnostic.severity == Severity::error;
+  });
+}
+
+std::string PathFeasibilityChecker::describe(const Diagnostic &idiagnostic) {
+  const std::string waypoint = "Waypoint " + std::to_string(idiagnostic.waypoint) + ": ";
+  const std::string value = std::to_string(idiagnostic.value);
+  const std::string limit = std::to_string(idiagnostic.limit);
+
+  switch (idiagnostic.problem) {
+  case Problem::tooFewWaypoints:
+    return "There are " + std::to_string(static_cast<std::size_t>(idiagnostic.value)) +
+           " waypoints but at least " +
+           std::to_string(static_cast<std::size_t>(idiagnostic.limit)) + " are needed.";
+
+  case Problem::invalidLimits:
+    return "The limits must be positive but one is " + value + ".";
+
+  case Problem::waypointsTooClose:
+    return waypoint + "The next waypoint is " + value + " m away but must be at least " + limit +
+           " m away.";
+
+  case Problem::headingDiscontinuity:
+    return waypoint + "The heading is " + value +
+           " rad away from the direction to the waypoint next to it but must be less than " +
+           limit + " rad away.";
+
+  case Problem::curvatureTooHigh:
+    return waypoint + "The curvature to the next waypoint reaches " + value +
+           " 1/m but must be at most " + limit + " 1/m so the inner wheel does not reverse.";
+
+  case Problem::centripetalAccelTooHigh:
+    return waypoint + "Turning at the max velocity to the next waypoint takes " + value +
+           " m/s/s of centripetal acceleration, which is more than the max acceleration of " +
+           limit + " m/s/s.";
+  }
+
+  return waypoint + "Unknown problem.";
+}
+
+QLength PathFeasibilityChecker::getWheelTrack() const {
+  return wheelTrack * meter;
+}
+} // namespace okapi
@@ -0,0 +1,100 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pathGenerationBatch.hpp"
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <stdexcept>
+
+namespace okapi {
+PathGenerationBatch::PathGenerationBatch(std::vector<std::string> ipathIds,
+                                         std::function<void(std::size_t)> igenerate,
+                                         const TimeUtil &itimeUtil,
+                                         const std::shared_ptr<Logger> &ilogger)
+  : pathIds(std::move(ipathIds)),
+    generate(std::move(igenerate)),
+    timeUtil(itimeUtil),
+    logger(ilogger) {
+}
+
+std::vector<PathGenerationResult> PathGenerationBatch::run(const std::size_t iworkers) {
+  if (iworkers == 0) {
+    std::string msg("PathGenerationBatch: There must be at least one worker.");
+    LOG_ERROR(msg);
+    throw std::invalid_argument(msg);
+  }
+
+  results.clear();
+  skipped.assign(pathIds.size(), false);
+  nextPath.store(0, std::memory_order_relaxed);
+  finishedWorkers.store(0, std::memory_order_relaxed);
+
+  std::set<std::string> seen;
+  for (std::size_t i = 0; i < pathIds.size(); ++i) {
+    results.push_back(PathGenerationResult{pathIds[i], false, 0_ms, ""});
+
+    if (!seen.insert(pathIds[i]).second) {
+      results[i].error =
+        "PathGenerationBatch: The path ID " + pathIds[i] + " is used by an earlier path.";
+      LOG_WARN(results[i].error);
+      skipped[i] = true;
+    }
+  }
+
+  const std::size_t threadCount = std::min(iworkers, std::max<std::size_t>(pathIds.size(), 1)) - 1;
+  LOG_INFO("PathGenerationBatch: Generating " + std::to_string(pathIds.size()) + " paths on " +
+           std::to_string(threadCount + 1) + " workers");
+
+  std::vector<std::unique_ptr<CrossplatformThread>> threads;
+  threads.reserve(threadCount);
+  for (std::size_t i = 0; i < threadCount; ++i) {
+    threads.push_back(
+      std::make_unique<CrossplatformThread>(trampoline, this, "PathGenerationBatch Worker"));
+  }
+
+  work();
+
+  // The workers are done with the batch once they have all finished, even if the tasks have not
+  // been cleaned up yet
+  auto rate = timeUtil.getRate();
+  while (finishedWorkers.load(std::memory_order_acquire) < threadCount + 1) {
+    rate->delayUntil(1_ms);
+  }
+
+  threads.clear();
+
+  return results;
+}
+
+void PathGenerationBatch::work() {
+  for (std::size_t i = nextPath.fetch_add(1, std::memory_order_relaxed); i < pathIds.size();
+       i = nextPath.fetch_add(1, std::memory_order_relaxed)) {
+    if (skipped[i]) {
+      continue;
+    }
+
+    auto timer = timeUtil.getTimer();
+
+    try {
+      generate(i);
+      results[i].succeeded = true;
+    } catch (const std::exception &e) {
+      // The generator already logged the error
+      results[i].error = e.what();
+    }
+
+    results[i].duration = timer->getDtFromStart();
+  }
+
+  finishedWorkers.fetch_add(1, std::memory_order_release);
+}
+
+void PathGenerationBatch::trampoline(void *context) {
+  if (context) {
+    static_cast<PathGenerationBatch *>(context)->work();
+  }
+}
+} // namespace okapi
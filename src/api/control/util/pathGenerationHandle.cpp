@@ -0,0 +1,49 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pathGenerationHandle.hpp"
+
+namespace okapi {
+PathGenerationHandle::PathGenerationHandle(std::string ipathId) : pathId(std::move(ipathId)) {
+}
+
+const std::string &PathGenerationHandle::getPathId() const {
+  return pathId;
+}
+
+PathGenerationHandle::Status PathGenerationHandle::getStatus() const {
+  return status.load(std::memory_order_acquire);
+}
+
+bool PathGenerationHandle::isReady() const {
+  return getStatus() != Status::pending;
+}
+
+std::string PathGenerationHandle::getError() const {
+  // The error is only written before the status is released, so it is safe to read once ready
+  return getStatus() == Status::failed ? error : "";
+}
+
+void PathGenerationHandle::waitUntilReady(const TimeUtil &itimeUtil) const {
+  if (isReady()) {
+    // Early exit to save calling getRate
+    return;
+  }
+
+  auto rate = itimeUtil.getRate();
+  while (!isReady()) {
+    rate->delayUntil(1_ms);
+  }
+}
+
+void PathGenerationHandle::markDone() {
+  status.store(Status::done, std::memory_order_release);
+}
+
+void PathGenerationHandle::markFailed(const std::string &ierror) {
+  error = ierror;
+  status.store(Status::failed, std::memory_order_release);
+}
+} // namespace okapi
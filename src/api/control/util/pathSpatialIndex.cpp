@@ -0,0 +1,90 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pathSpatialIndex.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace okapi {
+PathSpatialIndex::PathSpatialIndex(const std::vector<std::pair<double, double>> &ipoints) {
+  nodes.reserve(ipoints.size());
+  for (std::size_t i = 0; i < ipoints.size(); ++i) {
+    nodes.push_back(Node{ipoints[i].first, ipoints[i].second, i, i, i});
+  }
+
+  build(0, nodes.size(), true);
+}
+
+std::pair<std::size_t, std::size_t>
+PathSpatialIndex::build(const std::size_t ibegin, const std::size_t iend, const bool isplitX) {
+  if (ibegin >= iend) {
+    return {std::numeric_limits<std::size_t>::max(), 0};
+  }
+
+  const std::size_t mid = ibegin + (iend - ibegin) / 2;
+  std::nth_element(nodes.begin() + ibegin,
+                   nodes.begin() + mid,
+                   nodes.begin() + iend,
+                   [&](const Node &a, const Node &b) { return isplitX ? a.x < b.x : a.y < b.y; });
+
+  const auto [belowMin, belowMax] = build(ibegin, mid, !isplitX);
+  const auto [aboveMin, aboveMax] = build(mid + 1, iend, !isplitX);
+
+  auto &root = nodes[mid];
+  root.minIndex = std::min({root.index, belowMin, aboveMin});
+  root.maxIndex = std::max({root.index, belowMax, aboveMax});
+  return {root.minIndex, root.maxIndex};
+}
+
+std::size_t PathSpatialIndex::nearest(const double ix,
+                                      const double iy,
+                                      const std::size_t ifirst,
+                                      const std::size_t ilast) const {
+  Query query{ix, iy, ifirst, ilast, nodes.size(), std::numeric_limits<double>::infinity()};
+  search(0, nodes.size(), true, query);
+  return query.best;
+}
+
+void PathSpatialIndex::search(const std::size_t ibegin,
+                              const std::size_t iend,
+                              const bool isplitX,
+                              Query &ioquery) const {
+  if (ibegin >= iend) {
+    return;
+  }
+
+  const std::size_t mid = ibegin + (iend - ibegin) / 2;
+  const auto &root = nodes[mid];
+
+  // Every point in this subtree is outside of the window the search may return from
+  if (root.maxIndex < ioquery.first || root.minIndex > ioquery.last) {
+    return;
+  }
+
+  if (root.index >= ioquery.first && root.index <= ioquery.last) {
+    const double dx = root.x - ioquery.x;
+    const double dy = root.y - ioquery.y;
+    const double distance = dx * dx + dy * dy;
+    if (distance < ioquery.bestDistance ||
+        (distance == ioquery.bestDistance && root.index < ioquery.best)) {
+      ioquery.best = root.index;
+      ioquery.bestDistance = distance;
+    }
+  }
+
+  // Search the side of the split the position is on first, then the other side only if it could
+  // hold a closer point
+  const double offset = isplitX ? ioquery.x - root.x : ioquery.y - root.y;
+  const bool belowFirst = offset < 0;
+  search(belowFirst ? ibegin : mid + 1, belowFirst ? mid : iend, !isplitX, ioquery);
+  if (offset * offset <= ioquery.bestDistance) {
+    search(belowFirst ? mid + 1 : ibegin, belowFirst ? iend : mid, !isplitX, ioquery);
+  }
+}
+
+std::size_t PathSpatialIndex::size() const {
+  return nodes.size();
+}
+} // namespace okapi
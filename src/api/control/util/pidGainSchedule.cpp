@@ -0,0 +1,102 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pidGainSchedule.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace okapi {
+PIDGainSchedule::PIDGainSchedule(
+  const Source isource, std::vector<std::pair<double, IterativePosPIDController::Gains>> ipoints)
+  : source(isource), points(std::move(ipoints)) {
+  if (source == Source::external) {
+    throw std::invalid_argument(
+      "PIDGainSchedule: An external schedule must be constructed with a function.");
+  }
+
+  sortPoints();
+}
+
+PIDGainSchedule::PIDGainSchedule(
+  std::function<double()> iexternal,
+  std::vector<std::pair<double, IterativePosPIDController::Gains>> ipoints)
+  : source(Source::external), external(std::move(iexternal)), points(std::move(ipoints)) {
+  if (!external) {
+    throw std::invalid_argument("PIDGainSchedule: The external function must not be empty.");
+  }
+
+  sortPoints();
+}
+
+void PIDGainSchedule::sortPoints() {
+  if (points.empty()) {
+    throw std::invalid_argument("PIDGainSchedule: The schedule must have at least one point.");
+  }
+
+  std::sort(points.begin(), points.end(), [](const auto &a, const auto &b) {
+    return a.first < b.first;
+  });
+
+  for (std::size_t i = 1; i < points.size(); ++i) {
+    if (points[i].first == points[i - 1].first) {
+      throw std::invalid_argument("PIDGainSchedule: The input " + std::to_string(points[i].first) +
+                                  " is used by more than one point.");
+    }
+  }
+}
+
+IterativePosPIDController::Gains PIDGainSchedule::getGains(const double ierror,
+                                                           const double itarget) const {
+  switch (source) {
+  case Source::error:
+    return interpolate(std::abs(ierror));
+  case Source::target:
+    return interpolate(itarget);
+  case Source::external:
+  default:
+    return interpolate(external());
+  }
+}
+
+IterativePosPIDController::Gains PIDGainSchedule::interpolate(const double iinput) const {
+  const auto upper =
+    std::upper_bound(points.begin(), points.end(), iinput, [](const double input, const auto &p) {
+      return input < p.first;
+    });
+
+  if (upper == points.begin()) {
+    return points.front().second;
+  } else if (upper == points.end()) {
+    return points.back().second;
+  }
+
+  const auto lower = upper - 1;
+  return lerp(
+    lower->second, upper->second, (iinput - lower->first) / (upper->first - lower->first));
+}
+
+PIDGainSchedule::Source PIDGainSchedule::getSource() const {
+  return source;
+}
+
+const std::vector<std::pair<double, IterativePosPIDController::Gains>> &
+PIDGainSchedule::getPoints() const {
+  return points;
+}
+
+IterativePosPIDController::Gains PIDGainSchedule::lerp(const IterativePosPIDController::Gains &ia,
+                                                       const IterativePosPIDController::Gains &ib,
+                                                       const double it) {
+  const auto mix = [&](const double a, const double b) { return a + (b - a) * it; };
+  return {mix(ia.kP, ib.kP),
+          mix(ia.kI, ib.kI),
+          mix(ia.kD, ib.kD),
+          mix(ia.kBias, ib.kBias),
+          mix(ia.kS, ib.kS),
+          mix(ia.kV, ib.kV),
+          mix(ia.kA, ib.kA)};
+}
+} // namespace okapi
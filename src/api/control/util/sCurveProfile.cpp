@@ -0,0 +1,251 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/sCurveProfile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace okapi {
+SCurveProfile::SCurveProfile(const double idistance,
+                             const PathfinderLimits &ilimits,
+                             const Shape ishape)
+  : limits(ilimits), shape(ishape) {
+  validateLimits();
+
+  if (!std::isfinite(idistance)) {
+    throw std::invalid_argument("SCurveProfile: The distance must be finite.");
+  }
+
+  const double distance = std::abs(idistance);
+  const double sign = idistance < 0 ? -1 : 1;
+  const double maxAccel = limits.maxAccel;
+  const double maxJerk = limits.maxJerk;
+
+  // Speeding up to a velocity and back down to rest covers velocity * getRampTime(velocity), so
+  // the peak velocity of a profile too short to cruise is the solution of that for the distance
+  double peak = limits.maxVel;
+  if (peak * getRampTime(peak) > distance) {
+    if (shape == Shape::trapezoid) {
+      peak = std::sqrt(distance * maxAccel);
+    } else {
+      peak = maxAccel / 2 *
+             (std::sqrt(maxAccel * maxAccel / (maxJerk * maxJerk) + 4 * distance / maxAccel) -
+              maxAccel / maxJerk);
+
+      // The max acceleration is not reached
+      if (peak < maxAccel * maxAccel / maxJerk) {
+        peak = std::cbrt(distance * distance * maxJerk / 4);
+      }
+    }
+  }
+
+  if (peak <= 0) {
+    return;
+  }
+
+  appendVelocityChange(sign * peak);
+  appendPhase((distance - peak * getRampTime(peak)) / peak, 0);
+  appendVelocityChange(0);
+  end.position = idistance;
+}
+
+SCurveProfile::SCurveProfile(const State &istart,
+                             const double itarget,
+                             const PathfinderLimits &ilimits,
+                             const Shape ishape)
+  : limits(ilimits),
+    shape(ishape),
+    start{istart.position,
+          istart.velocity,
+          ishape == Shape::trapezoid ? 0 : istart.acceleration,
+          0} {
+  validateLimits();
+
+  if (!std::isfinite(start.position) || !std::isfinite(start.velocity) ||
+      !std::isfinite(start.acceleration) || !std::isfinite(itarget)) {
+    throw std::invalid_argument("SCurveProfile: The start and the target must be finite.");
+  }
+
+  end = start;
+
+  // Cruising faster ends further along, so bisect for the fastest cruise velocity which does not
+  // pass the target. The sign of the cruise velocity is the side of the target the profile would
+  // stop on without cruising.
+  double cruise = 0;
+  if (const double gap = itarget - getStopPosition(0); std::abs(gap) > 1e-12) {
+    const double fastest = std::copysign(limits.maxVel, gap);
+
+    if ((itarget - getStopPosition(fastest)) * gap >= 0) {
+      cruise = fastest;
+    } else {
+      double reachable = 0;
+      double unreachable = fastest;
+      for (int i = 0; i < 64 && std::abs(unreachable - reachable) > 1e-12; ++i) {
+        const double middle = (reachable + unreachable) / 2;
+        if ((itarget - getStopPosition(middle)) * gap >= 0) {
+          reachable = middle;
+        } else {
+          unreachable = middle;
+        }
+      }
+      cruise = reachable;
+    }
+  }
+
+  appendVelocityChange(cruise);
+  if (cruise != 0) {
+    appendPhase((itarget - end.position - cruise * getRampTime(cruise) / 2) / cruise, 0);
+  }
+  appendVelocityChange(0);
+  end.position = itarget;
+}
+
+SCurveProfile::State SCurveProfile::getState(const double itime) const {
+  if (itime <= 0) {
+    return start;
+  }
+
+  if (itime >= duration) {
+    return end;
+  }
+
+  const auto phase = std::find_if(phases.rbegin(), phases.rend(), [&](const Phase &p) {
+    return p.startTime <= itime;
+  });
+  return integrate(phase->start, itime - phase->startTime);
+}
+
+double SCurveProfile::getDuration() const {
+  return duration;
+}
+
+double SCurveProfile::getDistance() const {
+  return end.position;
+}
+
+SCurveProfile::Shape SCurveProfile::getShape() const {
+  return shape;
+}
+
+std::vector<Segment> SCurveProfile::getSegments(const QTime idt) const {
+  const double dt = idt.convert(second);
+  const int length = static_cast<int>(std::ceil(duration / dt - 1e-9));
+
+  std::vector<Segment> segments;
+  segments.reserve(length);
+
+  for (int i = 1; i <= length; ++i) {
+    const auto state = getState(std::min(i * dt, duration));
+    segments.push_back(Segment{dt,
+                               state.position,
+                               0,
+                               state.position,
+                               state.velocity,
+                               state.acceleration,
+                               state.jerk,
+                               0});
+  }
+
+  return segments;
+}
+
+void SCurveProfile::validateLimits() const {
+  if (!(limits.maxVel > 0) || !(limits.maxAccel > 0) ||
+      (shape == Shape::sCurve && !(limits.maxJerk > 0))) {
+    throw std::invalid_argument("SCurveProfile: The limits must be positive.");
+  }
+}
+
+void SCurveProfile::appendPhase(const double iduration, const double ijerk) {
+  if (!(iduration > 0)) {
+    return;
+  }
+
+  phases.push_back(
+    Phase{duration, iduration, {end.position, end.velocity, end.acceleration, ijerk}});
+  end = integrate(phases.back().start, iduration);
+  end.jerk = 0;
+  duration += iduration;
+}
+
+void SCurveProfile::appendVelocityChange(const double ivelocity) {
+  const double maxAccel = limits.maxAccel;
+
+  if (shape == Shape::trapezoid) {
+    const double change = ivelocity - end.velocity;
+    if (change != 0) {
+      end.acceleration = std::copysign(maxAccel, change);
+      appendPhase(std::abs(change) / maxAccel, 0);
+      end.acceleration = 0;
+      end.velocity = ivelocity;
+    }
+
+    return;
+  }
+
+  const double maxJerk = limits.maxJerk;
+
+  // If ramping the acceleration down right away reaches or passes the velocity, do that first and
+  // then change velocity from zero acceleration
+  if (const double accel = end.acceleration; accel != 0) {
+    const double rampDownVelocity = end.velocity + accel * std::abs(accel) / (2 * maxJerk);
+    if ((ivelocity - rampDownVelocity) * accel <= 0) {
+      appendPhase(std::abs(accel) / maxJerk, std::copysign(maxJerk, -accel));
+      end.acceleration = 0;
+    }
+  }
+
+  // Measure the change from where the acceleration would have been zero when ramping up to the
+  // current acceleration. The current acceleration is then part way through the first ramp.
+  const double accel = end.acceleration;
+  const double change = ivelocity - (end.velocity - accel * std::abs(accel) / (2 * maxJerk));
+  if (std::abs(change) < 1e-12) {
+    end.velocity = ivelocity;
+    return;
+  }
+
+  const double sign = change < 0 ? -1 : 1;
+  const double peak = std::min(maxAccel, std::sqrt(std::abs(change) * maxJerk));
+
+  appendPhase((peak - sign * accel) / maxJerk, sign * maxJerk);
+  appendPhase(std::abs(change) / peak - peak / maxJerk, 0);
+  appendPhase(peak / maxJerk, -sign * maxJerk);
+  end.acceleration = 0;
+  end.velocity = ivelocity;
+}
+
+double SCurveProfile::getStopPosition(const double ivelocity) const {
+  SCurveProfile trial(*this);
+  trial.appendVelocityChange(ivelocity);
+  trial.appendVelocityChange(0);
+  return trial.end.position;
+}
+
+double SCurveProfile::getRampTime(const double ivelocity) const {
+  const double velocity = std::abs(ivelocity);
+
+  if (shape == Shape::trapezoid) {
+    return velocity / limits.maxAccel;
+  }
+
+  const double maxAccel = limits.maxAccel;
+  const double maxJerk = limits.maxJerk;
+  if (velocity >= maxAccel * maxAccel / maxJerk) {
+    return velocity / maxAccel + maxAccel / maxJerk;
+  }
+
+  return 2 * std::sqrt(velocity / maxJerk);
+}
+
+SCurveProfile::State SCurveProfile::integrate(const State &istart, const double itime) {
+  const double t = itime;
+  return State{istart.position + istart.velocity * t + istart.acceleration * t * t / 2 +
+                 istart.jerk * t * t * t / 6,
+               istart.velocity + istart.acceleration * t + istart.jerk * t * t / 2,
+               istart.acceleration + istart.jerk * t,
+               istart.jerk};
+}
+} // namespace okapi
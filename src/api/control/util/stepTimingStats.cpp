@@ -0,0 +1,29 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/stepTimingStats.hpp"
+
+namespace okapi {
+void StepTimingStats::recordInterval(const QTime idt, const QTime ilateDt) {
+  if (intervals == 0 || idt < minDt) {
+    minDt = idt;
+  }
+
+  if (intervals == 0 || idt > maxDt) {
+    maxDt = idt;
+  }
+
+  if (idt > ilateDt) {
+    late++;
+  }
+
+  totalDt += idt;
+  intervals++;
+}
+
+QTime StepTimingStats::getMeanDt() const {
+  return intervals == 0 ? 0_ms : totalDt / static_cast<double>(intervals);
+}
+} // namespace okapi
@@ -0,0 +1,189 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/tankTrajectoryLimiter.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace okapi {
+TankTrajectoryLimiter::TankTrajectoryLimiter(const double imaxWheelVelocity,
+                                             const double imaxWheelAccel)
+  : maxWheelVelocity(imaxWheelVelocity), maxWheelAccel(imaxWheelAccel) {
+  if (!(maxWheelVelocity > 0) || !(maxWheelAccel > 0)) {
+    throw std::invalid_argument("TankTrajectoryLimiter: The limits must be positive.");
+  }
+}
+
+double
+TankTrajectoryLimiter::computeMaxWheelVelocity(const QLength iwheelDiameter,
+                                               const AbstractMotor::GearsetRatioPair &ipair) {
+  // The ratio converts wheel speed to motor speed, like in convertLinearToRotational()
+  const double wheelRpm = toUnderlyingType(ipair.internalGearset) / std::abs(ipair.ratio);
+  return wheelRpm / 60 * pi * iwheelDiameter.convert(meter);
+}
+
+std::pair<std::vector<Segment>, std::vector<Segment>>
+TankTrajectoryLimiter::limit(const Segment *ileft, const Segment *iright, const int ilength) const {
+  if (ilength <= 0) {
+    return {};
+  }
+
+  const auto scales = computeScales(ileft, iright, ilength);
+  if (std::all_of(scales.begin(), scales.end(), [](double scale) { return scale == 1; })) {
+    return {std::vector<Segment>(ileft, ileft + ilength),
+            std::vector<Segment>(iright, iright + ilength)};
+  }
+
+  // Both wheels are scaled by the same factor, so they travel their distances in the same time. The
+  // velocity is linear in time across each segment, so its duration grows by the ratio of the
+  // average speeds.
+  std::vector<double> times(ilength);
+  double time = 0;
+  for (int k = 0; k < ilength; ++k) {
+    const double speed = std::abs(ileft[k].velocity) + std::abs(iright[k].velocity);
+    const double lastSpeed =
+      k > 0 ? std::abs(ileft[k - 1].velocity) + std::abs(iright[k - 1].velocity) : 0;
+    const double lastScale = k > 0 ? scales[k - 1] : 1;
+
+    const double scaledSpeed = lastScale * lastSpeed + scales[k] * speed;
+    time += scaledSpeed > 0 ? ileft[k].dt * (lastSpeed + speed) / scaledSpeed : ileft[k].dt;
+    times[k] = time;
+  }
+
+  const double dt = ileft[0].dt;
+  return {resample(ileft, ilength, scales, times, dt),
+          resample(iright, ilength, scales, times, dt)};
+}
+
+std::vector<double> TankTrajectoryLimiter::computeScales(const Segment *ileft,
+                                                         const Segment *iright,
+                                                         const int ilength) const {
+  std::vector<double> scales(ilength, 1);
+
+  for (int k = 0; k < ilength; ++k) {
+    const double peak = std::max(std::abs(ileft[k].velocity), std::abs(iright[k].velocity));
+    if (peak > maxWheelVelocity) {
+      scales[k] = maxWheelVelocity / peak;
+    }
+  }
+
+  // The distance a wheel travels between two segments does not change when the path is re-timed,
+  // so the fastest a wheel can reach from one segment to the next is fixed by that distance
+  auto limitChange = [&](const Segment &ifrom,
+                         const double ifromScale,
+                         const Segment &ito,
+                         const double idt,
+                         double &otoScale) {
+    const double from = std::abs(ifrom.velocity);
+    const double to = std::abs(ito.velocity);
+    if (to > 0) {
+      const double distance = (from + to) / 2 * idt;
+      const double reachable =
+        std::sqrt(std::pow(ifromScale * from, 2) + 2 * maxWheelAccel * distance);
+      otoScale = std::min(otoScale, reachable / to);
+    }
+  };
+
+  // The path starts at rest
+  const Segment rest{ileft[0].dt, 0, 0, 0, 0, 0, 0, 0};
+
+  for (int k = 0; k < ilength; ++k) {
+    for (const Segment *side : {ileft, iright}) {
+      limitChange(k > 0 ? side[k - 1] : rest,
+                  k > 0 ? scales[k - 1] : 0,
+                  side[k],
+                  side[k].dt,
+                  scales[k]);
+    }
+  }
+
+  for (int k = ilength - 2; k >= 0; --k) {
+    for (const Segment *side : {ileft, iright}) {
+      limitChange(side[k + 1], scales[k + 1], side[k], side[k + 1].dt, scales[k]);
+    }
+  }
+
+  for (auto &scale : scales) {
+    if (scale > 1 - tolerance) {
+      scale = 1;
+    }
+  }
+
+  return scales;
+}
+
+std::vector<Segment> TankTrajectoryLimiter::resample(const Segment *iside,
+                                                     const int ilength,
+                                                     const std::vector<double> &iscales,
+                                                     const std::vector<double> &itimes,
+                                                     const double idt) {
+  const double duration = itimes.back();
+  const int count = std::max(1, static_cast<int>(std::ceil(duration / idt - 1e-9)));
+
+  std::vector<Segment> out;
+  out.reserve(count);
+
+  double lastVelocity = 0;
+  double lastAcceleration = 0;
+  for (int j = 0, k = 0; j < count; ++j) {
+    // The first segment is one step after rest, like the segments the generators make
+    const double time = std::min((j + 1) * idt, duration);
+    while (k < ilength - 1 && itimes[k] < time) {
+      ++k;
+    }
+
+    const Segment &to = iside[k];
+    const Segment from = k > 0 ? iside[k - 1] : Segment{to.dt, to.x, to.y, 0, 0, 0, 0, to.heading};
+    const double fromVelocity = k > 0 ? iscales[k - 1] * from.velocity : 0;
+    const double toVelocity = iscales[k] * to.velocity;
+
+    const double startTime = k > 0 ? itimes[k - 1] : 0;
+    const double progress = std::clamp((time - startTime) / (itimes[k] - startTime), 0.0, 1.0);
+
+    // The fraction of the segment's distance covered so far, from integrating the velocity
+    const double fromSpeed = std::abs(fromVelocity);
+    const double toSpeed = std::abs(toVelocity);
+    const double travelled =
+      fromSpeed + toSpeed > 0
+        ? (fromSpeed * progress + (toSpeed - fromSpeed) * progress * progress / 2) /
+            ((fromSpeed + toSpeed) / 2)
+        : progress;
+
+    double heading =
+      std::fmod(from.heading + std::remainder(to.heading - from.heading, 2 * pi) * travelled,
+                2 * pi);
+    if (heading < 0) {
+      heading += 2 * pi;
+    }
+
+    Segment segment{idt,
+                    from.x + (to.x - from.x) * travelled,
+                    from.y + (to.y - from.y) * travelled,
+                    from.position + (to.position - from.position) * travelled,
+                    fromVelocity + (toVelocity - fromVelocity) * progress,
+                    0,
+                    0,
+                    heading};
+    segment.acceleration = (segment.velocity - lastVelocity) / idt;
+    segment.jerk = (segment.acceleration - lastAcceleration) / idt;
+    lastVelocity = segment.velocity;
+    lastAcceleration = segment.acceleration;
+
+    out.push_back(segment);
+  }
+
+  return out;
+}
+
+double TankTrajectoryLimiter::getMaxWheelVelocity() const {
+  return maxWheelVelocity;
+}
+
+double TankTrajectoryLimiter::getMaxWheelAccel() const {
+  return maxWheelAccel;
+}
+} // namespace okapi
@@ -0,0 +1,375 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/trajectoryBaker.hpp"
+#include "okapi/api/control/util/pathFeasibilityChecker.hpp"
+#include "okapi/api/control/util/tankTrajectoryLimiter.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/units/QAngularSpeed.hpp"
+#include "okapi/api/units/QSpeed.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace okapi {
+TrajectoryBaker::TrajectoryBaker(Manifest imanifest) : manifest(std::move(imanifest)) {
+}
+
+TrajectoryBaker::Manifest TrajectoryBaker::parseManifest(std::istream &imanifest) {
+  Manifest manifest{0_m, 0_m, AbstractMotor::gearset::green, Generator::pathfinder, {}};
+  PathfinderLimits limits{1.0, 2.0, 10.0};
+  bool hasChassis = false;
+
+  std::string line;
+  for (int lineNumber = 1; std::getline(imanifest, line); ++lineNumber) {
+    if (const auto comment = line.find('#'); comment != std::string::npos) {
+      line.erase(comment);
+    }
+
+    std::istringstream words(line);
+    std::vector<std::string> tokens;
+    for (std::string token; words >> token;) {
+      tokens.push_back(token);
+    }
+
+    if (tokens.empty()) {
+      continue;
+    }
+
+    const auto &directive = tokens[0];
+    auto expectArgs = [&](const std::size_t imin, const std::size_t imax) {
+      if (tokens.size() - 1 < imin || tokens.size() - 1 > imax) {
+        throw manifestError(lineNumber, "Wrong number of arguments to " + directive + ".");
+      }
+    };
+
+    if (directive == "chassis") {
+      expectArgs(2, 2);
+      manifest.wheelDiameter = parseLength(tokens[1], lineNumber);
+      manifest.wheelTrack = parseLength(tokens[2], lineNumber);
+      if (manifest.wheelDiameter <= 0_m || manifest.wheelTrack <= 0_m) {
+        throw manifestError(lineNumber, "The chassis dimensions must be positive.");
+      }
+      hasChassis = true;
+    } else if (directive == "gearset") {
+      expectArgs(1, 2);
+      if (tokens[1] == "red") {
+        manifest.pair.internalGearset = AbstractMotor::gearset::red;
+      } else if (tokens[1] == "green") {
+        manifest.pair.internalGearset = AbstractMotor::gearset::green;
+      } else if (tokens[1] == "blue") {
+        manifest.pair.internalGearset = AbstractMotor::gearset::blue;
+      } else {
+        throw manifestError(lineNumber, "Unknown gearset " + tokens[1] + ".");
+      }
+
+      manifest.pair.ratio = tokens.size() > 2 ? parsePlainNumber(tokens[2], lineNumber) : 1;
+      if (manifest.pair.ratio == 0) {
+        throw manifestError(lineNumber, "The gear ratio cannot be zero.");
+      }
+    } else if (directive == "generator") {
+      expectArgs(1, 1);
+      if (tokens[1] == "pathfinder") {
+        manifest.generator = Generator::pathfinder;
+      } else if (tokens[1] == "native") {
+        manifest.generator = Generator::native;
+      } else {
+        throw manifestError(lineNumber, "Unknown generator " + tokens[1] + ".");
+      }
+    } else if (directive == "limits") {
+      expectArgs(3, 3);
+      limits = parseLimits(tokens, 1, lineNumber);
+    } else if (directive == "path") {
+      if (tokens.size() != 2 && tokens.size() != 5) {
+        throw manifestError(lineNumber, "Wrong number of arguments to path.");
+      }
+
+      for (const auto &path : manifest.paths) {
+        if (path.pathId == tokens[1]) {
+          throw manifestError(lineNumber, "The path ID " + tokens[1] + " is already used.");
+        }
+      }
+
+      manifest.paths.push_back(
+        PathSpec{tokens[1], {}, tokens.size() == 5 ? parseLimits(tokens, 2, lineNumber) : limits});
+    } else if (directive == "point") {
+      expectArgs(3, 3);
+      if (manifest.paths.empty()) {
+        throw manifestError(lineNumber, "A point must come after a path.");
+      }
+
+      manifest.paths.back().waypoints.push_back(PathfinderPoint{parseLength(tokens[1], lineNumber),
+                                                                parseLength(tokens[2], lineNumber),
+                                                                parseAngle(tokens[3], lineNumber)});
+    } else {
+      throw manifestError(lineNumber, "Unknown directive " + directive + ".");
+    }
+  }
+
+  if (!hasChassis) {
+    throw std::invalid_argument("TrajectoryBaker: The manifest does not give the chassis.");
+  }
+
+  for (const auto &path : manifest.paths) {
+    if (path.waypoints.size() < 2) {
+      throw std::invalid_argument("TrajectoryBaker: The path " + path.pathId +
+                                  " needs at least two points.");
+    }
+  }
+
+  return manifest;
+}
+
+std::pair<std::vector<Segment>, std::vector<Segment>>
+TrajectoryBaker::generate(const PathSpec &ipath) const {
+  if (manifest.generator == Generator::native) {
+    try {
+      return limitWheels(
+        TrajectoryGenerator().generateTank(ipath.waypoints, ipath.limits, manifest.wheelTrack),
+        ipath.limits);
+    } catch (const std::invalid_argument &e) {
+      throw std::runtime_error("TrajectoryBaker: The path " + ipath.pathId +
+                               " is impossible: " + e.what());
+    }
+  }
+
+  for (const auto &diagnostic :
+       PathFeasibilityChecker(manifest.wheelTrack).check(ipath.waypoints, ipath.limits)) {
+    if (diagnostic.severity == PathFeasibilityChecker::Severity::error) {
+      throw std::runtime_error("TrajectoryBaker: The path " + ipath.pathId +
+                               " is impossible: " + PathFeasibilityChecker::describe(diagnostic));
+    }
+  }
+
+  std::vector<Waypoint> points;
+  points.reserve(ipath.waypoints.size());
+  for (const auto &point : ipath.waypoints) {
+    points.push_back(
+      Waypoint{point.x.convert(meter), point.y.convert(meter), point.theta.convert(radian)});
+  }
+
+  TrajectoryCandidate candidate{};
+  pathfinder_prepare(points.data(),
+                     static_cast<int>(points.size()),
+                     FIT_HERMITE_CUBIC,
+                     PATHFINDER_SAMPLES_FAST,
+                     0.010,
+                     ipath.limits.maxVel,
+                     ipath.limits.maxAccel,
+                     ipath.limits.maxJerk,
+                     &candidate);
+
+  // The candidate owns buffers which pathfinder allocated
+  std::unique_ptr<void, void (*)(void *)> laptr(candidate.laptr, free);
+  std::unique_ptr<void, void (*)(void *)> saptr(candidate.saptr, free);
+
+  if (candidate.length <= 0) {
+    throw std::runtime_error("TrajectoryBaker: The path " + ipath.pathId + " is impossible.");
+  }
+
+  std::vector<Segment> center(candidate.length);
+  pathfinder_generate(&candidate, center.data());
+
+  std::pair<std::vector<Segment>, std::vector<Segment>> sides{
+    std::vector<Segment>(candidate.length), std::vector<Segment>(candidate.length)};
+  pathfinder_modify_tank(center.data(),
+                         candidate.length,
+                         sides.first.data(),
+                         sides.second.data(),
+                         manifest.wheelTrack.convert(meter));
+
+  return limitWheels(sides, ipath.limits);
+}
+
+std::pair<std::vector<Segment>, std::vector<Segment>>
+TrajectoryBaker::limitWheels(const std::pair<std::vector<Segment>, std::vector<Segment>> &isides,
+                             const PathfinderLimits &ilimits) const {
+  const TankTrajectoryLimiter limiter(
+    TankTrajectoryLimiter::computeMaxWheelVelocity(manifest.wheelDiameter, manifest.pair),
+    ilimits.maxAccel);
+  return limiter.limit(
+    isides.first.data(), isides.second.data(), static_cast<int>(isides.first.size()));
+}
+
+void TrajectoryBaker::writeHeader(std::ostream &iout, const std::string &inamespace) const {
+  if (manifest.paths.empty()) {
+    throw std::runtime_error("TrajectoryBaker: The manifest has no paths.");
+  }
+
+  const double gearsetRpm = toUnderlyingType(manifest.pair.internalGearset);
+
+  iout << "// Generated by bakeTrajectories. Do not edit.\n"
+       << "#pragma once\n\n"
+       << "#include \"okapi/api/control/util/bakedPath.hpp\"\n\n"
+       << "namespace " << inamespace << " {\n";
+
+  std::ostringstream table;
+  for (std::size_t p = 0; p < manifest.paths.size(); ++p) {
+    const auto &path = manifest.paths[p];
+    const auto [left, right] = generate(path);
+    const std::string prefix = "path" + std::to_string(p);
+
+    for (const auto &segment : left) {
+      if (segment.dt != left.front().dt) {
+        throw std::runtime_error("TrajectoryBaker: The segments of path " + path.pathId +
+                                 " do not have the same duration.");
+      }
+    }
+
+    iout << "// " << path.pathId << "\n";
+    for (const auto &[side, name] : {std::pair{&left, "Left"}, std::pair{&right, "Right"}}) {
+      writeColumn(iout, prefix + name + "Position", *side, &Segment::position);
+      writeColumn(iout, prefix + name + "Velocity", *side, &Segment::velocity);
+      writeColumn(iout, prefix + name + "X", *side, &Segment::x);
+      writeColumn(iout, prefix + name + "Y", *side, &Segment::y);
+      writeColumn(iout, prefix + name + "Heading", *side, &Segment::heading);
+    }
+
+    // Lower the velocities into motor commands the same way AsyncMotionProfileController does
+    auto toCommand = [&](const double ivelocity) {
+      const QAngularSpeed speed =
+        (ivelocity * mps * (360_deg / (manifest.wheelDiameter * 1_pi))) * manifest.pair.ratio;
+      return static_cast<float>(speed.convert(rpm) / gearsetRpm);
+    };
+
+    iout << "inline constexpr okapi::BakedMotorCommand " << prefix << "Commands[] = {";
+    for (std::size_t i = 0; i < left.size(); ++i) {
+      iout << (i % 3 == 0 ? "\n  " : " ") << "{" << formatFloat(toCommand(left[i].velocity))
+           << ", " << formatFloat(toCommand(right[i].velocity)) << ", "
+           << formatFloat(left[i].dt) << "},";
+    }
+    iout << "};\n\n";
+
+    auto side = [&](const std::string &iname) {
+      return "{" + prefix + iname + "Position, " + prefix + iname + "Velocity, " + prefix + iname +
+             "X, " + prefix + iname + "Y, " + prefix + iname + "Heading}";
+    };
+
+    char scalars[160];
+    std::snprintf(scalars,
+                  sizeof(scalars),
+                  "%d, %.17g, %.17g, %.17g, %.17g, %.17g",
+                  static_cast<int>(left.size()),
+                  left.front().dt,
+                  manifest.wheelDiameter.convert(meter),
+                  manifest.wheelTrack.convert(meter),
+                  gearsetRpm,
+                  manifest.pair.ratio);
+
+    table << "  {\"" << escape(path.pathId) << "\",\n   " << scalars << ",\n   " << side("Left")
+          << ",\n   " << side("Right") << ",\n   " << prefix << "Commands},\n";
+  }
+
+  iout << "inline constexpr okapi::BakedPath paths[] = {\n" << table.str() << "};\n"
+       << "} // namespace " << inamespace << "\n";
+}
+
+std::invalid_argument TrajectoryBaker::manifestError(const int iline, const std::string &imessage) {
+  return std::invalid_argument("TrajectoryBaker: Line " + std::to_string(iline) +
+                               " of the manifest: " + imessage);
+}
+
+double
+TrajectoryBaker::parseNumber(const std::string &itoken, std::string &ounit, const int iline) {
+  char *end = nullptr;
+  const double value = std::strtod(itoken.c_str(), &end);
+  if (end == itoken.c_str()) {
+    throw manifestError(iline, "Expected a number but got " + itoken + ".");
+  }
+
+  ounit = end;
+  return value;
+}
+
+QLength TrajectoryBaker::parseLength(const std::string &itoken, const int iline) {
+  std::string unit;
+  const double value = parseNumber(itoken, unit, iline);
+
+  if (unit.empty() || unit == "m") {
+    return value * meter;
+  } else if (unit == "cm") {
+    return value * centimeter;
+  } else if (unit == "mm") {
+    return value * millimeter;
+  } else if (unit == "in") {
+    return value * inch;
+  } else if (unit == "ft") {
+    return value * foot;
+  }
+
+  throw manifestError(iline, "Unknown length unit " + unit + ".");
+}
+
+QAngle TrajectoryBaker::parseAngle(const std::string &itoken, const int iline) {
+  std::string unit;
+  const double value = parseNumber(itoken, unit, iline);
+
+  if (unit.empty() || unit == "deg") {
+    return value * degree;
+  } else if (unit == "rad") {
+    return value * radian;
+  }
+
+  throw manifestError(iline, "Unknown angle unit " + unit + ".");
+}
+
+double TrajectoryBaker::parsePlainNumber(const std::string &itoken, const int iline) {
+  std::string unit;
+  const double value = parseNumber(itoken, unit, iline);
+  if (!unit.empty()) {
+    throw manifestError(iline, "Expected a number but got " + itoken + ".");
+  }
+
+  return value;
+}
+
+PathfinderLimits TrajectoryBaker::parseLimits(const std::vector<std::string> &itokens,
+                                              const std::size_t ifirst,
+                                              const int iline) {
+  return PathfinderLimits{parsePlainNumber(itokens[ifirst], iline),
+                          parsePlainNumber(itokens[ifirst + 1], iline),
+                          parsePlainNumber(itokens[ifirst + 2], iline)};
+}
+
+void TrajectoryBaker::writeColumn(std::ostream &iout,
+                                  const std::string &iname,
+                                  const std::vector<Segment> &isegments,
+                                  double Segment::*ifield) {
+  iout << "inline constexpr float " << iname << "[] = {";
+  for (std::size_t i = 0; i < isegments.size(); ++i) {
+    iout << (i % 8 == 0 ? "\n  " : " ") << formatFloat(isegments[i].*ifield) << ",";
+  }
+  iout << "};\n";
+}
+
+std::string TrajectoryBaker::formatFloat(const double ivalue) {
+  // 9 significant digits round trip a float exactly
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<float>(ivalue));
+
+  std::string literal(buffer);
+  if (literal.find_first_of(".e") == std::string::npos) {
+    literal += ".0";
+  }
+
+  return literal + "f";
+}
+
+std::string TrajectoryBaker::escape(const std::string &ivalue) {
+  std::string escaped;
+  for (const char c : ivalue) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+} // namespace okapi
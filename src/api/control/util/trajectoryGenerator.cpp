@@ -0,0 +1,429 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace okapi {
+TrajectoryGenerator::TrajectoryGenerator(const QTime idt, const double imaxCentripetalAccel)
+  : dt(idt.convert(second)), maxCentripetalAccel(imaxCentripetalAccel) {
+  if (dt <= 0) {
+    throw std::invalid_argument("TrajectoryGenerator: The segment duration must be positive.");
+  }
+
+  if (!(maxCentripetalAccel > 0)) {
+    throw std::invalid_argument(
+      "TrajectoryGenerator: The max centripetal acceleration must be positive.");
+  }
+}
+
+std::vector<Segment> TrajectoryGenerator::generate(const std::vector<PathfinderPoint> &iwaypoints,
+                                                   const PathfinderLimits &ilimits) const {
+  std::vector<double> curvatures;
+  return generateCenter(iwaypoints, ilimits, curvatures);
+}
+
+std::pair<std::vector<Segment>, std::vector<Segment>>
+TrajectoryGenerator::generateTank(const std::vector<PathfinderPoint> &iwaypoints,
+                                  const PathfinderLimits &ilimits,
+                                  const QLength iwheelTrack) const {
+  std::vector<double> curvatures;
+  const auto center = generateCenter(iwaypoints, ilimits, curvatures);
+  const double halfTrack = iwheelTrack.convert(meter) / 2;
+
+  std::vector<Segment> left(center);
+  std::vector<Segment> right(center);
+  for (std::size_t i = 0; i < center.size(); ++i) {
+    const double sinHeading = std::sin(center[i].heading);
+    const double cosHeading = std::cos(center[i].heading);
+
+    // The left wheel is on the inside of a counterclockwise turn
+    left[i].x = center[i].x - halfTrack * sinHeading;
+    left[i].y = center[i].y + halfTrack * cosHeading;
+    left[i].velocity = center[i].velocity * (1 - curvatures[i] * halfTrack);
+
+    right[i].x = center[i].x + halfTrack * sinHeading;
+    right[i].y = center[i].y - halfTrack * cosHeading;
+    right[i].velocity = center[i].velocity * (1 + curvatures[i] * halfTrack);
+  }
+
+  for (auto *side : {&left, &right}) {
+    double lastVelocity = 0;
+    double lastAcceleration = 0;
+    double position = 0;
+    for (auto &segment : *side) {
+      position += (lastVelocity + segment.velocity) / 2 * segment.dt;
+      segment.position = position;
+      segment.acceleration = (segment.velocity - lastVelocity) / segment.dt;
+      segment.jerk = (segment.acceleration - lastAcceleration) / segment.dt;
+      lastVelocity = segment.velocity;
+      lastAcceleration = segment.acceleration;
+    }
+  }
+
+  return {std::move(left), std::move(right)};
+}
+
+QTime TrajectoryGenerator::getDt() const {
+  return dt * second;
+}
+
+double TrajectoryGenerator::getMaxCentripetalAccel() const {
+  return maxCentripetalAccel;
+}
+
+std::vector<Segment>
+TrajectoryGenerator::generateCenter(const std::vector<PathfinderPoint> &iwaypoints,
+                                    const PathfinderLimits &ilimits,
+                                    std::vector<double> &ocurvatures) const {
+  if (iwaypoints.size() < 2) {
+    throw std::invalid_argument("TrajectoryGenerator: At least two waypoints are required.");
+  }
+
+  if (!(ilimits.maxVel > 0) || !(ilimits.maxAccel > 0) || !(ilimits.maxJerk > 0)) {
+    throw std::invalid_argument("TrajectoryGenerator: The limits must be positive.");
+  }
+
+  for (std::size_t i = 1; i < iwaypoints.size(); ++i) {
+    const double dx = (iwaypoints[i].x - iwaypoints[i - 1].x).convert(meter);
+    const double dy = (iwaypoints[i].y - iwaypoints[i - 1].y).convert(meter);
+    if (std::hypot(dx, dy) < 1e-6) {
+      throw std::invalid_argument("TrajectoryGenerator: Waypoints " + std::to_string(i - 1) +
+                                  " and " + std::to_string(i) + " are in the same place.");
+    }
+  }
+
+  return parameterize(SplinePath(iwaypoints), ilimits, ocurvatures);
+}
+
+std::vector<Segment> TrajectoryGenerator::parameterize(const SplinePath &ipath,
+                                                       const PathfinderLimits &ilimits,
+                                                       std::vector<double> &ocurvatures) const {
+  const double length = ipath.getLength();
+  const int gridCount = std::max(16, static_cast<int>(std::ceil(length / gridSpacing)));
+  const double ds = length / gridCount;
+
+  // The velocity limit at each grid point from the max velocity and the centripetal acceleration
+  std::vector<double> pathLimits(gridCount + 1);
+  for (int i = 0; i <= gridCount; ++i) {
+    const auto [spline, t] = ipath.locate(i * ds);
+    const double curvature = std::abs(spline->getCurvature(t));
+    pathLimits[i] = std::min(ilimits.maxVel, std::sqrt(maxCentripetalAccel / curvature));
+  }
+
+  // The limits the profile is planned with. These are lowered wherever smoothing the profile
+  // pushes it over the path limits.
+  std::vector<double> gridLimits(pathLimits);
+  double jerkWindow = ilimits.maxAccel / ilimits.maxJerk;
+
+  std::vector<double> velocities;
+  for (int refinement = 0; refinement < maxRefinements; ++refinement) {
+    // Plan the fastest velocity at each grid point which can be reached from rest and can come
+    // back to rest without exceeding the max acceleration
+    std::vector<double> gridVelocities(gridLimits);
+    gridVelocities.front() = 0;
+    gridVelocities.back() = 0;
+    for (int i = 0; i < gridCount; ++i) {
+      gridVelocities[i + 1] =
+        std::min(gridVelocities[i + 1],
+                 std::sqrt(gridVelocities[i] * gridVelocities[i] + 2 * ilimits.maxAccel * ds));
+    }
+    for (int i = gridCount; i > 0; --i) {
+      gridVelocities[i - 1] =
+        std::min(gridVelocities[i - 1],
+                 std::sqrt(gridVelocities[i] * gridVelocities[i] + 2 * ilimits.maxAccel * ds));
+    }
+
+    // The acceleration is constant between grid points, so the velocity is linear in time
+    std::vector<double> gridTimes(gridCount + 1, 0);
+    for (int i = 0; i < gridCount; ++i) {
+      gridTimes[i + 1] = gridTimes[i] + 2 * ds / (gridVelocities[i] + gridVelocities[i + 1]);
+    }
+
+    const int sampleCount = static_cast<int>(std::ceil(gridTimes.back() / dt));
+    std::vector<double> samples(sampleCount + 1, 0);
+    for (int k = 0, i = 0; k < sampleCount; ++k) {
+      const double time = k * dt;
+      while (i < gridCount - 1 && gridTimes[i + 1] < time) {
+        ++i;
+      }
+
+      const double progress =
+        std::clamp((time - gridTimes[i]) / (gridTimes[i + 1] - gridTimes[i]), 0.0, 1.0);
+      samples[k] = gridVelocities[i] + progress * (gridVelocities[i + 1] - gridVelocities[i]);
+    }
+
+    // Smoothing the velocity with a moving average over the jerk window limits how quickly the
+    // acceleration can change while keeping the acceleration and the distance the same
+    const int window = std::max(1, static_cast<int>(std::ceil(jerkWindow / dt - 1e-9)));
+    velocities.assign(samples.size() + window - 1, 0);
+    double windowSum = 0;
+    for (std::size_t k = 0; k < velocities.size(); ++k) {
+      if (k < samples.size()) {
+        windowSum += samples[k];
+      }
+
+      if (k >= static_cast<std::size_t>(window)) {
+        windowSum -= samples[k - window];
+      }
+
+      velocities[k] = std::max(0.0, windowSum / window);
+    }
+
+    // Correct the small error from sampling so the trajectory ends exactly at the end of the path
+    double distance = 0;
+    for (std::size_t k = 1; k < velocities.size(); ++k) {
+      distance += (velocities[k - 1] + velocities[k]) / 2 * dt;
+    }
+
+    for (auto &velocity : velocities) {
+      velocity *= length / distance;
+    }
+
+    bool refined = false;
+
+    double position = 0;
+    for (std::size_t k = 1; k < velocities.size(); ++k) {
+      position += (velocities[k - 1] + velocities[k]) / 2 * dt;
+      const int index = std::clamp(static_cast<int>(std::round(position / ds)), 0, gridCount);
+
+      if (velocities[k] > pathLimits[index] * (1 + 1e-3)) {
+        // Every sample the moving average covers has to respect the limit
+        const int spread = static_cast<int>(std::ceil(velocities[k] * window * dt / ds));
+        for (int i = std::max(0, index - spread); i <= std::min(gridCount, index + spread); ++i) {
+          gridLimits[i] = std::min(gridLimits[i], pathLimits[index]);
+        }
+        refined = true;
+      }
+    }
+
+    double lastAcceleration = 0;
+    for (std::size_t k = 1; k < velocities.size(); ++k) {
+      const double acceleration = (velocities[k] - velocities[k - 1]) / dt;
+      if (std::abs(acceleration - lastAcceleration) / dt > ilimits.maxJerk * (1 + 1e-3) &&
+          jerkWindow < 2 * ilimits.maxAccel / ilimits.maxJerk) {
+        // Going straight from accelerating to decelerating changes the acceleration twice as much,
+        // so it needs twice the window
+        jerkWindow = 2 * ilimits.maxAccel / ilimits.maxJerk;
+        refined = true;
+        break;
+      }
+      lastAcceleration = acceleration;
+    }
+
+    if (!refined) {
+      break;
+    }
+  }
+
+  // Refining can run out of passes, and correcting the distance scales every sample, so check the
+  // trajectory which is returned instead of trusting the last pass
+  double checkedPosition = 0;
+  for (std::size_t k = 1; k < velocities.size(); ++k) {
+    checkedPosition += (velocities[k - 1] + velocities[k]) / 2 * dt;
+    const int index = std::clamp(static_cast<int>(std::round(checkedPosition / ds)), 0, gridCount);
+    const double acceleration = (velocities[k] - velocities[k - 1]) / dt;
+
+    if (velocities[k] > pathLimits[index] * (1 + 1e-3) ||
+        std::abs(acceleration) > ilimits.maxAccel * (1 + 1e-3)) {
+      throw std::invalid_argument(
+        "TrajectoryGenerator: The limits could not be respected " +
+        std::to_string(std::min(checkedPosition, length)) + " m along the path (velocity " +
+        std::to_string(velocities[k]) + " m/s, acceleration " + std::to_string(acceleration) +
+        " m/s/s).");
+    }
+  }
+
+  std::vector<Segment> segments;
+  segments.reserve(velocities.size() - 1);
+  ocurvatures.clear();
+  ocurvatures.reserve(velocities.size() - 1);
+
+  // The first sample is at rest, so start from the one after it like pathfinder does
+  double position = 0;
+  double lastAcceleration = 0;
+  for (std::size_t k = 1; k < velocities.size(); ++k) {
+    position = std::min(length, position + (velocities[k - 1] + velocities[k]) / 2 * dt);
+    const double acceleration = (velocities[k] - velocities[k - 1]) / dt;
+
+    const auto [spline, t] = ipath.locate(position);
+    const auto [x, y] = spline->getPosition(t);
+
+    double heading = std::fmod(spline->getHeading(t), 2 * pi);
+    if (heading < 0) {
+      heading += 2 * pi;
+    }
+
+    segments.push_back(Segment{dt,
+                               x,
+                               y,
+                               position,
+                               velocities[k],
+                               acceleration,
+                               (acceleration - lastAcceleration) / dt,
+                               heading});
+    ocurvatures.push_back(spline->getCurvature(t));
+    lastAcceleration = acceleration;
+  }
+
+  return segments;
+}
+
+TrajectoryGenerator::QuinticSpline::QuinticSpline(const PathfinderPoint &istart,
+                                                  const PathfinderPoint &iend) {
+  const double x0 = istart.x.convert(meter);
+  const double y0 = istart.y.convert(meter);
+  const double x1 = iend.x.convert(meter);
+  const double y1 = iend.y.convert(meter);
+
+  // Scaling the tangents by the distance between the waypoints keeps the curve from looping
+  const double scale = 1.2 * std::hypot(x1 - x0, y1 - y0);
+  const double dx0 = scale * std::cos(istart.theta.convert(radian));
+  const double dy0 = scale * std::sin(istart.theta.convert(radian));
+  const double dx1 = scale * std::cos(iend.theta.convert(radian));
+  const double dy1 = scale * std::sin(iend.theta.convert(radian));
+
+  // Quintic Hermite basis with zero second derivative at both ends
+  auto fit = [](const double p0, const double v0, const double v1, const double p1) {
+    return std::array<double, 6>{p0,
+                                 v0,
+                                 0,
+                                 -10 * p0 - 6 * v0 - 4 * v1 + 10 * p1,
+                                 15 * p0 + 8 * v0 + 7 * v1 - 15 * p1,
+                                 -6 * p0 - 3 * v0 - 3 * v1 + 6 * p1};
+  };
+
+  x = fit(x0, dx0, dx1, x1);
+  y = fit(y0, dy0, dy1, y1);
+
+  for (int i = 0; i < quadratureIntervals; ++i) {
+    intervalDistances[i + 1] =
+      intervalDistances[i] +
+      integrate(static_cast<double>(i) / quadratureIntervals,
+                static_cast<double>(i + 1) / quadratureIntervals);
+  }
+}
+
+double TrajectoryGenerator::QuinticSpline::getLength() const {
+  return intervalDistances.back();
+}
+
+double TrajectoryGenerator::QuinticSpline::getParameter(const double idistance) const {
+  const double distance = std::clamp(idistance, 0.0, getLength());
+
+  const auto upper =
+    std::upper_bound(intervalDistances.begin() + 1, intervalDistances.end() - 1, distance);
+  const int interval = static_cast<int>(std::distance(intervalDistances.begin(), upper)) - 1;
+
+  const double t0 = static_cast<double>(interval) / quadratureIntervals;
+  const double t1 = static_cast<double>(interval + 1) / quadratureIntervals;
+  const double intervalLength = intervalDistances[interval + 1] - intervalDistances[interval];
+  if (intervalLength <= 0) {
+    return t0;
+  }
+
+  double t = t0 + (distance - intervalDistances[interval]) / intervalLength * (t1 - t0);
+  for (int i = 0; i < 4; ++i) {
+    const double speed = getSpeed(t);
+    if (speed <= 0) {
+      break;
+    }
+
+    const double error = intervalDistances[interval] + integrate(t0, t) - distance;
+    t = std::clamp(t - error / speed, t0, t1);
+  }
+
+  return t;
+}
+
+std::pair<double, double> TrajectoryGenerator::QuinticSpline::getPosition(const double it) const {
+  return {evaluate(x, it), evaluate(y, it)};
+}
+
+double TrajectoryGenerator::QuinticSpline::getHeading(const double it) const {
+  return std::atan2(derivative(y, it), derivative(x, it));
+}
+
+double TrajectoryGenerator::QuinticSpline::getCurvature(const double it) const {
+  const double dx = derivative(x, it);
+  const double dy = derivative(y, it);
+  const double speed = std::hypot(dx, dy);
+  if (speed <= 0) {
+    return 0;
+  }
+
+  return (dx * secondDerivative(y, it) - dy * secondDerivative(x, it)) / (speed * speed * speed);
+}
+
+double TrajectoryGenerator::QuinticSpline::evaluate(const std::array<double, 6> &icoeffs,
+                                                    const double it) {
+  return icoeffs[0] +
+         it * (icoeffs[1] +
+               it * (icoeffs[2] + it * (icoeffs[3] + it * (icoeffs[4] + it * icoeffs[5]))));
+}
+
+double TrajectoryGenerator::QuinticSpline::derivative(const std::array<double, 6> &icoeffs,
+                                                      const double it) {
+  return icoeffs[1] +
+         it * (2 * icoeffs[2] +
+               it * (3 * icoeffs[3] + it * (4 * icoeffs[4] + it * 5 * icoeffs[5])));
+}
+
+double TrajectoryGenerator::QuinticSpline::secondDerivative(const std::array<double, 6> &icoeffs,
+                                                            const double it) {
+  return 2 * icoeffs[2] + it * (6 * icoeffs[3] + it * (12 * icoeffs[4] + it * 20 * icoeffs[5]));
+}
+
+double TrajectoryGenerator::QuinticSpline::getSpeed(const double it) const {
+  return std::hypot(derivative(x, it), derivative(y, it));
+}
+
+double TrajectoryGenerator::QuinticSpline::integrate(const double it0, const double it1) const {
+  static constexpr std::array<double, 5> nodes{
+    0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+  static constexpr std::array<double, 5> weights{0.5688888888888889,
+                                                 0.4786286704993665,
+                                                 0.4786286704993665,
+                                                 0.2369268850561891,
+                                                 0.2369268850561891};
+
+  const double halfWidth = (it1 - it0) / 2;
+  const double midpoint = (it0 + it1) / 2;
+
+  double sum = 0;
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    sum += weights[i] * getSpeed(midpoint + halfWidth * nodes[i]);
+  }
+
+  return sum * halfWidth;
+}
+
+TrajectoryGenerator::SplinePath::SplinePath(const std::vector<PathfinderPoint> &iwaypoints) {
+  splines.reserve(iwaypoints.size() - 1);
+  startDistances.reserve(iwaypoints.size() - 1);
+
+  for (std::size_t i = 1; i < iwaypoints.size(); ++i) {
+    splines.emplace_back(iwaypoints[i - 1], iwaypoints[i]);
+    startDistances.push_back(length);
+    length += splines.back().getLength();
+  }
+}
+
+double TrajectoryGenerator::SplinePath::getLength() const {
+  return length;
+}
+
+std::pair<const TrajectoryGenerator::QuinticSpline *, double>
+TrajectoryGenerator::SplinePath::locate(const double idistance) const {
+  const auto upper = std::upper_bound(startDistances.begin() + 1, startDistances.end(), idistance);
+  const auto index = std::distance(startDistances.begin(), upper) - 1;
+  const auto &spline = splines[index];
+  return {&spline, spline.getParameter(idistance - startDistances[index])};
+}
+} // namespace okapi
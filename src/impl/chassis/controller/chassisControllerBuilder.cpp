@@ -209,6 +209,28 @@ ChassisControllerBuilder::withGains(const IterativePosPIDController::Gains &idis
   distanceGains = idistanceGains;
   turnGains = iturnGains;
   angleGains = iangleGains;
+  distanceSchedule = nullptr;
+  turnSchedule = nullptr;
+  angleSchedule = nullptr;
+  return *this;
+}
+
+ChassisControllerBuilder &
+ChassisControllerBuilder::withGains(const PIDGainSchedule &idistanceSchedule,
+                                    const PIDGainSchedule &iturnSchedule) {
+  return withGains(idistanceSchedule, iturnSchedule, iturnSchedule);
+}
+
+ChassisControllerBuilder &
+ChassisControllerBuilder::withGains(const PIDGainSchedule &idistanceSchedule,
+                                    const PIDGainSchedule &iturnSchedule,
+                                    const PIDGainSchedule &iangleSchedule) {
+  withGains(idistanceSchedule.getPoints().front().second,
+            iturnSchedule.getPoints().front().second,
+            iangleSchedule.getPoints().front().second);
+  distanceSchedule = std::make_shared<PIDGainSchedule>(idistanceSchedule);
+  turnSchedule = std::make_shared<PIDGainSchedule>(iturnSchedule);
+  angleSchedule = std::make_shared<PIDGainSchedule>(iangleSchedule);
   return *this;
 }
 
@@ -222,6 +244,19 @@ ChassisControllerBuilder::withDerivativeFilters(std::unique_ptr<Filter> idistanc
   return *this;
 }
 
+ChassisControllerBuilder &
+ChassisControllerBuilder::withMotionProfile(const PathfinderLimits &istraightLimits,
+                                            const PathfinderLimits &iturnLimits,
+                                            const SCurveProfile::Shape ishape,
+                                            const double ivelocityFeedforward) {
+  hasMotionProfile = true;
+  straightProfileLimits = istraightLimits;
+  turnProfileLimits = iturnLimits;
+  profileShape = ishape;
+  profileVelocityFeedforward = ivelocityFeedforward;
+  return *this;
+}
+
 ChassisControllerBuilder &ChassisControllerBuilder::withOdometry(const StateMode &imode,
                                                                  const QLength &imoveThreshold,
                                                                  const QAngle &iturnThreshold) {
@@ -420,24 +455,38 @@ std::shared_ptr<ChassisControllerPID> ChassisControllerBuilder::buildCCPID() {
     odomScales.straight = odomScales.straight / gearset.ratio;
     odomScales.turn = odomScales.turn / gearset.ratio;
   }
-  auto out = std::make_shared<ChassisControllerPID>(
-    chassisControllerTimeUtilFactory.create(),
-    makeChassisModel(),
+  auto distancePid =
     std::make_unique<IterativePosPIDController>(distanceGains,
                                                 closedLoopControllerTimeUtilFactory.create(),
                                                 std::move(distanceFilter),
-                                                controllerLogger),
+                                                controllerLogger);
+  auto turnPid =
     std::make_unique<IterativePosPIDController>(turnGains,
                                                 closedLoopControllerTimeUtilFactory.create(),
                                                 std::move(turnFilter),
-                                                controllerLogger),
+                                                controllerLogger);
+  auto anglePid =
     std::make_unique<IterativePosPIDController>(angleGains,
                                                 closedLoopControllerTimeUtilFactory.create(),
                                                 std::move(angleFilter),
-                                                controllerLogger),
-    gearset,
-    odomScales,
-    controllerLogger);
+                                                controllerLogger);
+  distancePid->setGainSchedule(distanceSchedule);
+  turnPid->setGainSchedule(turnSchedule);
+  anglePid->setGainSchedule(angleSchedule);
+
+  auto out = std::make_shared<ChassisControllerPID>(chassisControllerTimeUtilFactory.create(),
+                                                    makeChassisModel(),
+                                                    std::move(distancePid),
+                                                    std::move(turnPid),
+                                                    std::move(anglePid),
+                                                    gearset,
+                                                    odomScales,
+                                                    controllerLogger);
+
+  if (hasMotionProfile) {
+    out->setMotionProfile(
+      straightProfileLimits, turnProfileLimits, profileShape, profileVelocityFeedforward);
+  }
 
   out->startThread();
 
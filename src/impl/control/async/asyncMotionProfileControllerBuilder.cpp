@@ -68,6 +68,42 @@ AsyncMotionProfileControllerBuilder::withLimits(const PathfinderLimits &ilimits)
   return *this;
 }
 
+AsyncMotionProfileControllerBuilder &
+AsyncMotionProfileControllerBuilder::withFollowerGains(const ProfileFollowerGains &igains,
+                                                       const std::shared_ptr<Odometry> &iodometry) {
+  followerGains = igains;
+  followerOdometry = iodometry;
+  return *this;
+}
+
+AsyncMotionProfileControllerBuilder &AsyncMotionProfileControllerBuilder::withOdometry(
+  const std::shared_ptr<OdomChassisController> &icontroller) {
+  return withOdometry(icontroller->getOdometry());
+}
+
+AsyncMotionProfileControllerBuilder &
+AsyncMotionProfileControllerBuilder::withOdometry(const std::shared_ptr<Odometry> &iodometry) {
+  odometry = iodometry;
+  return *this;
+}
+
+AsyncMotionProfileControllerBuilder &
+AsyncMotionProfileControllerBuilder::withRamseteGains(const double ib, const double izeta) {
+  ramseteB = ib;
+  ramseteZeta = izeta;
+  return *this;
+}
+
+AsyncMotionProfileControllerBuilder &
+AsyncMotionProfileControllerBuilder::withPurePursuitLookahead(const QLength iminLookahead,
+                                                              const QLength imaxLookahead,
+                                                              const QTime ilookaheadTime) {
+  minLookahead = iminLookahead;
+  maxLookahead = imaxLookahead;
+  lookaheadTime = ilookaheadTime;
+  return *this;
+}
+
 AsyncMotionProfileControllerBuilder &
 AsyncMotionProfileControllerBuilder::withTimeUtilFactory(const TimeUtilFactory &itimeUtilFactory) {
   timeUtilFactory = itimeUtilFactory;
@@ -132,6 +168,115 @@ AsyncMotionProfileControllerBuilder::buildMotionProfileController() {
 
   auto out = std::make_shared<AsyncMotionProfileController>(
     timeUtilFactory.create(), limits, model, scales, pair, controllerLogger);
+
+  if (followerGains) {
+    out->setFollowerGains(*followerGains, followerOdometry);
+  }
+
+  out->startThread();
+
+  if (isParentedToCurrentTask && NOT_INITIALIZE_TASK && NOT_COMP_INITIALIZE_TASK) {
+    out->getThread()->notifyWhenDeletingRaw(pros::c::task_get_current());
+    out->getGenerationThread()->notifyWhenDeletingRaw(pros::c::task_get_current());
+  }
+
+  return out;
+}
+
+std::shared_ptr<AsyncRamseteController>
+AsyncMotionProfileControllerBuilder::buildRamseteController() {
+  if (!hasModel) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No model given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  if (!hasLimits) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No limits given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  if (!odometry) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No odometry given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  auto out = std::make_shared<AsyncRamseteController>(timeUtilFactory.create(),
+                                                      limits,
+                                                      model,
+                                                      scales,
+                                                      pair,
+                                                      odometry,
+                                                      ramseteB,
+                                                      ramseteZeta,
+                                                      controllerLogger);
+  out->startThread();
+
+  if (isParentedToCurrentTask && NOT_INITIALIZE_TASK && NOT_COMP_INITIALIZE_TASK) {
+    out->getThread()->notifyWhenDeletingRaw(pros::c::task_get_current());
+    out->getGenerationThread()->notifyWhenDeletingRaw(pros::c::task_get_current());
+  }
+
+  return out;
+}
+
+std::shared_ptr<AsyncPurePursuitController>
+AsyncMotionProfileControllerBuilder::buildPurePursuitController() {
+  if (!hasModel) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No model given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  if (!hasLimits) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No limits given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  if (!odometry) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No odometry given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  auto out = std::make_shared<AsyncPurePursuitController>(timeUtilFactory.create(),
+                                                          limits,
+                                                          model,
+                                                          scales,
+                                                          pair,
+                                                          odometry,
+                                                          minLookahead,
+                                                          maxLookahead,
+                                                          lookaheadTime,
+                                                          controllerLogger);
+  out->startThread();
+
+  if (isParentedToCurrentTask && NOT_INITIALIZE_TASK && NOT_COMP_INITIALIZE_TASK) {
+    out->getThread()->notifyWhenDeletingRaw(pros::c::task_get_current());
+  }
+
+  return out;
+}
+
+std::shared_ptr<AsyncHolonomicMotionProfileController>
+AsyncMotionProfileControllerBuilder::buildHolonomicMotionProfileController() {
+  if (!hasModel) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No model given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  if (!hasLimits) {
+    std::string msg("AsyncMotionProfileControllerBuilder: No limits given.");
+    LOG_ERROR(msg);
+    throw std::runtime_error(msg);
+  }
+
+  auto out = std::make_shared<AsyncHolonomicMotionProfileController>(
+    timeUtilFactory.create(), limits, model, scales, pair, controllerLogger);
   out->startThread();
 
   if (isParentedToCurrentTask && NOT_INITIALIZE_TASK && NOT_COMP_INITIALIZE_TASK) {
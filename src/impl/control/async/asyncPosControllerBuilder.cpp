@@ -60,6 +60,14 @@ AsyncPosControllerBuilder &
 AsyncPosControllerBuilder::withGains(const IterativePosPIDController::Gains &igains) {
   hasGains = true;
   gains = igains;
+  gainSchedule = nullptr;
+  return *this;
+}
+
+AsyncPosControllerBuilder &
+AsyncPosControllerBuilder::withGains(const PIDGainSchedule &igainSchedule) {
+  withGains(igainSchedule.getPoints().front().second);
+  gainSchedule = std::make_shared<PIDGainSchedule>(igainSchedule);
   return *this;
 }
 
@@ -139,6 +147,9 @@ std::shared_ptr<AsyncPosPIDController> AsyncPosControllerBuilder::buildAPPC() {
                                                      pair.ratio,
                                                      std::move(derivativeFilter),
                                                      controllerLogger);
+  // The constructor only takes the feedback gains
+  out->setGains(gains);
+  out->setGainSchedule(gainSchedule);
   out->startThread();
 
   if (isParentedToCurrentTask && NOT_INITIALIZE_TASK && NOT_COMP_INITIALIZE_TASK) {
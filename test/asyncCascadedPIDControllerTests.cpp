@@ -0,0 +1,75 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncCascadedPidController.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class AsyncCascadedPIDControllerTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    input = std::make_shared<MockControllerInput>();
+    output = std::make_shared<MockMotor>();
+    controller = new AsyncCascadedPIDController(
+      input,
+      output,
+      createTimeUtil(),
+      {0.01, 0, 0, 0},
+      {0.001, 0, 0.001, 0},
+      std::make_unique<VelMath>(
+        1800, std::make_unique<PassthroughFilter>(), 1_ms, std::make_unique<MockTimer>()),
+      100);
+  }
+
+  void TearDown() override {
+    delete controller;
+  }
+
+  std::shared_ptr<MockControllerInput> input;
+  std::shared_ptr<MockMotor> output;
+  AsyncCascadedPIDController *controller;
+};
+
+TEST_F(AsyncCascadedPIDControllerTest, SettledWhenDisabled) {
+  assertControllerIsSettledWhenDisabled(*controller, 100.0);
+}
+
+TEST_F(AsyncCascadedPIDControllerTest, WaitUntilSettledWorksWhenDisabled) {
+  assertWaitUntilSettledWorksWhenDisabled(*controller);
+}
+
+TEST_F(AsyncCascadedPIDControllerTest, ScalesControllerSetTargets) {
+  assertAsyncWrapperScalesControllerSetTargets(*controller);
+}
+
+TEST_F(AsyncCascadedPIDControllerTest, TestTarePosition) {
+  controller->startThread();
+  auto rate = createTimeUtil().getRate();
+
+  input->reading = 0;
+  controller->setTarget(100);
+  rate->delayUntil(100_ms);
+  EXPECT_EQ(controller->getError(), 100);
+
+  input->reading = 100;
+  rate->delayUntil(100_ms);
+  EXPECT_EQ(controller->getError(), 0);
+
+  controller->tarePosition();
+  rate->delayUntil(100_ms);
+  EXPECT_EQ(controller->getError(), 100);
+}
+
+TEST_F(AsyncCascadedPIDControllerTest, TestSetAndGetGains) {
+  IterativePosPIDController::Gains outerGains{1, 2, 3, 4};
+  controller->setOuterGains(outerGains);
+  EXPECT_EQ(controller->getOuterGains(), outerGains);
+
+  IterativeVelPIDController::Gains innerGains{5, 6, 7, 8};
+  controller->setInnerGains(innerGains);
+  EXPECT_EQ(controller->getInnerGains(), innerGains);
+}
@@ -0,0 +1,345 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncHolonomicMotionProfileController.hpp"
+#include "okapi/api/chassis/model/skidSteerModel.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class MockAsyncHolonomicMotionProfileController : public AsyncHolonomicMotionProfileController {
+  public:
+  using AsyncHolonomicMotionProfileController::AsyncHolonomicMotionProfileController;
+
+  const std::vector<HolonomicSegment> &getPathData(const std::string &ipathId) {
+    return *paths.at(ipathId);
+  }
+};
+
+class AsyncHolonomicMotionProfileControllerTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    controller = makeController(std::make_shared<XDriveModel>(topLeftMotor,
+                                                              topRightMotor,
+                                                              bottomRightMotor,
+                                                              bottomLeftMotor,
+                                                              topLeftMotor->getEncoder(),
+                                                              topRightMotor->getEncoder(),
+                                                              200,
+                                                              v5MotorMaxVoltage),
+                                {1.0, 2.0, 10.0});
+  }
+
+  std::unique_ptr<MockAsyncHolonomicMotionProfileController>
+  makeController(const std::shared_ptr<ChassisModel> &imodel, const PathfinderLimits &ilimits) {
+    auto out = std::make_unique<MockAsyncHolonomicMotionProfileController>(
+      createTimeUtil(),
+      ilimits,
+      imodel,
+      ChassisScales({4_in, 10.5_in}, quadEncoderTPR),
+      AbstractMotor::gearset::green);
+    out->startThread();
+    return out;
+  }
+
+  /**
+   * Integrates the velocities of a path to check that they take the robot to the end of it.
+   */
+  static MockAsyncHolonomicMotionProfileController::HolonomicSegment
+  integrate(const std::vector<MockAsyncHolonomicMotionProfileController::HolonomicSegment> &ipath) {
+    MockAsyncHolonomicMotionProfileController::HolonomicSegment out{0, 0, 0, 0, 0, 0, 0};
+    for (const auto &segment : ipath) {
+      out.x += segment.vx * segment.dt;
+      out.y += segment.vy * segment.dt;
+      out.theta += segment.omega * segment.dt;
+      out.dt += segment.dt;
+    }
+    return out;
+  }
+
+  std::shared_ptr<MockMotor> topLeftMotor = std::make_shared<MockMotor>();
+  std::shared_ptr<MockMotor> topRightMotor = std::make_shared<MockMotor>();
+  std::shared_ptr<MockMotor> bottomRightMotor = std::make_shared<MockMotor>();
+  std::shared_ptr<MockMotor> bottomLeftMotor = std::make_shared<MockMotor>();
+  std::unique_ptr<MockAsyncHolonomicMotionProfileController> controller;
+};
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, ConstructWithGearRatioOf0) {
+  EXPECT_THROW(AsyncHolonomicMotionProfileController(
+                 createTimeUtil(),
+                 {1.0, 2.0, 10.0},
+                 std::make_shared<XDriveModel>(topLeftMotor,
+                                               topRightMotor,
+                                               bottomRightMotor,
+                                               bottomLeftMotor,
+                                               topLeftMotor->getEncoder(),
+                                               topRightMotor->getEncoder(),
+                                               200,
+                                               v5MotorMaxVoltage),
+                 ChassisScales({4_in, 10.5_in}, quadEncoderTPR),
+                 AbstractMotor::gearset::green * 0),
+               std::invalid_argument);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, ConstructWithSkidSteerModelThrowsException) {
+  EXPECT_THROW(AsyncHolonomicMotionProfileController(
+                 createTimeUtil(),
+                 {1.0, 2.0, 10.0},
+                 std::make_shared<SkidSteerModel>(topLeftMotor,
+                                                  topRightMotor,
+                                                  topLeftMotor->getEncoder(),
+                                                  topRightMotor->getEncoder(),
+                                                  200,
+                                                  v5MotorMaxVoltage),
+                 ChassisScales({4_in, 10.5_in}, quadEncoderTPR),
+                 AbstractMotor::gearset::green),
+               std::invalid_argument);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, XDriveWheelSpeeds) {
+  const auto forward = controller->getWheelSpeeds(1, 0, 0);
+  for (const double speed : forward) {
+    EXPECT_NEAR(speed, forward[0], 1e-9);
+    EXPECT_GT(speed, 0);
+  }
+
+  // Strafing left drives the top left and bottom right wheels backwards
+  const auto left = controller->getWheelSpeeds(0, 1, 0);
+  EXPECT_LT(left[0], 0);
+  EXPECT_GT(left[1], 0);
+  EXPECT_LT(left[2], 0);
+  EXPECT_GT(left[3], 0);
+  EXPECT_NEAR(std::abs(left).max(), forward[0], 1e-9);
+
+  // Turning counterclockwise drives the left wheels backwards
+  const auto turn = controller->getWheelSpeeds(0, 0, 1);
+  EXPECT_LT(turn[0], 0);
+  EXPECT_GT(turn[1], 0);
+  EXPECT_GT(turn[2], 0);
+  EXPECT_LT(turn[3], 0);
+  EXPECT_NEAR(turn[1], controller->getWheelSpeeds((10.5_in).convert(meter) / 2, 0, 0)[1], 1e-9);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, HDriveWheelSpeeds) {
+  auto middleMotor = std::make_shared<MockMotor>();
+  auto hController = makeController(std::make_shared<HDriveModel>(topLeftMotor,
+                                                                   topRightMotor,
+                                                                   middleMotor,
+                                                                   topLeftMotor->getEncoder(),
+                                                                   topRightMotor->getEncoder(),
+                                                                   middleMotor->getEncoder(),
+                                                                   200,
+                                                                   v5MotorMaxVoltage),
+                                     {1.0, 2.0, 10.0});
+
+  const auto left = hController->getWheelSpeeds(0, 1, 0);
+  ASSERT_EQ(left.size(), 3);
+  EXPECT_NEAR(left[0], 0, 1e-9);
+  EXPECT_NEAR(left[1], 0, 1e-9);
+  EXPECT_LT(left[2], 0);
+
+  const auto turn = hController->getWheelSpeeds(0, 0, 1);
+  EXPECT_LT(turn[0], 0);
+  EXPECT_GT(turn[1], 0);
+  EXPECT_NEAR(turn[2], 0, 1e-9);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, StrafePathKeepsHeading) {
+  controller->generatePath({{0_ft, 0_ft, 0_deg}, {0_ft, 3_ft, 0_deg}}, "A");
+  const auto &path = controller->getPathData("A");
+  ASSERT_GT(path.size(), 2);
+
+  for (const auto &segment : path) {
+    EXPECT_NEAR(segment.theta, 0, 1e-9);
+    EXPECT_NEAR(segment.omega, 0, 1e-9);
+    EXPECT_NEAR(segment.vx, 0, 1e-6);
+    EXPECT_GE(segment.vy, 0);
+  }
+
+  const auto end = integrate(path);
+  EXPECT_NEAR(end.x, 0, 1e-3);
+  EXPECT_NEAR(end.y, (3_ft).convert(meter), 0.02);
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  // The robot strafes left with the top right and bottom left wheels going forwards
+  EXPECT_GT(topRightMotor->maxVelocity, 0);
+  EXPECT_GT(bottomLeftMotor->maxVelocity, 0);
+  EXPECT_EQ(topLeftMotor->maxVelocity, 0);
+  EXPECT_EQ(bottomRightMotor->maxVelocity, 0);
+  EXPECT_EQ(topLeftMotor->lastVelocity, 0);
+  EXPECT_EQ(topRightMotor->lastVelocity, 0);
+  EXPECT_EQ(bottomRightMotor->lastVelocity, 0);
+  EXPECT_EQ(bottomLeftMotor->lastVelocity, 0);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, DiagonalPathDrivesAtFullSpeed) {
+  controller->generatePath({{0_ft, 0_ft, 0_deg}, {3_ft, 3_ft, 0_deg}}, "A");
+  const auto &path = controller->getPathData("A");
+
+  double peak = 0;
+  for (const auto &segment : path) {
+    EXPECT_NEAR(segment.theta, 0, 1e-9);
+    EXPECT_NEAR(segment.vx, segment.vy, 1e-6);
+    peak = std::max(peak, std::abs(controller->getWheelSpeeds(segment.vx, segment.vy, 0)).max());
+  }
+
+  // The robot doesn't have to turn to face where it is going. Only two wheels drive it
+  // diagonally, which reach full speed before the robot reaches the velocity limit.
+  EXPECT_NEAR(peak, 1, 1e-9);
+
+  const auto end = integrate(path);
+  EXPECT_NEAR(end.x, (3_ft).convert(meter), 0.02);
+  EXPECT_NEAR(end.y, (3_ft).convert(meter), 0.02);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, HeadingIsProfiledBetweenWaypoints) {
+  controller->generatePath(
+    {{0_ft, 0_ft, 0_deg}, {2_ft, 2_ft, 90_deg}, {4_ft, 0_ft, 0_deg}}, "A");
+  const auto &path = controller->getPathData("A");
+
+  // The robot turns smoothly from rest and ends at the heading of the last waypoint
+  EXPECT_NEAR(path.front().theta, 0, 1e-9);
+  EXPECT_NEAR(path.front().omega, 0, 1e-9);
+  EXPECT_NEAR(path.back().theta, 0, 1e-9);
+  EXPECT_NEAR(path.back().omega, 0, 1e-9);
+
+  // The heading reaches that of the middle waypoint where the path passes through it
+  std::size_t closest = 0;
+  for (std::size_t i = 0; i < path.size(); ++i) {
+    if (std::hypot(path[i].x - 0.6096, path[i].y - 0.6096) <
+        std::hypot(path[closest].x - 0.6096, path[closest].y - 0.6096)) {
+      closest = i;
+    }
+  }
+  EXPECT_NEAR(path[closest].theta, pi / 2, 0.01);
+
+  double maxTheta = 0;
+  for (const auto &segment : path) {
+    maxTheta = std::max(maxTheta, segment.theta);
+  }
+  EXPECT_NEAR(maxTheta, pi / 2, 1e-9);
+
+  // The angular velocity is consistent with the heading
+  double theta = 0;
+  for (std::size_t i = 0; i < closest; ++i) {
+    theta += path[i].omega * path[i].dt;
+  }
+  EXPECT_NEAR(theta, pi / 2, 0.05);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, HeadingTurnsTheShortWay) {
+  controller->generatePath({{0_ft, 0_ft, 170_deg}, {3_ft, 0_ft, -170_deg}}, "A");
+  const auto &path = controller->getPathData("A");
+
+  EXPECT_NEAR(path.back().theta, 190 * degreeToRadian, 1e-9);
+  for (const auto &segment : path) {
+    EXPECT_GE(segment.omega, 0);
+  }
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, SegmentsAreSlowedWhenAWheelCannotKeepUp) {
+  // 3 m/s is faster than a 4 inch wheel on a green gearset can go
+  auto fastController = makeController(std::make_shared<XDriveModel>(topLeftMotor,
+                                                                     topRightMotor,
+                                                                     bottomRightMotor,
+                                                                     bottomLeftMotor,
+                                                                     topLeftMotor->getEncoder(),
+                                                                     topRightMotor->getEncoder(),
+                                                                     200,
+                                                                     v5MotorMaxVoltage),
+                                       {3.0, 4.0, 20.0});
+  fastController->generatePath({{0_ft, 0_ft, 0_deg}, {6_ft, 2_ft, 180_deg}}, "A");
+  const auto &path = fastController->getPathData("A");
+
+  bool slowed = false;
+  for (const auto &segment : path) {
+    const double cosTheta = std::cos(segment.theta);
+    const double sinTheta = std::sin(segment.theta);
+    const double forward = cosTheta * segment.vx + sinTheta * segment.vy;
+    const double left = -sinTheta * segment.vx + cosTheta * segment.vy;
+    const auto speeds = fastController->getWheelSpeeds(forward, left, segment.omega);
+    EXPECT_LE(std::abs(speeds).max(), 1 + 1e-9);
+    slowed = slowed || segment.dt > 0.010 + 1e-9;
+  }
+  EXPECT_TRUE(slowed);
+
+  // Slowing down doesn't move the robot off the path
+  const auto end = integrate(path);
+  EXPECT_NEAR(end.x, (6_ft).convert(meter), 0.05);
+  EXPECT_NEAR(end.y, (2_ft).convert(meter), 0.05);
+  EXPECT_NEAR(end.theta, pi, 0.05);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, HDriveStrafesWithTheMiddleWheel) {
+  auto middleMotor = std::make_shared<MockMotor>();
+  auto hController = makeController(std::make_shared<HDriveModel>(topLeftMotor,
+                                                                   topRightMotor,
+                                                                   middleMotor,
+                                                                   topLeftMotor->getEncoder(),
+                                                                   topRightMotor->getEncoder(),
+                                                                   middleMotor->getEncoder(),
+                                                                   200,
+                                                                   v5MotorMaxVoltage),
+                                     {1.0, 2.0, 10.0});
+
+  hController->moveTo({{0_ft, 0_ft, 0_deg}, {0_ft, -2_ft, 0_deg}});
+
+  EXPECT_EQ(topLeftMotor->maxVelocity, 0);
+  EXPECT_EQ(topRightMotor->maxVelocity, 0);
+  EXPECT_GT(middleMotor->maxVelocity, 0);
+  EXPECT_EQ(middleMotor->lastVelocity, 0);
+  EXPECT_EQ(hController->getPaths().size(), 0);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, ImpossiblePathThrowsException) {
+  EXPECT_THROW(controller->generatePath({{0_ft, 0_ft, 0_deg}, {0_ft, 0_ft, 90_deg}}, "A"),
+               std::runtime_error);
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, ZeroWaypointsDoesNothing) {
+  controller->generatePath({}, "A");
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, RemoveRunningPath) {
+  controller->generatePath({{0_ft, 0_ft, 0_deg}, {3_ft, 0_ft, 0_deg}}, "A");
+  controller->setTarget("A");
+
+  // The running path is freed once it finishes
+  EXPECT_TRUE(controller->removePath("A"));
+  EXPECT_EQ(controller->getPaths().size(), 0);
+  EXPECT_FALSE(controller->isDisabled());
+
+  controller->waitUntilSettled();
+  EXPECT_EQ(topLeftMotor->lastVelocity, 0);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, ReplaceRunningPath) {
+  controller->generatePath({{0_ft, 0_ft, 0_deg}, {3_ft, 0_ft, 0_deg}}, "A");
+  controller->setTarget("A");
+
+  // The old path keeps running until it finishes
+  controller->generatePath({{0_ft, 0_ft, 0_deg}, {1_ft, 0_ft, 0_deg}}, "A");
+  EXPECT_EQ(controller->getPaths().size(), 1);
+  EXPECT_FALSE(controller->isDisabled());
+
+  controller->waitUntilSettled();
+  EXPECT_EQ(topLeftMotor->lastVelocity, 0);
+  EXPECT_EQ(controller->getError().x.convert(meter), 0);
+}
+
+TEST_F(AsyncHolonomicMotionProfileControllerTest, WrongPathNameDoesNotMoveAnything) {
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(topLeftMotor->maxVelocity, 0);
+  EXPECT_EQ(topRightMotor->maxVelocity, 0);
+  EXPECT_EQ(controller->getError().x.convert(meter), 0);
+}
@@ -5,6 +5,8 @@
  */
 #include "okapi/api/control/async/asyncLinearMotionProfileController.hpp"
 #include "test/tests/api/implMocks.hpp"
+#include <chrono>
+#include <mutex>
 #include <gtest/gtest.h>
 
 using namespace okapi;
@@ -21,6 +23,23 @@ class MockAsyncLinearMotionProfileController : public AsyncLinearMotionProfileCo
   bool executeSinglePathCalled{false};
 };
 
+class RecordingControllerOutput : public ControllerOutput<double> {
+  public:
+  void controllerSet(const double ivalue) override {
+    std::scoped_lock lock(mutex);
+    values.push_back(ivalue);
+  }
+
+  std::vector<double> getValues() {
+    std::scoped_lock lock(mutex);
+    return values;
+  }
+
+  protected:
+  std::mutex mutex;
+  std::vector<double> values{};
+};
+
 class AsyncLinearMotionProfileControllerTest : public ::testing::Test {
   protected:
   void SetUp() override {
@@ -125,9 +144,13 @@ TEST_F(AsyncLinearMotionProfileControllerTest, RemoveRunningPath) {
 
   controller->setTarget("A");
 
-  EXPECT_FALSE(controller->removePath("A"));
+  // The running path is freed once it finishes
+  EXPECT_TRUE(controller->removePath("A"));
+  EXPECT_EQ(controller->getPaths().size(), 0);
+  EXPECT_FALSE(controller->isDisabled());
 
-  EXPECT_EQ(controller->getPaths().size(), 1);
+  controller->waitUntilSettled();
+  EXPECT_EQ(output->lastControllerOutputSet, 0);
 }
 
 TEST_F(AsyncLinearMotionProfileControllerTest, ReplaceRunningPath) {
@@ -136,12 +159,35 @@ TEST_F(AsyncLinearMotionProfileControllerTest, ReplaceRunningPath) {
   controller->setTarget("A");
   controller->flipDisable(false);
 
+  // The old path keeps running until it finishes
   controller->generatePath({0_m, 3_m}, "A");
-  EXPECT_EQ(controller->isDisabled(), true);
+  EXPECT_FALSE(controller->isDisabled());
 
   EXPECT_EQ(controller->getPaths().size(), 1);
 }
 
+TEST_F(AsyncLinearMotionProfileControllerTest, GeneratePathsReplacesRunningPath) {
+  controller->generatePath({0_m, 1_m}, "A");
+  controller->setTarget("A");
+
+  auto rate = createTimeUtil().getRate();
+  while (!controller->executeSinglePathCalled) {
+    rate->delayUntil(1_ms);
+  }
+
+  // Regenerate the running path and read the table while the old path is being followed
+  const auto results = controller->generatePaths({{{0_m, 2_m}, "A"}, {{0_m, 1_m}, "B"}}, 2);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_TRUE(results[0].succeeded);
+  EXPECT_TRUE(results[1].succeeded);
+  EXPECT_EQ(controller->getPaths(), (std::vector<std::string>{"A", "B"}));
+  EXPECT_FALSE(controller->isDisabled());
+
+  controller->waitUntilSettled();
+  EXPECT_EQ(output->lastControllerOutputSet, 0);
+  EXPECT_GT(output->maxControllerOutputSet, 0);
+}
+
 TEST_F(AsyncLinearMotionProfileControllerTest, RemoveAPathWhichDoesNotExist) {
   EXPECT_EQ(controller->getPaths().size(), 0);
 
@@ -232,3 +278,227 @@ TEST_F(AsyncLinearMotionProfileControllerTest, FollowPathBackwards) {
   // still running
   controller->flipDisable(true);
 }
+
+TEST_F(AsyncLinearMotionProfileControllerTest, FollowPathFromTrajectoryGenerator) {
+  controller->setTrajectoryGenerator(std::make_shared<TrajectoryGenerator>());
+  controller->generatePath({0_m, 3_m}, "A");
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(output->lastControllerOutputSet, 0);
+  EXPECT_GT(output->maxControllerOutputSet, 0);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerTest, TrajectoryGeneratorTimeComparedToPathfinder) {
+  constexpr int iterations = 20;
+  using clock = std::chrono::steady_clock;
+  using std::chrono::microseconds;
+
+  auto benchmark = [&](const std::string &iname) {
+    const auto start = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      controller->generatePath({0_m, 3_m}, "A");
+    }
+    const auto time = clock::now() - start;
+
+    RecordProperty(iname + "Micros",
+                   std::to_string(std::chrono::duration_cast<microseconds>(time).count() /
+                                  iterations));
+  };
+
+  benchmark("pathfinder");
+  controller->setTrajectoryGenerator(std::make_shared<TrajectoryGenerator>());
+  benchmark("native");
+
+  EXPECT_EQ(controller->getPaths().size(), 1);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerTest, FollowClosedFormProfile) {
+  controller->setClosedFormProfile(SCurveProfile::Shape::sCurve);
+  controller->generatePath({0_m, 1_m}, "A");
+  controller->setTarget("A");
+  EXPECT_NEAR(controller->getError(), 1, 1e-6);
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(output->lastControllerOutputSet, 0);
+  EXPECT_GT(output->maxControllerOutputSet, 0);
+  EXPECT_NEAR(controller->getError(), 0, 1e-6);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerTest, FollowLazyClosedFormProfile) {
+  controller->setClosedFormProfile(SCurveProfile::Shape::trapezoid, true);
+  controller->generatePath({1_m, 0_m}, "A");
+
+  // Following a profile which moves backwards, backwards, moves forwards
+  controller->setTarget("A", true);
+  EXPECT_NEAR(controller->getError(), -1, 1e-6);
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(output->lastControllerOutputSet, 0);
+  EXPECT_GT(output->maxControllerOutputSet, 0);
+  EXPECT_NEAR(controller->getError(), 0, 1e-6);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerTest, ClosedFormTimeComparedToPathfinder) {
+  constexpr int iterations = 20;
+  using clock = std::chrono::steady_clock;
+  using std::chrono::microseconds;
+
+  auto benchmark = [&](const std::string &iname) {
+    const auto start = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      controller->generatePath({0_m, 3_m}, "A");
+    }
+    const auto time = clock::now() - start;
+
+    RecordProperty(iname + "Micros",
+                   std::to_string(std::chrono::duration_cast<microseconds>(time).count() /
+                                  iterations));
+  };
+
+  benchmark("pathfinder");
+  controller->setClosedFormProfile(SCurveProfile::Shape::sCurve);
+  benchmark("closedForm");
+  controller->setClosedFormProfile(SCurveProfile::Shape::sCurve, true);
+  benchmark("closedFormLazy");
+
+  EXPECT_EQ(controller->getPaths().size(), 1);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerTest, GeneratePathsSavesEveryPath) {
+  const auto results = controller->generatePaths(
+    {{{0_m, 3_m}, "A"}, {{1_m, 0_m}, "B"}, {{0_m, 2_m}, "C", PathfinderLimits{0.5, 1.0, 5.0}}}, 2);
+
+  ASSERT_EQ(results.size(), 3);
+  for (const auto &result : results) {
+    EXPECT_TRUE(result.succeeded);
+    EXPECT_EQ(result.error, "");
+  }
+
+  EXPECT_EQ(controller->getPaths(), (std::vector<std::string>{"A", "B", "C"}));
+
+  controller->setTarget("C");
+  controller->waitUntilSettled();
+  EXPECT_EQ(output->lastControllerOutputSet, 0);
+  EXPECT_GT(output->maxControllerOutputSet, 0);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerTest, GeneratePathsReportsFailuresWithoutStopping) {
+  controller->setClosedFormProfile(SCurveProfile::Shape::sCurve);
+  const auto results = controller->generatePaths({{{0_m, 3_m}, "A", PathfinderLimits{0, 2, 10}},
+                                                  {{}, "B"},
+                                                  {{0_m, 1_m}, "C"},
+                                                  {{0_m, 2_m}, "C"}});
+
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_FALSE(results[0].succeeded);
+  EXPECT_FALSE(results[1].succeeded);
+  EXPECT_TRUE(results[2].succeeded);
+  EXPECT_FALSE(results[3].succeeded);
+  EXPECT_EQ(controller->getPaths(), std::vector<std::string>{"C"});
+
+  controller->setTarget("C");
+  EXPECT_NEAR(controller->getError(), 1, 1e-6);
+}
+
+class AsyncLinearMotionProfileControllerRetargetTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    output = std::make_shared<RecordingControllerOutput>();
+    controller = std::make_unique<AsyncLinearMotionProfileController>(
+      createTimeUtil(), PathfinderLimits{1.0, 2.0, 10.0}, output, 1_m, AbstractMotor::gearset::red);
+    controller->startThread();
+  }
+
+  void waitForTicks(const int iticks) {
+    auto rate = createTimeUtil().getRate();
+    while (output->getValues().size() < static_cast<std::size_t>(iticks)) {
+      rate->delayUntil(1_ms);
+    }
+  }
+
+  /**
+   * Checks that the output only stops at the end and never jumps.
+   */
+  void assertOutputIsContinuous() {
+    const auto values = output->getValues();
+    ASSERT_GT(values.size(), 2);
+    EXPECT_EQ(values.back(), 0);
+
+    // 2 m/s/s on a 1 m wheel through a 100 rpm gearset is 0.0038 per 10 ms
+    for (std::size_t i = 1; i < values.size() - 1; ++i) {
+      EXPECT_LT(std::abs(values[i] - values[i - 1]), 0.005) << "at tick " << i;
+    }
+  }
+
+  std::shared_ptr<RecordingControllerOutput> output;
+  std::unique_ptr<AsyncLinearMotionProfileController> controller;
+};
+
+TEST_F(AsyncLinearMotionProfileControllerRetargetTest, RetargetWhenIdleDoesNothing) {
+  EXPECT_FALSE(controller->retarget(1_m));
+  EXPECT_TRUE(output->getValues().empty());
+}
+
+TEST_F(AsyncLinearMotionProfileControllerRetargetTest, RetargetWithInvalidLimitsThrows) {
+  EXPECT_THROW(controller->retarget(1_m, {1.0, 0.0, 10.0}), std::invalid_argument);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerRetargetTest, RetargetFurtherWithoutStopping) {
+  controller->generatePath({0.5_m, 1.5_m}, "A");
+  controller->setTarget("A");
+  waitForTicks(40);
+
+  EXPECT_TRUE(controller->retarget(3_m));
+  waitForTicks(45);
+
+  // The target is measured like the waypoints, so there are 2.5 m to go from the start
+  EXPECT_GT(controller->getError(), 1);
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(controller->getError(), 0, 1e-6);
+  assertOutputIsContinuous();
+
+  // The profile ends at rest, and then the controller stops the output
+  const auto values = output->getValues();
+  for (std::size_t i = 0; i < values.size() - 2; ++i) {
+    EXPECT_GT(values[i], 0) << "at tick " << i;
+  }
+}
+
+TEST_F(AsyncLinearMotionProfileControllerRetargetTest, RetargetBehindComesBack) {
+  controller->setClosedFormProfile(SCurveProfile::Shape::sCurve, true);
+  controller->generatePath({0_m, 2_m}, "A");
+  controller->setTarget("A");
+  waitForTicks(100);
+
+  EXPECT_TRUE(controller->retarget(0.25_m));
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(controller->getError(), 0, 1e-6);
+  assertOutputIsContinuous();
+
+  const auto values = output->getValues();
+  EXPECT_LT(*std::min_element(values.begin(), values.end()), 0);
+}
+
+TEST_F(AsyncLinearMotionProfileControllerRetargetTest, RetargetTwice) {
+  controller->setClosedFormProfile(SCurveProfile::Shape::trapezoid, true);
+  controller->generatePath({0_m, 1_m}, "A");
+  controller->setTarget("A", true);
+  waitForTicks(20);
+
+  EXPECT_TRUE(controller->retarget(2_m));
+  waitForTicks(40);
+  EXPECT_TRUE(controller->retarget(1.5_m, {0.5, 1.0, 10.0}));
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(controller->getError(), 0, 1e-6);
+
+  // Following backwards negates the output. The profile ends at rest, and then the controller
+  // stops the output.
+  const auto values = output->getValues();
+  for (std::size_t i = 0; i < values.size() - 2; ++i) {
+    EXPECT_LT(values[i], 0) << "at tick " << i;
+  }
+}
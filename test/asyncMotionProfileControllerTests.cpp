@@ -4,7 +4,10 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "okapi/api/control/async/asyncMotionProfileController.hpp"
+#include "bakedTestPaths.hpp"
 #include "test/tests/api/implMocks.hpp"
+#include <chrono>
+#include <cstddef>
 #include <gtest/gtest.h>
 
 using namespace okapi;
@@ -13,22 +16,55 @@ class MockAsyncMotionProfileController : public AsyncMotionProfileController {
   public:
   using AsyncMotionProfileController::AsyncMotionProfileController;
   using AsyncMotionProfileController::convertLinearToRotational;
+  using AsyncMotionProfileController::getPath;
   using AsyncMotionProfileController::internalLoadPath;
+  using AsyncMotionProfileController::internalLoadPathsBinary;
   using AsyncMotionProfileController::internalStorePath;
+  using AsyncMotionProfileController::internalStorePathsBinary;
   using AsyncMotionProfileController::makeFilePath;
+  using AsyncMotionProfileController::TrajectoryFileHeader;
+  using AsyncMotionProfileController::TrajectoryFileIndexEntry;
 
   void executeSinglePath(const TrajectoryPair &path, std::unique_ptr<AbstractRate> rate) override {
     executeSinglePathCalled = true;
     AsyncMotionProfileController::executeSinglePath(path, std::move(rate));
   }
 
-  TrajectoryPair &getPathData(std::string ipathId) {
-    return paths.at(ipathId);
+  const TrajectoryPair &getPathData(std::string ipathId) {
+    return *paths.at(ipathId);
   }
 
   bool executeSinglePathCalled{false};
 };
 
+class MockHeadingOdometry : public Odometry {
+  public:
+  void setScales(const ChassisScales &) override {
+  }
+
+  void step() override {
+  }
+
+  OdomState getState(const StateMode &) const override {
+    // The first call is the start of the path, after which the robot has turned
+    return OdomState{0_m, 0_m, getStateCalls++ == 0 ? 0_rad : theta};
+  }
+
+  void setState(const OdomState &, const StateMode &) override {
+  }
+
+  std::shared_ptr<ReadOnlyChassisModel> getModel() override {
+    return nullptr;
+  }
+
+  ChassisScales getScales() override {
+    return ChassisScales({1_m, 1_m}, 360);
+  }
+
+  QAngle theta{0_rad};
+  mutable int getStateCalls{0};
+};
+
 class AsyncMotionProfileControllerTest : public ::testing::Test {
   protected:
   void SetUp() override {
@@ -151,6 +187,54 @@ TEST_F(AsyncMotionProfileControllerTest, ImpossiblePathThrowsException) {
   EXPECT_EQ(controller->getPaths().size(), 0);
 }
 
+TEST_F(AsyncMotionProfileControllerTest, ImpossiblePathIsDiagnosedBeforeGeneration) {
+  try {
+    controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg},
+                              PathfinderPoint{3_ft, 0_m, 0_deg},
+                              PathfinderPoint{3_ft, 1_ft, 0_deg}},
+                             "A");
+    FAIL() << "The path should be impossible";
+  } catch (const std::runtime_error &e) {
+    EXPECT_NE(std::string(e.what()).find("Waypoint 1: The heading"), std::string::npos)
+      << e.what();
+  }
+
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, OuterWheelStaysWithinTheGearset) {
+  // The max velocity is just under what the gearset allows, so only the outer wheel in the turn
+  // would go over it
+  MockAsyncMotionProfileController limited(
+    createTimeUtil(),
+    {1.0, 2.0, 10.0},
+    std::make_shared<SkidSteerModel>(leftMotor,
+                                     rightMotor,
+                                     leftMotor->getEncoder(),
+                                     rightMotor->getEncoder(),
+                                     100,
+                                     v5MotorMaxVoltage),
+    {{4_in, 10.5_in}, quadEncoderTPR},
+    AbstractMotor::gearset::green);
+
+  limited.generatePath({PathfinderPoint{0_m, 0_m, 0_deg},
+                        PathfinderPoint{3_ft, 0_m, 0_deg},
+                        PathfinderPoint{4_ft, 1_ft, 90_deg}},
+                       "A");
+
+  const auto &path = limited.getPathData("A");
+  float peak = 0;
+  for (const auto &command : path.commands) {
+    EXPECT_LE(std::abs(command.left), 1.001);
+    EXPECT_LE(std::abs(command.right), 1.001);
+    EXPECT_FLOAT_EQ(command.dt, 0.01f);
+    peak = std::max({peak, std::abs(command.left), std::abs(command.right)});
+  }
+
+  // The outer wheel is driven as fast as it can go instead of slowing down the whole path
+  EXPECT_GT(peak, 0.99);
+}
+
 TEST_F(AsyncMotionProfileControllerTest, ZeroWaypointsDoesNothing) {
   controller->generatePath({}, "A");
   EXPECT_EQ(controller->getPaths().size(), 0);
@@ -177,9 +261,13 @@ TEST_F(AsyncMotionProfileControllerTest, RemoveRunningPath) {
 
   controller->setTarget("A");
 
-  EXPECT_FALSE(controller->removePath("A"));
+  // The running path is freed once it finishes
+  EXPECT_TRUE(controller->removePath("A"));
+  EXPECT_EQ(controller->getPaths().size(), 0);
+  EXPECT_FALSE(controller->isDisabled());
 
-  EXPECT_EQ(controller->getPaths().size(), 1);
+  controller->waitUntilSettled();
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
 }
 
 TEST_F(AsyncMotionProfileControllerTest, ReplaceRunningPath) {
@@ -191,7 +279,7 @@ TEST_F(AsyncMotionProfileControllerTest, ReplaceRunningPath) {
 
   controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 3_ft, 45_deg}},
                            "A");
-  EXPECT_EQ(controller->isDisabled(), true);
+  EXPECT_EQ(controller->isDisabled(), false);
 
   EXPECT_EQ(controller->getPaths().size(), 1);
 }
@@ -373,3 +461,737 @@ TEST_F(AsyncMotionProfileControllerTest, SaveLoadPath) {
   controller->setTarget("A");
   EXPECT_EQ(controller->getTarget(), "A");
 }
+
+TEST_F(AsyncMotionProfileControllerTest, GeneratePathAsyncSavesThePath) {
+  auto handle = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 45_deg}}, "A");
+  EXPECT_EQ(handle->getPathId(), "A");
+
+  handle->waitUntilReady(createTimeUtil());
+
+  EXPECT_EQ(handle->getStatus(), PathGenerationHandle::Status::done);
+  EXPECT_EQ(handle->getError(), "");
+  EXPECT_EQ(controller->getPaths().front(), "A");
+  EXPECT_EQ(controller->getPaths().size(), 1);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, SetTargetWaitsForPathGeneratedAsync) {
+  controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 45_deg}}, "A");
+  controller->setTarget("A");
+
+  EXPECT_EQ(controller->getPaths().size(), 1);
+
+  controller->waitUntilSettled();
+
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+  EXPECT_GT(rightMotor->maxVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, GeneratePathAsyncWhileFollowingAnotherPath) {
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+  controller->setTarget("A");
+
+  auto handle = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}}, "B");
+  controller->waitUntilSettled();
+
+  controller->setTarget("B");
+  EXPECT_EQ(handle->getStatus(), PathGenerationHandle::Status::done);
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(controller->getPaths().size(), 2);
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ImpossiblePathAsyncFailsTheHandle) {
+  auto handle = controller->generatePathAsync({PathfinderPoint{0_m, 0_m, 0_deg},
+                                               PathfinderPoint{3_ft, 0_m, 0_deg},
+                                               PathfinderPoint{3_ft, 1_ft, 0_deg},
+                                               PathfinderPoint{2_ft, 1_ft, 0_deg},
+                                               PathfinderPoint{1_ft, 1_m, 0_deg},
+                                               PathfinderPoint{1_ft, 0_m, 0_deg}},
+                                              "A");
+  handle->waitUntilReady(createTimeUtil());
+
+  EXPECT_EQ(handle->getStatus(), PathGenerationHandle::Status::failed);
+  EXPECT_NE(handle->getError(), "");
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ZeroWaypointsAsyncFailsTheHandle) {
+  auto handle = controller->generatePathAsync({}, "A");
+  EXPECT_EQ(handle->getStatus(), PathGenerationHandle::Status::failed);
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, RemovePathCancelsQueuedGeneration) {
+  auto handleA = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 45_deg}}, "A");
+  auto handleB = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}}, "B");
+  auto handleC = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 1_ft, 0_deg}}, "C");
+
+  // C is still queued behind A and B
+  EXPECT_TRUE(controller->removePath("C"));
+  EXPECT_EQ(handleC->getStatus(), PathGenerationHandle::Status::failed);
+
+  handleA->waitUntilReady(createTimeUtil());
+  handleB->waitUntilReady(createTimeUtil());
+  createTimeUtil().getRate()->delayUntil(50_ms);
+
+  EXPECT_EQ(controller->getPaths(), std::vector<std::string>({"A", "B"}));
+
+  // Following the removed path doesn't wait for it
+  controller->setTarget("C");
+  controller->waitUntilSettled();
+}
+
+TEST_F(AsyncMotionProfileControllerTest, DestroyingTheControllerFailsUnfinishedGeneration) {
+  auto handleA = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 45_deg}}, "A");
+  auto handleB = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}}, "B");
+  auto handleC = controller->generatePathAsync(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 1_ft, 0_deg}}, "C");
+
+  delete controller;
+  controller = nullptr;
+
+  // Nothing is left pending, including the path which was being generated
+  EXPECT_TRUE(handleA->isReady());
+  EXPECT_TRUE(handleB->isReady());
+  EXPECT_EQ(handleC->getStatus(), PathGenerationHandle::Status::failed);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, MoveToWithoutCacheDoesNotSavePaths) {
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+
+  EXPECT_EQ(controller->getPaths().size(), 0);
+
+  auto stats = controller->getTrajectoryCacheStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.entries, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, MoveToReusesCachedTrajectory) {
+  controller->setTrajectoryCacheBudget(1024 * 1024);
+
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}},
+                     PathfinderLimits{0.5, 2.0, 10.0});
+
+  auto stats = controller->getTrajectoryCacheStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.entries, 2);
+  EXPECT_GT(stats.bytes, 0);
+  EXPECT_EQ(controller->getPaths().size(), 2);
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, TrajectoryCacheEvictsLeastRecentlyUsed) {
+  controller->setTrajectoryCacheBudget(1024 * 1024);
+
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+  const auto firstBytes = controller->getTrajectoryCacheStats().bytes;
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 1_ft, 0_deg}});
+
+  // Only leave room for the most recently used trajectory
+  controller->setTrajectoryCacheBudget(controller->getTrajectoryCacheStats().bytes - firstBytes);
+
+  auto stats = controller->getTrajectoryCacheStats();
+  EXPECT_EQ(stats.entries, 1);
+  EXPECT_EQ(controller->getPaths().size(), 1);
+
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 1_ft, 0_deg}});
+  EXPECT_EQ(controller->getTrajectoryCacheStats().hits, 1);
+
+  controller->clearTrajectoryCache();
+  stats = controller->getTrajectoryCacheStats();
+  EXPECT_EQ(stats.entries, 0);
+  EXPECT_EQ(stats.bytes, 0);
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, TrajectoryCacheRegeneratesRemovedPath) {
+  controller->setTrajectoryCacheBudget(1024 * 1024);
+
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+  controller->removePath(controller->getPaths().front());
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_ft, 0_m, 0_deg}});
+
+  auto stats = controller->getTrajectoryCacheStats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.entries, 1);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, SaveLoadPathsBinary) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "A");
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}}, "B");
+
+  const int lengthA = controller->getPathData("A").length;
+  const int lengthB = controller->getPathData("B").length;
+  auto rightB = controller->getPathData("B").right.getSegments();
+
+  FILE *pathFile = tmpfile();
+  controller->internalStorePathsBinary(pathFile, {"A", "Missing", "B"});
+
+  controller->removePath("A");
+  controller->removePath("B");
+  controller->internalLoadPathsBinary(pathFile);
+  fclose(pathFile);
+
+  EXPECT_EQ(controller->getPaths(), std::vector<std::string>({"A", "B"}));
+  EXPECT_EQ(controller->getPathData("A").length, lengthA);
+  EXPECT_EQ(controller->getPathData("B").length, lengthB);
+  for (int i = 0; i < lengthB; ++i) {
+    EXPECT_EQ(controller->getPathData("B").right.getVelocity(i), rightB[i].velocity);
+    EXPECT_EQ(controller->getPathData("B").right.getSegment(i).heading, rightB[i].heading);
+  }
+
+  controller->setTarget("B");
+  controller->waitUntilSettled();
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, CorruptBinaryPathFileLoadsNothing) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "A");
+
+  FILE *pathFile = tmpfile();
+  controller->internalStorePathsBinary(pathFile, {"A"});
+  controller->removePath("A");
+
+  // Flip a byte in the last segment
+  fseek(pathFile, -1, SEEK_END);
+  const int lastByte = fgetc(pathFile);
+  fseek(pathFile, -1, SEEK_END);
+  fputc(lastByte ^ 0xFF, pathFile);
+
+  controller->internalLoadPathsBinary(pathFile);
+  fclose(pathFile);
+
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, BinaryPathFileWithWrappingOffsetLoadsNothing) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "A");
+
+  FILE *pathFile = tmpfile();
+  controller->internalStorePathsBinary(pathFile, {"A"});
+  controller->removePath("A");
+
+  // An offset which makes offset + 2 * blockSize wrap around to a small number
+  const std::uint64_t offset = ~std::uint64_t{0} - 15;
+  fseek(pathFile,
+        sizeof(MockAsyncMotionProfileController::TrajectoryFileHeader) +
+          offsetof(MockAsyncMotionProfileController::TrajectoryFileIndexEntry, offset),
+        SEEK_SET);
+  fwrite(&offset, sizeof(offset), 1, pathFile);
+
+  controller->internalLoadPathsBinary(pathFile);
+  fclose(pathFile);
+
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, NonTrajectoryFileLoadsNothing) {
+  FILE *pathFile = tmpfile();
+  fputs("dt,x,y,position,velocity,acceleration,jerk,heading\n", pathFile);
+
+  controller->internalLoadPathsBinary(pathFile);
+  fclose(pathFile);
+
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, BinaryLoadTimeComparedToCsv) {
+  controller->generatePath({PathfinderPoint{0_in, 0_in, 0_deg},
+                            PathfinderPoint{4_ft, 2_ft, 0_deg},
+                            PathfinderPoint{8_ft, 0_ft, 0_deg}},
+                           "A");
+  const int length = controller->getPathData("A").length;
+
+  FILE *leftCsvFile = tmpfile();
+  FILE *rightCsvFile = tmpfile();
+  FILE *binaryFile = tmpfile();
+  controller->internalStorePath(leftCsvFile, rightCsvFile, "A");
+  controller->internalStorePathsBinary(binaryFile, {"A"});
+
+  constexpr int iterations = 20;
+  using clock = std::chrono::steady_clock;
+
+  const auto csvStart = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    rewind(leftCsvFile);
+    rewind(rightCsvFile);
+    controller->internalLoadPath(leftCsvFile, rightCsvFile, "A");
+  }
+  const auto csvTime = clock::now() - csvStart;
+  EXPECT_EQ(controller->getPathData("A").length, length);
+
+  const auto binaryStart = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    controller->internalLoadPathsBinary(binaryFile);
+  }
+  const auto binaryTime = clock::now() - binaryStart;
+  EXPECT_EQ(controller->getPathData("A").length, length);
+
+  using std::chrono::microseconds;
+  RecordProperty("csvLoadMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(csvTime).count() /
+                                iterations));
+  RecordProperty("binaryLoadMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(binaryTime).count() /
+                                iterations));
+
+  fclose(leftCsvFile);
+  fclose(rightCsvFile);
+  fclose(binaryFile);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, DefaultTrajectoryStorageIsLossless) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "A");
+
+  const auto &path = controller->getPathData("A");
+  EXPECT_EQ(path.left.getPrecision(), CompactTrajectory::Precision::float64);
+  EXPECT_TRUE(path.left.hasPose());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, TrajectoryStorageWithoutPoseUsesLessMemory) {
+  controller->setTrajectoryStorage(CompactTrajectory::Precision::float32);
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "A");
+
+  controller->setTrajectoryStorage(CompactTrajectory::Precision::fixed16, false);
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "B");
+
+  const auto &pathA = controller->getPathData("A");
+  const auto &pathB = controller->getPathData("B");
+  EXPECT_EQ(pathA.length, pathB.length);
+  EXPECT_TRUE(pathA.left.hasPose());
+  EXPECT_FALSE(pathB.left.hasPose());
+  EXPECT_LT(pathB.left.getMemoryUsage() * 4, pathA.left.getMemoryUsage());
+  EXPECT_LT(pathA.left.getMemoryUsage() * 3, sizeof(Segment) * pathA.length);
+
+  controller->setTarget("B");
+  controller->waitUntilSettled();
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, CompiledMotorCommandsMatchConvertedSpeeds) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 1_ft, 0_deg}}, "A");
+
+  const auto &path = controller->getPathData("A");
+  ASSERT_EQ(path.commands.size(), path.length);
+
+  const double gearset = toUnderlyingType(AbstractMotor::gearset::green);
+  for (int i = 0; i < path.length; ++i) {
+    const auto &command = path.commands.at(i);
+    EXPECT_NEAR(command.left,
+                controller->convertLinearToRotational(path.left.getVelocity(i) * mps).convert(rpm) /
+                  gearset,
+                1e-4);
+    EXPECT_NEAR(command.right,
+                controller->convertLinearToRotational(path.right.getVelocity(i) * mps)
+                    .convert(rpm) /
+                  gearset,
+                1e-4);
+    EXPECT_FLOAT_EQ(command.dt, path.left.getDt(i));
+  }
+}
+
+TEST_F(AsyncMotionProfileControllerTest, LoadedPathsHaveMotorCommands) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 0_deg}}, "A");
+  const auto commands = controller->getPathData("A").commands;
+
+  FILE *pathFile = tmpfile();
+  controller->internalStorePathsBinary(pathFile, {"A"});
+  controller->removePath("A");
+  controller->internalLoadPathsBinary(pathFile);
+  fclose(pathFile);
+
+  const auto &loaded = controller->getPathData("A").commands;
+  ASSERT_EQ(loaded.size(), commands.size());
+  for (std::size_t i = 0; i < commands.size(); ++i) {
+    EXPECT_NEAR(loaded[i].left, commands[i].left, 1e-5);
+    EXPECT_NEAR(loaded[i].right, commands[i].right, 1e-5);
+    EXPECT_FLOAT_EQ(loaded[i].dt, commands[i].dt);
+  }
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ClosedLoopFollowerCorrectsPositionError) {
+  controller->setFollowerGains({0, 0, 0, 1, 0});
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+
+  // The encoders never move, so the error is almost the whole path by the end of it
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_GT(leftMotor->lastVoltage, 0.9 * v5MotorMaxVoltage);
+  EXPECT_GT(rightMotor->lastVoltage, 0.9 * v5MotorMaxVoltage);
+  EXPECT_EQ(leftMotor->maxVelocity, 0);
+  EXPECT_EQ(rightMotor->maxVelocity, 0);
+  EXPECT_EQ(leftMotor->lastVelocity, 0);
+  EXPECT_EQ(rightMotor->lastVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ClosedLoopFollowerBackwards) {
+  controller->setFollowerGains({0, 0, 0, 1, 0});
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+
+  controller->setTarget("A", true);
+  controller->waitUntilSettled();
+
+  EXPECT_LT(leftMotor->lastVoltage, -0.9 * v5MotorMaxVoltage);
+  EXPECT_LT(rightMotor->lastVoltage, -0.9 * v5MotorMaxVoltage);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ClosedLoopFollowerCorrectsHeadingWithOdometry) {
+  auto odometry = std::make_shared<MockHeadingOdometry>();
+  odometry->theta = 0.1_rad;
+  controller->setFollowerGains({0, 0, 0, 0, 1}, odometry);
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  // The robot turned clockwise, so the right side has to speed up to turn it back
+  EXPECT_NEAR(leftMotor->lastVoltage, -0.1 * v5MotorMaxVoltage, 1);
+  EXPECT_NEAR(rightMotor->lastVoltage, 0.1 * v5MotorMaxVoltage, 1);
+  EXPECT_GT(odometry->getStateCalls, 1);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, OpenLoopFollowerAfterClosedLoopFollower) {
+  controller->setFollowerGains({0, 0, 0, 1, 0});
+  controller->setOpenLoopFollower();
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+  EXPECT_GT(rightMotor->maxVelocity, 0);
+  EXPECT_EQ(leftMotor->lastVoltage, 0);
+  EXPECT_EQ(rightMotor->lastVoltage, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, PathChainDoesNotStopAtJoints) {
+  controller->generatePathChain(
+    {{PathfinderPoint{0_ft, 0_ft, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}},
+     {PathfinderPoint{2_ft, 1_ft, 0_deg}, PathfinderPoint{4_ft, 1_ft, 0_deg}}},
+    "Chain");
+  controller->generatePath({PathfinderPoint{0_ft, 0_ft, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}},
+                           "A");
+  controller->generatePath({PathfinderPoint{2_ft, 1_ft, 0_deg}, PathfinderPoint{4_ft, 1_ft, 0_deg}},
+                           "B");
+
+  const auto &chain = controller->getPathData("Chain");
+  EXPECT_LT(chain.length,
+            controller->getPathData("A").length + controller->getPathData("B").length);
+
+  // Only the ends of the chain are slow
+  for (int i = chain.length / 4; i < chain.length * 3 / 4; ++i) {
+    EXPECT_GT(chain.left.getVelocity(i) + chain.right.getVelocity(i), 0.5);
+  }
+
+  controller->setTarget("Chain");
+  controller->waitUntilSettled();
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, PathChainMatchesPathThroughTheSameWaypoints) {
+  controller->generatePathChain(
+    {{PathfinderPoint{0_ft, 0_ft, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}},
+     {PathfinderPoint{2_ft, 1_ft, 0_deg}, PathfinderPoint{4_ft, 1_ft, 0_deg}}},
+    "Chain");
+  controller->generatePath({PathfinderPoint{0_ft, 0_ft, 0_deg},
+                            PathfinderPoint{2_ft, 1_ft, 0_deg},
+                            PathfinderPoint{4_ft, 1_ft, 0_deg}},
+                           "A");
+
+  EXPECT_EQ(controller->getPathData("Chain").length, controller->getPathData("A").length);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, PathChainWithDisconnectedLegsThrowsException) {
+  EXPECT_THROW(controller->generatePathChain(
+                 {{PathfinderPoint{0_ft, 0_ft, 0_deg}, PathfinderPoint{2_ft, 0_ft, 0_deg}},
+                  {PathfinderPoint{2_ft, 1_ft, 0_deg}, PathfinderPoint{4_ft, 1_ft, 0_deg}}},
+                 "Chain"),
+               std::invalid_argument);
+
+  EXPECT_TRUE(controller->getPaths().empty());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, PathChainAcceptsJointHeadingsWhichDifferByAFullTurn) {
+  EXPECT_NO_THROW(controller->generatePathChain(
+    {{PathfinderPoint{0_ft, 0_ft, 0_deg}, PathfinderPoint{3_ft, 0_ft, 0_deg}},
+     {PathfinderPoint{3_ft, 0_ft, 360_deg}, PathfinderPoint{6_ft, 0_ft, 360_deg}}},
+    "Chain"));
+
+  EXPECT_EQ(controller->getPaths(), std::vector<std::string>{"Chain"});
+}
+
+TEST_F(AsyncMotionProfileControllerTest, PathChainWithNoWaypointsDoesNothing) {
+  controller->generatePathChain({{}, {}}, "Chain");
+  EXPECT_TRUE(controller->getPaths().empty());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, PathSnapshotOutlivesRemovedPath) {
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+
+  const auto snapshot = controller->getPath("A");
+  ASSERT_NE(snapshot, nullptr);
+  const int length = snapshot->length;
+
+  controller->removePath("A");
+  EXPECT_EQ(controller->getPath("A"), nullptr);
+
+  // The snapshot is only freed once it is no longer used
+  EXPECT_EQ(snapshot->length, length);
+  EXPECT_EQ(snapshot->commands.size(), length);
+  EXPECT_EQ(snapshot.use_count(), 1);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ReplacedPathFinishesRunningSafely) {
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "A");
+  controller->setTarget("A");
+
+  auto rate = createTimeUtil().getRate();
+  while (!controller->executeSinglePathCalled) {
+    rate->delayUntil(1_ms);
+  }
+
+  // Replace the path many times while it is being followed
+  for (int i = 0; i < 5; ++i) {
+    controller->generatePath(
+      {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}}, "A");
+    EXPECT_FALSE(controller->isDisabled());
+    controller->setTarget("A");
+  }
+
+  controller->waitUntilSettled();
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+  EXPECT_EQ(controller->getPaths(), std::vector<std::string>({"A"}));
+}
+
+TEST_F(AsyncMotionProfileControllerTest, FollowPathFromTrajectoryGenerator) {
+  controller->setTrajectoryGenerator(std::make_shared<TrajectoryGenerator>(10_ms, 1.0));
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 2_ft, 45_deg}},
+                           "A");
+
+  const auto &path = controller->getPathData("A");
+  EXPECT_EQ(path.left.getLength(), path.length);
+  EXPECT_EQ(path.commands.size(), path.length);
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+  EXPECT_GT(rightMotor->maxVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, ImpossiblePathFromTrajectoryGeneratorThrowsException) {
+  controller->setTrajectoryGenerator(std::make_shared<TrajectoryGenerator>());
+  EXPECT_THROW(controller->generatePath(
+                 {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{0_m, 0_m, 90_deg}}, "A"),
+               std::runtime_error);
+  EXPECT_EQ(controller->getPaths().size(), 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, TrajectoryGeneratorTimeComparedToPathfinder) {
+  constexpr int iterations = 20;
+  using clock = std::chrono::steady_clock;
+  using std::chrono::microseconds;
+
+  auto benchmark = [&](const std::string &iname) {
+    const auto start = clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      controller->generatePath({PathfinderPoint{0_in, 0_in, 0_deg},
+                                PathfinderPoint{4_ft, 2_ft, 0_deg},
+                                PathfinderPoint{8_ft, 0_ft, 0_deg}},
+                               "A");
+    }
+    const auto time = clock::now() - start;
+
+    const auto &path = controller->getPathData("A");
+    RecordProperty(iname + "Micros",
+                   std::to_string(std::chrono::duration_cast<microseconds>(time).count() /
+                                  iterations));
+    RecordProperty(iname + "Bytes",
+                   std::to_string(path.left.getMemoryUsage() + path.right.getMemoryUsage() +
+                                  path.commands.size() * sizeof(path.commands.front())));
+    return path.left.getPosition(path.length - 1);
+  };
+
+  const double pathfinderLength = benchmark("pathfinder");
+  controller->setTrajectoryGenerator(std::make_shared<TrajectoryGenerator>());
+  const double nativeLength = benchmark("native");
+
+  // Both generators fit a similar curve through the waypoints
+  EXPECT_NEAR(nativeLength, pathfinderLength, pathfinderLength * 0.05);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, GeneratePathsSavesEveryPath) {
+  const auto results = controller->generatePaths(
+    {{{PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}}, "A"},
+     {{PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{2_ft, 1_ft, 0_deg}}, "B"},
+     {{PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{4_ft, 0_m, 0_deg}},
+      "C",
+      PathfinderLimits{0.5, 1.0, 5.0}}},
+    2);
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].pathId, "A");
+  EXPECT_EQ(results[1].pathId, "B");
+  EXPECT_EQ(results[2].pathId, "C");
+  for (const auto &result : results) {
+    EXPECT_TRUE(result.succeeded);
+    EXPECT_EQ(result.error, "");
+  }
+
+  EXPECT_EQ(controller->getPaths(), (std::vector<std::string>{"A", "B", "C"}));
+
+  // The limits of each path are respected
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{4_ft, 0_m, 0_deg}},
+                           "D",
+                           PathfinderLimits{0.5, 1.0, 5.0});
+  EXPECT_EQ(controller->getPathData("C").length, controller->getPathData("D").length);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, GeneratePathsReportsFailuresWithoutStopping) {
+  const auto results = controller->generatePaths(
+    {{{PathfinderPoint{0_m, 0_m, 0_deg},
+       PathfinderPoint{3_ft, 0_m, 0_deg},
+       PathfinderPoint{3_ft, 1_ft, 0_deg},
+       PathfinderPoint{2_ft, 1_ft, 0_deg},
+       PathfinderPoint{1_ft, 1_m, 0_deg},
+       PathfinderPoint{1_ft, 0_m, 0_deg}},
+      "A"},
+     {{}, "B"},
+     {{PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}}, "C"},
+     {{PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{2_ft, 0_m, 0_deg}}, "C"}},
+    3);
+
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_FALSE(results[0].succeeded);
+  EXPECT_NE(results[0].error, "");
+  EXPECT_FALSE(results[1].succeeded);
+  EXPECT_NE(results[1].error, "");
+  EXPECT_TRUE(results[2].succeeded);
+  EXPECT_FALSE(results[3].succeeded);
+  EXPECT_NE(results[3].error, "");
+
+  // The first path with a repeated ID is kept
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}},
+                           "D");
+  EXPECT_EQ(controller->getPaths(), (std::vector<std::string>{"C", "D"}));
+  EXPECT_EQ(controller->getPathData("C").length, controller->getPathData("D").length);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, GeneratePathsWithNoWorkersThrowsException) {
+  EXPECT_THROW(controller->generatePaths(
+                 {{{PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{3_ft, 0_m, 0_deg}}, "A"}},
+                 0),
+               std::invalid_argument);
+  EXPECT_TRUE(controller->generatePaths({}).empty());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, GeneratePathsTimeComparedToSerial) {
+  std::vector<AsyncMotionProfileController::PathSpec> specs;
+  for (int i = 0; i < 24; ++i) {
+    specs.push_back({{PathfinderPoint{0_in, 0_in, 0_deg},
+                      PathfinderPoint{4_ft, (i % 4) * 1_ft, 0_deg},
+                      PathfinderPoint{(8 + i % 3) * 1_ft, 0_ft, 0_deg}},
+                     "P" + std::to_string(i)});
+  }
+
+  using clock = std::chrono::steady_clock;
+  using std::chrono::microseconds;
+
+  auto benchmark = [&](const std::string &iname, const std::size_t iworkers) {
+    const auto start = clock::now();
+    const auto results = controller->generatePaths(specs, iworkers);
+    const auto time = clock::now() - start;
+
+    for (const auto &result : results) {
+      EXPECT_TRUE(result.succeeded);
+      EXPECT_GE(result.duration, 0_ms);
+    }
+
+    RecordProperty(iname + "Micros",
+                   std::to_string(std::chrono::duration_cast<microseconds>(time).count()));
+  };
+
+  benchmark("serial", 1);
+  benchmark("parallel", 4);
+  EXPECT_EQ(controller->getPaths().size(), specs.size());
+}
+
+TEST_F(AsyncMotionProfileControllerTest, BakedPathMatchesGeneratedPath) {
+  controller->generatePath(
+    {PathfinderPoint{0_in, 0_in, 0_deg}, PathfinderPoint{3_ft, 0_in, 45_deg}}, "generated");
+  controller->registerBakedPath(bakedTestPaths::paths[0]);
+  EXPECT_EQ(controller->getPaths(), (std::vector<std::string>{"A", "generated"}));
+
+  const auto &baked = controller->getPathData("A");
+  const auto &generated = controller->getPathData("generated");
+
+  // The baked data is followed in place instead of being copied
+  EXPECT_EQ(baked.left.getMemoryUsage() + baked.right.getMemoryUsage(), 0);
+  EXPECT_TRUE(baked.commands.empty());
+  EXPECT_EQ(baked.bakedCommands, bakedTestPaths::paths[0].commands);
+
+  ASSERT_EQ(baked.length, generated.length);
+  for (int i = 0; i < generated.length; ++i) {
+    EXPECT_FLOAT_EQ(baked.left.getPosition(i), generated.left.getPosition(i));
+    EXPECT_FLOAT_EQ(baked.right.getVelocity(i), generated.right.getVelocity(i));
+    EXPECT_FLOAT_EQ(baked.bakedCommands[i].left, generated.commands[i].left);
+    EXPECT_FLOAT_EQ(baked.bakedCommands[i].right, generated.commands[i].right);
+  }
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+  EXPECT_GT(leftMotor->maxVelocity, 0);
+  EXPECT_GT(rightMotor->maxVelocity, 0);
+}
+
+TEST_F(AsyncMotionProfileControllerTest, BakedPathForAnotherChassisThrowsException) {
+  auto path = bakedTestPaths::paths[1];
+  path.wheelTrack *= 2;
+  EXPECT_THROW(controller->registerBakedPath(path), std::invalid_argument);
+
+  path = bakedTestPaths::paths[1];
+  path.gearsetRpm = 600;
+  EXPECT_THROW(controller->registerBakedPath(path), std::invalid_argument);
+
+  EXPECT_TRUE(controller->getPaths().empty());
+  EXPECT_NO_THROW(controller->registerBakedPath(bakedTestPaths::paths[1]));
+}
@@ -49,3 +49,26 @@ TEST_F(AsyncPosPIDControllerTest, TestSetAndGetGains) {
   controller->setGains(gains);
   EXPECT_EQ(controller->getGains(), gains);
 }
+
+TEST_F(AsyncPosPIDControllerTest, TestSetAndGetFeedforwardGains) {
+  IterativePosPIDController::Gains gains{1, 2, 3, 4, 5, 6, 7};
+  controller->setGains(gains);
+  EXPECT_EQ(controller->getGains(), gains);
+}
+
+TEST_F(AsyncPosPIDControllerTest, TargetVelocityDrivesTheFeedforward) {
+  controller->setGains({0, 0, 0, 0, 0, 0.01, 0});
+  controller->startThread();
+  auto rate = createTimeUtil().getRate();
+
+  input->reading = 0;
+  controller->setTarget(0);
+  controller->setTargetVelocity(50);
+  rate->delayUntil(100_ms);
+  EXPECT_DOUBLE_EQ(controller->getOutput(), 0.5);
+
+  // Setting a new target clears the target velocity
+  controller->setTarget(0);
+  rate->delayUntil(100_ms);
+  EXPECT_DOUBLE_EQ(controller->getOutput(), 0);
+}
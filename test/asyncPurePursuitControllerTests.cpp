@@ -0,0 +1,260 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncPurePursuitController.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+/**
+ * Odometry which simulates a skid steer chassis by integrating the velocities commanded to its
+ * motors. Each call to getState() is one step of the controller.
+ */
+class PurePursuitSimulatedOdometry : public Odometry {
+  public:
+  PurePursuitSimulatedOdometry(std::shared_ptr<MockMotor> ileftMotor,
+                               std::shared_ptr<MockMotor> irightMotor)
+    : leftMotor(std::move(ileftMotor)), rightMotor(std::move(irightMotor)) {
+  }
+
+  void setScales(const ChassisScales &) override {
+  }
+
+  void step() override {
+  }
+
+  OdomState getState(const StateMode &) const override {
+    if (blocked) {
+      return OdomState{x * meter, y * meter, theta * radian};
+    }
+
+    minLeftVelocity = std::min(minLeftVelocity, leftMotor->lastVelocity);
+    minRightVelocity = std::min(minRightVelocity, rightMotor->lastVelocity);
+
+    const double left = leftMotor->lastVelocity / 60.0 * 1_pi * wheelDiameter;
+    const double right = rightMotor->lastVelocity / 60.0 * 1_pi * wheelDiameter;
+    theta += (left - right) / wheelTrack * dt;
+    x += (left + right) / 2 * std::cos(theta) * dt;
+    y += (left + right) / 2 * std::sin(theta) * dt;
+
+    return OdomState{x * meter, y * meter, theta * radian};
+  }
+
+  void setState(const OdomState &, const StateMode &) override {
+  }
+
+  std::shared_ptr<ReadOnlyChassisModel> getModel() override {
+    return nullptr;
+  }
+
+  ChassisScales getScales() override {
+    return ChassisScales({wheelDiameter * meter, wheelTrack * meter}, 360);
+  }
+
+  static constexpr double wheelDiameter = 0.1;
+  static constexpr double wheelTrack = 0.3;
+  static constexpr double dt = 0.01;
+
+  std::shared_ptr<MockMotor> leftMotor;
+  std::shared_ptr<MockMotor> rightMotor;
+  mutable std::int16_t minLeftVelocity{0};
+  mutable std::int16_t minRightVelocity{0};
+  mutable double x{0};
+  mutable double y{0};
+  mutable double theta{0};
+  bool blocked{false}; // If set, the robot doesn't move
+};
+
+class AsyncPurePursuitControllerTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    leftMotor = std::make_shared<MockMotor>();
+    rightMotor = std::make_shared<MockMotor>();
+
+    model = std::make_shared<SkidSteerModel>(leftMotor,
+                                             rightMotor,
+                                             leftMotor->getEncoder(),
+                                             rightMotor->getEncoder(),
+                                             200,
+                                             v5MotorMaxVoltage);
+
+    odometry = std::make_shared<PurePursuitSimulatedOdometry>(leftMotor, rightMotor);
+
+    controller = new AsyncPurePursuitController(createTimeUtil(),
+                                                {1.0, 2.0, 10.0},
+                                                model,
+                                                scales,
+                                                AbstractMotor::gearset::green,
+                                                odometry);
+    controller->startThread();
+  }
+
+  void TearDown() override {
+    delete controller;
+  }
+
+  const ChassisScales scales{{PurePursuitSimulatedOdometry::wheelDiameter * meter,
+                              PurePursuitSimulatedOdometry::wheelTrack * meter},
+                             quadEncoderTPR};
+  std::shared_ptr<MockMotor> leftMotor;
+  std::shared_ptr<MockMotor> rightMotor;
+  std::shared_ptr<SkidSteerModel> model;
+  std::shared_ptr<PurePursuitSimulatedOdometry> odometry;
+  AsyncPurePursuitController *controller;
+};
+
+TEST_F(AsyncPurePursuitControllerTest, ConstructWithInvalidArguments) {
+  EXPECT_THROW(AsyncPurePursuitController(createTimeUtil(),
+                                          {1.0, 2.0, 10.0},
+                                          model,
+                                          scales,
+                                          {AbstractMotor::gearset::green, 0},
+                                          odometry),
+               std::invalid_argument);
+
+  EXPECT_THROW(AsyncPurePursuitController(createTimeUtil(),
+                                          {1.0, 2.0, 10.0},
+                                          model,
+                                          scales,
+                                          AbstractMotor::gearset::green,
+                                          nullptr),
+               std::invalid_argument);
+
+  EXPECT_THROW(AsyncPurePursuitController(createTimeUtil(),
+                                          {1.0, 2.0, 10.0},
+                                          model,
+                                          scales,
+                                          AbstractMotor::gearset::green,
+                                          odometry,
+                                          0_in),
+               std::invalid_argument);
+
+  EXPECT_THROW(AsyncPurePursuitController(createTimeUtil(),
+                                          {1.0, 2.0, 10.0},
+                                          model,
+                                          scales,
+                                          AbstractMotor::gearset::green,
+                                          odometry,
+                                          12_in,
+                                          6_in),
+               std::invalid_argument);
+}
+
+TEST_F(AsyncPurePursuitControllerTest, LookaheadGrowsWithSpeedWithinBounds) {
+  EXPECT_DOUBLE_EQ(controller->getLookahead(0), (6_in).convert(meter));
+  EXPECT_DOUBLE_EQ(controller->getLookahead(0.5), 0.2);
+  EXPECT_DOUBLE_EQ(controller->getLookahead(10), (18_in).convert(meter));
+}
+
+TEST_F(AsyncPurePursuitControllerTest, ArcCurvatureTurnsTowardsThePoint) {
+  // A point to the left of the robot is reached by turning counterclockwise
+  EXPECT_DOUBLE_EQ(AsyncPurePursuitController::arcCurvature({0, 0, 0}, 1, 1), 1);
+  EXPECT_DOUBLE_EQ(AsyncPurePursuitController::arcCurvature({0, 0, 0}, 1, -1), -1);
+  EXPECT_DOUBLE_EQ(AsyncPurePursuitController::arcCurvature({0, 0, 0}, 1, 0), 0);
+
+  // The point is straight ahead of a robot facing left
+  EXPECT_NEAR(AsyncPurePursuitController::arcCurvature({0, 0, 1_pi / 2}, 0, 1), 0, 1e-12);
+}
+
+TEST_F(AsyncPurePursuitControllerTest, PathPointsAreEvenlySpacedAndSlowDownToTheEnd) {
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0.5_m, 0_deg}}, "A");
+
+  const auto points = controller->getPathPoints("A");
+  ASSERT_GT(points.size(), 100);
+  EXPECT_DOUBLE_EQ(points.front().x, 0);
+  EXPECT_DOUBLE_EQ(points.front().y, 0);
+  EXPECT_NEAR(points.back().x, 1, 1e-3);
+  EXPECT_NEAR(points.back().y, 0.5, 1e-3);
+  EXPECT_DOUBLE_EQ(points.back().velocity, 0);
+
+  for (std::size_t i = 1; i < points.size(); ++i) {
+    EXPECT_LE(std::hypot(points[i].x - points[i - 1].x, points[i].y - points[i - 1].y), 0.0101);
+    EXPECT_LE(points[i].velocity, 1.0);
+  }
+
+  // The path turns left, then right
+  EXPECT_GT(points[points.size() / 4].curvature, 0);
+  EXPECT_LT(points[points.size() * 3 / 4].curvature, 0);
+}
+
+TEST_F(AsyncPurePursuitControllerTest, ImpossiblePathThrows) {
+  EXPECT_THROW(controller->generatePath(
+                 {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{0_m, 0_m, 0_deg}}, "A"),
+               std::runtime_error);
+  EXPECT_TRUE(controller->getPaths().empty());
+}
+
+TEST_F(AsyncPurePursuitControllerTest, FollowStraightPath) {
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1.5_m, 0_m, 0_deg}}, "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(odometry->x, 1.5, 0.05);
+  EXPECT_NEAR(odometry->y, 0, 0.01);
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+}
+
+TEST_F(AsyncPurePursuitControllerTest, FollowCurvedPathWithoutTurningInPlace) {
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0.5_m, 0_deg}}, "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  // Paths turn left for positive y, which is negative y for odometry
+  EXPECT_NEAR(odometry->x, 1, 0.05);
+  EXPECT_NEAR(odometry->y, -0.5, 0.05);
+  // Pure pursuit cuts the corner of the last turn, so it doesn't end exactly at the path's heading
+  EXPECT_NEAR(odometry->theta, 0, 0.3);
+
+  // Both sides always drive forwards
+  EXPECT_GE(odometry->minLeftVelocity, 0);
+  EXPECT_GE(odometry->minRightVelocity, 0);
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+}
+
+TEST_F(AsyncPurePursuitControllerTest, FollowPathFromAnotherPose) {
+  odometry->x = 0.5;
+  odometry->y = 0.5;
+  odometry->theta = 1_pi / 2;
+
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0_m, 0_deg}}, "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  // The robot faces to the right of the odometry frame, so it drives along positive y
+  EXPECT_NEAR(odometry->x, 0.5, 0.01);
+  EXPECT_NEAR(odometry->y, 1.5, 0.05);
+}
+
+TEST_F(AsyncPurePursuitControllerTest, MoveToRemovesThePath) {
+  controller->moveTo({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{0.5_m, 0_m, 0_deg}});
+
+  EXPECT_NEAR(odometry->x, 0.5, 0.05);
+  EXPECT_TRUE(controller->getPaths().empty());
+}
+
+TEST_F(AsyncPurePursuitControllerTest, BlockedRobotGivesUpOnThePath) {
+  EXPECT_EQ(controller->getStallTimeout(), 1_s);
+  controller->setStallTimeout(200_ms);
+  EXPECT_EQ(controller->getStallTimeout(), 200_ms);
+
+  odometry->blocked = true;
+  controller->generatePath({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0_m, 0_deg}},
+                           "A");
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(odometry->x, 0);
+  EXPECT_EQ(leftMotor->lastVelocity, 0);
+  EXPECT_EQ(rightMotor->lastVelocity, 0);
+  EXPECT_EQ(controller->getError().x, 0_m);
+}
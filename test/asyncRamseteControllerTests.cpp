@@ -0,0 +1,210 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/async/asyncRamseteController.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+/**
+ * Odometry which simulates a skid steer chassis by integrating the velocities commanded to its
+ * motors. Each call to getState() is one step of the controller.
+ */
+class SimulatedOdometry : public Odometry {
+  public:
+  SimulatedOdometry(std::shared_ptr<MockMotor> ileftMotor, std::shared_ptr<MockMotor> irightMotor)
+    : leftMotor(std::move(ileftMotor)), rightMotor(std::move(irightMotor)) {
+  }
+
+  void setScales(const ChassisScales &) override {
+  }
+
+  void step() override {
+  }
+
+  OdomState getState(const StateMode &) const override {
+    if (steps++ == 1) {
+      // Push the robot to the right once it has started the path
+      y += pushRight;
+    }
+
+    const double left = leftMotor->lastVelocity / 60.0 * 1_pi * wheelDiameter;
+    const double right = rightMotor->lastVelocity / 60.0 * 1_pi * wheelDiameter;
+    theta += (left - right) / wheelTrack * dt;
+    x += (left + right) / 2 * std::cos(theta) * dt;
+    y += (left + right) / 2 * std::sin(theta) * dt;
+
+    return OdomState{x * meter, y * meter, theta * radian};
+  }
+
+  void setState(const OdomState &, const StateMode &) override {
+  }
+
+  std::shared_ptr<ReadOnlyChassisModel> getModel() override {
+    return nullptr;
+  }
+
+  ChassisScales getScales() override {
+    return ChassisScales({wheelDiameter * meter, wheelTrack * meter}, 360);
+  }
+
+  static constexpr double wheelDiameter = 0.1;
+  static constexpr double wheelTrack = 0.3;
+  static constexpr double dt = 0.01;
+
+  std::shared_ptr<MockMotor> leftMotor;
+  std::shared_ptr<MockMotor> rightMotor;
+  double pushRight{0};
+  mutable int steps{0};
+  mutable double x{0};
+  mutable double y{0};
+  mutable double theta{0};
+};
+
+class AsyncRamseteControllerTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    leftMotor = std::make_shared<MockMotor>();
+    rightMotor = std::make_shared<MockMotor>();
+
+    model = std::make_shared<SkidSteerModel>(leftMotor,
+                                             rightMotor,
+                                             leftMotor->getEncoder(),
+                                             rightMotor->getEncoder(),
+                                             200,
+                                             v5MotorMaxVoltage);
+
+    odometry = std::make_shared<SimulatedOdometry>(leftMotor, rightMotor);
+
+    controller = new AsyncRamseteController(
+      createTimeUtil(),
+      {1.0, 2.0, 10.0},
+      model,
+      {{SimulatedOdometry::wheelDiameter * meter, SimulatedOdometry::wheelTrack * meter},
+       quadEncoderTPR},
+      AbstractMotor::gearset::green,
+      odometry);
+    controller->startThread();
+  }
+
+  void TearDown() override {
+    delete controller;
+  }
+
+  std::shared_ptr<MockMotor> leftMotor;
+  std::shared_ptr<MockMotor> rightMotor;
+  std::shared_ptr<SkidSteerModel> model;
+  std::shared_ptr<SimulatedOdometry> odometry;
+  AsyncRamseteController *controller;
+};
+
+TEST_F(AsyncRamseteControllerTest, ConstructWithInvalidGains) {
+  EXPECT_THROW(AsyncRamseteController(createTimeUtil(),
+                                      {1.0, 2.0, 10.0},
+                                      model,
+                                      {{4_in, 10.5_in}, quadEncoderTPR},
+                                      AbstractMotor::gearset::green,
+                                      odometry,
+                                      0),
+               std::invalid_argument);
+
+  EXPECT_THROW(AsyncRamseteController(createTimeUtil(),
+                                      {1.0, 2.0, 10.0},
+                                      model,
+                                      {{4_in, 10.5_in}, quadEncoderTPR},
+                                      AbstractMotor::gearset::green,
+                                      odometry,
+                                      2,
+                                      1),
+               std::invalid_argument);
+}
+
+TEST_F(AsyncRamseteControllerTest, CalculateWithNoErrorReturnsDesiredSpeeds) {
+  const auto speeds = controller->calculate({1, 2, 0.5}, {1, 2, 0.5}, {1.5, 0.3});
+  EXPECT_DOUBLE_EQ(speeds.linear, 1.5);
+  EXPECT_DOUBLE_EQ(speeds.angular, 0.3);
+}
+
+TEST_F(AsyncRamseteControllerTest, CalculateCorrectsErrorAlongThePath) {
+  const auto speeds = controller->calculate({0, 0, 0}, {0.1, 0, 0}, {1, 0});
+  EXPECT_GT(speeds.linear, 1);
+  EXPECT_DOUBLE_EQ(speeds.angular, 0);
+}
+
+TEST_F(AsyncRamseteControllerTest, CalculateTurnsTowardsThePath) {
+  // The path is to the left of the robot
+  const auto speeds = controller->calculate({0, 0, 0}, {0, 0.1, 0}, {1, 0});
+  EXPECT_DOUBLE_EQ(speeds.linear, 1);
+  EXPECT_GT(speeds.angular, 0);
+}
+
+TEST_F(AsyncRamseteControllerTest, CalculateWrapsHeadingError) {
+  const auto speeds = controller->calculate({0, 0, 2 * 1_pi - 0.1}, {0, 0, 0.1}, {1, 0});
+  EXPECT_GT(speeds.angular, 0);
+  EXPECT_LT(speeds.angular, 1);
+}
+
+TEST_F(AsyncRamseteControllerTest, FollowPathCorrectsLateralError) {
+  odometry->pushRight = 0.1;
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1.5_m, 0_m, 0_deg}}, "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(odometry->x, 1.5, 0.05);
+  EXPECT_NEAR(odometry->y, 0, 0.03);
+  assertMotorsHaveBeenStopped(leftMotor.get(), rightMotor.get());
+}
+
+TEST_F(AsyncRamseteControllerTest, FollowPathBackwardsCorrectsLateralError) {
+  odometry->pushRight = 0.1;
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1.5_m, 0_m, 0_deg}}, "A");
+
+  controller->setTarget("A", true);
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(odometry->x, -1.5, 0.05);
+  EXPECT_NEAR(odometry->y, 0, 0.03);
+}
+
+TEST_F(AsyncRamseteControllerTest, FollowCurvedPath) {
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0.5_m, 0_deg}}, "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  // Paths turn left for positive y, which is negative y for odometry
+  EXPECT_NEAR(odometry->x, 1, 0.05);
+  EXPECT_NEAR(odometry->y, -0.5, 0.05);
+  EXPECT_NEAR(odometry->theta, 0, 0.1);
+}
+
+TEST_F(AsyncRamseteControllerTest, FollowMirroredCurvedPath) {
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0.5_m, 0_deg}}, "A");
+
+  controller->setTarget("A", false, true);
+  controller->waitUntilSettled();
+
+  EXPECT_NEAR(odometry->x, 1, 0.05);
+  EXPECT_NEAR(odometry->y, 0.5, 0.05);
+  EXPECT_NEAR(odometry->theta, 0, 0.1);
+}
+
+TEST_F(AsyncRamseteControllerTest, PathWithoutPoseIsNotFollowed) {
+  controller->setTrajectoryStorage(CompactTrajectory::Precision::float32, false);
+  controller->generatePath(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1.5_m, 0_m, 0_deg}}, "A");
+
+  controller->setTarget("A");
+  controller->waitUntilSettled();
+
+  EXPECT_EQ(leftMotor->maxVelocity, 0);
+  EXPECT_EQ(rightMotor->maxVelocity, 0);
+}
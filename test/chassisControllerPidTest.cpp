@@ -6,6 +6,7 @@
 #include "okapi/api/chassis/controller/chassisControllerPid.hpp"
 #include "okapi/api/chassis/model/skidSteerModel.hpp"
 #include "test/tests/api/implMocks.hpp"
+#include <chrono>
 #include <gtest/gtest.h>
 
 using namespace okapi;
@@ -399,3 +400,56 @@ TEST_F(ChassisControllerPIDTest, isSettledInModeNone) {
   controller->mode = CCPIDUnderTest::modeType::none;
   EXPECT_TRUE(controller->isSettled());
 }
+
+TEST_F(ChassisControllerPIDTest, SetMotionProfileWithInvalidLimitsThrows) {
+  EXPECT_THROW(controller->setMotionProfile({0, 2, 10}, {90, 360, 1000}), std::invalid_argument);
+  EXPECT_THROW(controller->setMotionProfile({0.5, 2, 10}, {90, 0, 1000}), std::invalid_argument);
+}
+
+TEST_F(ChassisControllerPIDTest, ProfiledMoveIsNotSettledUntilTheProfileIsDone) {
+  // Accelerate for 0.25 s, cruise for 0.35 s, then decelerate for 0.25 s
+  controller->setMotionProfile({0.5, 2, 10}, {90, 360, 1000});
+
+  const auto start = std::chrono::steady_clock::now();
+  controller->moveDistanceAsync(0.3_m);
+  EXPECT_FALSE(controller->isSettled());
+
+  controller->waitUntilSettled();
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(850));
+
+  // The controller's target is still the end of the movement
+  EXPECT_DOUBLE_EQ(distanceController->getTarget(), 0.3 * scales->straight);
+  assertMotorsHaveBeenStopped(leftMotor, rightMotor);
+}
+
+TEST_F(ChassisControllerPIDTest, ProfiledMoveFeedsForwardTheProfileVelocity) {
+  // Without any gains, the output is only the feedforward
+  controller->setGains({0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0});
+  controller->setMotionProfile({0.5, 2, 10}, {90, 360, 1000});
+  controller->moveDistance(0.3_m);
+
+  // The profile cruises at 0.5 m/s, which is this many RPM for a 4 inch wheel
+  const double cruiseRpm = 0.5 / (wheelDiam.convert(meter) * 1_pi) * 60;
+  EXPECT_NEAR(leftMotor->maxVelocity, cruiseRpm, 1);
+  EXPECT_NEAR(rightMotor->maxVelocity, cruiseRpm, 1);
+}
+
+TEST_F(ChassisControllerPIDTest, ProfiledTurnFeedsForwardTheProfileVelocity) {
+  controller->setGains({0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0});
+  controller->setMotionProfile({0.5, 2, 10}, {90, 360, 1000});
+  controller->turnAngle(90_deg);
+
+  // Turning the robot 90 deg/s moves each wheel 90 deg/s times the track over the diameter
+  const double cruiseRpm = 90.0 / 360 * 60 * (wheelTrack / wheelDiam).convert(number);
+  EXPECT_NEAR(leftMotor->maxVelocity, cruiseRpm, 1);
+  EXPECT_LE(rightMotor->maxVelocity, 0);
+}
+
+TEST_F(ChassisControllerPIDTest, DisabledMotionProfileStepsToTheTarget) {
+  controller->setMotionProfile({0.5, 2, 10}, {90, 360, 1000});
+  controller->disableMotionProfile();
+
+  controller->moveDistanceAsync(0.3_m);
+  EXPECT_TRUE(controller->isSettled());
+  controller->waitUntilSettled();
+}
@@ -0,0 +1,106 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/compactTrajectory.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class CompactTrajectoryTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    Segment last{0.01, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 100; ++i) {
+      Segment segment{};
+      segment.dt = 0.01;
+      segment.velocity = i < 50 ? i * 0.02 : (99 - i) * 0.02;
+      segment.position = last.position + (last.velocity + segment.velocity) / 2.0 * segment.dt;
+      segment.acceleration = (segment.velocity - last.velocity) / segment.dt;
+      segment.jerk = (segment.acceleration - last.acceleration) / segment.dt;
+      segment.x = segment.position;
+      segment.y = segment.position / 2;
+      segment.heading = 0.1 * i;
+      segments.push_back(segment);
+      last = segment;
+    }
+  }
+
+  std::vector<Segment> segments;
+};
+
+TEST_F(CompactTrajectoryTest, Float64IsLossless) {
+  CompactTrajectory trajectory(segments.data(), 100, CompactTrajectory::Precision::float64, true);
+
+  EXPECT_EQ(trajectory.getLength(), 100);
+  EXPECT_TRUE(trajectory.hasConstantDt());
+  for (int i = 0; i < 100; ++i) {
+    const auto segment = trajectory.getSegment(i);
+    EXPECT_EQ(segment.dt, segments[i].dt);
+    EXPECT_EQ(segment.velocity, segments[i].velocity);
+    EXPECT_EQ(segment.position, segments[i].position);
+    EXPECT_EQ(segment.x, segments[i].x);
+    EXPECT_EQ(segment.y, segments[i].y);
+    EXPECT_EQ(segment.heading, segments[i].heading);
+    EXPECT_EQ(segment.acceleration, segments[i].acceleration);
+    EXPECT_EQ(segment.jerk, segments[i].jerk);
+  }
+}
+
+TEST_F(CompactTrajectoryTest, Float32IsClose) {
+  CompactTrajectory trajectory(segments.data(), 100, CompactTrajectory::Precision::float32, true);
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NEAR(trajectory.getVelocity(i), segments[i].velocity, 1e-6);
+    EXPECT_NEAR(trajectory.getPosition(i), segments[i].position, 1e-6);
+    EXPECT_NEAR(trajectory.getSegment(i).heading, segments[i].heading, 1e-5);
+  }
+}
+
+TEST_F(CompactTrajectoryTest, Fixed16IsCloseToColumnResolution) {
+  CompactTrajectory trajectory(segments.data(), 100, CompactTrajectory::Precision::fixed16, false);
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NEAR(trajectory.getVelocity(i), segments[i].velocity, 1e-4);
+    EXPECT_NEAR(trajectory.getPosition(i), segments[i].position, 1e-4);
+  }
+}
+
+TEST_F(CompactTrajectoryTest, MemoryUsageShrinksWithPrecisionAndPose) {
+  CompactTrajectory full(segments.data(), 100, CompactTrajectory::Precision::float64, true);
+  CompactTrajectory floats(segments.data(), 100, CompactTrajectory::Precision::float32, false);
+  CompactTrajectory fixed(segments.data(), 100, CompactTrajectory::Precision::fixed16, false);
+
+  EXPECT_EQ(full.getMemoryUsage(), 100 * 7 * sizeof(double));
+  EXPECT_EQ(floats.getMemoryUsage(), 100 * 2 * sizeof(float));
+  EXPECT_EQ(fixed.getMemoryUsage(), 100 * 2 * sizeof(std::int16_t));
+  EXPECT_LT(fixed.getMemoryUsage() * 8, sizeof(Segment) * segments.size());
+}
+
+TEST_F(CompactTrajectoryTest, DroppedPoseIsRecoveredAsZero) {
+  CompactTrajectory trajectory(segments.data(), 100, CompactTrajectory::Precision::float64, false);
+
+  EXPECT_FALSE(trajectory.hasPose());
+  EXPECT_EQ(trajectory.getSegment(10).x, 0);
+  EXPECT_EQ(trajectory.getSegment(10).y, 0);
+  EXPECT_EQ(trajectory.getSegment(10).heading, 0);
+}
+
+TEST_F(CompactTrajectoryTest, NonConstantDtIsStoredPerSegment) {
+  segments[42].dt = 0.02;
+  CompactTrajectory trajectory(segments.data(), 100, CompactTrajectory::Precision::float32, false);
+
+  EXPECT_FALSE(trajectory.hasConstantDt());
+  EXPECT_NEAR(trajectory.getDt(41), 0.01, 1e-9);
+  EXPECT_NEAR(trajectory.getDt(42), 0.02, 1e-9);
+  EXPECT_EQ(trajectory.getMemoryUsage(), 100 * 3 * sizeof(float));
+}
+
+TEST_F(CompactTrajectoryTest, EmptyTrajectory) {
+  CompactTrajectory trajectory(segments.data(), 0);
+
+  EXPECT_EQ(trajectory.getLength(), 0);
+  EXPECT_EQ(trajectory.getMemoryUsage(), 0);
+  EXPECT_TRUE(trajectory.getSegments().empty());
+}
@@ -7,6 +7,7 @@
 #include "okapi/api/odometry/odomMath.hpp"
 #include "okapi/api/odometry/twoEncoderOdometry.hpp"
 #include "test/tests/api/implMocks.hpp"
+#include <algorithm>
 #include <gtest/gtest.h>
 
 using namespace okapi;
@@ -180,3 +181,187 @@ TEST_F(DefaultOdomChassisControllerTest, SetStateInCartesianTest) {
   auto stateAfter = drive->getState();
   EXPECT_EQ(stateAfter, newState);
 }
+
+/**
+ * Odometry which simulates a skid steer chassis by integrating the last vector given to a
+ * MockChassisModel. Each call to getState() is one tick of the controller.
+ */
+class DriveVectorSimulatedOdometry : public Odometry {
+  public:
+  explicit DriveVectorSimulatedOdometry(std::shared_ptr<MockChassisModel> imodel)
+    : model(std::move(imodel)) {
+  }
+
+  void setScales(const ChassisScales &) override {
+  }
+
+  void step() override {
+  }
+
+  OdomState getState(const StateMode &imode) const override {
+    ticks++;
+
+    // Mix and normalize the sides the same way SkidSteerModel::driveVector() does
+    const double forward = std::clamp(model->lastVectorY, -1.0, 1.0);
+    const double yaw = std::clamp(model->lastVectorZ, -1.0, 1.0);
+    double left = forward + yaw;
+    double right = forward - yaw;
+    const double maxInput = std::max(std::abs(left), std::abs(right));
+    if (maxInput > 1) {
+      left /= maxInput;
+      right /= maxInput;
+    }
+
+    // Frame transformation: +x is forward, +y is right, and theta is clockwise
+    theta += (left - right) * maxSpeed / wheelTrack * dt;
+    x += (left + right) / 2 * maxSpeed * std::cos(theta) * dt;
+    y += (left + right) / 2 * maxSpeed * std::sin(theta) * dt;
+
+    if (imode == StateMode::FRAME_TRANSFORMATION) {
+      return OdomState{x * meter, y * meter, theta * radian};
+    } else {
+      return OdomState{y * meter, x * meter, theta * radian};
+    }
+  }
+
+  void setState(const OdomState &, const StateMode &) override {
+  }
+
+  std::shared_ptr<ReadOnlyChassisModel> getModel() override {
+    return nullptr;
+  }
+
+  ChassisScales getScales() override {
+    return ChassisScales({4_in, wheelTrack * meter}, imev5GreenTPR);
+  }
+
+  static constexpr double maxSpeed = 1;
+  static constexpr double wheelTrack = 0.3;
+  static constexpr double dt = 0.01;
+
+  std::shared_ptr<MockChassisModel> model;
+  mutable int ticks{0};
+  mutable double x{0};
+  mutable double y{0};
+  mutable double theta{0};
+};
+
+class DefaultOdomChassisControllerPoseTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    controller = std::make_shared<MockChassisController>();
+    odom = std::make_shared<DriveVectorSimulatedOdometry>(controller->chassisModel);
+
+    drive = new MockDefaultOdomChassisController(createTimeUtil(), odom, controller);
+    drive->odomTaskRunning = true;
+  }
+
+  void TearDown() override {
+    delete drive;
+  }
+
+  std::shared_ptr<MockChassisController> controller;
+  std::shared_ptr<DriveVectorSimulatedOdometry> odom;
+  MockDefaultOdomChassisController *drive;
+};
+
+TEST_F(DefaultOdomChassisControllerPoseTest, DriveToPoseArrivesAtThePose) {
+  drive->driveToPose({1_m, 0.5_m}, 0_deg);
+
+  EXPECT_NEAR(odom->x, 1, 0.03);
+  EXPECT_NEAR(odom->y, 0.5, 0.03);
+  EXPECT_NEAR(odom->theta, 0, (3_deg).convert(radian) + 0.01);
+
+  // The internal controller is stopped instead of being asked to turn or drive
+  EXPECT_EQ(controller->stopCalled, 1);
+  EXPECT_EQ(controller->lastTurnAngleTargetQAngle, 0_deg);
+  EXPECT_EQ(controller->lastMoveDistanceTargetQLength, 0_m);
+  EXPECT_TRUE(controller->chassisModel->stopWasCalled);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, DriveToPoseBackwards) {
+  drive->driveToPose({-1_m, -0.5_m}, 0_deg, true);
+
+  EXPECT_NEAR(odom->x, -1, 0.03);
+  EXPECT_NEAR(odom->y, -0.5, 0.03);
+  EXPECT_NEAR(odom->theta, 0, (3_deg).convert(radian) + 0.01);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, DriveToPoseInCartesianMode) {
+  drive->setDefaultStateMode(StateMode::CARTESIAN);
+  drive->driveToPose({0.5_m, 1_m}, 90_deg);
+
+  EXPECT_NEAR(odom->x, 1, 0.03);
+  EXPECT_NEAR(odom->y, 0.5, 0.03);
+  EXPECT_NEAR(odom->theta, 1_pi / 2, (3_deg).convert(radian) + 0.01);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, DriveToPoseWithInvalidLeadThrows) {
+  EXPECT_THROW(drive->driveToPose({1_m, 0_m}, 0_deg, false, 1), std::invalid_argument);
+  EXPECT_THROW(drive->driveToPose({1_m, 0_m}, 0_deg, false, -0.1), std::invalid_argument);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, CurvedDriveToPointTurnsWhileDriving) {
+  drive->setPointMotion(DefaultOdomChassisController::PointMotion::curved);
+  EXPECT_EQ(drive->getPointMotion(), DefaultOdomChassisController::PointMotion::curved);
+
+  drive->driveToPoint({1_m, 1_m});
+
+  EXPECT_NEAR(odom->x, 1, 0.03);
+  EXPECT_NEAR(odom->y, 1, 0.03);
+  EXPECT_EQ(controller->lastTurnAngleTargetQAngle, 0_deg);
+  EXPECT_EQ(controller->lastMoveDistanceTargetQLength, 0_m);
+
+  // Turning in place and then driving takes at least the time to turn 45 degrees plus the time to
+  // drive the whole distance at full speed, which driving along a curve beats even though it
+  // turns and speeds up gradually
+  const double turnThenDriveTicks = (1_pi / 4) / (2 / DriveVectorSimulatedOdometry::wheelTrack) /
+                                      DriveVectorSimulatedOdometry::dt +
+                                    std::sqrt(2) / DriveVectorSimulatedOdometry::dt;
+  EXPECT_LT(odom->ticks, turnThenDriveTicks * 1.5);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, CurvedDriveToPointStopsShortByTheOffset) {
+  drive->setPointMotion(DefaultOdomChassisController::PointMotion::curved);
+  drive->driveToPoint({1_m, 0_m}, false, 0.25_m);
+
+  EXPECT_NEAR(odom->x, 0.75, 0.03);
+  EXPECT_NEAR(odom->y, 0, 0.03);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, CurvedDriveToPointBelowThresholdDoesNotMove) {
+  drive->setPointMotion(DefaultOdomChassisController::PointMotion::curved);
+  drive->setMoveThreshold(5_m);
+  drive->driveToPoint({1_m, 0_m});
+
+  EXPECT_EQ(odom->ticks, 1);
+  EXPECT_EQ(controller->stopCalled, 0);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, ExitConditionsTimeOut) {
+  // Without any gains the robot never moves
+  drive->setPoseGains({0, 0, 0, 0}, {0, 0, 0, 0});
+  drive->setPoseExitConditions({1_in, 3_deg, 0_ms, 100_ms});
+  drive->driveToPose({1_m, 0_m}, 0_deg);
+
+  EXPECT_DOUBLE_EQ(odom->x, 0);
+  EXPECT_TRUE(controller->chassisModel->stopWasCalled);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, ExitConditionsTimeOutByDefault) {
+  EXPECT_GT(DefaultOdomChassisController::PoseExitConditions{}.timeout, 0_ms);
+}
+
+TEST_F(DefaultOdomChassisControllerPoseTest, ExitConditionsWaitToSettle) {
+  drive->setPoseExitConditions({1_in, 3_deg, 0_ms, 0_ms});
+  drive->driveToPose({0.5_m, 0_m}, 0_deg);
+  const int ticksWithoutSettling = odom->ticks;
+
+  odom->ticks = 0;
+  odom->x = 0;
+  drive->setPoseExitConditions({1_in, 3_deg, 200_ms, 0_ms});
+  drive->driveToPose({0.5_m, 0_m}, 0_deg);
+
+  EXPECT_GT(odom->ticks, ticksWithoutSettling + 10);
+  EXPECT_NEAR(odom->x, 0.5, 0.03);
+}
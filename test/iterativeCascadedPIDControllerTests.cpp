@@ -0,0 +1,145 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/iterative/iterativeCascadedPidController.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+/**
+ * A timer which reads a clock that is advanced by the test.
+ */
+class CascadeClockTimer : public AbstractTimer {
+  public:
+  explicit CascadeClockTimer(std::shared_ptr<QTime> inow)
+    : AbstractTimer(*inow), now(std::move(inow)) {
+  }
+
+  QTime millis() const override {
+    return *now;
+  }
+
+  std::shared_ptr<QTime> now;
+};
+
+class IterativeCascadedPIDControllerTest : public ::testing::Test {
+  protected:
+  void SetUp() override {
+    // The clock starts after 0 because a timer mark at 0 counts as unset
+    now = std::make_shared<QTime>(1_s);
+    controller = makeController(10_ms, 5_ms);
+    *now += 5_ms;
+  }
+
+  std::unique_ptr<IterativeCascadedPIDController> makeController(const QTime iouterSampleTime,
+                                                                 const QTime iinnerSampleTime) {
+    const auto timeUtil = createTimeUtil(Supplier<std::unique_ptr<AbstractTimer>>(
+      [now = now]() { return std::make_unique<CascadeClockTimer>(now); }));
+
+    auto outer = std::make_shared<IterativePosPIDController>(0.01, 0, 0, 0, timeUtil);
+    outer->setSampleTime(iouterSampleTime);
+
+    auto inner = std::make_shared<IterativeVelPIDController>(
+      0.001,
+      0,
+      0.001,
+      0,
+      std::make_unique<VelMath>(1800,
+                                std::make_unique<PassthroughFilter>(),
+                                1_ms,
+                                std::make_unique<CascadeClockTimer>(now)),
+      timeUtil);
+    inner->setSampleTime(iinnerSampleTime);
+
+    return std::make_unique<IterativeCascadedPIDController>(outer, inner, 100);
+  }
+
+  /**
+   * Steps the controller and then advances the clock.
+   */
+  void stepAndAdvance(const double ireading, const QTime idt) {
+    controller->step(ireading);
+    *now += idt;
+  }
+
+  std::shared_ptr<QTime> now;
+  std::unique_ptr<IterativeCascadedPIDController> controller;
+};
+
+TEST_F(IterativeCascadedPIDControllerTest, SettledWhenDisabled) {
+  assertControllerIsSettledWhenDisabled(*controller, 100.0);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, FollowsDisableLifecycle) {
+  assertIterativeControllerFollowsDisableLifecycle(*controller);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, FollowsTargetLifecycle) {
+  assertControllerFollowsTargetLifecycle(*controller);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, ScalesControllerSetTargets) {
+  assertIterativeControllerScalesControllerSetTargets(*controller);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, OuterOutputIsTheInnerVelocityTarget) {
+  controller->setTarget(50);
+
+  // The outer output of 0.5 is half of the max velocity, which the inner kF feeds forward
+  EXPECT_DOUBLE_EQ(controller->step(0), 0.001 * 50 + 0.001 * 50);
+  EXPECT_DOUBLE_EQ(controller->getOuterController()->getOutput(), 0.5);
+  EXPECT_DOUBLE_EQ(controller->getInnerController()->getTarget(), 50);
+  EXPECT_DOUBLE_EQ(controller->getError(), 50);
+  EXPECT_DOUBLE_EQ(controller->getProcessValue(), 0);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, InnerLoopIsOversampled) {
+  EXPECT_DOUBLE_EQ(controller->getOversampling(), 2);
+  EXPECT_EQ(controller->getSampleTime(), 5_ms);
+  controller->setTarget(100);
+
+  for (int i = 0; i < 20; ++i) {
+    stepAndAdvance(0, 5_ms);
+  }
+
+  EXPECT_EQ(controller->getOuterController()->getStepTimingStats().steps, 10);
+  EXPECT_EQ(controller->getInnerController()->getStepTimingStats().steps, 20);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, LoopsStayInPhaseWhenStepsAreEarly) {
+  controller->setTarget(100);
+
+  // Without the jitter tolerance, the outer loop would skip the steps which come slightly early
+  for (int i = 0; i < 20; ++i) {
+    stepAndAdvance(0, 4.6_ms);
+  }
+
+  EXPECT_EQ(controller->getOuterController()->getStepTimingStats().steps, 10);
+  EXPECT_EQ(controller->getInnerController()->getStepTimingStats().steps, 20);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, SetSampleTimeKeepsTheOversampling) {
+  controller->setSampleTime(2_ms);
+  EXPECT_EQ(controller->getSampleTime(), 2_ms);
+  EXPECT_EQ(controller->getOuterController()->getSampleTime(), 4_ms);
+  EXPECT_EQ(controller->getOuterController()->getJitterTolerance(), 1_ms);
+  EXPECT_EQ(controller->getInnerController()->getJitterTolerance(), 1_ms);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, OutputLimitsApplyToTheInnerLoop) {
+  controller->setOutputLimits(0.5, -0.25);
+  EXPECT_DOUBLE_EQ(controller->getMaxOutput(), 0.5);
+  EXPECT_DOUBLE_EQ(controller->getMinOutput(), -0.25);
+  EXPECT_DOUBLE_EQ(controller->getInnerController()->getMaxOutput(), 0.5);
+}
+
+TEST_F(IterativeCascadedPIDControllerTest, InvalidConfigurationsThrow) {
+  EXPECT_THROW(makeController(5_ms, 10_ms), std::invalid_argument);
+  EXPECT_THROW(controller->setMaxVelocity(0), std::invalid_argument);
+
+  controller->setMaxVelocity(200);
+  EXPECT_DOUBLE_EQ(controller->getMaxVelocity(), 200);
+}
@@ -4,6 +4,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "okapi/api/control/iterative/iterativePosPidController.hpp"
+#include "okapi/api/control/util/pidGainSchedule.hpp"
 #include "test/tests/api/implMocks.hpp"
 #include <gtest/gtest.h>
 
@@ -153,3 +154,111 @@ TEST_F(IterativePosPIDControllerTest, TestGetGainsReturnsTheOriginalGains) {
   EXPECT_FLOAT_EQ(gains.kD, 0.3);
   EXPECT_FLOAT_EQ(gains.kBias, 0.4);
 }
+
+TEST_F(IterativePosPIDControllerTest, StepTimingStatsCountStepsAndIntervals) {
+  controller->step(1);
+  controller->step(1);
+  controller->step(1);
+
+  auto stats = controller->getStepTimingStats();
+  EXPECT_EQ(stats.steps, 3);
+  EXPECT_EQ(stats.skipped, 0);
+  EXPECT_EQ(stats.intervals, 2);
+  EXPECT_EQ(stats.late, 0);
+  EXPECT_EQ(stats.minDt, 10_ms);
+  EXPECT_EQ(stats.maxDt, 10_ms);
+  EXPECT_EQ(stats.getMeanDt(), 10_ms);
+
+  controller->resetStepTimingStats();
+  stats = controller->getStepTimingStats();
+  EXPECT_EQ(stats.steps, 0);
+  EXPECT_EQ(stats.intervals, 0);
+  EXPECT_EQ(stats.getMeanDt(), 0_ms);
+}
+
+TEST_F(IterativePosPIDControllerTest, MeasuredDtStepsWithinJitterTolerance) {
+  IterativePosPIDController fastController({0, 1, 0, 0}, createConstantTimeUtil(9.5_ms));
+  fastController.setTarget(1);
+
+  // The loop runs faster than the sample time, so every step is skipped
+  EXPECT_EQ(fastController.step(0.5), 0);
+  EXPECT_EQ(fastController.getStepTimingStats().skipped, 1);
+
+  fastController.setUseMeasuredDt(true);
+  EXPECT_TRUE(fastController.isUsingMeasuredDt());
+
+  // The first step uses the sample time and the second uses the measured dt
+  EXPECT_DOUBLE_EQ(fastController.step(0.5), 0.01 * 0.5);
+  EXPECT_DOUBLE_EQ(fastController.step(0.5), (0.01 + 0.0095) * 0.5);
+
+  const auto stats = fastController.getStepTimingStats();
+  EXPECT_EQ(stats.steps, 2);
+  EXPECT_EQ(stats.intervals, 1);
+  EXPECT_EQ(stats.late, 0);
+  EXPECT_EQ(stats.minDt, 9.5_ms);
+}
+
+TEST_F(IterativePosPIDControllerTest, MeasuredDtScalesTheDerivative) {
+  IterativePosPIDController slowController({0, 0, 0.0001, 0}, createConstantTimeUtil(20_ms));
+  slowController.setUseMeasuredDt(true);
+
+  EXPECT_DOUBLE_EQ(slowController.step(1), -0.01);
+
+  // The reading changed by the same amount over twice the time
+  EXPECT_DOUBLE_EQ(slowController.step(2), -0.005);
+  EXPECT_EQ(slowController.getStepTimingStats().late, 1);
+}
+
+TEST_F(IterativePosPIDControllerTest, JitterToleranceMustBeLessThanTheSampleTime) {
+  EXPECT_THROW(controller->setJitterTolerance(-1_ms), std::invalid_argument);
+  EXPECT_THROW(controller->setJitterTolerance(10_ms), std::invalid_argument);
+
+  controller->setJitterTolerance(5_ms);
+  EXPECT_EQ(controller->getJitterTolerance(), 5_ms);
+}
+
+TEST_F(IterativePosPIDControllerTest, VelocityAndAccelerationFeedforward) {
+  controller->setGains({0, 0, 0, 0, 0, 0.01, 0.001});
+  controller->setTargetVelocity(20, 100);
+  EXPECT_DOUBLE_EQ(controller->step(0), 0.01 * 20 + 0.001 * 100);
+
+  // Setting a new target clears the target velocity and acceleration
+  controller->setTarget(0);
+  EXPECT_DOUBLE_EQ(controller->step(0), 0);
+}
+
+TEST_F(IterativePosPIDControllerTest, StaticFeedforwardFollowsTargetVelocity) {
+  controller->setGains({0, 0, 0, 0, 0.1, 0, 0});
+
+  // Without a target velocity, kS does nothing, so it can't chatter around the target
+  controller->setTarget(10);
+  EXPECT_DOUBLE_EQ(controller->step(0), 0);
+  EXPECT_DOUBLE_EQ(controller->step(10.01), 0);
+  EXPECT_DOUBLE_EQ(controller->step(9.99), 0);
+
+  // With a target velocity, kS pushes in the direction the target moves
+  controller->setTargetVelocity(-5);
+  EXPECT_DOUBLE_EQ(controller->step(0), -0.1);
+  controller->setTargetVelocity(5);
+  EXPECT_DOUBLE_EQ(controller->step(20), 0.1);
+}
+
+TEST_F(IterativePosPIDControllerTest, GainScheduleReplacesTheGains) {
+  controller->setGainSchedule(std::make_shared<PIDGainSchedule>(
+    PIDGainSchedule::Source::target,
+    std::vector<std::pair<double, IterativePosPIDController::Gains>>{{0, {0.1, 0, 0, 0}},
+                                                                      {10, {0.3, 0, 0, 0}}}));
+
+  controller->setTarget(5);
+  EXPECT_DOUBLE_EQ(controller->step(4), 0.2 * 1);
+  EXPECT_DOUBLE_EQ(controller->getGains().kP, 0.2);
+
+  controller->setTarget(20);
+  EXPECT_DOUBLE_EQ(controller->step(19), 0.3 * 1);
+
+  // Removing the schedule keeps the last gains
+  controller->setGainSchedule(nullptr);
+  EXPECT_EQ(controller->getGainSchedule(), nullptr);
+  controller->setTarget(0);
+  EXPECT_DOUBLE_EQ(controller->step(1), 0.3 * -1);
+}
@@ -154,3 +154,45 @@ TEST_F(IterativeVelPIDControllerTest, TestGetGainsReturnsTheOriginalGains) {
   EXPECT_FLOAT_EQ(gains.kF, 0.3);
   EXPECT_FLOAT_EQ(gains.kSF, 0.4);
 }
+
+TEST_F(IterativeVelPIDControllerTest, MeasuredDtScalesTheChangeInOutput) {
+  auto makeController = []() {
+    return std::make_unique<IterativeVelPIDController>(
+      0.0001,
+      0,
+      0,
+      0,
+      std::make_unique<VelMath>(1800,
+                                std::make_unique<PassthroughFilter>(),
+                                0_ms,
+                                std::make_unique<ConstantMockTimer>(20_ms)),
+      createTimeUtil(Supplier<std::unique_ptr<AbstractTimer>>(
+        []() { return std::make_unique<ConstantMockTimer>(20_ms); })));
+  };
+
+  auto nominal = makeController();
+  auto measured = makeController();
+  measured->setUseMeasuredDt(true);
+  nominal->setTarget(10);
+  measured->setTarget(10);
+
+  // The first step uses the sample time
+  const double nominalFirst = nominal->step(1);
+  EXPECT_DOUBLE_EQ(measured->step(1), nominalFirst);
+
+  // Twice the sample time passed, so the change is doubled
+  const double nominalChange = nominal->step(2) - nominalFirst;
+  EXPECT_NE(nominalChange, 0);
+  EXPECT_DOUBLE_EQ(measured->step(2) - nominalFirst, 2 * nominalChange);
+
+  EXPECT_EQ(measured->getStepTimingStats().steps, 2);
+  EXPECT_EQ(measured->getStepTimingStats().late, 1);
+}
+
+TEST_F(IterativeVelPIDControllerTest, JitterToleranceMustBeLessThanTheSampleTime) {
+  EXPECT_THROW(controller->setJitterTolerance(-1_ms), std::invalid_argument);
+  EXPECT_THROW(controller->setJitterTolerance(10_ms), std::invalid_argument);
+
+  controller->setJitterTolerance(5_ms);
+  EXPECT_EQ(controller->getJitterTolerance(), 5_ms);
+}
@@ -0,0 +1,149 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pathFeasibilityChecker.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "okapi/pathfinder/include/pathfinder.h"
+}
+
+using namespace okapi;
+
+class PathFeasibilityCheckerTest : public ::testing::Test {
+  protected:
+  PathFeasibilityChecker checker{10.5_in};
+  PathfinderLimits limits{1.0, 4.0, 10.0};
+};
+
+TEST_F(PathFeasibilityCheckerTest, FeasiblePathHasNoDiagnostics) {
+  const auto diagnostics = checker.check(
+    {{0_m, 0_m, 0_deg}, {3_ft, 0_m, 45_deg}, {4_ft, 3_ft, 80_deg}}, limits);
+  for (const auto &diagnostic : diagnostics) {
+    ADD_FAILURE() << PathFeasibilityChecker::describe(diagnostic);
+  }
+  EXPECT_TRUE(PathFeasibilityChecker::isFeasible(diagnostics));
+}
+
+TEST_F(PathFeasibilityCheckerTest, TooFewWaypoints) {
+  const auto diagnostics = checker.check({{0_m, 0_m, 0_deg}}, limits);
+  ASSERT_EQ(diagnostics.size(), 1);
+  EXPECT_EQ(diagnostics[0].problem, PathFeasibilityChecker::Problem::tooFewWaypoints);
+  EXPECT_EQ(diagnostics[0].value, 1);
+  EXPECT_FALSE(PathFeasibilityChecker::isFeasible(diagnostics));
+}
+
+TEST_F(PathFeasibilityCheckerTest, LimitsMustBePositive) {
+  const auto diagnostics =
+    checker.check({{0_m, 0_m, 0_deg}, {3_ft, 0_m, 0_deg}}, PathfinderLimits{1.0, 0, -1});
+  ASSERT_EQ(diagnostics.size(), 2);
+  EXPECT_EQ(diagnostics[0].problem, PathFeasibilityChecker::Problem::invalidLimits);
+  EXPECT_EQ(diagnostics[0].value, 0);
+  EXPECT_EQ(diagnostics[1].problem, PathFeasibilityChecker::Problem::invalidLimits);
+  EXPECT_EQ(diagnostics[1].value, -1);
+}
+
+TEST_F(PathFeasibilityCheckerTest, WaypointsInTheSamePlace) {
+  const auto diagnostics = checker.check(
+    {{0_m, 0_m, 0_deg}, {3_ft, 0_m, 0_deg}, {3_ft, 0_m, 0_deg}}, limits);
+  ASSERT_EQ(diagnostics.size(), 1);
+  EXPECT_EQ(diagnostics[0].problem, PathFeasibilityChecker::Problem::waypointsTooClose);
+  EXPECT_EQ(diagnostics[0].waypoint, 1);
+  EXPECT_FALSE(PathFeasibilityChecker::isFeasible(diagnostics));
+}
+
+TEST_F(PathFeasibilityCheckerTest, WaypointFacingAwayFromTheNextOne) {
+  // The second span goes straight to the left but both ends face forwards
+  const auto diagnostics = checker.check(
+    {{0_m, 0_m, 0_deg}, {3_ft, 0_m, 0_deg}, {3_ft, 1_ft, 0_deg}, {2_ft, 1_ft, 0_deg}}, limits);
+  ASSERT_GE(diagnostics.size(), 2);
+  EXPECT_EQ(diagnostics[0].problem, PathFeasibilityChecker::Problem::headingDiscontinuity);
+  EXPECT_EQ(diagnostics[0].waypoint, 1);
+  EXPECT_NEAR(diagnostics[0].value, pi / 2, 1e-9);
+  EXPECT_EQ(diagnostics[1].problem, PathFeasibilityChecker::Problem::headingDiscontinuity);
+  EXPECT_EQ(diagnostics[1].waypoint, 2);
+  EXPECT_FALSE(PathFeasibilityChecker::isFeasible(diagnostics));
+}
+
+TEST_F(PathFeasibilityCheckerTest, CurvatureTooHighForTheWheelTrack) {
+  const std::vector<PathfinderPoint> path{{0_m, 0_m, 0_deg}, {10_cm, 0_m, 60_deg}};
+
+  const auto diagnostics = checker.check(path, limits);
+  ASSERT_EQ(diagnostics.size(), 1);
+  EXPECT_EQ(diagnostics[0].problem, PathFeasibilityChecker::Problem::curvatureTooHigh);
+  EXPECT_EQ(diagnostics[0].severity, PathFeasibilityChecker::Severity::warning);
+  EXPECT_GT(diagnostics[0].value, diagnostics[0].limit);
+  EXPECT_NEAR(diagnostics[0].limit, 2 / (10.5_in).convert(meter), 1e-9);
+
+  // Without a wheel track the path is only checked against the limits
+  const auto withoutTrack = PathFeasibilityChecker().check(path, limits);
+  ASSERT_EQ(withoutTrack.size(), 1);
+  EXPECT_EQ(withoutTrack[0].problem, PathFeasibilityChecker::Problem::centripetalAccelTooHigh);
+}
+
+TEST_F(PathFeasibilityCheckerTest, CentripetalAccelIsAWarning) {
+  const auto diagnostics =
+    checker.check({{0_m, 0_m, 0_deg}, {1_m, 0_m, 45_deg}}, PathfinderLimits{3.0, 2.0, 10.0});
+  ASSERT_EQ(diagnostics.size(), 1);
+  EXPECT_EQ(diagnostics[0].problem, PathFeasibilityChecker::Problem::centripetalAccelTooHigh);
+  EXPECT_EQ(diagnostics[0].severity, PathFeasibilityChecker::Severity::warning);
+  EXPECT_DOUBLE_EQ(diagnostics[0].limit, 2.0);
+  EXPECT_TRUE(PathFeasibilityChecker::isFeasible(diagnostics));
+}
+
+TEST_F(PathFeasibilityCheckerTest, DescribeNamesTheWaypoint) {
+  const auto diagnostics =
+    checker.check({{0_m, 0_m, 0_deg}, {3_ft, 0_m, 0_deg}, {3_ft, 0_m, 0_deg}}, limits);
+  ASSERT_EQ(diagnostics.size(), 1);
+  EXPECT_EQ(PathFeasibilityChecker::describe(diagnostics[0]).rfind("Waypoint 1: ", 0), 0);
+}
+
+TEST_F(PathFeasibilityCheckerTest, CurvatureMatchesPathfinder) {
+  const std::vector<PathfinderPoint> path{{0_m, 0_m, 0_deg}, {1_m, 0_m, 45_deg}};
+  const auto diagnostics = PathFeasibilityChecker().check(path, PathfinderLimits{100, 1, 1});
+  ASSERT_EQ(diagnostics.size(), 1);
+  const double curvature = diagnostics[0].value / (100 * 100);
+
+  // Sample the curvature of the spline pathfinder fits
+  Spline spline;
+  pf_fit_hermite_cubic(
+    Waypoint{0, 0, 0}, Waypoint{1, 0, 45 * degreeToRadian}, &spline);
+  double expected = 0;
+  for (int i = 0; i <= 1000; ++i) {
+    const double x = i / 1000.0;
+    const double slope = 3 * spline.c * x * x + 2 * spline.d * x + spline.e;
+    const double second = 6 * spline.c * x + 2 * spline.d;
+    expected = std::max(expected, std::abs(second) / std::pow(1 + slope * slope, 1.5));
+  }
+
+  EXPECT_NEAR(curvature, expected, expected * 0.01);
+}
+
+TEST_F(PathFeasibilityCheckerTest, CheckTime) {
+  constexpr int iterations = 1000;
+  using clock = std::chrono::steady_clock;
+  using std::chrono::microseconds;
+
+  const std::vector<PathfinderPoint> path{{0_m, 0_m, 0_deg},
+                                          {3_ft, 0_m, 45_deg},
+                                          {4_ft, 3_ft, 80_deg},
+                                          {3_ft, 6_ft, 120_deg},
+                                          {0_ft, 7_ft, 180_deg}};
+
+  std::size_t diagnostics = 0;
+  const auto start = clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    diagnostics += checker.check(path, limits).size();
+  }
+  const auto time = clock::now() - start;
+
+  RecordProperty(
+    "checkMicros",
+    std::to_string(std::chrono::duration_cast<microseconds>(time).count() / iterations));
+
+  EXPECT_EQ(diagnostics, 0);
+}
@@ -0,0 +1,156 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pathSpatialIndex.hpp"
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace okapi;
+
+class PathSpatialIndexTest : public ::testing::Test {
+  protected:
+  /**
+   * Finds the closest point by checking every point, breaking ties by the lower index.
+   */
+  static std::size_t linearNearest(const std::vector<std::pair<double, double>> &ipoints,
+                                   const double ix,
+                                   const double iy,
+                                   const std::size_t ifirst,
+                                   const std::size_t ilast) {
+    std::size_t best = ipoints.size();
+    double bestDistance = 0;
+    for (std::size_t i = ifirst; i < ipoints.size() && i <= ilast; ++i) {
+      const double dx = ipoints[i].first - ix;
+      const double dy = ipoints[i].second - iy;
+      const double distance = dx * dx + dy * dy;
+      if (best == ipoints.size() || distance < bestDistance) {
+        best = i;
+        bestDistance = distance;
+      }
+    }
+
+    return best;
+  }
+
+  /**
+   * A spiral, which passes near its earlier points, with a little noise.
+   */
+  static std::vector<std::pair<double, double>> makeSpiral(const std::size_t icount) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> noise(-0.001, 0.001);
+
+    std::vector<std::pair<double, double>> points;
+    for (std::size_t i = 0; i < icount; ++i) {
+      const double angle = i * 0.01;
+      const double radius = 1 + angle * 0.05;
+      points.emplace_back(radius * std::cos(angle) + noise(gen),
+                          radius * std::sin(angle) + noise(gen));
+    }
+
+    return points;
+  }
+};
+
+TEST_F(PathSpatialIndexTest, EmptyIndexFindsNothing) {
+  PathSpatialIndex index({});
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_EQ(index.nearest(0, 0), 0);
+}
+
+TEST_F(PathSpatialIndexTest, TiesGoToTheLowerIndex) {
+  PathSpatialIndex index({{1, 0}, {0, 1}, {1, 0}, {-1, 0}});
+  EXPECT_EQ(index.nearest(1, 0), 0);
+  EXPECT_EQ(index.nearest(1, 0, 1), 2);
+  EXPECT_EQ(index.nearest(0, 0), 0);
+}
+
+TEST_F(PathSpatialIndexTest, NearestMatchesLinearSearch) {
+  const auto points = makeSpiral(2000);
+  PathSpatialIndex index(points);
+  ASSERT_EQ(index.size(), points.size());
+
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> position(-3, 3);
+  std::uniform_int_distribution<std::size_t> first(0, points.size() + 1);
+  std::uniform_int_distribution<std::size_t> window(0, 300);
+  for (int i = 0; i < 1000; ++i) {
+    const double x = position(gen);
+    const double y = position(gen);
+    const std::size_t ifirst = i % 2 == 0 ? 0 : first(gen);
+    const std::size_t ilast = i % 3 == 0 ? points.size() : ifirst + window(gen);
+    EXPECT_EQ(index.nearest(x, y, ifirst, ilast), linearNearest(points, x, y, ifirst, ilast));
+  }
+}
+
+TEST_F(PathSpatialIndexTest, FirstIndexSkipsEarlierPartsOfThePath) {
+  // The path goes out and comes back along the same line
+  std::vector<std::pair<double, double>> points;
+  for (int i = 0; i <= 100; ++i) {
+    points.emplace_back(i * 0.01, 0);
+  }
+  for (int i = 100; i >= 0; --i) {
+    points.emplace_back(i * 0.01, 0.001);
+  }
+
+  PathSpatialIndex index(points);
+  EXPECT_EQ(index.nearest(0.2, 0), 20);
+  EXPECT_EQ(index.nearest(0.2, 0, 101), 181);
+}
+
+TEST_F(PathSpatialIndexTest, LastIndexSkipsLaterPartsOfThePath) {
+  // The path goes out and comes back along the same line
+  std::vector<std::pair<double, double>> points;
+  for (int i = 0; i <= 100; ++i) {
+    points.emplace_back(i * 0.01, 0.001);
+  }
+  for (int i = 100; i >= 0; --i) {
+    points.emplace_back(i * 0.01, 0);
+  }
+
+  PathSpatialIndex index(points);
+  EXPECT_EQ(index.nearest(0.2, 0), 181);
+  EXPECT_EQ(index.nearest(0.2, 0, 10, 60), 20);
+  EXPECT_EQ(index.nearest(0.2, 0, 50, 60), 50);
+  EXPECT_EQ(index.nearest(0.2, 0, 60, 50), points.size());
+}
+
+TEST_F(PathSpatialIndexTest, NearestTimeComparedToLinearSearch) {
+  const auto points = makeSpiral(20000);
+  PathSpatialIndex index(points);
+
+  constexpr int queries = 2000;
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> position(-3, 3);
+  std::vector<std::pair<double, double>> positions;
+  for (int i = 0; i < queries; ++i) {
+    positions.emplace_back(position(gen), position(gen));
+  }
+
+  using clock = std::chrono::steady_clock;
+
+  std::size_t indexSum = 0;
+  const auto indexStart = clock::now();
+  for (const auto &[x, y] : positions) {
+    indexSum += index.nearest(x, y);
+  }
+  const auto indexTime = clock::now() - indexStart;
+
+  std::size_t linearSum = 0;
+  const auto linearStart = clock::now();
+  for (const auto &[x, y] : positions) {
+    linearSum += linearNearest(points, x, y, 0, points.size());
+  }
+  const auto linearTime = clock::now() - linearStart;
+
+  EXPECT_EQ(indexSum, linearSum);
+
+  using std::chrono::microseconds;
+  RecordProperty("nearestMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(indexTime).count()));
+  RecordProperty("linearNearestMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(linearTime).count()));
+}
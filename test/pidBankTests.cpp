@@ -0,0 +1,211 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/iterative/pidBank.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace okapi;
+
+class PIDBankTest : public ::testing::Test {
+  protected:
+  /**
+   * Gains which use every term, with and without the integral.
+   */
+  static std::vector<IterativePosPIDController::Gains> makeGains(const std::size_t icount) {
+    std::vector<IterativePosPIDController::Gains> gains;
+    for (std::size_t i = 0; i < icount; ++i) {
+      gains.push_back({0.01 * (i + 1), i % 2 == 0 ? 0 : 0.002 * i, 0.0001 * i, i % 3 * 0.01});
+    }
+
+    return gains;
+  }
+
+  /**
+   * One IterativePosPIDController for each of the gains.
+   */
+  static std::vector<std::unique_ptr<IterativePosPIDController>>
+  makeControllers(const std::vector<IterativePosPIDController::Gains> &igains) {
+    std::vector<std::unique_ptr<IterativePosPIDController>> controllers;
+    for (const auto &gains : igains) {
+      controllers.push_back(
+        std::make_unique<IterativePosPIDController>(gains, createConstantTimeUtil(10_ms)));
+    }
+
+    return controllers;
+  }
+};
+
+TEST_F(PIDBankTest, StepWithWrongNumberOfReadingsThrows) {
+  PIDBank bank(makeGains(3), createConstantTimeUtil(10_ms));
+  EXPECT_EQ(bank.size(), 3);
+  EXPECT_THROW(bank.step({0, 0}), std::invalid_argument);
+}
+
+TEST_F(PIDBankTest, GainsAreScaledBySampleTime) {
+  PIDBank bank({{1, 2, 3, 4}}, createConstantTimeUtil(10_ms));
+  EXPECT_EQ(bank.getGains(0), (IterativePosPIDController::Gains{1, 2, 3, 4}));
+
+  bank.setSampleTime(20_ms);
+  EXPECT_EQ(bank.getSampleTime(), 20_ms);
+  EXPECT_NEAR(bank.getGains(0).kI, 2, 1e-12);
+  EXPECT_NEAR(bank.getGains(0).kD, 3, 1e-12);
+}
+
+TEST_F(PIDBankTest, StepIsGatedBySampleTime) {
+  PIDBank bank({{0.1, 0, 0, 0}}, createTimeUtil());
+  bank.setSampleTime(10_s);
+  bank.setTarget(0, 1);
+
+  EXPECT_DOUBLE_EQ(bank.step({0})[0], 0);
+  EXPECT_DOUBLE_EQ(bank.getProcessValue(0), 0);
+}
+
+TEST_F(PIDBankTest, DisabledControllersOutputZeroAndAreSettled) {
+  PIDBank bank({{0.1, 0, 0, 0}, {0.1, 0, 0, 0}}, createConstantTimeUtil(10_ms));
+  bank.setTarget(0, 1000);
+  bank.setTarget(1, 1000);
+  bank.flipDisable(1, true);
+
+  const auto &outputs = bank.step({0, 0});
+  EXPECT_DOUBLE_EQ(outputs[0], 1);
+  EXPECT_DOUBLE_EQ(outputs[1], 0);
+  EXPECT_DOUBLE_EQ(bank.getOutput(1), 0);
+  EXPECT_FALSE(bank.isSettled(0));
+  EXPECT_TRUE(bank.isSettled(1));
+  EXPECT_FALSE(bank.isSettled());
+
+  // The disabled controller did not read its measurement
+  EXPECT_DOUBLE_EQ(bank.getProcessValue(1), 0);
+  bank.step({0, 500});
+  EXPECT_DOUBLE_EQ(bank.getProcessValue(1), 0);
+
+  bank.flipDisable(1, false);
+  EXPECT_DOUBLE_EQ(bank.step({0, 500})[1], 1);
+}
+
+TEST_F(PIDBankTest, SettlesImmediatelyWithZeroSettleTime) {
+  PIDBank bank({{0.1, 0, 0, 0}}, createConstantTimeUtil(10_ms));
+  bank.setSettleConditions(0, 2, 5, 0_ms);
+  bank.setTarget(0, 10);
+
+  bank.step({0});
+  EXPECT_FALSE(bank.isSettled(0));
+
+  bank.step({9});
+  EXPECT_FALSE(bank.isSettled(0));
+
+  bank.step({9});
+  EXPECT_TRUE(bank.isSettled(0));
+
+  bank.reset(0);
+  EXPECT_FALSE(bank.isSettled(0));
+  EXPECT_DOUBLE_EQ(bank.getOutput(0), 0);
+}
+
+TEST_F(PIDBankTest, MatchesIterativePosPIDControllers) {
+  constexpr std::size_t count = 8;
+  const auto gains = makeGains(count);
+  auto controllers = makeControllers(gains);
+  PIDBank bank(gains, createConstantTimeUtil(10_ms));
+
+  // Exercise the limits and integrator options on some of the controllers
+  controllers[1]->setIntegratorReset(false);
+  bank.setIntegratorReset(1, false);
+  controllers[3]->setErrorSumLimits(50, 5);
+  bank.setErrorSumLimits(3, 50, 5);
+  controllers[5]->setIntegralLimits(0.2, -0.1);
+  bank.setIntegralLimits(5, 0.2, -0.1);
+  controllers[6]->setOutputLimits(0.5, -0.25);
+  bank.setOutputLimits(6, 0.5, -0.25);
+
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> readingDist(-100, 100);
+  std::vector<double> readings(count, 0);
+
+  for (int tick = 0; tick < 500; ++tick) {
+    if (tick % 100 == 0) {
+      for (std::size_t i = 0; i < count; ++i) {
+        const double target = readingDist(gen);
+        controllers[i]->setTarget(target);
+        bank.setTarget(i, target);
+      }
+    }
+
+    if (tick == 200) {
+      controllers[2]->flipDisable(true);
+      bank.flipDisable(2, true);
+    } else if (tick == 300) {
+      controllers[2]->flipDisable(false);
+      bank.flipDisable(2, false);
+      controllers[4]->reset();
+      bank.reset(4);
+    }
+
+    for (auto &reading : readings) {
+      reading = readingDist(gen);
+    }
+
+    const auto &outputs = bank.step(readings);
+    for (std::size_t i = 0; i < count; ++i) {
+      EXPECT_DOUBLE_EQ(outputs[i], controllers[i]->step(readings[i]));
+      EXPECT_DOUBLE_EQ(bank.getOutput(i), controllers[i]->getOutput());
+      EXPECT_DOUBLE_EQ(bank.getError(i), controllers[i]->getError());
+    }
+  }
+}
+
+TEST_F(PIDBankTest, StepTimeComparedToIterativePosPIDControllers) {
+  constexpr std::size_t count = 8;
+  constexpr int ticks = 20000;
+  const auto gains = makeGains(count);
+  auto controllers = makeControllers(gains);
+  PIDBank bank(gains, createConstantTimeUtil(10_ms));
+
+  for (std::size_t i = 0; i < count; ++i) {
+    controllers[i]->setTarget(10);
+    bank.setTarget(i, 10);
+  }
+
+  std::mt19937 gen(5);
+  std::uniform_real_distribution<double> readingDist(-100, 100);
+  std::vector<std::vector<double>> readings(ticks, std::vector<double>(count));
+  for (auto &tickReadings : readings) {
+    for (auto &reading : tickReadings) {
+      reading = readingDist(gen);
+    }
+  }
+
+  using clock = std::chrono::steady_clock;
+
+  double bankSum = 0;
+  const auto bankStart = clock::now();
+  for (const auto &tickReadings : readings) {
+    bankSum += bank.step(tickReadings)[count - 1];
+  }
+  const auto bankTime = clock::now() - bankStart;
+
+  double controllerSum = 0;
+  const auto controllerStart = clock::now();
+  for (const auto &tickReadings : readings) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const double output = controllers[i]->step(tickReadings[i]);
+      if (i == count - 1) {
+        controllerSum += output;
+      }
+    }
+  }
+  const auto controllerTime = clock::now() - controllerStart;
+
+  EXPECT_DOUBLE_EQ(bankSum, controllerSum);
+
+  using std::chrono::microseconds;
+  RecordProperty("pidBankStepMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(bankTime).count()));
+  RecordProperty("iterativePosPIDStepMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(controllerTime).count()));
+}
@@ -0,0 +1,236 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/iterative/pidController.hpp"
+#include "okapi/api/filter/averageFilter.hpp"
+#include "test/tests/api/implMocks.hpp"
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace okapi;
+
+/**
+ * A signed fixed-point number with 16 fractional bits.
+ */
+class Q16 {
+  public:
+  Q16() = default;
+
+  explicit Q16(const double ivalue) : raw(static_cast<std::int32_t>(std::lround(ivalue * one))) {
+  }
+
+  explicit operator double() const {
+    return static_cast<double>(raw) / one;
+  }
+
+  Q16 operator+(const Q16 &rhs) const {
+    return fromRaw(raw + rhs.raw);
+  }
+
+  Q16 operator-(const Q16 &rhs) const {
+    return fromRaw(raw - rhs.raw);
+  }
+
+  Q16 operator-() const {
+    return fromRaw(-raw);
+  }
+
+  Q16 operator*(const Q16 &rhs) const {
+    return fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(raw) * rhs.raw) >> 16));
+  }
+
+  bool operator<(const Q16 &rhs) const {
+    return raw < rhs.raw;
+  }
+
+  bool operator>(const Q16 &rhs) const {
+    return raw > rhs.raw;
+  }
+
+  protected:
+  static Q16 fromRaw(const std::int32_t iraw) {
+    Q16 out;
+    out.raw = iraw;
+    return out;
+  }
+
+  static constexpr double one = 65536;
+  std::int32_t raw{0};
+};
+
+using FullPIDController = PIDController<double,
+                                        PIDFeature::UnfilteredDerivative,
+                                        PIDFeature::ErrorSumLimits,
+                                        PIDFeature::ResetOnCross>;
+
+class PIDControllerTest : public ::testing::Test {
+  protected:
+  /**
+   * Random readings around 0.
+   */
+  static std::vector<double> makeReadings(const std::size_t icount) {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> readingDist(-100, 100);
+    std::vector<double> readings(icount);
+    for (auto &reading : readings) {
+      reading = readingDist(gen);
+    }
+
+    return readings;
+  }
+};
+
+TEST_F(PIDControllerTest, FeaturesAreChosenAtCompileTime) {
+  EXPECT_FALSE(PIDController<>::hasErrorSumLimits);
+  EXPECT_FALSE(PIDController<>::hasResetOnCross);
+  EXPECT_TRUE(FullPIDController::hasErrorSumLimits);
+  EXPECT_TRUE(FullPIDController::hasResetOnCross);
+}
+
+TEST_F(PIDControllerTest, BasicKpTest) {
+  PIDController<> controller({0.1, 0, 0, 0});
+  EXPECT_DOUBLE_EQ(controller.step(1), 0.1 * -1);
+  EXPECT_DOUBLE_EQ(controller.getError(), -1);
+}
+
+TEST_F(PIDControllerTest, GainsAreScaledBySampleTime) {
+  PIDController<> controller({1, 2, 3, 4});
+  EXPECT_EQ(controller.getGains(), (IterativePosPIDController::Gains{1, 2, 3, 4}));
+
+  controller.setSampleTime(20_ms);
+  EXPECT_EQ(controller.getSampleTime(), 20_ms);
+  EXPECT_NEAR(controller.getGains().kI, 2, 1e-12);
+  EXPECT_NEAR(controller.getGains().kD, 3, 1e-12);
+}
+
+TEST_F(PIDControllerTest, IntegralIsNotResetOnCrossWithoutTheFeature) {
+  PIDController<> controller({0, 10, 0, 0});
+  controller.setTarget(1);
+
+  controller.step(0);
+  EXPECT_DOUBLE_EQ(controller.getOutput(), 0.1);
+
+  // The error changes sign, so the integral only shrinks
+  controller.step(1.5);
+  EXPECT_DOUBLE_EQ(controller.getOutput(), 0.1 - 0.05);
+
+  PIDController<double, PIDFeature::UnfilteredDerivative, PIDFeature::ResetOnCross> resetting(
+    {0, 10, 0, 0});
+  resetting.setTarget(1);
+  resetting.step(0);
+  EXPECT_DOUBLE_EQ(resetting.step(1.5), 0);
+}
+
+TEST_F(PIDControllerTest, MatchesIterativePosPIDController) {
+  PIDController<double, AverageFilter<3>, PIDFeature::ErrorSumLimits, PIDFeature::ResetOnCross>
+    controller({0.01, 0.05, 0.001, 0.02});
+  IterativePosPIDController reference({0.01, 0.05, 0.001, 0.02},
+                                      createConstantTimeUtil(10_ms),
+                                      std::make_unique<AverageFilter<3>>());
+
+  controller.setErrorSumLimits(80, 5);
+  reference.setErrorSumLimits(80, 5);
+  controller.setIntegralLimits(0.5, -0.25);
+  reference.setIntegralLimits(0.5, -0.25);
+
+  const auto readings = makeReadings(1000);
+  for (std::size_t i = 0; i < readings.size(); ++i) {
+    if (i % 100 == 0) {
+      controller.setTarget(readings[i] / 2);
+      reference.setTarget(readings[i] / 2);
+    }
+
+    EXPECT_DOUBLE_EQ(controller.step(readings[i]), reference.step(readings[i]));
+    EXPECT_DOUBLE_EQ(controller.getError(), reference.getError());
+  }
+}
+
+TEST_F(PIDControllerTest, FloatAndFixedPointFollowDouble) {
+  const IterativePosPIDController::Gains gains{0.01, 0.5, 0.001, 0};
+  PIDController<> doubleController(gains);
+  PIDController<float> floatController(gains);
+  PIDController<Q16> fixedController(gains);
+
+  doubleController.setTarget(20);
+  floatController.setTarget(20);
+  fixedController.setTarget(Q16(20));
+
+  for (const double reading : makeReadings(500)) {
+    const double expected = doubleController.step(reading);
+    EXPECT_NEAR(floatController.step(static_cast<float>(reading)), expected, 1e-4);
+    // The gains and products are rounded to 16 fractional bits, so the integral drifts slightly
+    EXPECT_NEAR(static_cast<double>(fixedController.step(Q16(reading))), expected, 1e-2);
+  }
+}
+
+TEST_F(PIDControllerTest, WrapperMatchesIterativePosPIDController) {
+  IterativePIDWrapper<FullPIDController> wrapper(FullPIDController({0.01, 0.05, 0.001, 0}),
+                                                 createConstantTimeUtil(10_ms));
+  IterativePosPIDController reference({0.01, 0.05, 0.001, 0}, createConstantTimeUtil(10_ms));
+
+  wrapper.getController().setErrorSumLimits(80, 5);
+  reference.setErrorSumLimits(80, 5);
+
+  IterativePositionController<double, double> &controller = wrapper;
+  controller.setControllerSetTargetLimits(50, -50);
+  reference.setControllerSetTargetLimits(50, -50);
+  controller.controllerSet(0.5);
+  reference.controllerSet(0.5);
+  EXPECT_DOUBLE_EQ(controller.getTarget(), reference.getTarget());
+
+  for (const double reading : makeReadings(200)) {
+    EXPECT_DOUBLE_EQ(controller.step(reading), reference.step(reading));
+    EXPECT_DOUBLE_EQ(controller.getOutput(), reference.getOutput());
+  }
+}
+
+TEST_F(PIDControllerTest, WrapperSettledWhenDisabled) {
+  IterativePIDWrapper<PIDController<>> wrapper(PIDController<>({0.1, 0, 0, 0}),
+                                               createConstantTimeUtil(10_ms));
+  assertControllerIsSettledWhenDisabled(wrapper, 100.0);
+}
+
+TEST_F(PIDControllerTest, WrapperDisabledLifecycle) {
+  IterativePIDWrapper<PIDController<>> wrapper(PIDController<>({0.1, 0, 0, 0}),
+                                               createConstantTimeUtil(10_ms));
+  assertIterativeControllerFollowsDisableLifecycle(wrapper);
+}
+
+TEST_F(PIDControllerTest, StepTimeComparedToIterativePosPIDController) {
+  constexpr std::size_t count = 200000;
+  PIDController<> controller({0.01, 0.05, 0.001, 0});
+  IterativePosPIDController reference({0.01, 0.05, 0.001, 0}, createConstantTimeUtil(10_ms));
+  controller.setTarget(10);
+  reference.setTarget(10);
+
+  const auto readings = makeReadings(count);
+
+  using clock = std::chrono::steady_clock;
+
+  double controllerSum = 0;
+  const auto controllerStart = clock::now();
+  for (const double reading : readings) {
+    controllerSum += controller.step(reading);
+  }
+  const auto controllerTime = clock::now() - controllerStart;
+
+  double referenceSum = 0;
+  const auto referenceStart = clock::now();
+  for (const double reading : readings) {
+    referenceSum += reference.step(reading);
+  }
+  const auto referenceTime = clock::now() - referenceStart;
+
+  EXPECT_NE(controllerSum, 0);
+  EXPECT_NE(referenceSum, 0);
+
+  using std::chrono::microseconds;
+  RecordProperty("pidControllerStepMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(controllerTime).count()));
+  RecordProperty("iterativePosPIDStepMicros",
+                 std::to_string(std::chrono::duration_cast<microseconds>(referenceTime).count()));
+}
@@ -0,0 +1,76 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/pidGainSchedule.hpp"
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class PIDGainScheduleTest : public ::testing::Test {
+  protected:
+  using Points = std::vector<std::pair<double, IterativePosPIDController::Gains>>;
+};
+
+TEST_F(PIDGainScheduleTest, InterpolatesBetweenPoints) {
+  PIDGainSchedule schedule(PIDGainSchedule::Source::target,
+                           {{0, {0, 0, 0, 0, 0, 0, 0}}, {10, {1, 2, 3, 4, 5, 6, 7}}});
+  EXPECT_EQ(schedule.interpolate(5),
+            (IterativePosPIDController::Gains{0.5, 1, 1.5, 2, 2.5, 3, 3.5}));
+}
+
+TEST_F(PIDGainScheduleTest, ClampsToTheEndPoints) {
+  PIDGainSchedule schedule(PIDGainSchedule::Source::target,
+                           {{0, {1, 0, 0, 0}}, {10, {2, 0, 0, 0}}});
+  EXPECT_DOUBLE_EQ(schedule.interpolate(-5).kP, 1);
+  EXPECT_DOUBLE_EQ(schedule.interpolate(15).kP, 2);
+}
+
+TEST_F(PIDGainScheduleTest, SinglePointIsConstant) {
+  PIDGainSchedule schedule(PIDGainSchedule::Source::target, {{3, {1, 2, 3, 4}}});
+  EXPECT_EQ(schedule.interpolate(-100), (IterativePosPIDController::Gains{1, 2, 3, 4}));
+  EXPECT_EQ(schedule.interpolate(100), (IterativePosPIDController::Gains{1, 2, 3, 4}));
+}
+
+TEST_F(PIDGainScheduleTest, PointsAreSorted) {
+  PIDGainSchedule schedule(PIDGainSchedule::Source::target,
+                           {{10, {2, 0, 0, 0}}, {0, {1, 0, 0, 0}}, {5, {4, 0, 0, 0}}});
+  ASSERT_EQ(schedule.getPoints().size(), 3);
+  EXPECT_DOUBLE_EQ(schedule.getPoints()[0].first, 0);
+  EXPECT_DOUBLE_EQ(schedule.getPoints()[1].first, 5);
+  EXPECT_DOUBLE_EQ(schedule.getPoints()[2].first, 10);
+  EXPECT_DOUBLE_EQ(schedule.interpolate(7.5).kP, 3);
+}
+
+TEST_F(PIDGainScheduleTest, InvalidPointsThrow) {
+  EXPECT_THROW(PIDGainSchedule(PIDGainSchedule::Source::error, Points{}), std::invalid_argument);
+  EXPECT_THROW(PIDGainSchedule(PIDGainSchedule::Source::error,
+                               Points{{1, {1, 0, 0, 0}}, {1, {2, 0, 0, 0}}}),
+               std::invalid_argument);
+}
+
+TEST_F(PIDGainScheduleTest, ExternalSourceNeedsAFunction) {
+  EXPECT_THROW(PIDGainSchedule(PIDGainSchedule::Source::external, Points{{0, {1, 0, 0, 0}}}),
+               std::invalid_argument);
+  EXPECT_THROW(PIDGainSchedule(std::function<double()>(), Points{{0, {1, 0, 0, 0}}}),
+               std::invalid_argument);
+}
+
+TEST_F(PIDGainScheduleTest, ErrorSourceUsesTheMagnitudeOfTheError) {
+  PIDGainSchedule schedule(PIDGainSchedule::Source::error,
+                           {{0, {1, 0, 0, 0}}, {10, {2, 0, 0, 0}}});
+  EXPECT_EQ(schedule.getSource(), PIDGainSchedule::Source::error);
+  EXPECT_DOUBLE_EQ(schedule.getGains(-5, 100).kP, 1.5);
+  EXPECT_DOUBLE_EQ(schedule.getGains(5, 100).kP, 1.5);
+}
+
+TEST_F(PIDGainScheduleTest, ExternalSourceCallsTheFunction) {
+  double height = 0;
+  PIDGainSchedule schedule([&height] { return height; }, {{0, {1, 0, 0, 0}}, {10, {2, 0, 0, 0}}});
+  EXPECT_EQ(schedule.getSource(), PIDGainSchedule::Source::external);
+  EXPECT_DOUBLE_EQ(schedule.getGains(5, 5).kP, 1);
+
+  height = 10;
+  EXPECT_DOUBLE_EQ(schedule.getGains(5, 5).kP, 2);
+}
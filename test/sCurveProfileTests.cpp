@@ -0,0 +1,191 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/sCurveProfile.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class SCurveProfileTest : public ::testing::Test {
+  protected:
+  void assertFollowsLimits(const SCurveProfile &iprofile) const {
+    double lastPosition = iprofile.getState(0).position;
+    for (double time = 0; time <= iprofile.getDuration(); time += 0.001) {
+      const auto state = iprofile.getState(time);
+      EXPECT_LE(std::abs(state.velocity), limits.maxVel * (1 + 1e-9));
+      EXPECT_LE(std::abs(state.acceleration), limits.maxAccel * (1 + 1e-9));
+      if (iprofile.getShape() == SCurveProfile::Shape::sCurve) {
+        EXPECT_LE(std::abs(state.jerk), limits.maxJerk * (1 + 1e-9));
+      }
+
+      // The profile never moves away from where it is going
+      EXPECT_GE((state.position - lastPosition) * iprofile.getDistance(), -1e-12);
+      lastPosition = state.position;
+    }
+
+    const auto end = iprofile.getState(iprofile.getDuration());
+    EXPECT_NEAR(end.velocity, 0, 1e-9);
+    EXPECT_NEAR(end.acceleration, 0, 1e-9);
+  }
+
+  PathfinderLimits limits{1.0, 2.0, 10.0};
+};
+
+TEST_F(SCurveProfileTest, LongMoveCruisesAtMaxVelocity) {
+  SCurveProfile profile(2, limits);
+  assertFollowsLimits(profile);
+
+  // 0.7 s to speed up, 1.3 s to cruise, and 0.7 s to slow down
+  EXPECT_NEAR(profile.getDuration(), 2.7, 1e-9);
+  EXPECT_NEAR(profile.getDistance(), 2, 1e-9);
+  EXPECT_NEAR(profile.getState(1.35).velocity, 1, 1e-9);
+  EXPECT_NEAR(profile.getState(1.35).position, 1, 1e-9);
+  EXPECT_NEAR(profile.getState(100).position, 2, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, ShortMoveDoesNotReachMaxVelocity) {
+  SCurveProfile profile(0.4, limits);
+  assertFollowsLimits(profile);
+
+  const auto middle = profile.getState(profile.getDuration() / 2);
+  EXPECT_LT(middle.velocity, 1);
+  EXPECT_NEAR(middle.position, 0.2, 1e-9);
+  EXPECT_NEAR(profile.getState(profile.getDuration()).position, 0.4, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, VeryShortMoveDoesNotReachMaxAcceleration) {
+  SCurveProfile profile(0.01, limits);
+  assertFollowsLimits(profile);
+
+  double maxAcceleration = 0;
+  for (double time = 0; time <= profile.getDuration(); time += 0.001) {
+    maxAcceleration = std::max(maxAcceleration, profile.getState(time).acceleration);
+  }
+  EXPECT_LT(maxAcceleration, limits.maxAccel);
+  EXPECT_NEAR(profile.getState(profile.getDuration()).position, 0.01, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, NegativeDistanceMovesBackwards) {
+  SCurveProfile forwards(1.5, limits);
+  SCurveProfile backwards(-1.5, limits);
+  assertFollowsLimits(backwards);
+
+  EXPECT_DOUBLE_EQ(backwards.getDuration(), forwards.getDuration());
+  for (double time = 0; time <= forwards.getDuration(); time += 0.05) {
+    EXPECT_NEAR(backwards.getState(time).position, -forwards.getState(time).position, 1e-9);
+    EXPECT_NEAR(backwards.getState(time).velocity, -forwards.getState(time).velocity, 1e-9);
+  }
+}
+
+TEST_F(SCurveProfileTest, TrapezoidIsFasterAndIgnoresJerk) {
+  SCurveProfile sCurve(2, limits);
+  SCurveProfile trapezoid(2, limits, SCurveProfile::Shape::trapezoid);
+  assertFollowsLimits(trapezoid);
+
+  // 0.5 s to speed up, 1.5 s to cruise, and 0.5 s to slow down
+  EXPECT_NEAR(trapezoid.getDuration(), 2.5, 1e-9);
+  EXPECT_LT(trapezoid.getDuration(), sCurve.getDuration());
+  EXPECT_NEAR(trapezoid.getState(0.25).acceleration, 2, 1e-9);
+
+  EXPECT_NO_THROW(SCurveProfile(1, {1.0, 2.0, 0.0}, SCurveProfile::Shape::trapezoid));
+}
+
+TEST_F(SCurveProfileTest, ZeroDistanceHasNoDuration) {
+  SCurveProfile profile(0, limits);
+  EXPECT_EQ(profile.getDuration(), 0);
+  EXPECT_EQ(profile.getState(1).position, 0);
+  EXPECT_TRUE(profile.getSegments().empty());
+}
+
+TEST_F(SCurveProfileTest, SegmentsSampleTheProfile) {
+  SCurveProfile profile(2, limits);
+  const auto segments = profile.getSegments(10_ms);
+
+  ASSERT_EQ(segments.size(), 270);
+  for (std::size_t i = 0; i < segments.size(); ++i) {
+    const auto state = profile.getState((i + 1) * 0.01);
+    EXPECT_DOUBLE_EQ(segments[i].dt, 0.01);
+    EXPECT_NEAR(segments[i].position, state.position, 1e-9);
+    EXPECT_NEAR(segments[i].velocity, state.velocity, 1e-9);
+  }
+
+  EXPECT_NEAR(segments.back().position, 2, 1e-9);
+  EXPECT_NEAR(segments.back().velocity, 0, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, InvalidInputsThrow) {
+  EXPECT_THROW(SCurveProfile(1, {0.0, 2.0, 10.0}), std::invalid_argument);
+  EXPECT_THROW(SCurveProfile(1, {1.0, -2.0, 10.0}), std::invalid_argument);
+  EXPECT_THROW(SCurveProfile(1, {1.0, 2.0, 0.0}), std::invalid_argument);
+  EXPECT_THROW(SCurveProfile(NAN, limits), std::invalid_argument);
+}
+
+TEST_F(SCurveProfileTest, ReplanFromRestMatchesRestToRest) {
+  SCurveProfile restToRest(2, limits);
+  SCurveProfile replanned({1, 0, 0, 0}, 3, limits);
+
+  EXPECT_NEAR(replanned.getDuration(), restToRest.getDuration(), 1e-6);
+  EXPECT_NEAR(replanned.getState(1).position, restToRest.getState(1).position + 1, 1e-6);
+  EXPECT_NEAR(replanned.getDistance(), 3, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, ReplanFromMotionStartsAtTheState) {
+  const SCurveProfile::State start{0.3, 0.8, 1.5, 0};
+  SCurveProfile profile(start, 2, limits);
+  assertFollowsLimits(profile);
+
+  const auto first = profile.getState(0);
+  EXPECT_EQ(first.position, start.position);
+  EXPECT_EQ(first.velocity, start.velocity);
+  EXPECT_EQ(first.acceleration, start.acceleration);
+
+  // The state is continuous right after the start
+  const auto next = profile.getState(0.001);
+  EXPECT_NEAR(next.velocity, start.velocity + start.acceleration * 0.001, 1e-4);
+  EXPECT_NEAR(profile.getState(profile.getDuration()).position, 2, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, ReplanWhichCannotStopInTimeComesBack) {
+  SCurveProfile profile({0.5, 1, 0, 0}, 0.55, limits);
+
+  double furthest = 0;
+  double slowest = 0;
+  for (double time = 0; time <= profile.getDuration(); time += 0.001) {
+    const auto state = profile.getState(time);
+    EXPECT_LE(std::abs(state.velocity), limits.maxVel * (1 + 1e-9));
+    EXPECT_LE(std::abs(state.acceleration), limits.maxAccel * (1 + 1e-9));
+    EXPECT_LE(std::abs(state.jerk), limits.maxJerk * (1 + 1e-9));
+    furthest = std::max(furthest, state.position);
+    slowest = std::min(slowest, state.velocity);
+  }
+
+  EXPECT_GT(furthest, 0.55);
+  EXPECT_LT(slowest, 0);
+
+  const auto end = profile.getState(profile.getDuration());
+  EXPECT_NEAR(end.position, 0.55, 1e-9);
+  EXPECT_NEAR(end.velocity, 0, 1e-9);
+}
+
+TEST_F(SCurveProfileTest, ReplanToAnotherTargetWhileMoving) {
+  SCurveProfile original(2, limits);
+  const auto state = original.getState(1);
+
+  SCurveProfile longer(state, 3, limits);
+  assertFollowsLimits(longer);
+  EXPECT_GT(longer.getDuration(), original.getDuration() - 1);
+
+  SCurveProfile backwards(state, -1, limits);
+  EXPECT_NEAR(backwards.getState(backwards.getDuration()).position, -1, 1e-9);
+  EXPECT_LT(backwards.getState(backwards.getDuration() / 2).velocity, 0);
+}
+
+TEST_F(SCurveProfileTest, TrapezoidReplanIgnoresAcceleration) {
+  SCurveProfile profile({0, 0.5, 5, 0}, 1, limits, SCurveProfile::Shape::trapezoid);
+  assertFollowsLimits(profile);
+  EXPECT_EQ(profile.getState(0).acceleration, 0);
+  EXPECT_NEAR(profile.getState(profile.getDuration()).position, 1, 1e-9);
+}
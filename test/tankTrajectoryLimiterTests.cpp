@@ -0,0 +1,133 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/tankTrajectoryLimiter.hpp"
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class TankTrajectoryLimiterTest : public ::testing::Test {
+  protected:
+  static double peakVelocity(const std::vector<Segment> &isegments) {
+    double out = 0;
+    for (const auto &segment : isegments) {
+      out = std::max(out, std::abs(segment.velocity));
+    }
+    return out;
+  }
+
+  static void assertRespectsLimits(const std::vector<Segment> &isegments,
+                                   const TankTrajectoryLimiter &ilimiter) {
+    double lastVelocity = 0;
+    for (const auto &segment : isegments) {
+      EXPECT_LE(std::abs(segment.velocity), ilimiter.getMaxWheelVelocity() * 1.001);
+      EXPECT_LE(std::abs(segment.velocity - lastVelocity) / segment.dt,
+                ilimiter.getMaxWheelAccel() * 1.001);
+      lastVelocity = segment.velocity;
+    }
+  }
+
+  PathfinderLimits limits{1.0, 2.0, 10.0};
+  QLength wheelTrack = 10.5_in;
+
+  // A straight which turns sharply to the left
+  std::vector<PathfinderPoint> curve{{0_m, 0_m, 0_deg}, {1_m, 0_m, 0_deg}, {1.5_m, 0.5_m, 90_deg}};
+};
+
+TEST_F(TankTrajectoryLimiterTest, MaxWheelVelocityFromTheGearset) {
+  EXPECT_NEAR(
+    TankTrajectoryLimiter::computeMaxWheelVelocity(4_in, AbstractMotor::gearset::green),
+    200.0 / 60 * pi * 4 * 0.0254,
+    1e-9);
+
+  // The motors turn twice for every turn of the wheels
+  EXPECT_NEAR(
+    TankTrajectoryLimiter::computeMaxWheelVelocity(4_in, {AbstractMotor::gearset::blue, 2}),
+    600.0 / 60 / 2 * pi * 4 * 0.0254,
+    1e-9);
+}
+
+TEST_F(TankTrajectoryLimiterTest, LimitsMustBePositive) {
+  EXPECT_THROW(TankTrajectoryLimiter(0, 1), std::invalid_argument);
+  EXPECT_THROW(TankTrajectoryLimiter(1, -1), std::invalid_argument);
+}
+
+TEST_F(TankTrajectoryLimiterTest, StraightPathIsUnchanged) {
+  const auto [left, right] = TrajectoryGenerator().generateTank(
+    {{0_m, 0_m, 0_deg}, {2_m, 0_m, 0_deg}}, limits, wheelTrack);
+
+  const auto [limitedLeft, limitedRight] =
+    TankTrajectoryLimiter(1.5, limits.maxAccel)
+      .limit(left.data(), right.data(), static_cast<int>(left.size()));
+
+  ASSERT_EQ(limitedLeft.size(), left.size());
+  ASSERT_EQ(limitedRight.size(), right.size());
+  for (std::size_t i = 0; i < left.size(); ++i) {
+    EXPECT_EQ(limitedLeft[i].velocity, left[i].velocity);
+    EXPECT_EQ(limitedRight[i].position, right[i].position);
+  }
+}
+
+TEST_F(TankTrajectoryLimiterTest, OuterWheelRespectsTheLimits) {
+  const auto [left, right] = TrajectoryGenerator().generateTank(curve, limits, wheelTrack);
+
+  // The right wheel is on the outside of the turn and goes faster than the center
+  ASSERT_GT(peakVelocity(right), limits.maxVel * 1.05);
+
+  const TankTrajectoryLimiter limiter(limits.maxVel, limits.maxAccel);
+  const auto [limitedLeft, limitedRight] =
+    limiter.limit(left.data(), right.data(), static_cast<int>(left.size()));
+
+  ASSERT_EQ(limitedLeft.size(), limitedRight.size());
+  EXPECT_GT(limitedLeft.size(), left.size());
+  assertRespectsLimits(limitedLeft, limiter);
+  assertRespectsLimits(limitedRight, limiter);
+  EXPECT_NEAR(peakVelocity(limitedRight), limits.maxVel, 1e-2);
+
+  for (const auto &segment : limitedLeft) {
+    EXPECT_DOUBLE_EQ(segment.dt, left.front().dt);
+  }
+}
+
+TEST_F(TankTrajectoryLimiterTest, PathKeepsItsShape) {
+  const auto [left, right] = TrajectoryGenerator().generateTank(curve, limits, wheelTrack);
+  const auto [limitedLeft, limitedRight] =
+    TankTrajectoryLimiter(limits.maxVel, limits.maxAccel)
+      .limit(left.data(), right.data(), static_cast<int>(left.size()));
+
+  for (const auto &[original, limited] :
+       {std::pair{&left, &limitedLeft}, std::pair{&right, &limitedRight}}) {
+    EXPECT_NEAR(limited->back().position, original->back().position, 1e-9);
+    EXPECT_NEAR(limited->back().x, original->back().x, 1e-9);
+    EXPECT_NEAR(limited->back().y, original->back().y, 1e-9);
+    EXPECT_NEAR(limited->back().heading, original->back().heading, 1e-9);
+
+    // Integrating the velocity ends up where the positions say
+    double position = 0;
+    double lastVelocity = 0;
+    for (const auto &segment : *limited) {
+      position += (lastVelocity + segment.velocity) / 2 * segment.dt;
+      lastVelocity = segment.velocity;
+    }
+    EXPECT_NEAR(position, limited->back().position, 1e-2);
+  }
+}
+
+TEST_F(TankTrajectoryLimiterTest, FasterThanLoweringTheMaxVelocity) {
+  const auto [left, right] = TrajectoryGenerator().generateTank(curve, limits, wheelTrack);
+  const TankTrajectoryLimiter limiter(limits.maxVel, limits.maxAccel);
+  const auto limited = limiter.limit(left.data(), right.data(), static_cast<int>(left.size()));
+
+  // Lowering the max velocity enough for the outer wheel slows down the straight too
+  const double slower = limits.maxVel * limits.maxVel / peakVelocity(right);
+  const auto lowered = TrajectoryGenerator().generateTank(
+    curve, PathfinderLimits{slower, limits.maxAccel, limits.maxJerk}, wheelTrack);
+
+  EXPECT_LT(limited.first.size(), lowered.first.size());
+}
@@ -0,0 +1,124 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/trajectoryBaker.hpp"
+#include "bakedTestPaths.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace okapi;
+
+class TrajectoryBakerTest : public ::testing::Test {
+  protected:
+  static TrajectoryBaker::Manifest parse(const std::string &imanifest) {
+    std::istringstream stream(imanifest);
+    return TrajectoryBaker::parseManifest(stream);
+  }
+};
+
+TEST_F(TrajectoryBakerTest, ParseManifest) {
+  const auto manifest = parse("# A comment\n"
+                              "chassis 4in 0.3 # A trailing comment\n"
+                              "gearset blue 0.6\n"
+                              "generator native\n"
+                              "limits 1 2 10\n"
+                              "path A\n"
+                              "point 0 0 0\n"
+                              "point 1ft 2cm 1.5rad\n"
+                              "\n"
+                              "path B 0.5 1 5\n"
+                              "point 0 0 0\n"
+                              "point 1 0 90deg\n");
+
+  EXPECT_EQ(manifest.wheelDiameter, 4_in);
+  EXPECT_EQ(manifest.wheelTrack, 0.3_m);
+  EXPECT_EQ(manifest.pair.internalGearset, AbstractMotor::gearset::blue);
+  EXPECT_DOUBLE_EQ(manifest.pair.ratio, 0.6);
+  EXPECT_EQ(manifest.generator, TrajectoryBaker::Generator::native);
+
+  ASSERT_EQ(manifest.paths.size(), 2);
+  EXPECT_EQ(manifest.paths[0].pathId, "A");
+  EXPECT_DOUBLE_EQ(manifest.paths[0].limits.maxVel, 1);
+  ASSERT_EQ(manifest.paths[0].waypoints.size(), 2);
+  EXPECT_EQ(manifest.paths[0].waypoints[1].x, 1_ft);
+  EXPECT_EQ(manifest.paths[0].waypoints[1].y, 2_cm);
+  EXPECT_EQ(manifest.paths[0].waypoints[1].theta, 1.5_rad);
+
+  EXPECT_EQ(manifest.paths[1].pathId, "B");
+  EXPECT_DOUBLE_EQ(manifest.paths[1].limits.maxVel, 0.5);
+  EXPECT_DOUBLE_EQ(manifest.paths[1].limits.maxJerk, 5);
+  EXPECT_EQ(manifest.paths[1].waypoints[1].theta, 90_deg);
+}
+
+TEST_F(TrajectoryBakerTest, MalformedManifestThrows) {
+  EXPECT_THROW(parse("path A\npoint 0 0 0\npoint 1 0 0\n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in\n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in 0 \n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4yd 1m\n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in 1m\ngearset purple\n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in 1m\npoint 0 0 0\n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in 1m\npath A\npoint 0 0 0\n"), std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in 1m\npath A\npoint 0 0 0\npoint 1 0 0\npath A\n"),
+               std::invalid_argument);
+  EXPECT_THROW(parse("chassis 4in 1m\nwaypoint 0 0 0\n"), std::invalid_argument);
+
+  try {
+    parse("chassis 4in 1m\n\nlimits 1 fast 10\n");
+    FAIL();
+  } catch (const std::invalid_argument &e) {
+    EXPECT_NE(std::string(e.what()).find("Line 3"), std::string::npos);
+  }
+}
+
+TEST_F(TrajectoryBakerTest, WriteHeaderMatchesGeneratedPaths) {
+  TrajectoryBaker baker(parse("chassis 4in 10.5in\n"
+                              "path A\n"
+                              "point 0 0 0\n"
+                              "point 1 0 0\n"));
+
+  std::ostringstream header;
+  baker.writeHeader(header, "myPaths");
+  const auto text = header.str();
+
+  EXPECT_NE(text.find("namespace myPaths {"), std::string::npos);
+  EXPECT_NE(text.find("inline constexpr okapi::BakedPath paths[]"), std::string::npos);
+  EXPECT_NE(text.find("\"A\""), std::string::npos);
+}
+
+TEST_F(TrajectoryBakerTest, EmptyManifestCannotBeBaked) {
+  TrajectoryBaker baker(parse("chassis 4in 10.5in\n"));
+  std::ostringstream header;
+  EXPECT_THROW(baker.writeHeader(header, "myPaths"), std::runtime_error);
+}
+
+TEST_F(TrajectoryBakerTest, BakedDataMatchesGeneratedSegments) {
+  // The test paths are baked by the build from bakedTestPaths.manifest
+  ASSERT_EQ(std::size(bakedTestPaths::paths), 2);
+
+  TrajectoryBaker baker(parse("chassis 4in 10.5in\n"
+                              "gearset green 0.5\n"
+                              "path A\n"
+                              "point 0in 0in 0deg\n"
+                              "point 3ft 0in 45deg\n"));
+  const auto [left, right] = baker.generate(
+    {"A", {{0_in, 0_in, 0_deg}, {3_ft, 0_in, 45_deg}}, PathfinderLimits{1.0, 2.0, 10.0}});
+
+  const auto &baked = bakedTestPaths::paths[0];
+  EXPECT_STREQ(baked.pathId, "A");
+  ASSERT_EQ(baked.length, static_cast<std::int32_t>(left.size()));
+  EXPECT_DOUBLE_EQ(baked.dt, left.front().dt);
+  EXPECT_DOUBLE_EQ(baked.wheelDiameter, (4_in).convert(meter));
+  EXPECT_DOUBLE_EQ(baked.gearsetRpm, 200);
+  EXPECT_DOUBLE_EQ(baked.gearRatio, 0.5);
+
+  for (std::size_t i = 0; i < left.size(); ++i) {
+    EXPECT_EQ(baked.left.position[i], static_cast<float>(left[i].position));
+    EXPECT_EQ(baked.left.velocity[i], static_cast<float>(left[i].velocity));
+    EXPECT_EQ(baked.right.x[i], static_cast<float>(right[i].x));
+    EXPECT_EQ(baked.right.heading[i], static_cast<float>(right[i].heading));
+  }
+
+  EXPECT_STREQ(bakedTestPaths::paths[1].pathId, "B");
+}
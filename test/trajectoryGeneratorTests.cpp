@@ -0,0 +1,176 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/trajectoryGenerator.hpp"
+#include "okapi/api/util/mathUtil.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace okapi;
+
+class TrajectoryGeneratorTest : public ::testing::Test {
+  protected:
+  static void assertRespectsLimits(const std::vector<Segment> &isegments,
+                                   const PathfinderLimits &ilimits) {
+    for (const auto &segment : isegments) {
+      EXPECT_LE(std::abs(segment.velocity), ilimits.maxVel * 1.001);
+      EXPECT_LE(std::abs(segment.acceleration), ilimits.maxAccel * 1.001);
+      EXPECT_LE(std::abs(segment.jerk), ilimits.maxJerk * 1.001);
+    }
+  }
+
+  PathfinderLimits limits{1.0, 2.0, 10.0};
+};
+
+TEST_F(TrajectoryGeneratorTest, StraightPathRespectsLimits) {
+  TrajectoryGenerator generator;
+  const auto segments = generator.generate(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{2_m, 0_m, 0_deg}}, limits);
+
+  ASSERT_FALSE(segments.empty());
+  assertRespectsLimits(segments, limits);
+
+  EXPECT_NEAR(segments.back().position, 2, 1e-3);
+  EXPECT_NEAR(segments.back().x, 2, 1e-3);
+  EXPECT_NEAR(segments.back().velocity, 0, 1e-3);
+
+  // The robot reaches the max velocity on a path this long
+  const auto fastest = std::max_element(
+    segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+      return a.velocity < b.velocity;
+    });
+  EXPECT_NEAR(fastest->velocity, 1, 1e-2);
+
+  for (const auto &segment : segments) {
+    EXPECT_DOUBLE_EQ(segment.dt, 0.01);
+    EXPECT_NEAR(segment.y, 0, 1e-9);
+    EXPECT_NEAR(segment.heading, 0, 1e-9);
+  }
+}
+
+TEST_F(TrajectoryGeneratorTest, CurvedPathEndsAtTheLastWaypoint) {
+  TrajectoryGenerator generator;
+  const auto segments = generator.generate({PathfinderPoint{0_m, 0_m, 0_deg},
+                                            PathfinderPoint{1_m, 0.5_m, 45_deg},
+                                            PathfinderPoint{2_m, 1_m, 0_deg}},
+                                           limits);
+
+  assertRespectsLimits(segments, limits);
+  EXPECT_NEAR(segments.back().x, 2, 1e-3);
+  EXPECT_NEAR(segments.back().y, 1, 1e-3);
+  EXPECT_NEAR(segments.back().heading, 0, 1e-3);
+
+  // The path is longer than the straight line between its ends
+  EXPECT_GT(segments.back().position, std::hypot(2, 1));
+}
+
+TEST_F(TrajectoryGeneratorTest, CentripetalLimitSlowsDownInTurns) {
+  const std::vector<PathfinderPoint> waypoints{PathfinderPoint{0_m, 0_m, 0_deg},
+                                               PathfinderPoint{1_m, 1_m, 90_deg}};
+
+  TrajectoryGenerator unlimited;
+  TrajectoryGenerator limited(10_ms, 0.5);
+  const auto fast = unlimited.generate(waypoints, limits);
+  const auto slow = limited.generate(waypoints, limits);
+
+  assertRespectsLimits(slow, limits);
+  EXPECT_GT(slow.size(), fast.size());
+  EXPECT_NEAR(slow.back().position, fast.back().position, 1e-3);
+
+  // v^2 * curvature is the centripetal acceleration. Estimate the curvature from the heading.
+  for (std::size_t i = 1; i < slow.size(); ++i) {
+    const double distance = slow[i].position - slow[i - 1].position;
+    if (distance < 1e-4) {
+      continue;
+    }
+
+    double turn = std::abs(slow[i].heading - slow[i - 1].heading);
+    turn = std::min(turn, 2 * pi - turn);
+    EXPECT_LE(slow[i].velocity * slow[i].velocity * turn / distance, 0.5 * 1.05);
+  }
+}
+
+TEST_F(TrajectoryGeneratorTest, TightTurnsRespectTheLimitsAfterRefining) {
+  // The first pass overshoots the centripetal limit in both turns, so this needs to be refined
+  const std::vector<PathfinderPoint> waypoints{PathfinderPoint{0_m, 0_m, 0_deg},
+                                               PathfinderPoint{0.3_m, 0.3_m, 90_deg},
+                                               PathfinderPoint{0_m, 0.6_m, 180_deg}};
+
+  TrajectoryGenerator generator(10_ms, 0.3);
+  const auto segments = generator.generate(waypoints, limits);
+
+  assertRespectsLimits(segments, limits);
+
+  for (std::size_t i = 1; i < segments.size(); ++i) {
+    const double distance = segments[i].position - segments[i - 1].position;
+    if (distance < 1e-4) {
+      continue;
+    }
+
+    double turn = std::abs(segments[i].heading - segments[i - 1].heading);
+    turn = std::min(turn, 2 * pi - turn);
+    EXPECT_LE(segments[i].velocity * segments[i].velocity * turn / distance, 0.3 * 1.05);
+  }
+}
+
+TEST_F(TrajectoryGeneratorTest, SegmentDurationIsConfigurable) {
+  TrajectoryGenerator generator(20_ms);
+  EXPECT_EQ(generator.getDt(), 20_ms);
+
+  const auto segments = generator.generate(
+    {PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0_m, 0_deg}}, limits);
+
+  TrajectoryGenerator fine(5_ms);
+  const auto fineSegments =
+    fine.generate({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0_m, 0_deg}}, limits);
+
+  for (const auto &segment : segments) {
+    EXPECT_DOUBLE_EQ(segment.dt, 0.02);
+  }
+
+  EXPECT_NEAR(segments.back().position, 1, 1e-3);
+  EXPECT_NEAR(fineSegments.back().position, 1, 1e-3);
+  EXPECT_NEAR(segments.size() * 0.02, fineSegments.size() * 0.005, 0.05);
+}
+
+TEST_F(TrajectoryGeneratorTest, TankWheelsFollowTheCurvature) {
+  TrajectoryGenerator generator;
+  const std::vector<PathfinderPoint> waypoints{PathfinderPoint{0_m, 0_m, 0_deg},
+                                               PathfinderPoint{1_m, 1_m, 90_deg}};
+
+  const auto center = generator.generate(waypoints, limits);
+  const auto [left, right] = generator.generateTank(waypoints, limits, 0.3_m);
+
+  ASSERT_EQ(left.size(), center.size());
+  ASSERT_EQ(right.size(), center.size());
+
+  // The left wheel is on the inside of this turn
+  EXPECT_LT(left.back().position, center.back().position);
+  EXPECT_GT(right.back().position, center.back().position);
+  EXPECT_NEAR((left.back().position + right.back().position) / 2, center.back().position, 1e-3);
+
+  // The wheels are half the track from the center, on the left at +y when facing +x
+  EXPECT_NEAR(left.front().x, center.front().x, 1e-3);
+  EXPECT_NEAR(left.front().y, center.front().y + 0.15, 1e-3);
+  EXPECT_NEAR(right.front().y, center.front().y - 0.15, 1e-3);
+}
+
+TEST_F(TrajectoryGeneratorTest, InvalidInputsThrow) {
+  EXPECT_THROW(TrajectoryGenerator(0_ms), std::invalid_argument);
+  EXPECT_THROW(TrajectoryGenerator(10_ms, 0), std::invalid_argument);
+
+  TrajectoryGenerator generator;
+  EXPECT_THROW(generator.generate({PathfinderPoint{0_m, 0_m, 0_deg}}, limits),
+               std::invalid_argument);
+  EXPECT_THROW(
+    generator.generate({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{0_m, 0_m, 90_deg}},
+                       limits),
+    std::invalid_argument);
+  EXPECT_THROW(
+    generator.generate({PathfinderPoint{0_m, 0_m, 0_deg}, PathfinderPoint{1_m, 0_m, 0_deg}},
+                       {1.0, 0.0, 10.0}),
+    std::invalid_argument);
+}
@@ -0,0 +1,47 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "okapi/api/control/util/trajectoryBaker.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/**
+ * Bakes the paths in a manifest into a header of constant data. This runs on the host as part of
+ * the build. See `TrajectoryBaker::parseManifest()` for the manifest format.
+ *
+ * Usage: bakeTrajectories <manifest> <output header> [namespace]
+ */
+int main(int argc, char **argv) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0] << " <manifest> <output header> [namespace]" << std::endl;
+    return 2;
+  }
+
+  std::ifstream manifestFile(argv[1]);
+  if (!manifestFile) {
+    std::cerr << "bakeTrajectories: Could not open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  // Write the whole header at once so a failed bake does not leave a partial header behind
+  std::ostringstream header;
+  try {
+    okapi::TrajectoryBaker baker(okapi::TrajectoryBaker::parseManifest(manifestFile));
+    baker.writeHeader(header, argc > 3 ? argv[3] : "bakedPaths");
+  } catch (const std::exception &e) {
+    std::cerr << "bakeTrajectories: " << argv[1] << ": " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::ofstream headerFile(argv[2]);
+  headerFile << header.str();
+  if (!headerFile) {
+    std::cerr << "bakeTrajectories: Could not write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  return 0;
+}